@@ -1,8 +1,16 @@
 #include "animals_manager.h"
+#include "stock_manager.h"
+#include "archive_store.h"
+#include "regulatory_compliance.h"
+#include "breeding_register.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 #include <string.h>
+#include <stdio.h>
 #include <inttypes.h>
 
 static const char* TAG = "ANIMALS_MANAGER";
@@ -12,6 +20,342 @@ static bool g_initialized = false;
 static animal_t g_animals[MAX_ANIMALS];
 static uint32_t g_animals_count = 0;
 static uint32_t g_next_id = 1;
+static SemaphoreHandle_t g_mutex = NULL;  // Protège les animaux, leurs événements et la tournée de nourrissage
+
+// Versions de changement et dernières suppressions, pour les sauvegardes incrémentales
+static uint32_t g_change_version = 0;
+static record_deletion_t g_deletions[CHANGE_LOG_DELETIONS];
+static uint32_t g_deletions_count = 0;
+static uint32_t g_forgotten_version = 0;    // Suppressions oubliées jusqu'à cette version incluse
+
+// Tournée de nourrissage : déductions de stock regroupées jusqu'à la fin de la tournée
+static bool g_feeding_round_active = false;
+static stock_deduction_batch_t g_feeding_batch;
+
+// Événements récents triés par date (en PSRAM) ; les plus anciens sont déplacés dans l'archive
+static animal_event_t* g_events = NULL;
+static uint32_t g_events_count = 0;
+static archive_store_t g_event_archive;
+static bool g_event_archive_enabled = false;
+static uint8_t g_event_payload[sizeof(animal_event_t)];
+static animal_event_t g_register_event;  // Événement archivé en cours de lecture pour le registre
+
+// Les animaux sont rangés par ID croissant (ajout en fin, suppression par décalage) :
+// position du premier ID supérieur ou égal
+static uint32_t animal_lower_bound(uint32_t animal_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_animals_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_animals[mid].id < animal_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static int32_t find_animal_index(uint32_t animal_id)
+{
+    uint32_t low = animal_lower_bound(animal_id);
+    if (low < g_animals_count && g_animals[low].id == animal_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+static void log_deletion(uint32_t animal_id)
+{
+    // Journal plein : la suppression la plus ancienne est oubliée
+    if (g_deletions_count == CHANGE_LOG_DELETIONS) {
+        g_forgotten_version = g_deletions[0].version;
+        memmove(&g_deletions[0], &g_deletions[1], (CHANGE_LOG_DELETIONS - 1) * sizeof(record_deletion_t));
+        g_deletions_count--;
+    }
+    
+    g_deletions[g_deletions_count].id = animal_id;
+    g_deletions[g_deletions_count].version = ++g_change_version;
+    g_deletions_count++;
+}
+
+// Ajoute une déduction au lot courant, en appliquant le lot s'il est plein ; si cette application
+// échoue, le lot reste plein jusqu'à la fin de la tournée (après réapprovisionnement) ou son abandon
+static system_error_t queue_food_deduction(uint32_t item_id, float quantity)
+{
+    system_error_t ret = stock_batch_add(&g_feeding_batch, item_id, quantity);
+    if (ret == SYSTEM_ERROR_MEMORY) {
+        ret = stock_batch_commit(&g_feeding_batch);
+        if (ret != SYSTEM_OK) {
+            return ret;
+        }
+        ret = stock_batch_add(&g_feeding_batch, item_id, quantity);
+    }
+    
+    return ret;
+}
+
+// Image d'un événement dans l'archive : champs fixes puis textes préfixés par leur longueur
+static size_t put_bytes(size_t pos, const void* data, size_t length)
+{
+    memcpy(&g_event_payload[pos], data, length);
+    return pos + length;
+}
+
+static size_t put_string(size_t pos, const char* str, size_t max_len)
+{
+    uint16_t length = (uint16_t)strnlen(str, max_len);
+    pos = put_bytes(pos, &length, sizeof(length));
+    return put_bytes(pos, str, length);
+}
+
+static size_t encode_event(const animal_event_t* event)
+{
+    size_t pos = 0;
+    
+    pos = put_bytes(pos, &event->weight_grams, sizeof(event->weight_grams));
+    pos = put_bytes(pos, &event->food_item_id, sizeof(event->food_item_id));
+    pos = put_bytes(pos, &event->food_quantity, sizeof(event->food_quantity));
+    pos = put_string(pos, event->event_type, sizeof(event->event_type) - 1);
+    pos = put_string(pos, event->description, sizeof(event->description) - 1);
+    pos = put_string(pos, event->notes, sizeof(event->notes) - 1);
+    
+    return pos;
+}
+
+static bool get_bytes(const archive_record_t* record, size_t* pos, void* data, size_t size)
+{
+    if (*pos + size > record->length) {
+        return false;
+    }
+    memcpy(data, &record->payload[*pos], size);
+    *pos += size;
+    return true;
+}
+
+static bool get_string(const archive_record_t* record, size_t* pos, char* dst, size_t size)
+{
+    uint16_t length;
+    if (!get_bytes(record, pos, &length, sizeof(length)) || length >= size || !get_bytes(record, pos, dst, length)) {
+        return false;
+    }
+    dst[length] = '\0';
+    return true;
+}
+
+static bool decode_event(const archive_record_t* record, animal_event_t* event)
+{
+    size_t pos = 0;
+    
+    memset(event, 0, sizeof(animal_event_t));
+    event->animal_id = record->keys[0];
+    event->event_date = record->date;
+    
+    return get_bytes(record, &pos, &event->weight_grams, sizeof(event->weight_grams)) &&
+           get_bytes(record, &pos, &event->food_item_id, sizeof(event->food_item_id)) &&
+           get_bytes(record, &pos, &event->food_quantity, sizeof(event->food_quantity)) &&
+           get_string(record, &pos, event->event_type, sizeof(event->event_type)) &&
+           get_string(record, &pos, event->description, sizeof(event->description)) &&
+           get_string(record, &pos, event->notes, sizeof(event->notes));
+}
+
+// Déplace dans l'archive les événements datés avant cutoff
+static system_error_t archive_events_before(time_t cutoff)
+{
+    uint32_t count = 0;
+    while (count < g_events_count && g_events[count].event_date < cutoff) {
+        count++;
+    }
+    if (count == 0) {
+        return SYSTEM_OK;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    for (uint32_t i = 0; i < count && ret == SYSTEM_OK; i++) {
+        uint32_t keys[ARCHIVE_KEY_COUNT] = { g_events[i].animal_id, 0, 0 };
+        size_t length = encode_event(&g_events[i]);
+        ret = archive_store_add(&g_event_archive, g_events[i].event_date, keys, g_event_payload, length);
+        if (ret == SYSTEM_ERROR_MEMORY) {
+            // Lot plein : l'écrire puis reprendre
+            ret = archive_store_commit(&g_event_archive);
+            if (ret == SYSTEM_OK) {
+                ret = archive_store_add(&g_event_archive, g_events[i].event_date, keys, g_event_payload, length);
+            }
+        }
+    }
+    if (ret == SYSTEM_OK) {
+        ret = archive_store_commit(&g_event_archive);
+    }
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Échec de l'archivage des événements");
+        return ret;
+    }
+    
+    memmove(&g_events[0], &g_events[count], (g_events_count - count) * sizeof(animal_event_t));
+    g_events_count -= count;
+    
+    ESP_LOGI(TAG, "%" PRIu32 " événements archivés", count);
+    return SYSTEM_OK;
+}
+
+static system_error_t store_event(const animal_event_t* event)
+{
+    if (g_events_count >= MAX_ANIMAL_EVENTS) {
+        // Table pleine : le plus ancien quart part dans l'archive, ou est abandonné sans archive
+        uint32_t quarter = MAX_ANIMAL_EVENTS / 4;
+        if (!g_event_archive_enabled || archive_events_before(g_events[quarter].event_date) != SYSTEM_OK ||
+            g_events_count >= MAX_ANIMAL_EVENTS) {
+            ESP_LOGW(TAG, "Table des événements pleine, %" PRIu32 " événements les plus anciens abandonnés", quarter);
+            memmove(&g_events[0], &g_events[quarter], (g_events_count - quarter) * sizeof(animal_event_t));
+            g_events_count -= quarter;
+        }
+    }
+    
+    // Insertion après les événements de même date
+    uint32_t low = 0;
+    uint32_t high = g_events_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_events[mid].event_date <= event->event_date) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    memmove(&g_events[low + 1], &g_events[low], (g_events_count - low) * sizeof(animal_event_t));
+    g_events[low] = *event;
+    g_events_count++;
+    return SYSTEM_OK;
+}
+
+// Transmet au suivi de conformité les éléments réglementaires d'un animal
+static void report_compliance(const animal_t* animal)
+{
+    compliance_animal_info_t info = {
+        .animal_id = animal->id,
+        .status = (uint8_t)animal->status,
+        .cites_declared = animal->cites_required,
+        .has_cites_number = (animal->cites_number[0] != '\0')
+    };
+    snprintf(info.species_name, sizeof(info.species_name), "%s", animal->species);
+    regulatory_animal_changed(&info);
+}
+
+// Nom de l'animal suivi de sa puce, pour le registre
+static void describe_animal(uint32_t animal_id, char* buffer, size_t size)
+{
+    int32_t index = find_animal_index(animal_id);
+    if (index < 0) {
+        snprintf(buffer, size, "ID %" PRIu32, animal_id);
+    } else if (g_animals[index].microchip_id[0] != '\0') {
+        snprintf(buffer, size, "%s (%s)", g_animals[index].name, g_animals[index].microchip_id);
+    } else {
+        snprintf(buffer, size, "%s", g_animals[index].name);
+    }
+}
+
+// Registre : une entrée par animal, à sa date d'acquisition ou de naissance
+static void fetch_register_animals(register_batch_t* batch)
+{
+    register_entry_t entry;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < g_animals_count; i++) {
+        const animal_t* animal = &g_animals[i];
+        time_t date = (animal->acquisition_date != 0) ? animal->acquisition_date :
+                      (animal->birth_date != 0) ? animal->birth_date : animal->created_at;
+        if (!register_batch_accepts(batch, date, animal->id)) {
+            continue;
+        }
+        
+        memset(&entry, 0, sizeof(entry));
+        entry.date = date;
+        entry.key = animal->id;
+        entry.animal_id = animal->id;
+        entry.movement = REGISTER_MOVEMENT_ENTRY;
+        snprintf(entry.species_name, sizeof(entry.species_name), "%s", animal->species);
+        describe_animal(animal->id, entry.identification, sizeof(entry.identification));
+        snprintf(entry.reason, sizeof(entry.reason), "%s",
+                 (animal->acquisition_date != 0) ? "Acquisition" : "Naissance");
+        snprintf(entry.counterpart, sizeof(entry.counterpart), "%s", animal->origin);
+        snprintf(entry.document, sizeof(entry.document), "%s", animal->cites_number);
+        register_batch_offer(batch, &entry);
+    }
+    xSemaphoreGive(g_mutex);
+}
+
+// Propose au registre un événement de naissance ou de décès
+static void offer_register_event(register_batch_t* batch, const animal_event_t* event)
+{
+    bool birth = (strcmp(event->event_type, ANIMAL_EVENT_BIRTH) == 0);
+    if ((!birth && strcmp(event->event_type, ANIMAL_EVENT_DEATH) != 0) ||
+        !register_batch_accepts(batch, event->event_date, event->animal_id)) {
+        return;
+    }
+    
+    register_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.date = event->event_date;
+    entry.key = event->animal_id;
+    entry.animal_id = event->animal_id;
+    entry.movement = birth ? REGISTER_MOVEMENT_ENTRY : REGISTER_MOVEMENT_EXIT;
+    int32_t index = find_animal_index(event->animal_id);
+    if (index >= 0) {
+        snprintf(entry.species_name, sizeof(entry.species_name), "%s", g_animals[index].species);
+    }
+    describe_animal(event->animal_id, entry.identification, sizeof(entry.identification));
+    snprintf(entry.reason, sizeof(entry.reason), "%s", birth ? "Naissance" : "Décès");
+    snprintf(entry.counterpart, sizeof(entry.counterpart), "%.*s",
+             (int)sizeof(entry.counterpart) - 1, event->description);
+    register_batch_offer(batch, &entry);
+}
+
+static bool visit_register_event(const archive_record_t* record, void* context)
+{
+    register_batch_t* batch = (register_batch_t*)context;
+    
+    if (register_batch_complete(batch, record->date)) {
+        return false;
+    }
+    if (decode_event(record, &g_register_event)) {
+        offer_register_event(batch, &g_register_event);
+    }
+    
+    return true;
+}
+
+// Registre : naissances et décès, de l'archive puis des événements récents
+static void fetch_register_events(register_batch_t* batch)
+{
+    time_t start_date = batch->started ? batch->after_date : 0;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_event_archive_enabled) {
+        archive_store_query(&g_event_archive, start_date, 0, -1, 0, visit_register_event, batch);
+    }
+    
+    uint32_t low = 0;
+    uint32_t high = g_events_count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_events[mid].event_date < start_date) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    for (uint32_t i = low; i < g_events_count && !register_batch_complete(batch, g_events[i].event_date); i++) {
+        offer_register_event(batch, &g_events[i]);
+    }
+    
+    xSemaphoreGive(g_mutex);
+}
 
 system_error_t animals_manager_init(void)
 {
@@ -21,6 +365,11 @@ system_error_t animals_manager_init(void)
     
     ESP_LOGI(TAG, "Initialisation du gestionnaire d'animaux...");
     
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_mutex == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
     // Initialisation des données
     memset(g_animals, 0, sizeof(g_animals));
     g_animals_count = 0;
@@ -28,6 +377,24 @@ system_error_t animals_manager_init(void)
     
     // TODO: Charger les données depuis NVS
     
+    g_events = heap_caps_calloc(MAX_ANIMAL_EVENTS, sizeof(animal_event_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_events == NULL) {
+        g_events = heap_caps_calloc(MAX_ANIMAL_EVENTS, sizeof(animal_event_t), MALLOC_CAP_8BIT);
+    }
+    if (g_events == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer la table des événements");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    g_events_count = 0;
+    
+    g_event_archive_enabled = (archive_store_open(&g_event_archive, EVENT_ARCHIVE_PATH, NULL) == SYSTEM_OK);
+    if (!g_event_archive_enabled) {
+        ESP_LOGW(TAG, "Archive des événements indisponible");
+    }
+    
+    breeding_register_set_source(REGISTER_SOURCE_ANIMALS, fetch_register_animals);
+    breeding_register_set_source(REGISTER_SOURCE_EVENTS, fetch_register_events);
+    
     g_initialized = true;
     ESP_LOGI(TAG, "Gestionnaire d'animaux initialisé");
     
@@ -40,7 +407,10 @@ system_error_t animals_add(animal_t* animal)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     if (g_animals_count >= MAX_ANIMALS) {
+        xSemaphoreGive(g_mutex);
         ESP_LOGE(TAG, "Nombre maximum d'animaux atteint");
         return SYSTEM_ERROR_MEMORY;
     }
@@ -49,10 +419,14 @@ system_error_t animals_add(animal_t* animal)
     animal->id = g_next_id++;
     animal->created_at = time(NULL);
     animal->updated_at = animal->created_at;
+    animal->change_version = ++g_change_version;
     
     // Ajouter à la liste
     memcpy(&g_animals[g_animals_count], animal, sizeof(animal_t));
     g_animals_count++;
+    report_compliance(animal);
+    
+    xSemaphoreGive(g_mutex);
     
     ESP_LOGI(TAG, "Animal ajouté: ID=%" PRIu32 ", Nom=%s", animal->id, animal->name);
     
@@ -67,22 +441,28 @@ system_error_t animals_update(const animal_t* animal)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher l'animal
-    for (uint32_t i = 0; i < g_animals_count; i++) {
-        if (g_animals[i].id == animal->id) {
-            memcpy(&g_animals[i], animal, sizeof(animal_t));
-            g_animals[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Animal mis à jour: ID=%" PRIu32, animal->id);
-            
-            // TODO: Sauvegarder dans NVS
-            
-            return SYSTEM_OK;
-        }
+    int32_t index = find_animal_index(animal->id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGW(TAG, "Animal non trouvé: ID=%" PRIu32, animal->id);
+        return SYSTEM_ERROR_NOT_FOUND;
     }
     
-    ESP_LOGW(TAG, "Animal non trouvé: ID=%" PRIu32, animal->id);
-    return SYSTEM_ERROR_NOT_FOUND;
+    memcpy(&g_animals[index], animal, sizeof(animal_t));
+    g_animals[index].updated_at = time(NULL);
+    g_animals[index].change_version = ++g_change_version;
+    report_compliance(&g_animals[index]);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Animal mis à jour: ID=%" PRIu32, animal->id);
+    
+    // TODO: Sauvegarder dans NVS
+    
+    return SYSTEM_OK;
 }
 
 system_error_t animals_delete(uint32_t animal_id)
@@ -91,25 +471,29 @@ system_error_t animals_delete(uint32_t animal_id)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher et supprimer l'animal
-    for (uint32_t i = 0; i < g_animals_count; i++) {
-        if (g_animals[i].id == animal_id) {
-            // Décaler les éléments suivants
-            for (uint32_t j = i; j < g_animals_count - 1; j++) {
-                memcpy(&g_animals[j], &g_animals[j + 1], sizeof(animal_t));
-            }
-            g_animals_count--;
-            
-            ESP_LOGI(TAG, "Animal supprimé: ID=%" PRIu32, animal_id);
-            
-            // TODO: Sauvegarder dans NVS
-            
-            return SYSTEM_OK;
-        }
+    int32_t index = find_animal_index(animal_id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGW(TAG, "Animal non trouvé pour suppression: ID=%" PRIu32, animal_id);
+        return SYSTEM_ERROR_NOT_FOUND;
     }
     
-    ESP_LOGW(TAG, "Animal non trouvé pour suppression: ID=%" PRIu32, animal_id);
-    return SYSTEM_ERROR_NOT_FOUND;
+    // Décaler les éléments suivants
+    memmove(&g_animals[index], &g_animals[index + 1], (g_animals_count - (uint32_t)index - 1) * sizeof(animal_t));
+    g_animals_count--;
+    log_deletion(animal_id);
+    regulatory_animal_removed(animal_id);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Animal supprimé: ID=%" PRIu32, animal_id);
+    
+    // TODO: Sauvegarder dans NVS
+    
+    return SYSTEM_OK;
 }
 
 system_error_t animals_get_by_id(uint32_t animal_id, animal_t* animal)
@@ -118,14 +502,17 @@ system_error_t animals_get_by_id(uint32_t animal_id, animal_t* animal)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    for (uint32_t i = 0; i < g_animals_count; i++) {
-        if (g_animals[i].id == animal_id) {
-            memcpy(animal, &g_animals[i], sizeof(animal_t));
-            return SYSTEM_OK;
-        }
+    system_error_t ret = SYSTEM_ERROR_NOT_FOUND;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    int32_t index = find_animal_index(animal_id);
+    if (index >= 0) {
+        memcpy(animal, &g_animals[index], sizeof(animal_t));
+        ret = SYSTEM_OK;
     }
+    xSemaphoreGive(g_mutex);
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    return ret;
 }
 
 system_error_t animals_get_all(animal_t* animals, uint32_t max_count, uint32_t* count)
@@ -134,29 +521,306 @@ system_error_t animals_get_all(animal_t* animals, uint32_t max_count, uint32_t*
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     uint32_t copy_count = (g_animals_count < max_count) ? g_animals_count : max_count;
     
     for (uint32_t i = 0; i < copy_count; i++) {
         memcpy(&animals[i], &g_animals[i], sizeof(animal_t));
     }
     
+    xSemaphoreGive(g_mutex);
+    
     *count = copy_count;
     return SYSTEM_OK;
 }
 
+// Parcours par lots : les animaux sont copiés sous g_mutex par ID croissant, chaque lot reprenant
+// après le dernier ID du précédent, puis remis à l'appelant hors du verrou
+#define VISIT_BATCH_ENTRIES     16
+
+system_error_t animals_for_each(animal_visit_fn_t visit, void* context)
+{
+    if (!g_initialized || visit == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    animal_t* batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(animal_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (batch == NULL) {
+        batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(animal_t), MALLOC_CAP_8BIT);
+    }
+    if (batch == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    uint32_t next_id = 0;
+    uint32_t count;
+    bool keep_going = true;
+    do {
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+        uint32_t pos = animal_lower_bound(next_id);
+        count = (g_animals_count - pos < VISIT_BATCH_ENTRIES) ? g_animals_count - pos : VISIT_BATCH_ENTRIES;
+        memcpy(batch, &g_animals[pos], count * sizeof(animal_t));
+        xSemaphoreGive(g_mutex);
+        
+        for (uint32_t i = 0; keep_going && i < count; i++) {
+            keep_going = visit(&batch[i], context);
+        }
+        if (count > 0) {
+            next_id = batch[count - 1].id + 1;
+        }
+    } while (keep_going && count == VISIT_BATCH_ENTRIES);
+    
+    heap_caps_free(batch);
+    return SYSTEM_OK;
+}
+
+system_error_t animals_restore(const animal_t* animals, uint32_t count)
+{
+    if (!g_initialized || animals == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const animal_t* animal = &animals[i];
+        int32_t index = find_animal_index(animal->id);
+        if (index < 0) {
+            if (g_animals_count >= MAX_ANIMALS) {
+                xSemaphoreGive(g_mutex);
+                ESP_LOGE(TAG, "Nombre maximum d'animaux atteint");
+                return SYSTEM_ERROR_MEMORY;
+            }
+            
+            // Insertion à sa place dans l'ordre des IDs
+            uint32_t pos = g_animals_count;
+            while (pos > 0 && g_animals[pos - 1].id > animal->id) {
+                pos--;
+            }
+            memmove(&g_animals[pos + 1], &g_animals[pos], (g_animals_count - pos) * sizeof(animal_t));
+            g_animals_count++;
+            index = (int32_t)pos;
+        }
+        
+        memcpy(&g_animals[index], animal, sizeof(animal_t));
+        g_animals[index].change_version = ++g_change_version;
+        report_compliance(&g_animals[index]);
+        if (animal->id >= g_next_id) {
+            g_next_id = animal->id + 1;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return SYSTEM_OK;
+}
+
+uint32_t animals_get_change_version(void)
+{
+    if (!g_initialized) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    uint32_t version = g_change_version;
+    xSemaphoreGive(g_mutex);
+    return version;
+}
+
+system_error_t animals_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                     uint32_t* count)
+{
+    if (!g_initialized || deletions == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    *count = 0;
+    if (since_version < g_forgotten_version) {
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    }
+    for (uint32_t i = 0; ret == SYSTEM_OK && i < g_deletions_count; i++) {
+        if (g_deletions[i].version <= since_version) {
+            continue;
+        }
+        if (*count >= max_count) {
+            ret = SYSTEM_ERROR_MEMORY;
+            break;
+        }
+        deletions[(*count)++] = g_deletions[i];
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return ret;
+}
+
 system_error_t animals_add_event(const animal_event_t* event)
 {
     if (!g_initialized || event == NULL) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    bool feeding = (strcmp(event->event_type, ANIMAL_EVENT_FEEDING) == 0);
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    // La déduction de stock passe avant l'enregistrement : en cas d'échec aucun événement n'est
+    // ajouté et l'appelant peut réessayer sans doublon. Hors tournée elle est appliquée immédiatement.
+    if (feeding && event->food_item_id != 0 && event->food_quantity > 0.0f) {
+        system_error_t ret;
+        if (g_feeding_round_active) {
+            ret = queue_food_deduction(event->food_item_id, event->food_quantity);
+        } else {
+            stock_batch_init(&g_feeding_batch, "Nourrissage");
+            ret = stock_batch_add(&g_feeding_batch, event->food_item_id, event->food_quantity);
+            if (ret == SYSTEM_OK) {
+                ret = stock_batch_commit(&g_feeding_batch);
+            }
+        }
+        if (ret != SYSTEM_OK) {
+            xSemaphoreGive(g_mutex);
+            ESP_LOGW(TAG, "Événement non ajouté pour animal ID=%" PRIu32 ": déduction de stock impossible",
+                     event->animal_id);
+            return ret;
+        }
+    }
+    
+    system_error_t ret = store_event(event);
+    if (ret != SYSTEM_OK) {
+        xSemaphoreGive(g_mutex);
+        return ret;
+    }
+    
+    int32_t index = find_animal_index(event->animal_id);
+    if (feeding && index >= 0 && event->event_date > g_animals[index].last_feeding) {
+        g_animals[index].last_feeding = event->event_date;
+        g_animals[index].change_version = ++g_change_version;
+    }
+    
+    xSemaphoreGive(g_mutex);
+    
     ESP_LOGI(TAG, "Événement ajouté pour animal ID=%" PRIu32 ": %s", event->animal_id, event->event_type);
     
-    // TODO: Implémenter le stockage des événements
+    return SYSTEM_OK;
+}
+
+system_error_t animals_begin_feeding_round(void)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_feeding_round_active) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_OK;
+    }
+    
+    stock_batch_init(&g_feeding_batch, "Tournée de nourrissage");
+    g_feeding_round_active = true;
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Tournée de nourrissage démarrée");
+    return SYSTEM_OK;
+}
+
+system_error_t animals_end_feeding_round(void)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (!g_feeding_round_active) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    // Le lot est appliqué en entier ou pas du tout : en cas d'échec la tournée reste ouverte
+    // avec ses déductions, pour être terminée à nouveau après réapprovisionnement
+    system_error_t ret = stock_batch_commit(&g_feeding_batch);
+    if (ret != SYSTEM_OK) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGE(TAG, "Échec de la déduction de stock de la tournée, déductions conservées");
+        return ret;
+    }
+    
+    g_feeding_round_active = false;
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Tournée de nourrissage terminée");
+    return SYSTEM_OK;
+}
+
+system_error_t animals_abort_feeding_round(void)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     
+    if (!g_feeding_round_active) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    // Les événements de la tournée restent enregistrés, seules leurs déductions sont abandonnées
+    ESP_LOGW(TAG, "Tournée de nourrissage abandonnée, %" PRIu32 " déductions de stock non appliquées",
+             g_feeding_batch.line_count);
+    stock_batch_init(&g_feeding_batch, NULL);
+    g_feeding_round_active = false;
+    
+    xSemaphoreGive(g_mutex);
     return SYSTEM_OK;
 }
 
+// Historique d'un animal par date croissante : archive et événements récents fusionnés
+typedef struct {
+    uint32_t animal_id;
+    uint32_t hot_pos;
+    animal_event_t* events;
+    uint32_t max_count;
+    uint32_t found_count;
+} event_cursor_t;
+
+// Copie les événements récents de l'animal datés au plus de until
+static bool emit_recent_events(event_cursor_t* cursor, time_t until)
+{
+    for (; cursor->hot_pos < g_events_count && cursor->found_count < cursor->max_count; cursor->hot_pos++) {
+        const animal_event_t* event = &g_events[cursor->hot_pos];
+        if (event->event_date > until) {
+            break;
+        }
+        if (event->animal_id == cursor->animal_id) {
+            cursor->events[cursor->found_count++] = *event;
+        }
+    }
+    
+    return cursor->found_count < cursor->max_count;
+}
+
+static bool visit_archived_event(const archive_record_t* record, void* context)
+{
+    event_cursor_t* cursor = (event_cursor_t*)context;
+    
+    if (!emit_recent_events(cursor, record->date)) {
+        return false;
+    }
+    if (decode_event(record, &cursor->events[cursor->found_count])) {
+        cursor->found_count++;
+    }
+    
+    return cursor->found_count < cursor->max_count;
+}
+
 system_error_t animals_get_events(uint32_t animal_id, animal_event_t* events, 
                                  uint32_t max_count, uint32_t* count)
 {
@@ -164,12 +828,32 @@ system_error_t animals_get_events(uint32_t animal_id, animal_event_t* events,
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des événements
-    *count = 0;
+    event_cursor_t cursor = { .animal_id = animal_id, .events = events, .max_count = max_count };
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    if (max_count > 0 && g_event_archive_enabled) {
+        archive_store_query(&g_event_archive, 0, 0, 0, animal_id, visit_archived_event, &cursor);
+    }
+    emit_recent_events(&cursor, (time_t)INT64_MAX);
+    xSemaphoreGive(g_mutex);
     
+    *count = cursor.found_count;
     return SYSTEM_OK;
 }
 
+system_error_t animals_archive_events(time_t now)
+{
+    if (!g_initialized || !g_event_archive_enabled) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    system_error_t ret = archive_events_before(now - (time_t)EVENT_ARCHIVE_DAYS * 24 * 3600);
+    xSemaphoreGive(g_mutex);
+    
+    return ret;
+}
+
 system_error_t animals_get_stats(animals_stats_t* stats)
 {
     if (!g_initialized || stats == NULL) {
@@ -178,7 +862,13 @@ system_error_t animals_get_stats(animals_stats_t* stats)
     
     memset(stats, 0, sizeof(animals_stats_t));
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     stats->total_animals = g_animals_count;
+    stats->total_events = g_events_count;
+    if (g_event_archive_enabled) {
+        stats->total_events += archive_store_count(&g_event_archive);
+    }
     
     // Calculer les statistiques
     for (uint32_t i = 0; i < g_animals_count; i++) {
@@ -195,6 +885,8 @@ system_error_t animals_get_stats(animals_stats_t* stats)
         }
     }
     
+    xSemaphoreGive(g_mutex);
+    
     return SYSTEM_OK;
 }
 
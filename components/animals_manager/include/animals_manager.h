@@ -53,8 +53,24 @@ typedef struct {
     char cites_number[32];
     time_t created_at;
     time_t updated_at;
+    uint32_t change_version;    // Version de la dernière modification (attribuée par le gestionnaire)
 } animal_t;
 
+/**
+ * @brief Fonction appelée pour chaque animal d'un parcours
+ * @param animal Animal (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ * @return true pour continuer le parcours, false pour l'arrêter
+ */
+typedef bool (*animal_visit_fn_t)(const animal_t* animal, void* context);
+
+// Type d'événement déclenchant la déduction de nourriture
+#define ANIMAL_EVENT_FEEDING    "feeding"
+
+// Types d'événements reportés au registre d'entrées et de sorties
+#define ANIMAL_EVENT_BIRTH      "birth"
+#define ANIMAL_EVENT_DEATH      "death"
+
 // Structure pour les événements d'animaux
 typedef struct {
     uint32_t animal_id;
@@ -63,6 +79,8 @@ typedef struct {
     char description[256];
     float weight_grams;
     char notes[256];
+    uint32_t food_item_id;  // Article de stock consommé (0 si aucun)
+    float food_quantity;
 } animal_event_t;
 
 // Structure pour les statistiques
@@ -121,15 +139,72 @@ system_error_t animals_get_by_id(uint32_t animal_id, animal_t* animal);
  */
 system_error_t animals_get_all(animal_t* animals, uint32_t max_count, uint32_t* count);
 
+/**
+ * @brief Parcourt les animaux par ID croissant
+ *
+ * Les animaux sont copiés sous le verrou par petits lots et visit est appelée hors du verrou :
+ * elle peut lire ou modifier les animaux, un parcours reflète alors chaque lot au moment de sa copie.
+ *
+ * @param visit Fonction appelée pour chaque animal
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot n'a pas pu être alloué
+ */
+system_error_t animals_for_each(animal_visit_fn_t visit, void* context);
+
+/**
+ * @brief Restaure des animaux sauvegardés avec leurs IDs et leurs dates (un animal de même ID est remplacé)
+ * @param animals Animaux à restaurer
+ * @param count Nombre d'animaux
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si la table est pleine
+ */
+system_error_t animals_restore(const animal_t* animals, uint32_t count);
+
+/**
+ * @brief Version de changement courante, avancée à chaque ajout, modification ou suppression d'animal
+ * @return Dernière version attribuée (0 au démarrage)
+ */
+uint32_t animals_get_change_version(void);
+
+/**
+ * @brief Copie les suppressions d'animaux postérieures à une version de changement
+ * @param since_version Version de référence
+ * @param deletions Tableau à remplir (CHANGE_LOG_DELETIONS entrées suffisent)
+ * @param max_count Taille du tableau
+ * @param count Pointeur vers le nombre de suppressions copiées
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si des suppressions postérieures ont été oubliées
+ */
+system_error_t animals_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                     uint32_t* count);
+
 /**
  * @brief Ajoute un événement pour un animal
  * @param event Pointeur vers la structure événement
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès ; si la déduction de stock d'un nourrissage échoue,
+ *         l'erreur est renvoyée et l'événement n'est pas ajouté
  */
 system_error_t animals_add_event(const animal_event_t* event);
 
 /**
- * @brief Récupère les événements d'un animal
+ * @brief Démarre une tournée de nourrissage : les déductions de stock sont regroupées
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t animals_begin_feeding_round(void);
+
+/**
+ * @brief Termine la tournée et applique les déductions de stock en une seule fois
+ * @return SYSTEM_OK en cas de succès ; en cas d'échec (stock insuffisant) la tournée
+ *         reste ouverte avec toutes ses déductions et peut être terminée à nouveau ou abandonnée
+ */
+system_error_t animals_end_feeding_round(void);
+
+/**
+ * @brief Abandonne la tournée sans appliquer ses déductions de stock (les événements sont conservés)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_INVALID_PARAM si aucune tournée n'est ouverte
+ */
+system_error_t animals_abort_feeding_round(void);
+
+/**
+ * @brief Récupère les événements d'un animal, archivés compris, triés par date
  * @param animal_id ID de l'animal
  * @param events Tableau d'événements à remplir
  * @param max_count Nombre maximum d'événements à récupérer
@@ -139,6 +214,13 @@ system_error_t animals_add_event(const animal_event_t* event);
 system_error_t animals_get_events(uint32_t animal_id, animal_event_t* events, 
                                  uint32_t max_count, uint32_t* count);
 
+/**
+ * @brief Déplace dans l'archive les événements de plus de EVENT_ARCHIVE_DAYS jours
+ * @param now Date de référence
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t animals_archive_events(time_t now);
+
 /**
  * @brief Récupère les statistiques des animaux
  * @param stats Pointeur vers la structure statistiques à remplir
@@ -0,0 +1,176 @@
+#include "archive_lz.h"
+#include <string.h>
+
+#define LZ_MIN_MATCH    4
+#define LZ_MAX_OFFSET   0xFFFF
+#define LZ_HASH_SHIFT   (32 - 12)  // log2(ARCHIVE_LZ_HASH_SIZE)
+
+static uint32_t read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hash32(uint32_t value)
+{
+    return (value * 2654435761u) >> LZ_HASH_SHIFT;
+}
+
+// Longueur au-delà de 15 : suite d'octets 255 terminée par le reste
+static uint8_t* write_length(uint8_t* op, const uint8_t* end, size_t length)
+{
+    while (length >= 255) {
+        if (op >= end) {
+            return NULL;
+        }
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= end) {
+        return NULL;
+    }
+    *op++ = (uint8_t)length;
+    return op;
+}
+
+// Séquence : jeton (littéraux << 4 | correspondance - 4), littéraux, offset, suite de la longueur
+static uint8_t* write_sequence(uint8_t* op, const uint8_t* end, const uint8_t* literals, size_t literal_length,
+                               size_t offset, size_t match_length)
+{
+    if (op >= end) {
+        return NULL;
+    }
+    
+    uint8_t* token = op++;
+    size_t match_code = (match_length > 0) ? match_length - LZ_MIN_MATCH : 0;
+    *token = (uint8_t)(((literal_length < 15) ? literal_length : 15) << 4);
+    *token |= (uint8_t)((match_code < 15) ? match_code : 15);
+    
+    if (literal_length >= 15 && (op = write_length(op, end, literal_length - 15)) == NULL) {
+        return NULL;
+    }
+    if ((size_t)(end - op) < literal_length) {
+        return NULL;
+    }
+    memcpy(op, literals, literal_length);
+    op += literal_length;
+    
+    // La dernière séquence ne contient que des littéraux
+    if (match_length == 0) {
+        return op;
+    }
+    
+    if (end - op < 2) {
+        return NULL;
+    }
+    *op++ = (uint8_t)(offset & 0xFF);
+    *op++ = (uint8_t)(offset >> 8);
+    
+    if (match_code >= 15) {
+        op = write_length(op, end, match_code - 15);
+    }
+    return op;
+}
+
+size_t archive_lz_compress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity, uint16_t* table)
+{
+    const uint8_t* end = dst + capacity;
+    uint8_t* op = dst;
+    size_t anchor = 0;
+    size_t pos = 0;
+    
+    // Positions stockées plus un : 0 signifie une entrée vide
+    memset(table, 0, ARCHIVE_LZ_HASH_SIZE * sizeof(uint16_t));
+    
+    while (pos + LZ_MIN_MATCH <= length) {
+        uint32_t sequence = read32(&src[pos]);
+        uint32_t hash = hash32(sequence);
+        size_t candidate = table[hash];
+        table[hash] = (uint16_t)(pos + 1);
+        
+        if (candidate == 0 || pos - (candidate - 1) > LZ_MAX_OFFSET || read32(&src[candidate - 1]) != sequence) {
+            pos++;
+            continue;
+        }
+        
+        candidate--;
+        size_t match_length = LZ_MIN_MATCH;
+        while (pos + match_length < length && src[candidate + match_length] == src[pos + match_length]) {
+            match_length++;
+        }
+        
+        op = write_sequence(op, end, &src[anchor], pos - anchor, pos - candidate, match_length);
+        if (op == NULL) {
+            return 0;
+        }
+        
+        pos += match_length;
+        anchor = pos;
+    }
+    
+    op = write_sequence(op, end, &src[anchor], length - anchor, 0, 0);
+    return (op != NULL) ? (size_t)(op - dst) : 0;
+}
+
+static const uint8_t* read_length(const uint8_t* ip, const uint8_t* end, size_t* length)
+{
+    uint8_t byte;
+    do {
+        if (ip >= end) {
+            return NULL;
+        }
+        byte = *ip++;
+        *length += byte;
+    } while (byte == 255);
+    
+    return ip;
+}
+
+size_t archive_lz_decompress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity)
+{
+    const uint8_t* ip = src;
+    const uint8_t* end = src + length;
+    size_t out = 0;
+    
+    while (ip < end) {
+        uint8_t token = *ip++;
+        
+        size_t literal_length = token >> 4;
+        if (literal_length == 15 && (ip = read_length(ip, end, &literal_length)) == NULL) {
+            return 0;
+        }
+        if ((size_t)(end - ip) < literal_length || capacity - out < literal_length) {
+            return 0;
+        }
+        memcpy(&dst[out], ip, literal_length);
+        ip += literal_length;
+        out += literal_length;
+        
+        if (ip == end) {
+            break;
+        }
+        
+        if (end - ip < 2) {
+            return 0;
+        }
+        size_t offset = ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        
+        size_t match_length = token & 0x0F;
+        if (match_length == 15 && (ip = read_length(ip, end, &match_length)) == NULL) {
+            return 0;
+        }
+        match_length += LZ_MIN_MATCH;
+        
+        if (offset == 0 || offset > out || capacity - out < match_length) {
+            return 0;
+        }
+        // Copie octet par octet : la source peut chevaucher la destination
+        for (size_t i = 0; i < match_length; i++, out++) {
+            dst[out] = dst[out - offset];
+        }
+    }
+    
+    return out;
+}
\ No newline at end of file
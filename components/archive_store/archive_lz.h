@@ -0,0 +1,31 @@
+#ifndef ARCHIVE_LZ_H
+#define ARCHIVE_LZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Taille de la table de hachage du compresseur (entrées de 16 bits)
+#define ARCHIVE_LZ_HASH_SIZE 4096
+
+/**
+ * @brief Compresse un bloc (séquences littéraux + correspondances, fenêtre de 64 Ko)
+ * @param src Données à compresser (64 Ko au plus)
+ * @param length Taille des données
+ * @param dst Tampon de sortie
+ * @param capacity Taille du tampon de sortie
+ * @param table Table de travail de ARCHIVE_LZ_HASH_SIZE entrées
+ * @return Taille compressée, 0 si la sortie ne tient pas dans le tampon
+ */
+size_t archive_lz_compress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity, uint16_t* table);
+
+/**
+ * @brief Décompresse un bloc produit par archive_lz_compress
+ * @param src Données compressées
+ * @param length Taille des données compressées
+ * @param dst Tampon de sortie
+ * @param capacity Taille du tampon de sortie
+ * @return Taille décompressée, 0 si les données sont invalides
+ */
+size_t archive_lz_decompress(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity);
+
+#endif // ARCHIVE_LZ_H
\ No newline at end of file
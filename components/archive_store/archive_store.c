@@ -0,0 +1,882 @@
+#include "archive_store.h"
+#include "archive_lz.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+static const char* TAG = "ARCHIVE_STORE";
+
+#define SEGMENT_MAGIC       0x47455341  // "ASEG"
+#define SEGMENT_VERSION     1
+#define RECORD_HEADER_SIZE  (sizeof(int64_t) + ARCHIVE_KEY_COUNT * sizeof(uint32_t) + sizeof(uint16_t))
+#define PACKED_SIZE         (ARCHIVE_BLOCK_SIZE + ARCHIVE_BLOCK_SIZE / 255 + 16)
+#define BLOOM_BITS          (ARCHIVE_BLOOM_BYTES * 8)
+
+// En-tête d'un fichier segment, suivi des blocs puis de l'index des blocs
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t reserved;
+    int32_t month_key;
+    uint32_t record_count;
+    uint32_t block_count;
+    uint32_t index_offset;
+    int64_t first_date;
+    int64_t last_date;
+    uint32_t key_min[ARCHIVE_KEY_COUNT];
+    uint32_t key_max[ARCHIVE_KEY_COUNT];
+    uint8_t bloom[ARCHIVE_BLOOM_BYTES];
+    uint8_t summary[ARCHIVE_SUMMARY_SIZE];
+    uint32_t crc;           // CRC32 des champs précédents
+} segment_header_t;
+
+// Entrée de l'index : un bloc stocké brut lorsque packed_length == raw_length
+typedef struct {
+    int64_t first_date;
+    int64_t last_date;
+    uint32_t offset;
+    uint32_t packed_length;
+    uint32_t raw_length;
+    uint32_t record_count;
+    uint32_t crc;           // CRC32 du bloc tel que stocké
+    uint32_t reserved;
+} block_entry_t;
+
+// Lecture séquentielle d'un segment, en sautant les blocs hors de l'intervalle demandé
+typedef struct {
+    archive_store_t* store;
+    FILE* file;
+    const archive_segment_t* segment;
+    time_t start_date;
+    time_t end_date;
+    uint32_t next_block;
+    size_t length;
+    size_t pos;
+    bool failed;            // Bloc illisible ou corrompu
+    archive_record_t record;
+} segment_reader_t;
+
+// Écriture d'un nouveau segment
+typedef struct {
+    archive_store_t* store;
+    FILE* file;
+    archive_segment_t segment;
+    block_entry_t* blocks;  // Index des blocs écrits
+    size_t block_length;
+    size_t run_start;       // Début des enregistrements du bloc partageant la dernière date
+    uint32_t block_records;
+    time_t block_first;
+    time_t block_last;
+    uint32_t offset;
+} segment_writer_t;
+
+// Enregistrement en attente, trié par mois puis par date
+typedef struct {
+    int32_t month_key;
+    int64_t date;
+    uint32_t offset;
+} pending_entry_t;
+
+static void* alloc_buffer(size_t size)
+{
+    void* buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        buffer = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+static int32_t month_key(time_t date)
+{
+    struct tm date_tm;
+    localtime_r(&date, &date_tm);
+    return (date_tm.tm_year + 1900) * 12 + date_tm.tm_mon;
+}
+
+static void segment_path(const archive_store_t* store, int32_t key, const char* extension, char* path, size_t size)
+{
+    snprintf(path, size, "%s/%04" PRId32 "%02" PRId32 ".%s", store->directory, key / 12, key % 12 + 1, extension);
+}
+
+static system_error_t sync_file(FILE* file)
+{
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        return SYSTEM_ERROR_STORAGE;
+    }
+    return SYSTEM_OK;
+}
+
+static uint32_t bloom_hash(uint32_t key_slot, uint32_t key)
+{
+    uint32_t hash = key * 0x9E3779B1u ^ (key_slot + 1) * 0x85EBCA6Bu;
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+static void bloom_add(uint8_t* bloom, uint32_t key_slot, uint32_t key)
+{
+    uint32_t hash = bloom_hash(key_slot, key);
+    uint32_t step = (hash >> 16) | 1;
+    
+    for (uint32_t i = 0; i < 3; i++, hash += step) {
+        uint32_t bit = hash % BLOOM_BITS;
+        bloom[bit / 8] |= (uint8_t)(1 << (bit % 8));
+    }
+}
+
+static bool bloom_test(const uint8_t* bloom, uint32_t key_slot, uint32_t key)
+{
+    uint32_t hash = bloom_hash(key_slot, key);
+    uint32_t step = (hash >> 16) | 1;
+    
+    for (uint32_t i = 0; i < 3; i++, hash += step) {
+        uint32_t bit = hash % BLOOM_BITS;
+        if ((bloom[bit / 8] & (1 << (bit % 8))) == 0) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static size_t encode_record(uint8_t* dst, time_t date, const uint32_t* keys, const uint8_t* payload, uint16_t length)
+{
+    int64_t stored_date = date;
+    size_t pos = 0;
+    
+    memcpy(&dst[pos], &stored_date, sizeof(stored_date));
+    pos += sizeof(stored_date);
+    memcpy(&dst[pos], keys, ARCHIVE_KEY_COUNT * sizeof(uint32_t));
+    pos += ARCHIVE_KEY_COUNT * sizeof(uint32_t);
+    memcpy(&dst[pos], &length, sizeof(length));
+    pos += sizeof(length);
+    memcpy(&dst[pos], payload, length);
+    
+    return pos + length;
+}
+
+// Décode l'enregistrement situé à src, false s'il dépasse la fin du tampon
+static bool decode_record(const uint8_t* src, size_t available, archive_record_t* record, size_t* size)
+{
+    int64_t stored_date;
+    
+    if (available < RECORD_HEADER_SIZE) {
+        return false;
+    }
+    memcpy(&stored_date, src, sizeof(stored_date));
+    memcpy(record->keys, &src[sizeof(stored_date)], ARCHIVE_KEY_COUNT * sizeof(uint32_t));
+    memcpy(&record->length, &src[RECORD_HEADER_SIZE - sizeof(uint16_t)], sizeof(uint16_t));
+    if (available - RECORD_HEADER_SIZE < record->length) {
+        return false;
+    }
+    
+    record->date = (time_t)stored_date;
+    record->payload = &src[RECORD_HEADER_SIZE];
+    *size = RECORD_HEADER_SIZE + record->length;
+    return true;
+}
+
+static bool read_header(FILE* file, archive_segment_t* segment)
+{
+    segment_header_t header;
+    
+    if (fseek(file, 0, SEEK_SET) != 0 || fread(&header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+    if (header.magic != SEGMENT_MAGIC || header.version != SEGMENT_VERSION ||
+        header.crc != esp_rom_crc32_le(0, (const uint8_t*)&header, offsetof(segment_header_t, crc))) {
+        return false;
+    }
+    
+    segment->month_key = header.month_key;
+    segment->record_count = header.record_count;
+    segment->block_count = header.block_count;
+    segment->index_offset = header.index_offset;
+    segment->first_date = (time_t)header.first_date;
+    segment->last_date = (time_t)header.last_date;
+    memcpy(segment->key_min, header.key_min, sizeof(segment->key_min));
+    memcpy(segment->key_max, header.key_max, sizeof(segment->key_max));
+    memcpy(segment->bloom, header.bloom, sizeof(segment->bloom));
+    memcpy(segment->summary, header.summary, sizeof(segment->summary));
+    return true;
+}
+
+static uint32_t segment_lower_bound(const archive_store_t* store, int32_t key)
+{
+    uint32_t low = 0;
+    uint32_t high = store->segment_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (store->segments[mid].month_key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void make_directories(const char* directory)
+{
+    char path[sizeof(((archive_store_t*)0)->directory)];
+    strncpy(path, directory, sizeof(path) - 1);
+    path[sizeof(path) - 1] = '\0';
+    
+    for (char* c = path + 1; *c != '\0'; c++) {
+        if (*c == '/') {
+            *c = '\0';
+            mkdir(path, 0755);
+            *c = '/';
+        }
+    }
+    mkdir(path, 0755);
+}
+
+// Termine un remplacement interrompu : un .tmp sans .seg a été synchronisé avant la suppression
+static void recover_segment(const archive_store_t* store, int32_t key)
+{
+    char seg_path[80];
+    char tmp_path[80];
+    struct stat st;
+    
+    segment_path(store, key, "seg", seg_path, sizeof(seg_path));
+    segment_path(store, key, "tmp", tmp_path, sizeof(tmp_path));
+    
+    if (stat(seg_path, &st) == 0) {
+        remove(tmp_path);
+    } else if (rename(tmp_path, seg_path) != 0) {
+        ESP_LOGW(TAG, "Impossible de restaurer %s", tmp_path);
+    }
+}
+
+static void load_segment(archive_store_t* store, int32_t key)
+{
+    char path[80];
+    segment_path(store, key, "seg", path, sizeof(path));
+    
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return;
+    }
+    
+    if (store->segment_count >= ARCHIVE_MAX_SEGMENTS) {
+        ESP_LOGW(TAG, "Nombre maximum de segments atteint, %s ignoré", path);
+    } else if (read_header(file, &store->segments[store->segment_count]) &&
+               store->segments[store->segment_count].month_key == key) {
+        store->segment_count++;
+    } else {
+        ESP_LOGW(TAG, "Segment invalide ignoré: %s", path);
+    }
+    
+    fclose(file);
+}
+
+static int compare_segments(const void* a, const void* b)
+{
+    int32_t key_a = ((const archive_segment_t*)a)->month_key;
+    int32_t key_b = ((const archive_segment_t*)b)->month_key;
+    return (key_a > key_b) - (key_a < key_b);
+}
+
+// Nom attendu : AAAAMM.seg ou AAAAMM.tmp
+static bool parse_segment_name(const char* name, int32_t* key, bool* is_tmp)
+{
+    if (strlen(name) != 10 || name[6] != '.') {
+        return false;
+    }
+    
+    int32_t value = 0;
+    for (int i = 0; i < 6; i++) {
+        if (name[i] < '0' || name[i] > '9') {
+            return false;
+        }
+        value = value * 10 + (name[i] - '0');
+    }
+    
+    int32_t month = value % 100;
+    if (month < 1 || month > 12) {
+        return false;
+    }
+    
+    *key = (value / 100) * 12 + month - 1;
+    *is_tmp = (strcmp(&name[7], "tmp") == 0);
+    return *is_tmp || strcmp(&name[7], "seg") == 0;
+}
+
+system_error_t archive_store_open(archive_store_t* store, const char* directory, archive_summary_fn_t summarize)
+{
+    if (store == NULL || directory == NULL || strlen(directory) >= sizeof(store->directory)) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    memset(store, 0, sizeof(archive_store_t));
+    strcpy(store->directory, directory);
+    store->summarize = summarize;
+    
+    store->segments = alloc_buffer(ARCHIVE_MAX_SEGMENTS * sizeof(archive_segment_t));
+    store->pending = alloc_buffer(ARCHIVE_PENDING_SIZE);
+    store->block = alloc_buffer(ARCHIVE_BLOCK_SIZE);
+    store->read_block = alloc_buffer(ARCHIVE_BLOCK_SIZE);
+    store->packed = alloc_buffer(PACKED_SIZE);
+    store->hash_table = alloc_buffer(ARCHIVE_LZ_HASH_SIZE * sizeof(uint16_t));
+    store->block_index = alloc_buffer(ARCHIVE_MAX_BLOCKS * sizeof(block_entry_t));
+    if (store->segments == NULL || store->pending == NULL || store->block == NULL ||
+        store->read_block == NULL || store->packed == NULL || store->hash_table == NULL || store->block_index == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer l'archive %s", directory);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    make_directories(directory);
+    
+    DIR* dir = opendir(directory);
+    if (dir == NULL) {
+        ESP_LOGE(TAG, "Répertoire d'archive inaccessible: %s", directory);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // Les remplacements interrompus sont terminés avant de charger les en-têtes
+    struct dirent* entry;
+    int32_t key;
+    bool is_tmp;
+    while ((entry = readdir(dir)) != NULL) {
+        if (parse_segment_name(entry->d_name, &key, &is_tmp) && is_tmp) {
+            recover_segment(store, key);
+        }
+    }
+    rewinddir(dir);
+    while ((entry = readdir(dir)) != NULL) {
+        if (parse_segment_name(entry->d_name, &key, &is_tmp) && !is_tmp) {
+            load_segment(store, key);
+        }
+    }
+    closedir(dir);
+    
+    qsort(store->segments, store->segment_count, sizeof(archive_segment_t), compare_segments);
+    
+    ESP_LOGI(TAG, "Archive %s ouverte: %" PRIu32 " segments, %" PRIu32 " enregistrements",
+             directory, store->segment_count, archive_store_count(store));
+    return SYSTEM_OK;
+}
+
+system_error_t archive_store_add(archive_store_t* store, time_t date, const uint32_t keys[ARCHIVE_KEY_COUNT],
+                                 const uint8_t* payload, size_t length)
+{
+    if (store == NULL || store->pending == NULL || keys == NULL || payload == NULL || length > ARCHIVE_MAX_RECORD) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    if (store->pending_length + RECORD_HEADER_SIZE + length > ARCHIVE_PENDING_SIZE) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    store->pending_length += encode_record(&store->pending[store->pending_length], date, keys, payload, (uint16_t)length);
+    store->pending_count++;
+    return SYSTEM_OK;
+}
+
+static bool reader_load_block(segment_reader_t* reader)
+{
+    archive_store_t* store = reader->store;
+    block_entry_t entry;
+    
+    while (reader->next_block < reader->segment->block_count) {
+        uint32_t block = reader->next_block++;
+        long position = (long)(reader->segment->index_offset + block * sizeof(block_entry_t));
+        if (fseek(reader->file, position, SEEK_SET) != 0 || fread(&entry, sizeof(entry), 1, reader->file) != 1) {
+            reader->failed = true;
+            return false;
+        }
+        
+        // Blocs triés par date : ceux d'avant l'intervalle sont sautés, ceux d'après terminent la lecture
+        if (reader->start_date != 0 && entry.last_date < reader->start_date) {
+            continue;
+        }
+        if (reader->end_date != 0 && entry.first_date > reader->end_date) {
+            reader->next_block = reader->segment->block_count;
+            return false;
+        }
+        
+        // Bloc déjà décompressé par la requête précédente (parcours repris par lots)
+        if (store->read_length != 0 && store->read_length == entry.raw_length && store->read_crc == entry.crc &&
+            store->read_offset == entry.offset && store->read_month_key == reader->segment->month_key) {
+            reader->length = entry.raw_length;
+            reader->pos = 0;
+            return true;
+        }
+        store->read_length = 0;
+        
+        if (entry.raw_length > ARCHIVE_BLOCK_SIZE || entry.packed_length > PACKED_SIZE ||
+            fseek(reader->file, (long)entry.offset, SEEK_SET) != 0 ||
+            fread(store->packed, 1, entry.packed_length, reader->file) != entry.packed_length ||
+            entry.crc != esp_rom_crc32_le(0, store->packed, entry.packed_length)) {
+            ESP_LOGE(TAG, "Bloc %" PRIu32 " corrompu dans le segment %" PRId32, block, reader->segment->month_key);
+            reader->failed = true;
+            return false;
+        }
+        
+        if (entry.packed_length == entry.raw_length) {
+            memcpy(store->read_block, store->packed, entry.raw_length);
+        } else if (archive_lz_decompress(store->packed, entry.packed_length, store->read_block,
+                                         ARCHIVE_BLOCK_SIZE) != entry.raw_length) {
+            ESP_LOGE(TAG, "Décompression impossible du bloc %" PRIu32, block);
+            reader->failed = true;
+            return false;
+        }
+        store->read_month_key = reader->segment->month_key;
+        store->read_offset = entry.offset;
+        store->read_crc = entry.crc;
+        store->read_length = entry.raw_length;
+        
+        reader->length = entry.raw_length;
+        reader->pos = 0;
+        return true;
+    }
+    
+    return false;
+}
+
+static bool reader_open(segment_reader_t* reader, archive_store_t* store, const archive_segment_t* segment,
+                        time_t start_date, time_t end_date)
+{
+    char path[80];
+    segment_path(store, segment->month_key, "seg", path, sizeof(path));
+    
+    memset(reader, 0, sizeof(segment_reader_t));
+    reader->store = store;
+    reader->segment = segment;
+    reader->start_date = start_date;
+    reader->end_date = end_date;
+    reader->file = fopen(path, "rb");
+    return reader->file != NULL;
+}
+
+// Avance sur l'enregistrement suivant, false en fin de segment
+static bool reader_next(segment_reader_t* reader)
+{
+    if (reader->pos >= reader->length && !reader_load_block(reader)) {
+        return false;
+    }
+    
+    size_t size;
+    if (!decode_record(&reader->store->read_block[reader->pos], reader->length - reader->pos, &reader->record, &size)) {
+        reader->failed = true;
+        return false;
+    }
+    
+    reader->pos += size;
+    return true;
+}
+
+static void reader_close(segment_reader_t* reader)
+{
+    if (reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+static bool writer_flush_block(segment_writer_t* writer)
+{
+    archive_store_t* store = writer->store;
+    
+    if (writer->block_records == 0) {
+        return true;
+    }
+    if (writer->segment.block_count >= ARCHIVE_MAX_BLOCKS) {
+        ESP_LOGE(TAG, "Segment %" PRId32 " trop volumineux", writer->segment.month_key);
+        return false;
+    }
+    
+    // Un bloc incompressible est stocké brut
+    const uint8_t* data = store->packed;
+    size_t length = archive_lz_compress(store->block, writer->block_length, store->packed, PACKED_SIZE,
+                                        store->hash_table);
+    if (length == 0 || length >= writer->block_length) {
+        data = store->block;
+        length = writer->block_length;
+    }
+    
+    if (fwrite(data, 1, length, writer->file) != length) {
+        return false;
+    }
+    
+    block_entry_t* entry = &writer->blocks[writer->segment.block_count++];
+    memset(entry, 0, sizeof(block_entry_t));
+    entry->first_date = writer->block_first;
+    entry->last_date = writer->block_last;
+    entry->offset = writer->offset;
+    entry->packed_length = (uint32_t)length;
+    entry->raw_length = (uint32_t)writer->block_length;
+    entry->record_count = writer->block_records;
+    entry->crc = esp_rom_crc32_le(0, data, (uint32_t)length);
+    
+    writer->offset += (uint32_t)length;
+    writer->block_length = 0;
+    writer->run_start = 0;
+    writer->block_records = 0;
+    return true;
+}
+
+// Un enregistrement identique de même date est déjà dans le bloc courant
+static bool writer_contains(const segment_writer_t* writer, const archive_record_t* record)
+{
+    if (writer->block_records == 0 || record->date != writer->block_last) {
+        return false;
+    }
+    
+    archive_record_t existing;
+    size_t size = 0;
+    for (size_t pos = writer->run_start; pos < writer->block_length; pos += size) {
+        if (!decode_record(&writer->store->block[pos], writer->block_length - pos, &existing, &size)) {
+            break;
+        }
+        if (existing.length == record->length &&
+            memcmp(existing.keys, record->keys, sizeof(existing.keys)) == 0 &&
+            memcmp(existing.payload, record->payload, record->length) == 0) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+static bool writer_add(segment_writer_t* writer, const archive_record_t* record)
+{
+    archive_segment_t* segment = &writer->segment;
+    
+    if (writer_contains(writer, record)) {
+        return true;
+    }
+    
+    if (writer->block_length + RECORD_HEADER_SIZE + record->length > ARCHIVE_BLOCK_SIZE && !writer_flush_block(writer)) {
+        return false;
+    }
+    
+    if (writer->block_records == 0 || record->date != writer->block_last) {
+        writer->run_start = writer->block_length;
+    }
+    if (writer->block_records == 0) {
+        writer->block_first = record->date;
+    }
+    writer->block_last = record->date;
+    writer->block_records++;
+    writer->block_length += encode_record(&writer->store->block[writer->block_length], record->date, record->keys,
+                                          record->payload, record->length);
+    
+    if (segment->record_count == 0) {
+        segment->first_date = record->date;
+        memcpy(segment->key_min, record->keys, sizeof(segment->key_min));
+        memcpy(segment->key_max, record->keys, sizeof(segment->key_max));
+    }
+    segment->last_date = record->date;
+    segment->record_count++;
+    for (uint32_t k = 0; k < ARCHIVE_KEY_COUNT; k++) {
+        if (record->keys[k] < segment->key_min[k]) {
+            segment->key_min[k] = record->keys[k];
+        }
+        if (record->keys[k] > segment->key_max[k]) {
+            segment->key_max[k] = record->keys[k];
+        }
+        bloom_add(segment->bloom, k, record->keys[k]);
+    }
+    if (writer->store->summarize != NULL) {
+        writer->store->summarize(record, segment->summary);
+    }
+    
+    return true;
+}
+
+static bool writer_finish(segment_writer_t* writer)
+{
+    if (!writer_flush_block(writer)) {
+        return false;
+    }
+    
+    size_t index_size = writer->segment.block_count * sizeof(block_entry_t);
+    writer->segment.index_offset = writer->offset;
+    if (fwrite(writer->blocks, 1, index_size, writer->file) != index_size) {
+        return false;
+    }
+    
+    segment_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SEGMENT_MAGIC;
+    header.version = SEGMENT_VERSION;
+    header.month_key = writer->segment.month_key;
+    header.record_count = writer->segment.record_count;
+    header.block_count = writer->segment.block_count;
+    header.index_offset = writer->segment.index_offset;
+    header.first_date = writer->segment.first_date;
+    header.last_date = writer->segment.last_date;
+    memcpy(header.key_min, writer->segment.key_min, sizeof(header.key_min));
+    memcpy(header.key_max, writer->segment.key_max, sizeof(header.key_max));
+    memcpy(header.bloom, writer->segment.bloom, sizeof(header.bloom));
+    memcpy(header.summary, writer->segment.summary, sizeof(header.summary));
+    header.crc = esp_rom_crc32_le(0, (const uint8_t*)&header, offsetof(segment_header_t, crc));
+    
+    return fseek(writer->file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, writer->file) == 1 &&
+           sync_file(writer->file) == SYSTEM_OK;
+}
+
+static int compare_pending(const void* a, const void* b)
+{
+    const pending_entry_t* entry_a = (const pending_entry_t*)a;
+    const pending_entry_t* entry_b = (const pending_entry_t*)b;
+    
+    if (entry_a->month_key != entry_b->month_key) {
+        return (entry_a->month_key < entry_b->month_key) ? -1 : 1;
+    }
+    if (entry_a->date != entry_b->date) {
+        return (entry_a->date < entry_b->date) ? -1 : 1;
+    }
+    // Ordre d'ajout conservé à date égale
+    return (entry_a->offset > entry_b->offset) - (entry_a->offset < entry_b->offset);
+}
+
+// Fusionne les enregistrements en attente d'un mois avec son segment existant dans un nouveau fichier
+static system_error_t write_month(archive_store_t* store, int32_t key, const pending_entry_t* entries, uint32_t count)
+{
+    char seg_path[80];
+    char tmp_path[80];
+    segment_path(store, key, "seg", seg_path, sizeof(seg_path));
+    segment_path(store, key, "tmp", tmp_path, sizeof(tmp_path));
+    
+    uint32_t pos = segment_lower_bound(store, key);
+    bool exists = (pos < store->segment_count && store->segments[pos].month_key == key);
+    if (!exists && store->segment_count >= ARCHIVE_MAX_SEGMENTS) {
+        ESP_LOGE(TAG, "Nombre maximum de segments atteint");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    segment_writer_t writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.store = store;
+    writer.blocks = store->block_index;
+    writer.segment.month_key = key;
+    writer.offset = sizeof(segment_header_t);
+    writer.file = fopen(tmp_path, "wb");
+    if (writer.file == NULL) {
+        ESP_LOGE(TAG, "Impossible de créer %s", tmp_path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // En-tête écrit en dernier, une fois l'index connu
+    segment_header_t placeholder;
+    memset(&placeholder, 0, sizeof(placeholder));
+    bool ok = fwrite(&placeholder, sizeof(placeholder), 1, writer.file) == 1;
+    
+    segment_reader_t reader;
+    bool has_old = false;
+    if (ok && exists) {
+        ok = reader_open(&reader, store, &store->segments[pos], 0, 0);
+        has_old = ok && reader_next(&reader);
+    }
+    
+    uint32_t next = 0;
+    archive_record_t incoming;
+    size_t size = 0;
+    while (ok && (has_old || next < count)) {
+        bool take_old = has_old;
+        if (has_old && next < count) {
+            take_old = reader.record.date <= entries[next].date;
+        }
+        
+        if (take_old) {
+            ok = writer_add(&writer, &reader.record);
+            has_old = reader_next(&reader);
+        } else {
+            ok = decode_record(&store->pending[entries[next].offset], store->pending_length - entries[next].offset,
+                               &incoming, &size) &&
+                 writer_add(&writer, &incoming);
+            next++;
+        }
+    }
+    
+    if (exists) {
+        reader_close(&reader);
+        // Un segment existant qui n'a pas été relu entièrement ne doit pas être remplacé
+        ok = ok && !reader.failed;
+    }
+    ok = ok && writer_finish(&writer);
+    fclose(writer.file);
+    
+    if (!ok) {
+        ESP_LOGE(TAG, "Échec écriture du segment %s", tmp_path);
+        remove(tmp_path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // Le .tmp synchronisé remplace l'ancien segment (restauré à l'ouverture en cas de coupure)
+    remove(seg_path);
+    if (rename(tmp_path, seg_path) != 0) {
+        ESP_LOGE(TAG, "Impossible de renommer %s", tmp_path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    if (!exists) {
+        memmove(&store->segments[pos + 1], &store->segments[pos],
+                (store->segment_count - pos) * sizeof(archive_segment_t));
+        store->segment_count++;
+    }
+    store->segments[pos] = writer.segment;
+    
+    ESP_LOGI(TAG, "Segment %s: %" PRIu32 " enregistrements, %" PRIu32 " octets",
+             seg_path, writer.segment.record_count, writer.offset);
+    return SYSTEM_OK;
+}
+
+system_error_t archive_store_commit(archive_store_t* store)
+{
+    if (store == NULL || store->pending == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    if (store->pending_count == 0) {
+        return SYSTEM_OK;
+    }
+    
+    pending_entry_t* entries = alloc_buffer(store->pending_count * sizeof(pending_entry_t));
+    if (entries == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    archive_record_t record;
+    size_t size = 0;
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < store->pending_count; i++) {
+        if (!decode_record(&store->pending[offset], store->pending_length - offset, &record, &size)) {
+            ESP_LOGE(TAG, "Lot en attente illisible à la position %" PRIu32, offset);
+            heap_caps_free(entries);
+            return SYSTEM_ERROR_STORAGE;
+        }
+        entries[i].month_key = month_key(record.date);
+        entries[i].date = record.date;
+        entries[i].offset = offset;
+        offset += (uint32_t)size;
+    }
+    
+    qsort(entries, store->pending_count, sizeof(pending_entry_t), compare_pending);
+    
+    system_error_t ret = SYSTEM_OK;
+    uint32_t start = 0;
+    while (ret == SYSTEM_OK && start < store->pending_count) {
+        int32_t key = entries[start].month_key;
+        uint32_t end = start;
+        while (end < store->pending_count && entries[end].month_key == key) {
+            end++;
+        }
+        ret = write_month(store, key, &entries[start], end - start);
+        start = end;
+    }
+    
+    heap_caps_free(entries);
+    
+    // En cas d'échec le lot reste en attente : les mois déjà écrits ne seront pas dupliqués
+    if (ret == SYSTEM_OK) {
+        store->pending_length = 0;
+        store->pending_count = 0;
+    }
+    
+    return ret;
+}
+
+system_error_t archive_store_query(archive_store_t* store, time_t start_date, time_t end_date,
+                                   int32_t key_slot, uint32_t key, archive_visit_fn_t visit, void* context)
+{
+    if (store == NULL || visit == NULL || key_slot >= ARCHIVE_KEY_COUNT) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    for (uint32_t s = 0; s < store->segment_count; s++) {
+        const archive_segment_t* segment = &store->segments[s];
+        
+        if (start_date != 0 && segment->last_date < start_date) {
+            continue;
+        }
+        if (end_date != 0 && segment->first_date > end_date) {
+            break;
+        }
+        if (key_slot >= 0 && (key < segment->key_min[key_slot] || key > segment->key_max[key_slot] ||
+                              !bloom_test(segment->bloom, key_slot, key))) {
+            continue;
+        }
+        
+        segment_reader_t reader;
+        if (!reader_open(&reader, store, segment, start_date, end_date)) {
+            ESP_LOGE(TAG, "Segment %" PRId32 " inaccessible", segment->month_key);
+            return SYSTEM_ERROR_STORAGE;
+        }
+        
+        bool keep_going = true;
+        while (keep_going && reader_next(&reader)) {
+            const archive_record_t* record = &reader.record;
+            if (start_date != 0 && record->date < start_date) {
+                continue;
+            }
+            if (end_date != 0 && record->date > end_date) {
+                break;
+            }
+            if (key_slot >= 0 && record->keys[key_slot] != key) {
+                continue;
+            }
+            keep_going = visit(record, context);
+        }
+        reader_close(&reader);
+        
+        if (reader.failed) {
+            return SYSTEM_ERROR_STORAGE;
+        }
+        if (!keep_going) {
+            break;
+        }
+    }
+    
+    return SYSTEM_OK;
+}
+
+uint32_t archive_store_count(const archive_store_t* store)
+{
+    uint32_t count = 0;
+    
+    for (uint32_t s = 0; s < store->segment_count; s++) {
+        count += store->segments[s].record_count;
+    }
+    
+    return count;
+}
+
+uint32_t archive_store_key_max(const archive_store_t* store, uint32_t key_slot)
+{
+    uint32_t max = 0;
+    
+    for (uint32_t s = 0; key_slot < ARCHIVE_KEY_COUNT && s < store->segment_count; s++) {
+        if (store->segments[s].key_max[key_slot] > max) {
+            max = store->segments[s].key_max[key_slot];
+        }
+    }
+    
+    return max;
+}
+
+bool archive_store_may_contain(const archive_store_t* store, uint32_t key_slot, uint32_t key)
+{
+    for (uint32_t s = 0; key_slot < ARCHIVE_KEY_COUNT && s < store->segment_count; s++) {
+        const archive_segment_t* segment = &store->segments[s];
+        if (key >= segment->key_min[key_slot] && key <= segment->key_max[key_slot] &&
+            bloom_test(segment->bloom, key_slot, key)) {
+            return true;
+        }
+    }
+    
+    return false;
+}
\ No newline at end of file
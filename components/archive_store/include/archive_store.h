@@ -0,0 +1,141 @@
+#ifndef ARCHIVE_STORE_H
+#define ARCHIVE_STORE_H
+
+#include "system_types.h"
+#include <stddef.h>
+
+// Clés de recherche portées par chaque enregistrement archivé (0 si inutilisée)
+#define ARCHIVE_KEY_COUNT       3
+#define ARCHIVE_BLOOM_BYTES     64   // Filtre de Bloom des clés d'un segment (512 bits)
+#define ARCHIVE_SUMMARY_SIZE    96   // Résumé libre calculé par l'utilisateur de l'archive
+#define ARCHIVE_MAX_RECORD      4096
+
+// Enregistrement archivé : date, clés et charge utile opaque
+typedef struct {
+    time_t date;
+    uint32_t keys[ARCHIVE_KEY_COUNT];
+    const uint8_t* payload;
+    uint16_t length;
+} archive_record_t;
+
+/**
+ * @brief Fonction appelée pour chaque enregistrement trouvé par une requête
+ * @param record Enregistrement (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ * @return true pour continuer le parcours, false pour l'arrêter
+ */
+typedef bool (*archive_visit_fn_t)(const archive_record_t* record, void* context);
+
+/**
+ * @brief Fonction cumulant un enregistrement dans le résumé de son segment
+ * @param record Enregistrement écrit dans le segment
+ * @param summary Résumé du segment (ARCHIVE_SUMMARY_SIZE octets, initialisé à zéro)
+ */
+typedef void (*archive_summary_fn_t)(const archive_record_t* record, uint8_t* summary);
+
+// Segment mensuel immuable : enregistrements triés par date, découpés en blocs compressés
+typedef struct {
+    int32_t month_key;      // année * 12 + mois (0-11)
+    time_t first_date;
+    time_t last_date;
+    uint32_t record_count;
+    uint32_t block_count;
+    uint32_t index_offset;  // Position de l'index des blocs dans le fichier
+    uint32_t key_min[ARCHIVE_KEY_COUNT];
+    uint32_t key_max[ARCHIVE_KEY_COUNT];
+    uint8_t bloom[ARCHIVE_BLOOM_BYTES];
+    uint8_t summary[ARCHIVE_SUMMARY_SIZE];
+} archive_segment_t;
+
+// Archive : un répertoire de segments mensuels et un tampon d'enregistrements en attente
+typedef struct {
+    char directory[48];
+    archive_summary_fn_t summarize;
+    archive_segment_t* segments;    // Triés par mois croissant
+    uint32_t segment_count;
+    uint8_t* pending;               // Enregistrements ajoutés depuis la dernière validation
+    size_t pending_length;
+    uint32_t pending_count;
+    uint8_t* block;                 // Bloc décompressé en écriture
+    uint8_t* read_block;            // Bloc décompressé en lecture
+    int32_t read_month_key;         // Identité de read_block (segment, position et CRC du bloc stocké)
+    uint32_t read_offset;           // pour le réutiliser sans relire ni décompresser
+    uint32_t read_crc;
+    uint32_t read_length;           // 0 : aucun bloc valide
+    uint8_t* packed;                // Bloc compressé
+    uint16_t* hash_table;           // Table de travail du compresseur
+    void* block_index;              // Index des blocs du segment en cours d'écriture
+} archive_store_t;
+
+/**
+ * @brief Ouvre une archive : crée son répertoire et charge l'en-tête de chaque segment
+ * @param store Archive à initialiser
+ * @param directory Répertoire des segments
+ * @param summarize Fonction de résumé des segments (NULL si aucune)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t archive_store_open(archive_store_t* store, const char* directory, archive_summary_fn_t summarize);
+
+/**
+ * @brief Ajoute un enregistrement au lot en attente
+ * @param store Archive cible
+ * @param date Date de l'enregistrement (détermine son segment)
+ * @param keys Clés de recherche
+ * @param payload Charge utile
+ * @param length Taille de la charge utile
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot est plein (valider puis recommencer)
+ */
+system_error_t archive_store_add(archive_store_t* store, time_t date, const uint32_t keys[ARCHIVE_KEY_COUNT],
+                                 const uint8_t* payload, size_t length);
+
+/**
+ * @brief Écrit le lot en attente : chaque mois concerné est fusionné dans un nouveau segment
+ *
+ * Le nouveau segment remplace l'ancien par renommage une fois synchronisé. Un enregistrement
+ * identique à un enregistrement de même date déjà archivé est ignoré, ce qui permet de
+ * rejouer un lot interrompu.
+ *
+ * @param store Archive cible
+ * @return SYSTEM_OK si tout le lot est durable, SYSTEM_ERROR_STORAGE sinon (le lot est conservé)
+ */
+system_error_t archive_store_commit(archive_store_t* store);
+
+/**
+ * @brief Parcourt par date croissante les enregistrements d'un intervalle
+ * @param store Archive source
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param key_slot Indice de la clé filtrée (-1 pour aucun filtre)
+ * @param key Valeur de la clé filtrée
+ * @param visit Fonction appelée pour chaque enregistrement
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t archive_store_query(archive_store_t* store, time_t start_date, time_t end_date,
+                                   int32_t key_slot, uint32_t key, archive_visit_fn_t visit, void* context);
+
+/**
+ * @brief Compte les enregistrements archivés
+ * @param store Archive source
+ * @return Nombre d'enregistrements dans les segments
+ */
+uint32_t archive_store_count(const archive_store_t* store);
+
+/**
+ * @brief Plus grande valeur archivée d'une clé
+ * @param store Archive source
+ * @param key_slot Indice de la clé
+ * @return Valeur maximale (0 si l'archive est vide)
+ */
+uint32_t archive_store_key_max(const archive_store_t* store, uint32_t key_slot);
+
+/**
+ * @brief Indique si un segment peut contenir une valeur de clé (filtres de Bloom, sans lecture)
+ * @param store Archive source
+ * @param key_slot Indice de la clé
+ * @param key Valeur recherchée
+ * @return false si aucun segment ne la contient, true si elle y est peut-être
+ */
+bool archive_store_may_contain(const archive_store_t* store, uint32_t key_slot, uint32_t key);
+
+#endif // ARCHIVE_STORE_H
\ No newline at end of file
@@ -1,9 +1,1284 @@
-#include "data_export.h"
+#include "backup_manager.h"
+#include "animals_manager.h"
+#include "terrarium_monitor.h"
+#include "stock_manager.h"
+#include "transaction_manager.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <inttypes.h>
 
 static const char* TAG = "BACKUP_MANAGER";
 
-void backup_manager_init(void)
+#define BACKUP_MAGIC            0x50554B42  // "BKUP"
+#define BACKUP_END_MAGIC        0x444E4B42  // "BKND"
+#define BACKUP_VERSION          2           // 2 : chaînes de sauvegardes incrémentales
+#define BACKUP_MIN_VERSION      1           // 1 : sauvegardes complètes seulement, encore relues
+#define BACKUP_MAX_SECTIONS     16          // Sections lues dans l'index d'une sauvegarde
+#define BACKUP_REMOVAL_BATCH    16          // Fichiers relevés par parcours du répertoire avant suppression
+
+#define BACKUP_FLAG_INCREMENTAL 0x01        // Modifications depuis la sauvegarde parente seulement
+#define BACKUP_FLAG_AUTOMATIC   0x02        // Chaîne de la sauvegarde automatique, soumise à la rétention
+#define BACKUP_DELETIONS        0x100       // Table d'une section de suppressions (IDs seuls)
+
+// En-tête du fichier
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t backup_id;
+    uint32_t flags;             // BACKUP_FLAG_*
+    int64_t created_at;
+    uint32_t block_size;        // Longueur maximale d'un bloc
+    uint32_t section_count;
+    uint32_t base_id;           // Sauvegarde complète de la chaîne (la sauvegarde elle-même si complète)
+    uint32_t parent_id;         // Sauvegarde précédente de la chaîne (0 si complète)
+    uint32_t sequence;          // Rang dans la chaîne (0 si complète)
+    uint8_t reserved[16];
+    uint32_t crc;               // CRC32 des champs précédents
+} backup_header_t;
+
+// En-tête d'un bloc, suivi de length octets d'enregistrements bruts
+typedef struct {
+    uint32_t table;
+    uint32_t record_count;
+    uint32_t length;
+    uint32_t crc;               // CRC32 des champs précédents puis des enregistrements
+} backup_block_t;
+
+// Entrée de l'index : une section par table
+typedef struct {
+    uint32_t table;
+    uint32_t record_size;       // Taille de la structure à l'écriture, comparée à la restauration
+    uint32_t record_count;
+    uint32_t block_count;
+    uint32_t offset;            // Position du premier bloc
+    uint32_t length;            // Longueur de la section, en-têtes de blocs compris
+    uint32_t since_version;     // Incrément : changements postérieurs à cette version du gestionnaire
+    uint32_t version;           // Version du gestionnaire relevée avant l'écriture
+} backup_section_t;
+
+// Fin du fichier
+typedef struct {
+    uint32_t index_offset;
+    uint32_t section_count;
+    uint32_t index_crc;         // CRC32 de l'index
+    uint32_t magic;
+} backup_trailer_t;
+
+_Static_assert(sizeof(backup_header_t) == 64, "En-tête de sauvegarde de taille inattendue");
+_Static_assert(sizeof(backup_block_t) == 16, "En-tête de bloc de taille inattendue");
+_Static_assert(sizeof(backup_section_t) == 32, "Entrée d'index de taille inattendue");
+_Static_assert(sizeof(backup_trailer_t) == 16, "Fin de sauvegarde de taille inattendue");
+
+// Écriture d'une sauvegarde : les enregistrements d'une table sont regroupés en blocs
+typedef struct {
+    export_writer_t out;
+    uint8_t* block;             // Enregistrements du bloc en cours (BACKUP_BLOCK_SIZE octets)
+    uint32_t block_length;
+    uint32_t block_records;
+    backup_section_t* section;  // Section en cours
+    bool incremental;
+    uint32_t since_version;     // Incrément : version de la table en cours dans la sauvegarde parente
+} backup_writer_t;
+
+// Lecture d'une sauvegarde : en-tête et index sont chargés à l'ouverture
+typedef struct {
+    FILE* file;
+    backup_header_t header;
+    backup_section_t sections[BACKUP_MAX_SECTIONS];
+    uint32_t section_count;
+    uint32_t file_size;
+} backup_reader_t;
+
+// Table sauvegardée
+typedef struct {
+    uint32_t table;
+    uint32_t record_size;
+    const char* name;
+    system_error_t (*save)(backup_writer_t* writer);
+    system_error_t (*restore)(const void* records, uint32_t count);
+    uint32_t (*version)(void);
+    system_error_t (*deletions)(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                uint32_t* count);
+    system_error_t (*remove)(uint32_t id);
+} backup_table_t;
+
+// Variables globales
+static SemaphoreHandle_t g_backup_mutex = NULL;  // Sérialise écritures, restaurations et suppressions
+static uint32_t g_next_backup_id = 1;
+
+static void* alloc_buffer(size_t size)
+{
+    void* buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        buffer = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+static uint32_t block_crc(const backup_block_t* block, const uint8_t* records)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t*)block, offsetof(backup_block_t, crc));
+    return esp_rom_crc32_le(crc, records, block->length);
+}
+
+static void write_block(backup_writer_t* writer)
+{
+    if (writer->block_records == 0) {
+        return;
+    }
+    
+    backup_block_t block = {
+        .table = writer->section->table,
+        .record_count = writer->block_records,
+        .length = writer->block_length,
+    };
+    block.crc = block_crc(&block, writer->block);
+    
+    export_writer_write(&writer->out, (const char*)&block, sizeof(block));
+    export_writer_write(&writer->out, (const char*)writer->block, writer->block_length);
+    
+    writer->section->record_count += writer->block_records;
+    writer->section->block_count++;
+    writer->block_length = 0;
+    writer->block_records = 0;
+}
+
+// Copie brute de l'enregistrement : aucune conversion, le bloc part tel quel vers le fichier
+static bool add_record(backup_writer_t* writer, const void* record)
+{
+    uint32_t size = writer->section->record_size;
+    
+    if (writer->block_length + size > BACKUP_BLOCK_SIZE) {
+        write_block(writer);
+    }
+    memcpy(&writer->block[writer->block_length], record, size);
+    writer->block_length += size;
+    writer->block_records++;
+    
+    return export_writer_record(&writer->out);
+}
+
+// Un incrément ne reprend que les enregistrements modifiés depuis la sauvegarde parente
+static bool save_changed(backup_writer_t* writer, const void* record, uint32_t change_version)
+{
+    if (writer->incremental && change_version <= writer->since_version) {
+        return true;
+    }
+    return add_record(writer, record);
+}
+
+static bool save_animal(const animal_t* animal, void* context)
+{
+    return save_changed(context, animal, animal->change_version);
+}
+
+static bool save_terrarium(const terrarium_t* terrarium, void* context)
+{
+    return save_changed(context, terrarium, terrarium->change_version);
+}
+
+static bool save_stock_item(const stock_item_t* item, void* context)
+{
+    return save_changed(context, item, item->change_version);
+}
+
+static bool save_transaction(const transaction_t* transaction, void* context)
+{
+    return add_record(context, transaction);
+}
+
+static system_error_t save_animals(backup_writer_t* writer)
+{
+    return animals_for_each(save_animal, writer);
+}
+
+static system_error_t save_terrariums(backup_writer_t* writer)
+{
+    return terrarium_for_each(save_terrarium, writer);
+}
+
+static system_error_t save_stock_items(backup_writer_t* writer)
+{
+    return stock_for_each_item(save_stock_item, writer);
+}
+
+// Complète : archive comprise ; incrément : table en mémoire seulement, les transactions archivées depuis
+// la sauvegarde parente imposent une sauvegarde complète
+static system_error_t save_transactions(backup_writer_t* writer)
+{
+    if (writer->incremental) {
+        return transaction_for_each_changed(writer->since_version, save_transaction, writer);
+    }
+    return transaction_for_each(0, 0, save_transaction, writer);
+}
+
+static system_error_t restore_animals(const void* records, uint32_t count)
+{
+    return animals_restore(records, count);
+}
+
+static system_error_t restore_terrariums(const void* records, uint32_t count)
+{
+    return terrarium_restore(records, count);
+}
+
+static system_error_t restore_stock_items(const void* records, uint32_t count)
+{
+    return stock_restore_items(records, count);
+}
+
+static system_error_t restore_transactions(const void* records, uint32_t count)
+{
+    system_error_t ret = transaction_restore(records, count);
+    if (ret == SYSTEM_ERROR_MEMORY) {
+        // Table pleine : les transactions anciennes passent à l'archive pour faire de la place
+        transaction_archive_old(time(NULL), NULL);
+        ret = transaction_restore(records, count);
+    }
+    return ret;
+}
+
+// Ordre d'écriture et de restauration : les animaux avant les transactions qui les citent
+static const backup_table_t k_tables[] = {
+    { BACKUP_TABLE_ANIMALS, sizeof(animal_t), "animaux", save_animals, restore_animals,
+      animals_get_change_version, animals_get_deletions, animals_delete },
+    { BACKUP_TABLE_TERRARIUMS, sizeof(terrarium_t), "terrariums", save_terrariums, restore_terrariums,
+      terrarium_get_change_version, terrarium_get_deletions, terrarium_delete },
+    { BACKUP_TABLE_STOCK_ITEMS, sizeof(stock_item_t), "articles", save_stock_items, restore_stock_items,
+      stock_get_change_version, stock_get_deletions, stock_delete_item },
+    { BACKUP_TABLE_TRANSACTIONS, sizeof(transaction_t), "transactions", save_transactions, restore_transactions,
+      transaction_get_change_version, transaction_get_deletions, transaction_delete },
+};
+
+#define TABLE_COUNT (sizeof(k_tables) / sizeof(k_tables[0]))
+
+// Sauvegarde à écrire : complète, ou incrément depuis les versions de la sauvegarde parente
+typedef struct {
+    bool incremental;
+    uint32_t since_versions[TABLE_COUNT];
+    uint32_t versions[TABLE_COUNT];         // Relevées avant le parcours des tables
+    record_deletion_t* deletions;           // CHANGE_LOG_DELETIONS entrées par table
+    uint32_t deletion_counts[TABLE_COUNT];
+} backup_plan_t;
+
+// Chaîne de la sauvegarde automatique (sous g_backup_mutex). Les versions de changement repartent de zéro
+// au démarrage : la première sauvegarde automatique après un redémarrage est complète.
+typedef struct {
+    uint32_t base_id;           // 0 : pas de chaîne, la prochaine sauvegarde automatique est complète
+    uint32_t last_id;
+    uint32_t sequence;
+    uint32_t versions[TABLE_COUNT];
+} backup_chain_t;
+
+static backup_chain_t g_chain;
+
+_Static_assert(2 * TABLE_COUNT <= BACKUP_MAX_SECTIONS, "Trop de tables pour l'index");
+_Static_assert(sizeof(transaction_t) <= BACKUP_BLOCK_SIZE, "Bloc de sauvegarde plus petit qu'une transaction");
+
+static const backup_table_t* find_table(uint32_t table)
+{
+    for (uint32_t i = 0; i < TABLE_COUNT; i++) {
+        if (k_tables[i].table == table) {
+            return &k_tables[i];
+        }
+    }
+    
+    return NULL;
+}
+
+static void close_reader(backup_reader_t* reader)
+{
+    if (reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+// Charge et vérifie l'en-tête, la fin de fichier et l'index
+static system_error_t open_reader(backup_reader_t* reader, const char* path)
+{
+    backup_trailer_t trailer;
+    
+    memset(reader, 0, sizeof(backup_reader_t));
+    reader->file = fopen(path, "rb");
+    if (reader->file == NULL) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    backup_header_t* header = &reader->header;
+    bool valid = fread(header, sizeof(backup_header_t), 1, reader->file) == 1 &&
+                 header->magic == BACKUP_MAGIC &&
+                 header->version >= BACKUP_MIN_VERSION && header->version <= BACKUP_VERSION &&
+                 header->header_size == sizeof(backup_header_t) &&
+                 header->crc == esp_rom_crc32_le(0, (const uint8_t*)header, offsetof(backup_header_t, crc));
+    
+    if (valid) {
+        long end = (fseek(reader->file, 0, SEEK_END) == 0) ? ftell(reader->file) : -1;
+        valid = end >= (long)(sizeof(backup_header_t) + sizeof(trailer)) &&
+                fseek(reader->file, end - (long)sizeof(trailer), SEEK_SET) == 0 &&
+                fread(&trailer, sizeof(trailer), 1, reader->file) == 1 &&
+                trailer.magic == BACKUP_END_MAGIC && trailer.section_count <= BACKUP_MAX_SECTIONS &&
+                trailer.section_count == header->section_count &&
+                trailer.index_offset + trailer.section_count * sizeof(backup_section_t) + sizeof(trailer) == (uint32_t)end;
+        reader->file_size = (uint32_t)end;
+    }
+    
+    if (valid) {
+        reader->section_count = trailer.section_count;
+        valid = fseek(reader->file, (long)trailer.index_offset, SEEK_SET) == 0 &&
+                fread(reader->sections, sizeof(backup_section_t), reader->section_count, reader->file) == reader->section_count &&
+                trailer.index_crc == esp_rom_crc32_le(0, (const uint8_t*)reader->sections,
+                                                      reader->section_count * sizeof(backup_section_t));
+    }
+    
+    if (!valid) {
+        close_reader(reader);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // Version 1 : champs de chaîne à zéro, chaque sauvegarde est sa propre base
+    if (header->base_id == 0) {
+        header->base_id = header->backup_id;
+    }
+    
+    return SYSTEM_OK;
+}
+
+// Lit le bloc suivant de la section et vérifie son CRC32
+static bool read_block(backup_reader_t* reader, const backup_section_t* section, backup_block_t* block,
+                       uint8_t* records)
+{
+    if (fread(block, sizeof(backup_block_t), 1, reader->file) != 1 ||
+        block->table != section->table || block->length > BACKUP_BLOCK_SIZE ||
+        block->length != block->record_count * section->record_size) {
+        return false;
+    }
+    
+    return fread(records, 1, block->length, reader->file) == block->length &&
+           block->crc == block_crc(block, records);
+}
+
+// Vérifie le CRC32 de chaque bloc et la cohérence des sections avec l'index. Les sections se suivent :
+// une seule lecture séquentielle de l'en-tête jusqu'à l'index
+static bool verify_blocks(backup_reader_t* reader, const char* path, uint8_t* records)
+{
+    setvbuf(reader->file, NULL, _IONBF, 0);
+    
+    bool valid = true;
+    uint32_t position = sizeof(backup_header_t);
+    for (uint32_t i = 0; i < reader->section_count && valid; i++) {
+        const backup_section_t* section = &reader->sections[i];
+        valid = section->offset == position && fseek(reader->file, (long)position, SEEK_SET) == 0;
+        
+        backup_block_t block;
+        uint32_t count = 0;
+        for (uint32_t b = 0; b < section->block_count && valid; b++) {
+            valid = read_block(reader, section, &block, records);
+            if (valid) {
+                count += block.record_count;
+                position += sizeof(block) + block.length;
+            }
+        }
+        
+        valid = valid && count == section->record_count && position == section->offset + section->length;
+        if (!valid) {
+            ESP_LOGW(TAG, "Section %" PRIu32 " corrompue: %s", section->table, path);
+        }
+    }
+    
+    return valid;
+}
+
+static void fill_info(const backup_reader_t* reader, const char* path, backup_info_t* info)
+{
+    uint32_t records = 0;
+    uint32_t deleted = 0;
+    
+    for (uint32_t i = 0; i < reader->section_count; i++) {
+        if (reader->sections[i].table & BACKUP_DELETIONS) {
+            deleted += reader->sections[i].record_count;
+        } else {
+            records += reader->sections[i].record_count;
+        }
+    }
+    
+    memset(info, 0, sizeof(backup_info_t));
+    info->backup_id = reader->header.backup_id;
+    info->backup_date = (time_t)reader->header.created_at;
+    strncpy(info->backup_path, path, sizeof(info->backup_path) - 1);
+    info->backup_size = reader->file_size;
+    info->base_id = reader->header.base_id;
+    info->parent_id = reader->header.parent_id;
+    if (reader->header.flags & BACKUP_FLAG_INCREMENTAL) {
+        snprintf(info->description, sizeof(info->description),
+                 "Incrément %" PRIu32 " de la sauvegarde %" PRIu32 ": %" PRIu32 " modifications, %" PRIu32 " suppressions",
+                 reader->header.sequence, reader->header.base_id, records, deleted);
+    } else {
+        snprintf(info->description, sizeof(info->description), "Sauvegarde complète, %" PRIu32 " enregistrements",
+                 records);
+    }
+    // En-tête et index intacts ; les blocs sont vérifiés par backup_validate
+    info->is_valid = true;
+}
+
+/**
+ * @brief Parcourt les sauvegardes de BACKUP_DIRECTORY (fichiers sans en-tête valide ignorés)
+ * @param visit Fonction appelée pour chaque sauvegarde (en-tête et index chargés), false pour arrêter
+ * @param context Contexte transmis à visit
+ */
+static void scan_backups(bool (*visit)(const backup_reader_t* reader, const char* path, void* context),
+                         void* context)
+{
+    DIR* dir = opendir(BACKUP_DIRECTORY);
+    if (dir == NULL) {
+        return;
+    }
+    
+    struct dirent* entry;
+    char path[256];
+    backup_reader_t reader;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.' ||
+            snprintf(path, sizeof(path), "%s/%s", BACKUP_DIRECTORY, entry->d_name) >= (int)sizeof(path)) {
+            continue;
+        }
+        if (open_reader(&reader, path) != SYSTEM_OK) {
+            continue;
+        }
+        close_reader(&reader);
+        if (!visit(&reader, path, context)) {
+            break;
+        }
+    }
+    closedir(dir);
+}
+
+static bool track_max_id(const backup_reader_t* reader, const char* path, void* context)
+{
+    uint32_t* max_id = context;
+    if (reader->header.backup_id > *max_id) {
+        *max_id = reader->header.backup_id;
+    }
+    return true;
+}
+
+system_error_t backup_manager_init(void)
+{
+    if (g_backup_mutex == NULL) {
+        g_backup_mutex = xSemaphoreCreateMutex();
+        if (g_backup_mutex == NULL) {
+            ESP_LOGE(TAG, "Échec création mutex sauvegardes");
+            return SYSTEM_ERROR_MEMORY;
+        }
+    }
+    
+    mkdir(BACKUP_DIRECTORY, 0755);
+    
+    uint32_t max_id = 0;
+    scan_backups(track_max_id, &max_id);
+    g_next_backup_id = max_id + 1;
+    memset(&g_chain, 0, sizeof(g_chain));
+    
+    ESP_LOGI(TAG, "Gestionnaire de sauvegarde initialisé: prochaine sauvegarde ID=%" PRIu32, g_next_backup_id);
+    return SYSTEM_OK;
+}
+
+uint32_t backup_estimate_records(void)
+{
+    uint32_t total = 0;
+    animals_stats_t animals;
+    terrarium_stats_t terrariums;
+    stock_stats_t stocks;
+    financial_stats_t transactions;
+    
+    if (animals_get_stats(&animals) == SYSTEM_OK) {
+        total += animals.total_animals;
+    }
+    if (terrarium_get_stats(&terrariums) == SYSTEM_OK) {
+        total += terrariums.total_terrariums;
+    }
+    if (stock_get_stats(&stocks) == SYSTEM_OK) {
+        total += stocks.total_items;
+    }
+    if (transaction_get_financial_stats(&transactions) == SYSTEM_OK) {
+        total += transactions.total_transactions;
+    }
+    
+    return total;
+}
+
+static void begin_section(backup_writer_t* writer, backup_section_t* section, uint32_t table, uint32_t record_size,
+                          const backup_plan_t* plan, uint32_t table_index)
+{
+    section->table = table;
+    section->record_size = record_size;
+    section->offset = (uint32_t)writer->out.size;
+    section->since_version = plan->since_versions[table_index];
+    section->version = plan->versions[table_index];
+    writer->section = section;
+}
+
+static void end_section(backup_writer_t* writer)
+{
+    write_block(writer);
+    writer->section->length = (uint32_t)writer->out.size - writer->section->offset;
+}
+
+// Écrit en-tête, sections et index ; les champs de chaîne de l'en-tête sont remplis par l'appelant
+static system_error_t write_backup(const char* path, export_progress_t* progress, backup_header_t* header,
+                                   const backup_plan_t* plan)
+{
+    backup_writer_t writer;
+    backup_section_t sections[2 * TABLE_COUNT];
+    
+    memset(&writer, 0, sizeof(writer));
+    memset(sections, 0, sizeof(sections));
+    writer.block = alloc_buffer(BACKUP_BLOCK_SIZE);
+    if (writer.block == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer le bloc de sauvegarde");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    system_error_t ret = export_writer_open(&writer.out, path);
+    if (ret != SYSTEM_OK) {
+        heap_caps_free(writer.block);
+        return ret;
+    }
+    writer.out.progress = progress;
+    writer.incremental = plan->incremental;
+    
+    // Un incrément fait précéder les enregistrements de chaque table des IDs supprimés depuis la sauvegarde parente
+    uint32_t section_count = plan->incremental ? 2 * TABLE_COUNT : TABLE_COUNT;
+    header->magic = BACKUP_MAGIC;
+    header->version = BACKUP_VERSION;
+    header->header_size = sizeof(backup_header_t);
+    header->created_at = (int64_t)time(NULL);
+    header->block_size = BACKUP_BLOCK_SIZE;
+    header->section_count = section_count;
+    header->crc = esp_rom_crc32_le(0, (const uint8_t*)header, offsetof(backup_header_t, crc));
+    export_writer_write(&writer.out, (const char*)header, sizeof(backup_header_t));
+    
+    uint32_t records = 0;
+    uint32_t deleted = 0;
+    backup_section_t* section = sections;
+    for (uint32_t i = 0; i < TABLE_COUNT && ret == SYSTEM_OK && !writer.out.failed; i++) {
+        writer.since_version = plan->since_versions[i];
+        
+        if (plan->incremental) {
+            const record_deletion_t* deletions = &plan->deletions[i * CHANGE_LOG_DELETIONS];
+            begin_section(&writer, section, k_tables[i].table | BACKUP_DELETIONS, sizeof(uint32_t), plan, i);
+            for (uint32_t d = 0; d < plan->deletion_counts[i]; d++) {
+                if (!add_record(&writer, &deletions[d].id)) {
+                    break;
+                }
+            }
+            end_section(&writer);
+            deleted += section->record_count;
+            section++;
+        }
+        
+        begin_section(&writer, section, k_tables[i].table, k_tables[i].record_size, plan, i);
+        ret = k_tables[i].save(&writer);
+        end_section(&writer);
+        records += section->record_count;
+        section++;
+    }
+    
+    backup_trailer_t trailer = {
+        .index_offset = (uint32_t)writer.out.size,
+        .section_count = section_count,
+        .index_crc = esp_rom_crc32_le(0, (const uint8_t*)sections, section_count * sizeof(backup_section_t)),
+        .magic = BACKUP_END_MAGIC,
+    };
+    export_writer_write(&writer.out, (const char*)sections, section_count * sizeof(backup_section_t));
+    export_writer_write(&writer.out, (const char*)&trailer, sizeof(trailer));
+    
+    // Un parcours en échec abandonne le fichier comme une erreur d'écriture
+    if (ret != SYSTEM_OK) {
+        writer.out.failed = true;
+    }
+    uint32_t size = (uint32_t)writer.out.size;
+    system_error_t close_ret = export_writer_close(&writer.out, path);
+    heap_caps_free(writer.block);
+    if (ret == SYSTEM_OK) {
+        ret = close_ret;
+    }
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    if (plan->incremental) {
+        ESP_LOGI(TAG, "Incrément %" PRIu32 " de la sauvegarde ID=%" PRIu32 " créé: ID=%" PRIu32 ", %s, "
+                 "%" PRIu32 " modifications, %" PRIu32 " suppressions, %" PRIu32 " octets",
+                 header->sequence, header->base_id, header->backup_id, path, records, deleted, size);
+    } else {
+        ESP_LOGI(TAG, "Sauvegarde ID=%" PRIu32 " créée: %s, %" PRIu32 " enregistrements, %" PRIu32 " octets",
+                 header->backup_id, path, records, size);
+    }
+    return SYSTEM_OK;
+}
+
+typedef struct {
+    uint32_t base_id;
+    uint32_t found;             // Rangs présents, un bit par rang
+} backup_chain_scan_t;
+
+_Static_assert(BACKUP_MAX_INCREMENTS < 32, "Rangs de chaîne au-delà du masque de présence");
+
+static bool mark_chain_member(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_chain_scan_t* scan = context;
+    
+    if (reader->header.base_id == scan->base_id && reader->header.sequence <= BACKUP_MAX_INCREMENTS) {
+        scan->found |= 1u << reader->header.sequence;
+    }
+    return true;
+}
+
+// Un incrément suppose la chaîne intacte sur la flash et l'historique des suppressions complet depuis
+static bool plan_increment(backup_plan_t* plan)
+{
+    if (g_chain.base_id == 0) {
+        return false;
+    }
+    if (g_chain.sequence >= BACKUP_MAX_INCREMENTS) {
+        ESP_LOGI(TAG, "%d incréments depuis la sauvegarde ID=%" PRIu32 ": nouvelle sauvegarde complète",
+                 BACKUP_MAX_INCREMENTS, g_chain.base_id);
+        return false;
+    }
+    
+    backup_chain_scan_t scan = { g_chain.base_id, 0 };
+    scan_backups(mark_chain_member, &scan);
+    uint32_t expected = (2u << g_chain.sequence) - 1;
+    if ((scan.found & expected) != expected) {
+        ESP_LOGW(TAG, "Chaîne de la sauvegarde ID=%" PRIu32 " incomplète: nouvelle sauvegarde complète",
+                 g_chain.base_id);
+        return false;
+    }
+    
+    for (uint32_t i = 0; i < TABLE_COUNT; i++) {
+        plan->since_versions[i] = g_chain.versions[i];
+        if (k_tables[i].deletions(g_chain.versions[i], &plan->deletions[i * CHANGE_LOG_DELETIONS],
+                                  CHANGE_LOG_DELETIONS, &plan->deletion_counts[i]) != SYSTEM_OK) {
+            ESP_LOGW(TAG, "Changements des %s depuis la sauvegarde ID=%" PRIu32 " perdus: nouvelle sauvegarde complète",
+                     k_tables[i].name, g_chain.last_id);
+            memset(plan->since_versions, 0, sizeof(plan->since_versions));
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// Sauvegardes à supprimer : une chaîne à partir d'un rang, ou les chaînes automatiques de base plus ancienne
+typedef struct {
+    uint32_t base_id;
+    uint32_t from_sequence;
+    bool older_automatic;
+    char (*paths)[256];
+    uint32_t count;
+} backup_removal_t;
+
+static bool collect_removal(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_removal_t* removal = context;
+    const backup_header_t* header = &reader->header;
+    
+    bool match = removal->older_automatic ?
+                 (header->flags & BACKUP_FLAG_AUTOMATIC) && header->base_id < removal->base_id :
+                 header->base_id == removal->base_id && header->sequence >= removal->from_sequence;
+    if (match) {
+        snprintf(removal->paths[removal->count++], sizeof(removal->paths[0]), "%s", path);
+    }
+    return removal->count < BACKUP_REMOVAL_BATCH;
+}
+
+// Relève les fichiers par lots puis les supprime, hors du parcours du répertoire
+static system_error_t remove_backups(backup_removal_t* removal, uint32_t* removed)
+{
+    *removed = 0;
+    removal->paths = alloc_buffer(BACKUP_REMOVAL_BATCH * sizeof(removal->paths[0]));
+    if (removal->paths == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    do {
+        removal->count = 0;
+        scan_backups(collect_removal, removal);
+        for (uint32_t i = 0; i < removal->count; i++) {
+            if (remove(removal->paths[i]) != 0) {
+                ESP_LOGE(TAG, "Impossible de supprimer %s", removal->paths[i]);
+                ret = SYSTEM_ERROR_STORAGE;
+            } else {
+                (*removed)++;
+            }
+        }
+    } while (ret == SYSTEM_OK && removal->count == BACKUP_REMOVAL_BATCH);
+    
+    heap_caps_free(removal->paths);
+    return ret;
+}
+
+typedef struct {
+    uint32_t bases[BACKUP_KEEP_CHAINS];     // Bases automatiques les plus récentes
+    uint32_t count;
+} backup_retention_t;
+
+static bool track_automatic_base(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_retention_t* retention = context;
+    const backup_header_t* header = &reader->header;
+    
+    if (!(header->flags & BACKUP_FLAG_AUTOMATIC) || (header->flags & BACKUP_FLAG_INCREMENTAL)) {
+        return true;
+    }
+    if (retention->count < BACKUP_KEEP_CHAINS) {
+        retention->bases[retention->count++] = header->backup_id;
+        return true;
+    }
+    
+    uint32_t oldest = 0;
+    for (uint32_t i = 1; i < retention->count; i++) {
+        if (retention->bases[i] < retention->bases[oldest]) {
+            oldest = i;
+        }
+    }
+    if (header->backup_id > retention->bases[oldest]) {
+        retention->bases[oldest] = header->backup_id;
+    }
+    return true;
+}
+
+// Garde les BACKUP_KEEP_CHAINS chaînes automatiques les plus récentes ; les sauvegardes manuelles restent
+static void prune_chains(void)
+{
+    backup_retention_t retention = { .count = 0 };
+    scan_backups(track_automatic_base, &retention);
+    if (retention.count < BACKUP_KEEP_CHAINS) {
+        return;
+    }
+    
+    backup_removal_t removal = { .base_id = retention.bases[0], .older_automatic = true };
+    for (uint32_t i = 1; i < retention.count; i++) {
+        if (retention.bases[i] < removal.base_id) {
+            removal.base_id = retention.bases[i];
+        }
+    }
+    
+    uint32_t removed;
+    remove_backups(&removal, &removed);
+    if (removed > 0) {
+        ESP_LOGI(TAG, "Rétention: %" PRIu32 " sauvegardes antérieures à l'ID=%" PRIu32 " supprimées",
+                 removed, removal.base_id);
+    }
+}
+
+static void capture_versions(backup_plan_t* plan)
+{
+    for (uint32_t i = 0; i < TABLE_COUNT; i++) {
+        plan->versions[i] = k_tables[i].version();
+    }
+}
+
+system_error_t backup_create(const char* path, export_progress_t* progress, uint32_t* backup_id)
+{
+    if (path == NULL || g_backup_mutex == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    backup_plan_t plan;
+    memset(&plan, 0, sizeof(plan));
+    
+    xSemaphoreTake(g_backup_mutex, portMAX_DELAY);
+    capture_versions(&plan);
+    backup_header_t header = { .backup_id = g_next_backup_id++ };
+    header.base_id = header.backup_id;
+    system_error_t ret = write_backup(path, progress, &header, &plan);
+    xSemaphoreGive(g_backup_mutex);
+    
+    if (ret == SYSTEM_OK && backup_id != NULL) {
+        *backup_id = header.backup_id;
+    }
+    return ret;
+}
+
+system_error_t backup_create_incremental(const char* path, export_progress_t* progress, uint32_t* backup_id)
+{
+    if (path == NULL || g_backup_mutex == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    backup_plan_t plan;
+    memset(&plan, 0, sizeof(plan));
+    plan.deletions = alloc_buffer(TABLE_COUNT * CHANGE_LOG_DELETIONS * sizeof(record_deletion_t));
+    if (plan.deletions == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    xSemaphoreTake(g_backup_mutex, portMAX_DELAY);
+    
+    // Versions relevées avant le parcours : un changement pendant l'écriture est repris par l'incrément suivant
+    capture_versions(&plan);
+    plan.incremental = plan_increment(&plan);
+    
+    backup_header_t header = {
+        .backup_id = g_next_backup_id++,
+        .flags = BACKUP_FLAG_AUTOMATIC,
+    };
+    if (plan.incremental) {
+        header.flags |= BACKUP_FLAG_INCREMENTAL;
+        header.base_id = g_chain.base_id;
+        header.parent_id = g_chain.last_id;
+        header.sequence = g_chain.sequence + 1;
+    } else {
+        header.base_id = header.backup_id;
+    }
+    
+    system_error_t ret = write_backup(path, progress, &header, &plan);
+    if (ret == SYSTEM_OK) {
+        g_chain.base_id = header.base_id;
+        g_chain.last_id = header.backup_id;
+        g_chain.sequence = header.sequence;
+        memcpy(g_chain.versions, plan.versions, sizeof(g_chain.versions));
+        if (!plan.incremental) {
+            prune_chains();
+        }
+    }
+    
+    xSemaphoreGive(g_backup_mutex);
+    heap_caps_free(plan.deletions);
+    
+    if (ret == SYSTEM_OK && backup_id != NULL) {
+        *backup_id = header.backup_id;
+    }
+    return ret;
+}
+
+// Un changement de structure rendrait les enregistrements bruts inutilisables
+static bool check_formats(const backup_reader_t* reader)
+{
+    for (uint32_t i = 0; i < reader->section_count; i++) {
+        const backup_section_t* section = &reader->sections[i];
+        const backup_table_t* table = find_table(section->table & ~BACKUP_DELETIONS);
+        if (table == NULL) {
+            continue;
+        }
+        uint32_t expected = (section->table & BACKUP_DELETIONS) ? sizeof(uint32_t) : table->record_size;
+        if (section->record_size != expected) {
+            ESP_LOGE(TAG, "Format des %s incompatible: %" PRIu32 " octets sauvegardés, %" PRIu32 " attendus",
+                     table->name, section->record_size, expected);
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static system_error_t remove_records(const backup_table_t* table, const uint8_t* records, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t id;
+        memcpy(&id, &records[i * sizeof(uint32_t)], sizeof(id));
+        system_error_t ret = table->remove(id);
+        if (ret != SYSTEM_OK && ret != SYSTEM_ERROR_NOT_FOUND) {
+            return ret;
+        }
+    }
+    
+    return SYSTEM_OK;
+}
+
+// Applique les sections d'une sauvegarde ouverte, dans l'ordre de l'index (suppressions avant enregistrements)
+static system_error_t restore_file(backup_reader_t* reader, const char* path, uint8_t* records, uint32_t* restored)
+{
+    system_error_t ret = SYSTEM_OK;
+    
+    // Lectures directes dans le bloc : pas de copie intermédiaire par le tampon de FILE
+    setvbuf(reader->file, NULL, _IONBF, 0);
+    
+    for (uint32_t i = 0; i < reader->section_count && ret == SYSTEM_OK; i++) {
+        const backup_section_t* section = &reader->sections[i];
+        bool deletions = (section->table & BACKUP_DELETIONS) != 0;
+        const backup_table_t* table = find_table(section->table & ~BACKUP_DELETIONS);
+        if (table == NULL) {
+            ESP_LOGW(TAG, "Table %" PRIu32 " inconnue ignorée", section->table);
+            continue;
+        }
+        if (fseek(reader->file, (long)section->offset, SEEK_SET) != 0) {
+            ret = SYSTEM_ERROR_STORAGE;
+            break;
+        }
+        
+        backup_block_t block;
+        for (uint32_t b = 0; b < section->block_count && ret == SYSTEM_OK; b++) {
+            if (!read_block(reader, section, &block, records)) {
+                ESP_LOGE(TAG, "Bloc %" PRIu32 " des %s corrompu: %s", b, table->name, path);
+                ret = SYSTEM_ERROR_STORAGE;
+                break;
+            }
+            if (deletions) {
+                ret = remove_records(table, records, block.record_count);
+            } else {
+                ret = table->restore(records, block.record_count);
+                *restored += block.record_count;
+            }
+        }
+    }
+    
+    return ret;
+}
+
+// Membre d'une chaîne à restaurer, par rang
+typedef struct {
+    char path[256];
+    uint32_t backup_id;
+    uint32_t parent_id;
+    bool found;
+} backup_member_t;
+
+typedef struct {
+    uint32_t base_id;
+    uint32_t sequence;          // Rang de la sauvegarde visée
+    backup_member_t* members;
+} backup_chain_search_t;
+
+static bool collect_chain_member(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_chain_search_t* search = context;
+    const backup_header_t* header = &reader->header;
+    
+    if (header->base_id == search->base_id && header->sequence < search->sequence) {
+        backup_member_t* member = &search->members[header->sequence];
+        snprintf(member->path, sizeof(member->path), "%s", path);
+        member->backup_id = header->backup_id;
+        member->parent_id = header->parent_id;
+        member->found = true;
+    }
+    return true;
+}
+
+// Chaque incrément doit partir des versions où s'est arrêtée la sauvegarde précédente
+static bool follows(const backup_reader_t* reader, const backup_section_t* previous, uint32_t previous_count)
+{
+    for (uint32_t i = 0; i < reader->section_count; i++) {
+        const backup_section_t* section = &reader->sections[i];
+        for (uint32_t p = 0; p < previous_count; p++) {
+            if (previous[p].table == section->table && (section->table & BACKUP_DELETIONS) == 0 &&
+                previous[p].version != section->since_version) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+// Retrouve la base et les incréments précédents, vérifie toute la chaîne puis l'applique dans l'ordre
+static system_error_t restore_chain(const backup_header_t* target, const char* path, uint8_t* records,
+                                    uint32_t* restored)
+{
+    uint32_t length = target->sequence + 1;
+    backup_member_t* members = alloc_buffer(length * sizeof(backup_member_t));
+    if (members == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    memset(members, 0, length * sizeof(backup_member_t));
+    
+    backup_chain_search_t search = { target->base_id, target->sequence, members };
+    scan_backups(collect_chain_member, &search);
+    snprintf(members[target->sequence].path, sizeof(members[0].path), "%s", path);
+    members[target->sequence].backup_id = target->backup_id;
+    members[target->sequence].parent_id = target->parent_id;
+    members[target->sequence].found = true;
+    
+    system_error_t ret = SYSTEM_OK;
+    for (uint32_t i = 0; i < length && ret == SYSTEM_OK; i++) {
+        bool linked = members[i].found &&
+                      ((i == 0) ? members[i].backup_id == target->base_id :
+                                  members[i].parent_id == members[i - 1].backup_id);
+        if (!linked) {
+            ESP_LOGE(TAG, "Chaîne de la sauvegarde ID=%" PRIu32 " incomplète: rang %" PRIu32 " introuvable",
+                     target->base_id, i);
+            ret = SYSTEM_ERROR_NOT_FOUND;
+        }
+    }
+    
+    // Toute la chaîne est lue et vérifiée, CRC32 de chaque bloc compris, avant d'appliquer quoi que ce soit
+    backup_reader_t reader;
+    backup_section_t previous[BACKUP_MAX_SECTIONS];
+    uint32_t previous_count = 0;
+    for (uint32_t i = 0; i < length && ret == SYSTEM_OK; i++) {
+        ret = open_reader(&reader, members[i].path);
+        if (ret != SYSTEM_OK) {
+            ESP_LOGE(TAG, "Sauvegarde illisible: %s", members[i].path);
+            break;
+        }
+        if (!check_formats(&reader)) {
+            ret = SYSTEM_ERROR_INVALID_PARAM;
+        } else if (i > 0 && !follows(&reader, previous, previous_count)) {
+            ESP_LOGE(TAG, "Incrément ID=%" PRIu32 " sans continuité avec sa sauvegarde parente", members[i].backup_id);
+            ret = SYSTEM_ERROR_STORAGE;
+        } else if (!verify_blocks(&reader, members[i].path, records)) {
+            ret = SYSTEM_ERROR_STORAGE;
+        }
+        memcpy(previous, reader.sections, reader.section_count * sizeof(backup_section_t));
+        previous_count = reader.section_count;
+        close_reader(&reader);
+    }
+    
+    for (uint32_t i = 0; i < length && ret == SYSTEM_OK; i++) {
+        ret = open_reader(&reader, members[i].path);
+        if (ret == SYSTEM_OK) {
+            ret = restore_file(&reader, members[i].path, records, restored);
+            close_reader(&reader);
+        }
+    }
+    
+    heap_caps_free(members);
+    return ret;
+}
+
+system_error_t backup_restore(const char* path)
+{
+    if (path == NULL || g_backup_mutex == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    backup_reader_t reader;
+    system_error_t ret = open_reader(&reader, path);
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Sauvegarde illisible: %s", path);
+        return ret;
+    }
+    
+    // Rien n'est appliqué si la structure des enregistrements a changé depuis l'écriture
+    if (!check_formats(&reader)) {
+        close_reader(&reader);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint8_t* records = alloc_buffer(BACKUP_BLOCK_SIZE);
+    if (records == NULL) {
+        close_reader(&reader);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    backup_header_t header = reader.header;
+    uint32_t restored = 0;
+    
+    xSemaphoreTake(g_backup_mutex, portMAX_DELAY);
+    if (header.flags & BACKUP_FLAG_INCREMENTAL) {
+        close_reader(&reader);
+        ret = restore_chain(&header, path, records, &restored);
+    } else {
+        // Un bloc corrompu en fin de fichier ne doit pas laisser une restauration à moitié appliquée
+        ret = verify_blocks(&reader, path, records) ? restore_file(&reader, path, records, &restored) :
+                                                      SYSTEM_ERROR_STORAGE;
+        close_reader(&reader);
+    }
+    // Versions de changement réattribuées par la restauration : la sauvegarde automatique repart d'une complète
+    memset(&g_chain, 0, sizeof(g_chain));
+    xSemaphoreGive(g_backup_mutex);
+    
+    heap_caps_free(records);
+    
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Restauration interrompue: %s", path);
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Sauvegarde ID=%" PRIu32 " restaurée (rang %" PRIu32 " de sa chaîne): %" PRIu32 " enregistrements",
+             header.backup_id, header.sequence, restored);
+    return SYSTEM_OK;
+}
+
+system_error_t backup_validate(const char* path, bool* is_valid)
+{
+    if (path == NULL || is_valid == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    *is_valid = false;
+    
+    backup_reader_t reader;
+    system_error_t ret = open_reader(&reader, path);
+    if (ret == SYSTEM_ERROR_NOT_FOUND) {
+        return ret;
+    }
+    if (ret != SYSTEM_OK) {
+        ESP_LOGW(TAG, "En-tête ou index de sauvegarde corrompu: %s", path);
+        return SYSTEM_OK;
+    }
+    
+    uint8_t* records = alloc_buffer(BACKUP_BLOCK_SIZE);
+    if (records == NULL) {
+        close_reader(&reader);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    bool valid = verify_blocks(&reader, path, records);
+    
+    heap_caps_free(records);
+    close_reader(&reader);
+    
+    *is_valid = valid;
+    return SYSTEM_OK;
+}
+
+typedef struct {
+    backup_info_t* backups;
+    uint32_t max_count;
+    uint32_t count;
+} backup_list_t;
+
+// Garde les max_count sauvegardes les plus récentes
+static bool list_backup(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_list_t* list = context;
+    uint32_t slot = list->count;
+    
+    if (list->count == list->max_count) {
+        uint32_t oldest = 0;
+        for (uint32_t i = 1; i < list->count; i++) {
+            if (list->backups[i].backup_id < list->backups[oldest].backup_id) {
+                oldest = i;
+            }
+        }
+        if (list->count == 0 || reader->header.backup_id < list->backups[oldest].backup_id) {
+            return true;
+        }
+        slot = oldest;
+    } else {
+        list->count++;
+    }
+    
+    fill_info(reader, path, &list->backups[slot]);
+    return true;
+}
+
+// Par chaîne, puis par ID : chaque base est suivie de ses incréments
+static int compare_backups(const void* a, const void* b)
+{
+    const backup_info_t* info_a = a;
+    const backup_info_t* info_b = b;
+    
+    if (info_a->base_id != info_b->base_id) {
+        return (info_a->base_id > info_b->base_id) - (info_a->base_id < info_b->base_id);
+    }
+    return (info_a->backup_id > info_b->backup_id) - (info_a->backup_id < info_b->backup_id);
+}
+
+typedef struct {
+    uint32_t backup_id;
+    char* path;
+    size_t size;
+    backup_header_t header;
+    bool found;
+} backup_search_t;
+
+static bool match_backup(const backup_reader_t* reader, const char* path, void* context)
+{
+    backup_search_t* search = context;
+    
+    if (reader->header.backup_id != search->backup_id) {
+        return true;
+    }
+    if (search->path != NULL) {
+        snprintf(search->path, search->size, "%s", path);
+    }
+    search->header = reader->header;
+    search->found = true;
+    return false;
+}
+
+static bool find_backup(uint32_t backup_id, char* path, size_t size, backup_header_t* header)
+{
+    backup_search_t search = { .backup_id = backup_id, .path = path, .size = size };
+    scan_backups(match_backup, &search);
+    
+    if (search.found && header != NULL) {
+        *header = search.header;
+    }
+    return search.found;
+}
+
+system_error_t backup_list(backup_info_t* backups, uint32_t max_count, uint32_t* count)
+{
+    if (backups == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    backup_list_t list = { backups, max_count, 0 };
+    scan_backups(list_backup, &list);
+    qsort(backups, list.count, sizeof(backup_info_t), compare_backups);
+    
+    // Un incrément n'est restaurable que si sa sauvegarde parente l'est ; dans l'ordre du tri,
+    // la parente précède. Une parente trop ancienne pour la liste est cherchée dans le répertoire.
+    for (uint32_t i = 0; i < list.count; i++) {
+        if (backups[i].parent_id == 0) {
+            continue;
+        }
+        int32_t parent = -1;
+        for (int32_t j = (int32_t)i - 1; j >= 0 && backups[j].base_id == backups[i].base_id; j--) {
+            if (backups[j].backup_id == backups[i].parent_id) {
+                parent = j;
+                break;
+            }
+        }
+        backups[i].is_valid = (parent >= 0) ? backups[parent].is_valid :
+                              find_backup(backups[i].parent_id, NULL, 0, NULL);
+    }
+    
+    *count = list.count;
+    return SYSTEM_OK;
+}
+
+system_error_t backup_find(uint32_t backup_id, char* path, size_t size)
+{
+    if (path == NULL || size == 0) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    return find_backup(backup_id, path, size, NULL) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+}
+
+system_error_t backup_delete(uint32_t backup_id)
 {
-    ESP_LOGI(TAG, "Gestionnaire de sauvegarde initialisé");
+    if (g_backup_mutex == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    backup_header_t header;
+    if (!find_backup(backup_id, NULL, 0, &header)) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    // Les incréments suivants dépendent de celle-ci : ils partent avec elle
+    backup_removal_t removal = { .base_id = header.base_id, .from_sequence = header.sequence };
+    uint32_t removed;
+    
+    xSemaphoreTake(g_backup_mutex, portMAX_DELAY);
+    system_error_t ret = remove_backups(&removal, &removed);
+    if (g_chain.base_id == header.base_id) {
+        memset(&g_chain, 0, sizeof(g_chain));
+    }
+    xSemaphoreGive(g_backup_mutex);
+    
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ESP_LOGI(TAG, "Sauvegarde ID=%" PRIu32 " supprimée: %" PRIu32 " fichiers de sa chaîne", backup_id, removed);
+    return SYSTEM_OK;
 }
\ No newline at end of file
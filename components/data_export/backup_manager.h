@@ -0,0 +1,111 @@
+#ifndef BACKUP_MANAGER_H
+#define BACKUP_MANAGER_H
+
+#include "export_writer.h"
+
+// Conteneur de sauvegarde, écrit séquentiellement :
+//   - en-tête (version, ID, date, CRC32) ;
+//   - une section par table : blocs d'enregistrements bruts de BACKUP_BLOCK_SIZE octets au plus,
+//     chacun précédé de son nombre d'enregistrements, de sa longueur et de son CRC32 ;
+//   - index des sections (table, taille d'enregistrement, position, longueur) puis fin de fichier
+//     donnant la position de l'index, pour atteindre une table sans lire les précédentes.
+// Un incrément ne contient que les enregistrements modifiés depuis la sauvegarde précédente de sa chaîne,
+// d'après leur version de changement, chaque table précédée d'une section des IDs supprimés depuis.
+// Une chaîne part d'une sauvegarde complète ; l'en-tête d'un incrément désigne sa base et sa parente.
+
+typedef enum {
+    BACKUP_TABLE_ANIMALS = 1,
+    BACKUP_TABLE_TERRARIUMS,
+    BACKUP_TABLE_STOCK_ITEMS,
+    BACKUP_TABLE_TRANSACTIONS
+} backup_table_id_t;
+
+/**
+ * @brief Crée le répertoire des sauvegardes et reprend la numérotation des sauvegardes existantes
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t backup_manager_init(void);
+
+/**
+ * @brief Nombre d'enregistrements d'une sauvegarde complète, pour l'avancement
+ * @return Somme des tailles des tables sauvegardées
+ */
+uint32_t backup_estimate_records(void);
+
+/**
+ * @brief Écrit une sauvegarde complète (transactions archivées comprises)
+ * @param path Chemin du fichier, supprimé en cas d'échec ou d'annulation
+ * @param progress Avancement tenu à jour pendant l'écriture (NULL pour aucun)
+ * @param backup_id Pointeur vers l'ID attribué (NULL si inutile)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t backup_create(const char* path, export_progress_t* progress, uint32_t* backup_id);
+
+/**
+ * @brief Écrit la sauvegarde suivante de la chaîne automatique : un incrément, ou une sauvegarde complète
+ *        si aucune chaîne n'est en cours, si elle compte BACKUP_MAX_INCREMENTS incréments, si un de ses
+ *        fichiers manque ou si des changements depuis la précédente ne sont plus connus
+ *
+ * Une nouvelle sauvegarde complète supprime les chaînes automatiques au-delà de BACKUP_KEEP_CHAINS.
+ * La chaîne n'est suivie que dans BACKUP_DIRECTORY.
+ *
+ * @param path Chemin du fichier, supprimé en cas d'échec ou d'annulation
+ * @param progress Avancement tenu à jour pendant l'écriture (NULL pour aucun)
+ * @param backup_id Pointeur vers l'ID attribué (NULL si inutile)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t backup_create_incremental(const char* path, export_progress_t* progress, uint32_t* backup_id);
+
+/**
+ * @brief Restaure une sauvegarde, table par table, après vérification du CRC32 de tous ses blocs
+ *
+ * Les enregistrements sont remplacés ou ajoutés par ID. Un incrément est restauré avec sa chaîne :
+ * la base puis chaque incrément jusqu'à lui, suppressions comprises, après vérification de tous
+ * les fichiers. Un bloc corrompu est détecté avant qu'aucun enregistrement ne soit appliqué ; seul
+ * un échec d'application laisse les blocs précédents appliqués, et une nouvelle restauration les
+ * remplace à l'identique.
+ *
+ * @param path Chemin de la sauvegarde
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE si un fichier est illisible ou corrompu,
+ *         SYSTEM_ERROR_NOT_FOUND si un fichier de la chaîne manque dans BACKUP_DIRECTORY,
+ *         SYSTEM_ERROR_INVALID_PARAM si le format des enregistrements a changé depuis l'écriture
+ */
+system_error_t backup_restore(const char* path);
+
+/**
+ * @brief Vérifie l'en-tête, l'index et le CRC32 de chaque bloc, sans décoder les enregistrements
+ * @param path Chemin de la sauvegarde
+ * @param is_valid Pointeur vers le résultat
+ * @return SYSTEM_OK si la vérification a pu être menée, SYSTEM_ERROR_NOT_FOUND si le fichier n'existe pas
+ */
+system_error_t backup_validate(const char* path, bool* is_valid);
+
+/**
+ * @brief Liste les sauvegardes de BACKUP_DIRECTORY par chaîne puis par ID, en ne lisant que l'en-tête et l'index
+ *
+ * Un incrément dont une sauvegarde précédente de la chaîne manque est marqué invalide.
+ *
+ * @param backups Tableau à remplir (les plus récentes s'il est trop petit)
+ * @param max_count Taille du tableau
+ * @param count Pointeur vers le nombre de sauvegardes listées
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t backup_list(backup_info_t* backups, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Retrouve le fichier d'une sauvegarde de BACKUP_DIRECTORY
+ * @param backup_id ID de la sauvegarde
+ * @param path Chemin à remplir
+ * @param size Taille de path
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND sinon
+ */
+system_error_t backup_find(uint32_t backup_id, char* path, size_t size);
+
+/**
+ * @brief Supprime une sauvegarde de BACKUP_DIRECTORY et les incréments qui en dépendent
+ * @param backup_id ID de la sauvegarde
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si elle n'existe pas
+ */
+system_error_t backup_delete(uint32_t backup_id);
+
+#endif // BACKUP_MANAGER_H
\ No newline at end of file
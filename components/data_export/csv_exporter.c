@@ -1,9 +1,322 @@
-#include "data_export.h"
+#include "csv_exporter.h"
+#include "export_labels.h"
+#include "animals_manager.h"
+#include "terrarium_monitor.h"
+#include "stock_manager.h"
+#include "transaction_manager.h"
 #include "esp_log.h"
+#include <string.h>
+#include <inttypes.h>
 
 static const char* TAG = "CSV_EXPORTER";
 
+static const char* const k_animal_columns[] = {
+    "ID", "Nom", "Espèce", "Type", "Sexe", "Statut", "Naissance", "Acquisition", "Origine", "Puce",
+    "Terrarium", "Poids (g)", "Longueur (cm)", "CITES", "N° CITES", "Notes", "Créé le", "Modifié le"
+};
+
+static const char* const k_terrarium_columns[] = {
+    "ID", "Nom", "Description", "Animal", "Capteurs", "Chauffage", "Éclairage", "Humidificateur",
+    "Créé le", "Modifié le"
+};
+
+static const char* const k_stock_columns[] = {
+    "ID", "Nom", "Type", "Quantité", "Unité", "Minimum", "Maximum", "Prix unitaire", "Fournisseur", "Lot",
+    "Expiration", "Emplacement", "Consommation/jour", "Rupture prévue", "Réappro. suggéré", "Notes"
+};
+
+static const char* const k_transaction_columns[] = {
+    "ID", "Date", "Type", "Statut", "Animal ID", "Animal", "Espèce", "Montant", "Devise", "Contrepartie",
+    "Adresse", "Téléphone", "Email", "CITES", "Permis CITES", "Certificat", "Notes"
+};
+
+// Parcours d'un export : fichier et filtre de dates
+typedef struct {
+    csv_writer_t csv;
+    time_t start_date;
+    time_t end_date;
+} csv_export_t;
+
+static void field_separator(csv_writer_t* csv)
+{
+    if (csv->row_open) {
+        export_writer_write(&csv->out, ";", 1);
+    }
+    csv->row_open = true;
+}
+
 void csv_exporter_init(void)
 {
     ESP_LOGI(TAG, "Exporteur CSV initialisé");
+}
+
+system_error_t csv_writer_open(csv_writer_t* csv, const char* path, const char* const* titles, uint32_t column_count)
+{
+    memset(csv, 0, sizeof(csv_writer_t));
+    
+    system_error_t ret = export_writer_open(&csv->out, path);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    // BOM UTF-8 et séparateur point-virgule pour les tableurs configurés en français
+    export_writer_write(&csv->out, "\xEF\xBB\xBF", 3);
+    for (uint32_t c = 0; c < column_count; c++) {
+        csv_writer_text(csv, titles[c]);
+    }
+    csv_writer_end_row(csv);
+    csv->rows = 0;
+    
+    return SYSTEM_OK;
+}
+
+// Champ entre guillemets s'il contient un séparateur, un guillemet ou un saut de ligne
+void csv_writer_text(csv_writer_t* csv, const char* value)
+{
+    field_separator(csv);
+    
+    if (strpbrk(value, ";\"\r\n") == NULL) {
+        export_writer_write(&csv->out, value, strlen(value));
+        return;
+    }
+    
+    export_writer_write(&csv->out, "\"", 1);
+    for (const char* quote; (quote = strchr(value, '"')) != NULL; value = quote + 1) {
+        export_writer_write(&csv->out, value, (size_t)(quote - value) + 1);
+        export_writer_write(&csv->out, "\"", 1);
+    }
+    export_writer_write(&csv->out, value, strlen(value));
+    export_writer_write(&csv->out, "\"", 1);
+}
+
+void csv_writer_uint(csv_writer_t* csv, uint32_t value)
+{
+    field_separator(csv);
+    export_writer_printf(&csv->out, "%" PRIu32, value);
+}
+
+void csv_writer_number(csv_writer_t* csv, float value, int decimals)
+{
+    char text[EXPORT_FORMAT_SIZE];
+    int length = snprintf(text, sizeof(text), "%.*f", decimals, (double)value);
+    
+    field_separator(csv);
+    if (length <= 0 || (size_t)length >= sizeof(text)) {
+        return;
+    }
+    
+    char* point = strchr(text, '.');
+    if (point != NULL) {
+        *point = ',';
+    }
+    export_writer_write(&csv->out, text, (size_t)length);
+}
+
+void csv_writer_date(csv_writer_t* csv, time_t date)
+{
+    field_separator(csv);
+    if (date == 0) {
+        return;
+    }
+    
+    struct tm tm_info;
+    localtime_r(&date, &tm_info);
+    export_writer_printf(&csv->out, "%02d/%02d/%04d", tm_info.tm_mday, tm_info.tm_mon + 1, tm_info.tm_year + 1900);
+}
+
+void csv_writer_bool(csv_writer_t* csv, bool value)
+{
+    csv_writer_text(csv, value ? "Oui" : "Non");
+}
+
+void csv_writer_end_row(csv_writer_t* csv)
+{
+    export_writer_write(&csv->out, "\r\n", 2);
+    csv->row_open = false;
+    csv->rows++;
+}
+
+system_error_t csv_writer_close(csv_writer_t* csv, const char* path)
+{
+    return export_writer_close(&csv->out, path);
+}
+
+static bool in_range(const csv_export_t* export, time_t date)
+{
+    return (export->start_date == 0 || date >= export->start_date) &&
+           (export->end_date == 0 || date <= export->end_date);
+}
+
+static bool write_animal(const animal_t* animal, void* context)
+{
+    csv_export_t* export = (csv_export_t*)context;
+    csv_writer_t* csv = &export->csv;
+    
+    if (!in_range(export, (animal->acquisition_date != 0) ? animal->acquisition_date : animal->birth_date)) {
+        return true;
+    }
+    
+    csv_writer_uint(csv, animal->id);
+    csv_writer_text(csv, animal->name);
+    csv_writer_text(csv, animal->species);
+    csv_writer_text(csv, EXPORT_LABEL(k_animal_type_labels, animal->type));
+    csv_writer_text(csv, EXPORT_LABEL(k_animal_sex_labels, animal->sex));
+    csv_writer_text(csv, EXPORT_LABEL(k_animal_status_labels, animal->status));
+    csv_writer_date(csv, animal->birth_date);
+    csv_writer_date(csv, animal->acquisition_date);
+    csv_writer_text(csv, animal->origin);
+    csv_writer_text(csv, animal->microchip_id);
+    csv_writer_uint(csv, animal->terrarium_id);
+    csv_writer_number(csv, animal->weight_grams, 1);
+    csv_writer_number(csv, animal->length_cm, 1);
+    csv_writer_bool(csv, animal->cites_required);
+    csv_writer_text(csv, animal->cites_number);
+    csv_writer_text(csv, animal->notes);
+    csv_writer_date(csv, animal->created_at);
+    csv_writer_date(csv, animal->updated_at);
+    csv_writer_end_row(csv);
+    
+    return export_writer_record(&csv->out);
+}
+
+static bool write_terrarium(const terrarium_t* terrarium, void* context)
+{
+    csv_writer_t* csv = &((csv_export_t*)context)->csv;
+    
+    csv_writer_uint(csv, terrarium->id);
+    csv_writer_text(csv, terrarium->name);
+    csv_writer_text(csv, terrarium->description);
+    csv_writer_uint(csv, terrarium->animal_id);
+    csv_writer_uint(csv, terrarium->sensor_count);
+    csv_writer_bool(csv, terrarium->heating_enabled);
+    csv_writer_bool(csv, terrarium->lighting_enabled);
+    csv_writer_bool(csv, terrarium->humidifier_enabled);
+    csv_writer_date(csv, terrarium->created_at);
+    csv_writer_date(csv, terrarium->updated_at);
+    csv_writer_end_row(csv);
+    
+    return export_writer_record(&csv->out);
+}
+
+static bool write_stock_item(const stock_item_t* item, void* context)
+{
+    csv_writer_t* csv = &((csv_export_t*)context)->csv;
+    
+    csv_writer_uint(csv, item->id);
+    csv_writer_text(csv, item->name);
+    csv_writer_text(csv, EXPORT_LABEL(k_stock_type_labels, item->type));
+    csv_writer_number(csv, item->current_quantity, 2);
+    csv_writer_text(csv, EXPORT_LABEL(k_stock_unit_labels, item->unit));
+    csv_writer_number(csv, item->min_quantity, 2);
+    csv_writer_number(csv, item->max_quantity, 2);
+    csv_writer_number(csv, item->unit_price, 2);
+    csv_writer_text(csv, item->supplier);
+    csv_writer_text(csv, item->batch_number);
+    csv_writer_date(csv, item->expiry_date);
+    csv_writer_text(csv, item->storage_location);
+    csv_writer_number(csv, item->daily_consumption, 2);
+    csv_writer_date(csv, item->predicted_stockout_date);
+    csv_writer_number(csv, item->suggested_reorder_qty, 2);
+    csv_writer_text(csv, item->notes);
+    csv_writer_end_row(csv);
+    
+    return export_writer_record(&csv->out);
+}
+
+static bool write_transaction(const transaction_t* transaction, void* context)
+{
+    csv_writer_t* csv = &((csv_export_t*)context)->csv;
+    
+    csv_writer_uint(csv, transaction->id);
+    csv_writer_date(csv, transaction->transaction_date);
+    csv_writer_text(csv, EXPORT_LABEL(k_transaction_type_labels, transaction->type));
+    csv_writer_text(csv, EXPORT_LABEL(k_transaction_status_labels, transaction->status));
+    csv_writer_uint(csv, transaction->animal_id);
+    csv_writer_text(csv, transaction->animal_name);
+    csv_writer_text(csv, transaction->animal_species);
+    csv_writer_number(csv, transaction->amount, 2);
+    csv_writer_text(csv, transaction->currency);
+    csv_writer_text(csv, transaction->counterpart_name);
+    csv_writer_text(csv, transaction->counterpart_address);
+    csv_writer_text(csv, transaction->counterpart_phone);
+    csv_writer_text(csv, transaction->counterpart_email);
+    csv_writer_bool(csv, transaction->cites_required);
+    csv_writer_text(csv, transaction->cites_permit_number);
+    csv_writer_text(csv, transaction->certificate_number);
+    csv_writer_text(csv, transaction->notes);
+    csv_writer_end_row(csv);
+    
+    return export_writer_record(&csv->out);
+}
+
+static system_error_t finish_export(csv_export_t* export, system_error_t ret, const char* path)
+{
+    system_error_t close_ret = csv_writer_close(&export->csv, path);
+    if (ret != SYSTEM_OK) {
+        remove(path);
+        return ret;
+    }
+    if (close_ret != SYSTEM_OK) {
+        return close_ret;
+    }
+    
+    ESP_LOGI(TAG, "Export CSV %s: %" PRIu32 " lignes, %u octets", path, export->csv.rows,
+             (unsigned)export->csv.out.size);
+    return SYSTEM_OK;
+}
+
+system_error_t csv_export_animals(const char* path, time_t start_date, time_t end_date, export_progress_t* progress)
+{
+    csv_export_t export = { .start_date = start_date, .end_date = end_date };
+    system_error_t ret = csv_writer_open(&export.csv, path, k_animal_columns,
+                                         sizeof(k_animal_columns) / sizeof(k_animal_columns[0]));
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    export.csv.out.progress = progress;
+    
+    ret = animals_for_each(write_animal, &export);
+    return finish_export(&export, ret, path);
+}
+
+system_error_t csv_export_terrariums(const char* path, export_progress_t* progress)
+{
+    csv_export_t export = { 0 };
+    system_error_t ret = csv_writer_open(&export.csv, path, k_terrarium_columns,
+                                         sizeof(k_terrarium_columns) / sizeof(k_terrarium_columns[0]));
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    export.csv.out.progress = progress;
+    
+    ret = terrarium_for_each(write_terrarium, &export);
+    return finish_export(&export, ret, path);
+}
+
+system_error_t csv_export_stocks(const char* path, export_progress_t* progress)
+{
+    csv_export_t export = { 0 };
+    system_error_t ret = csv_writer_open(&export.csv, path, k_stock_columns,
+                                         sizeof(k_stock_columns) / sizeof(k_stock_columns[0]));
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    export.csv.out.progress = progress;
+    
+    ret = stock_for_each_item(write_stock_item, &export);
+    return finish_export(&export, ret, path);
+}
+
+system_error_t csv_export_transactions(const char* path, time_t start_date, time_t end_date, export_progress_t* progress)
+{
+    csv_export_t export = { .start_date = start_date, .end_date = end_date };
+    system_error_t ret = csv_writer_open(&export.csv, path, k_transaction_columns,
+                                         sizeof(k_transaction_columns) / sizeof(k_transaction_columns[0]));
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    export.csv.out.progress = progress;
+    
+    ret = transaction_for_each(start_date, end_date, write_transaction, &export);
+    return finish_export(&export, ret, path);
 }
\ No newline at end of file
@@ -0,0 +1,114 @@
+#ifndef CSV_EXPORTER_H
+#define CSV_EXPORTER_H
+
+#include "export_writer.h"
+
+// Fichier CSV en cours d'écriture (séparateur point-virgule, BOM UTF-8)
+typedef struct {
+    export_writer_t out;
+    uint32_t rows;          // Lignes de données terminées
+    bool row_open;          // Un champ a déjà été écrit sur la ligne en cours
+} csv_writer_t;
+
+/**
+ * @brief Initialise l'exporteur CSV
+ */
+void csv_exporter_init(void);
+
+/**
+ * @brief Crée un fichier CSV et écrit sa ligne de titres
+ * @param csv Fichier à initialiser
+ * @param path Chemin du fichier
+ * @param titles Titres des colonnes
+ * @param column_count Nombre de colonnes
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t csv_writer_open(csv_writer_t* csv, const char* path, const char* const* titles, uint32_t column_count);
+
+/**
+ * @brief Ajoute un champ texte, échappé au fil de l'écriture
+ * @param csv Fichier CSV
+ * @param value Texte UTF-8
+ */
+void csv_writer_text(csv_writer_t* csv, const char* value);
+
+/**
+ * @brief Ajoute un champ entier
+ * @param csv Fichier CSV
+ * @param value Valeur
+ */
+void csv_writer_uint(csv_writer_t* csv, uint32_t value);
+
+/**
+ * @brief Ajoute un champ décimal (virgule décimale)
+ * @param csv Fichier CSV
+ * @param value Valeur
+ * @param decimals Nombre de décimales
+ */
+void csv_writer_number(csv_writer_t* csv, float value, int decimals);
+
+/**
+ * @brief Ajoute un champ date (JJ/MM/AAAA, vide si la date est nulle)
+ * @param csv Fichier CSV
+ * @param date Date
+ */
+void csv_writer_date(csv_writer_t* csv, time_t date);
+
+/**
+ * @brief Ajoute un champ Oui/Non
+ * @param csv Fichier CSV
+ * @param value Valeur
+ */
+void csv_writer_bool(csv_writer_t* csv, bool value);
+
+/**
+ * @brief Termine la ligne en cours
+ * @param csv Fichier CSV
+ */
+void csv_writer_end_row(csv_writer_t* csv);
+
+/**
+ * @brief Écrit la fin du fichier et le ferme
+ * @param csv Fichier CSV
+ * @param path Chemin du fichier, supprimé en cas d'échec
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE sinon
+ */
+system_error_t csv_writer_close(csv_writer_t* csv, const char* path);
+
+/**
+ * @brief Exporte les animaux entrés dans l'élevage (acquisition, à défaut naissance) sur une période
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t csv_export_animals(const char* path, time_t start_date, time_t end_date, export_progress_t* progress);
+
+/**
+ * @brief Exporte les terrariums
+ * @param path Chemin du fichier
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t csv_export_terrariums(const char* path, export_progress_t* progress);
+
+/**
+ * @brief Exporte les articles en stock
+ * @param path Chemin du fichier
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t csv_export_stocks(const char* path, export_progress_t* progress);
+
+/**
+ * @brief Exporte les transactions d'une période, archive comprise, par date croissante
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t csv_export_transactions(const char* path, time_t start_date, time_t end_date, export_progress_t* progress);
+
+#endif // CSV_EXPORTER_H
\ No newline at end of file
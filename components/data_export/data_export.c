@@ -1,6 +1,17 @@
 #include "data_export.h"
+#include "csv_exporter.h"
+#include "json_exporter.h"
+#include "pdf_generator.h"
+#include "export_jobs.h"
+#include "backup_manager.h"
+#include "animals_manager.h"
+#include "terrarium_monitor.h"
+#include "stock_manager.h"
+#include "transaction_manager.h"
 #include "esp_log.h"
+#include <stdio.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <inttypes.h>
 
 static const char* TAG = "DATA_EXPORT";
@@ -8,6 +19,130 @@ static const char* TAG = "DATA_EXPORT";
 // Variables globales
 static bool g_initialized = false;
 
+static system_error_t unsupported_format(export_format_t format)
+{
+    ESP_LOGW(TAG, "Format d'export non pris en charge: %d", format);
+    return SYSTEM_ERROR_INVALID_PARAM;
+}
+
+static bool is_supported(export_type_t type, export_format_t format)
+{
+    switch (type) {
+        case EXPORT_TYPE_ANIMALS:
+        case EXPORT_TYPE_TRANSACTIONS:
+            return format == EXPORT_FORMAT_CSV || format == EXPORT_FORMAT_JSON || format == EXPORT_FORMAT_PDF;
+        case EXPORT_TYPE_TERRARIUMS:
+        case EXPORT_TYPE_STOCKS:
+            return format == EXPORT_FORMAT_CSV;
+        case EXPORT_TYPE_FULL_BACKUP:
+        case EXPORT_TYPE_INCREMENTAL_BACKUP:
+            return format == EXPORT_FORMAT_BINARY;
+        default:
+            return false;
+    }
+}
+
+// Borne haute du nombre d'enregistrements, sans parcours : le filtre de dates n'est pas appliqué
+static uint32_t estimate_records(export_type_t type)
+{
+    switch (type) {
+        case EXPORT_TYPE_ANIMALS: {
+            animals_stats_t stats;
+            return (animals_get_stats(&stats) == SYSTEM_OK) ? stats.total_animals : 0;
+        }
+        case EXPORT_TYPE_TERRARIUMS: {
+            terrarium_stats_t stats;
+            return (terrarium_get_stats(&stats) == SYSTEM_OK) ? stats.total_terrariums : 0;
+        }
+        case EXPORT_TYPE_STOCKS: {
+            stock_stats_t stats;
+            return (stock_get_stats(&stats) == SYSTEM_OK) ? stats.total_items : 0;
+        }
+        case EXPORT_TYPE_TRANSACTIONS: {
+            financial_stats_t stats;
+            return (transaction_get_financial_stats(&stats) == SYSTEM_OK) ? stats.total_transactions : 0;
+        }
+        case EXPORT_TYPE_FULL_BACKUP:
+        case EXPORT_TYPE_INCREMENTAL_BACKUP:
+            return backup_estimate_records();
+        default:
+            return 0;
+    }
+}
+
+static system_error_t export_animals(export_format_t format, const char* path, time_t start_date, time_t end_date,
+                                     bool compress, export_progress_t* progress)
+{
+    switch (format) {
+        case EXPORT_FORMAT_CSV:
+            return csv_export_animals(path, start_date, end_date, progress);
+        case EXPORT_FORMAT_JSON:
+            return json_export_animals(path, start_date, end_date, progress);
+        case EXPORT_FORMAT_PDF:
+            return pdf_export_animals(path, start_date, end_date, compress, progress);
+        default:
+            return unsupported_format(format);
+    }
+}
+
+static system_error_t export_terrariums(export_format_t format, const char* path, export_progress_t* progress)
+{
+    switch (format) {
+        case EXPORT_FORMAT_CSV:
+            return csv_export_terrariums(path, progress);
+        default:
+            return unsupported_format(format);
+    }
+}
+
+static system_error_t export_stocks(export_format_t format, const char* path, export_progress_t* progress)
+{
+    switch (format) {
+        case EXPORT_FORMAT_CSV:
+            return csv_export_stocks(path, progress);
+        default:
+            return unsupported_format(format);
+    }
+}
+
+static system_error_t export_transactions(export_format_t format, const char* path, time_t start_date,
+                                          time_t end_date, bool compress, export_progress_t* progress)
+{
+    switch (format) {
+        case EXPORT_FORMAT_CSV:
+            return csv_export_transactions(path, start_date, end_date, progress);
+        case EXPORT_FORMAT_JSON:
+            return json_export_transactions(path, start_date, end_date, progress);
+        case EXPORT_FORMAT_PDF:
+            return pdf_export_transactions(path, start_date, end_date, compress, progress);
+        default:
+            return unsupported_format(format);
+    }
+}
+
+// Exécuté par les tâches d'export
+static system_error_t run_export(const export_params_t* params, export_progress_t* progress)
+{
+    switch (params->type) {
+        case EXPORT_TYPE_ANIMALS:
+            return export_animals(params->format, params->output_path, params->start_date, params->end_date,
+                                  params->compress, progress);
+        case EXPORT_TYPE_TERRARIUMS:
+            return export_terrariums(params->format, params->output_path, progress);
+        case EXPORT_TYPE_STOCKS:
+            return export_stocks(params->format, params->output_path, progress);
+        case EXPORT_TYPE_TRANSACTIONS:
+            return export_transactions(params->format, params->output_path, params->start_date, params->end_date,
+                                       params->compress, progress);
+        case EXPORT_TYPE_FULL_BACKUP:
+            return backup_create(params->output_path, progress, NULL);
+        case EXPORT_TYPE_INCREMENTAL_BACKUP:
+            return backup_create_incremental(params->output_path, progress, NULL);
+        default:
+            return SYSTEM_ERROR_INVALID_PARAM;
+    }
+}
+
 system_error_t data_export_init(void)
 {
     if (g_initialized) {
@@ -16,7 +151,21 @@ system_error_t data_export_init(void)
     
     ESP_LOGI(TAG, "Initialisation de l'export de données...");
     
-    // TODO: Initialiser le système de fichiers
+    // Le système de fichiers est monté par system_init
+    csv_exporter_init();
+    json_exporter_init();
+    pdf_generator_init();
+    mkdir(EXPORT_DIRECTORY, 0755);
+    
+    system_error_t ret = backup_manager_init();
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = export_jobs_init(run_export);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
     
     g_initialized = true;
     ESP_LOGI(TAG, "Export de données initialisé");
@@ -26,14 +175,22 @@ system_error_t data_export_init(void)
 
 system_error_t data_export_start(const export_params_t* params, uint32_t* export_id)
 {
-    if (!g_initialized || params == NULL || export_id == NULL) {
+    if (!g_initialized || params == NULL || export_id == NULL || params->output_path[0] == '\0') {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter le démarrage d'export
-    *export_id = 1;
+    // Refusé tout de suite plutôt qu'en échec dans la tâche d'export
+    if (!is_supported(params->type, params->format)) {
+        ESP_LOGW(TAG, "Export non pris en charge: type %d, format %d", params->type, params->format);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = export_jobs_submit(params, estimate_records(params->type), export_id);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
     
-    ESP_LOGI(TAG, "Export démarré: ID=%" PRIu32, *export_id);
+    ESP_LOGI(TAG, "Export mis en file: ID=%" PRIu32 ", %s", *export_id, params->output_path);
     
     return SYSTEM_OK;
 }
@@ -44,12 +201,7 @@ system_error_t data_export_get_status(uint32_t export_id, export_status_t* statu
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération du statut
-    memset(status, 0, sizeof(export_status_t));
-    status->export_id = export_id;
-    status->is_complete = true;
-    
-    return SYSTEM_OK;
+    return export_jobs_get_status(export_id, status);
 }
 
 system_error_t data_export_cancel(uint32_t export_id)
@@ -58,9 +210,7 @@ system_error_t data_export_cancel(uint32_t export_id)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    ESP_LOGI(TAG, "Export annulé: ID=%" PRIu32, export_id);
-    
-    return SYSTEM_OK;
+    return export_jobs_cancel(export_id);
 }
 
 system_error_t data_export_animals(export_format_t format, const char* output_path,
@@ -72,9 +222,7 @@ system_error_t data_export_animals(export_format_t format, const char* output_pa
     
     ESP_LOGI(TAG, "Export animaux: %s", output_path);
     
-    // TODO: Implémenter l'export des animaux
-    
-    return SYSTEM_OK;
+    return export_animals(format, output_path, start_date, end_date, true, NULL);
 }
 
 system_error_t data_export_terrariums(export_format_t format, const char* output_path)
@@ -85,9 +233,7 @@ system_error_t data_export_terrariums(export_format_t format, const char* output
     
     ESP_LOGI(TAG, "Export terrariums: %s", output_path);
     
-    // TODO: Implémenter l'export des terrariums
-    
-    return SYSTEM_OK;
+    return export_terrariums(format, output_path, NULL);
 }
 
 system_error_t data_export_stocks(export_format_t format, const char* output_path)
@@ -98,9 +244,7 @@ system_error_t data_export_stocks(export_format_t format, const char* output_pat
     
     ESP_LOGI(TAG, "Export stocks: %s", output_path);
     
-    // TODO: Implémenter l'export des stocks
-    
-    return SYSTEM_OK;
+    return export_stocks(format, output_path, NULL);
 }
 
 system_error_t data_export_transactions(export_format_t format, const char* output_path,
@@ -112,9 +256,22 @@ system_error_t data_export_transactions(export_format_t format, const char* outp
     
     ESP_LOGI(TAG, "Export transactions: %s", output_path);
     
-    // TODO: Implémenter l'export des transactions
+    return export_transactions(format, output_path, start_date, end_date, true, NULL);
+}
+
+system_error_t data_export_stream(export_type_t type, export_format_t format, time_t start_date, time_t end_date,
+                                  export_sink_fn_t sink, void* context)
+{
+    if (!g_initialized || sink == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
     
-    return SYSTEM_OK;
+    switch (format) {
+        case EXPORT_FORMAT_JSON:
+            return json_export_stream(type, start_date, end_date, sink, context, NULL);
+        default:
+            return unsupported_format(format);
+    }
 }
 
 system_error_t data_export_create_backup(const char* backup_path, bool compress, bool encrypt,
@@ -124,12 +281,16 @@ system_error_t data_export_create_backup(const char* backup_path, bool compress,
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la création de sauvegarde
-    *backup_id = 1;
-    
-    ESP_LOGI(TAG, "Sauvegarde créée: ID=%" PRIu32 ", Chemin=%s", *backup_id, backup_path);
+    if (encrypt) {
+        ESP_LOGW(TAG, "Chiffrement des sauvegardes non pris en charge");
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    if (compress) {
+        // Blocs bruts : la sauvegarde et la restauration vont à la vitesse de la flash
+        ESP_LOGW(TAG, "Compression ignorée, sauvegarde en blocs bruts");
+    }
     
-    return SYSTEM_OK;
+    return backup_create(backup_path, NULL, backup_id);
 }
 
 system_error_t data_export_restore_backup(const char* backup_path, const char* password)
@@ -140,9 +301,7 @@ system_error_t data_export_restore_backup(const char* backup_path, const char* p
     
     ESP_LOGI(TAG, "Restauration sauvegarde: %s", backup_path);
     
-    // TODO: Implémenter la restauration
-    
-    return SYSTEM_OK;
+    return backup_restore(backup_path);
 }
 
 system_error_t data_export_get_backups(backup_info_t* backups, uint32_t max_count, uint32_t* count)
@@ -151,10 +310,7 @@ system_error_t data_export_get_backups(backup_info_t* backups, uint32_t max_coun
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des sauvegardes
-    *count = 0;
-    
-    return SYSTEM_OK;
+    return backup_list(backups, max_count, count);
 }
 
 system_error_t data_export_delete_backup(uint32_t backup_id)
@@ -163,9 +319,7 @@ system_error_t data_export_delete_backup(uint32_t backup_id)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    ESP_LOGI(TAG, "Sauvegarde supprimée: ID=%" PRIu32, backup_id);
-    
-    return SYSTEM_OK;
+    return backup_delete(backup_id);
 }
 
 system_error_t data_export_validate_backup(uint32_t backup_id, bool* is_valid)
@@ -174,10 +328,39 @@ system_error_t data_export_validate_backup(uint32_t backup_id, bool* is_valid)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la validation
-    *is_valid = true;
+    char path[256];
+    system_error_t ret = backup_find(backup_id, path, sizeof(path));
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
     
-    return SYSTEM_OK;
+    return backup_validate(path, is_valid);
+}
+
+system_error_t data_export_auto_backup(uint32_t* export_id)
+{
+    if (!g_initialized || export_id == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    export_params_t params = {
+        .type = EXPORT_TYPE_INCREMENTAL_BACKUP,
+        .format = EXPORT_FORMAT_BINARY,
+    };
+    
+    // Nom daté ; un fichier existant, membre d'une chaîne, n'est jamais écrasé
+    time_t now = time(NULL);
+    struct tm now_tm;
+    char name[32];
+    struct stat st;
+    localtime_r(&now, &now_tm);
+    strftime(name, sizeof(name), "auto-%Y%m%d-%H%M%S", &now_tm);
+    snprintf(params.output_path, sizeof(params.output_path), "%s/%s.bak", BACKUP_DIRECTORY, name);
+    for (uint32_t n = 1; stat(params.output_path, &st) == 0; n++) {
+        snprintf(params.output_path, sizeof(params.output_path), "%s/%s-%" PRIu32 ".bak", BACKUP_DIRECTORY, name, n);
+    }
+    
+    return data_export_start(&params, export_id);
 }
 
 system_error_t data_export_schedule_backup(uint32_t interval_hours, uint32_t max_backups)
@@ -0,0 +1,288 @@
+#include "export_jobs.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <string.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <inttypes.h>
+
+static const char* TAG = "EXPORT_JOBS";
+
+_Static_assert(EXPORT_TASK_CORE != LVGL_TASK_CORE, "Les exports ne doivent pas ralentir le rendu de l'interface");
+_Static_assert(EXPORT_MAX_JOBS >= EXPORT_QUEUE_LENGTH + EXPORT_WORKER_COUNT, "Table des exports trop petite");
+
+typedef enum {
+    JOB_FREE,
+    JOB_QUEUED,
+    JOB_RUNNING,
+    JOB_FINISHED
+} job_state_t;
+
+// Export suivi : l'avancement est écrit par la tâche d'export sans verrou, le reste sous g_jobs_mutex
+typedef struct {
+    job_state_t state;
+    export_params_t params;
+    export_progress_t progress;
+    export_status_t status;
+} export_job_t;
+
+// Variables globales
+static export_job_t* g_jobs = NULL;                 // EXPORT_MAX_JOBS emplacements (PSRAM)
+static SemaphoreHandle_t g_jobs_mutex = NULL;
+static SemaphoreHandle_t g_jobs_pending = NULL;     // Un jeton par export mis en file
+static TaskHandle_t g_workers[EXPORT_WORKER_COUNT];
+static export_job_fn_t g_run = NULL;
+static uint32_t g_next_job_id = 1;
+
+static export_job_t* find_job(uint32_t job_id)
+{
+    for (uint32_t i = 0; i < EXPORT_MAX_JOBS; i++) {
+        if (g_jobs[i].state != JOB_FREE && g_jobs[i].status.export_id == job_id) {
+            return &g_jobs[i];
+        }
+    }
+    
+    return NULL;
+}
+
+static uint32_t count_queued(void)
+{
+    uint32_t count = 0;
+    
+    for (uint32_t i = 0; i < EXPORT_MAX_JOBS; i++) {
+        if (g_jobs[i].state == JOB_QUEUED) {
+            count++;
+        }
+    }
+    
+    return count;
+}
+
+// Deux exports actifs vers le même fichier l'écriraient en même temps
+static bool path_in_use(const char* path)
+{
+    for (uint32_t i = 0; i < EXPORT_MAX_JOBS; i++) {
+        if ((g_jobs[i].state == JOB_QUEUED || g_jobs[i].state == JOB_RUNNING) &&
+            strcmp(g_jobs[i].params.output_path, path) == 0) {
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+// Emplacement libre, à défaut celui de l'export terminé le plus ancien
+static export_job_t* allocate_job(void)
+{
+    export_job_t* oldest = NULL;
+    
+    for (uint32_t i = 0; i < EXPORT_MAX_JOBS; i++) {
+        if (g_jobs[i].state == JOB_FREE) {
+            return &g_jobs[i];
+        }
+        if (g_jobs[i].state == JOB_FINISHED &&
+            (oldest == NULL || g_jobs[i].status.export_id < oldest->status.export_id)) {
+            oldest = &g_jobs[i];
+        }
+    }
+    
+    return oldest;
+}
+
+// Export en attente le plus ancien, passé en cours
+static export_job_t* take_next_job(void)
+{
+    export_job_t* next = NULL;
+    
+    xSemaphoreTake(g_jobs_mutex, portMAX_DELAY);
+    for (uint32_t i = 0; i < EXPORT_MAX_JOBS; i++) {
+        if (g_jobs[i].state == JOB_QUEUED &&
+            (next == NULL || g_jobs[i].status.export_id < next->status.export_id)) {
+            next = &g_jobs[i];
+        }
+    }
+    if (next != NULL) {
+        next->state = JOB_RUNNING;
+        next->status.start_time = time(NULL);
+    }
+    xSemaphoreGive(g_jobs_mutex);
+    
+    return next;
+}
+
+static void finish_job(export_job_t* job, system_error_t ret)
+{
+    export_status_t* status = &job->status;
+    
+    xSemaphoreTake(g_jobs_mutex, portMAX_DELAY);
+    status->end_time = time(NULL);
+    status->records_processed = job->progress.records;
+    status->is_complete = true;
+    
+    // Une annulation arrivée après le dernier enregistrement laisse un fichier complet
+    if (ret == SYSTEM_OK) {
+        status->total_records = status->records_processed;
+        struct stat st;
+        if (stat(job->params.output_path, &st) == 0) {
+            status->file_size = (size_t)st.st_size;
+        }
+        ESP_LOGI(TAG, "Export %" PRIu32 " terminé: %" PRIu32 " enregistrements, %u octets",
+                 status->export_id, status->records_processed, (unsigned)status->file_size);
+    } else if (job->progress.cancelled) {
+        status->is_cancelled = true;
+        snprintf(status->error_message, sizeof(status->error_message), "Export annulé");
+        ESP_LOGI(TAG, "Export %" PRIu32 " annulé après %" PRIu32 " enregistrements",
+                 status->export_id, status->records_processed);
+    } else {
+        status->has_error = true;
+        snprintf(status->error_message, sizeof(status->error_message), "Échec de l'export (erreur %d)", ret);
+        ESP_LOGE(TAG, "Échec de l'export %" PRIu32 ": %d", status->export_id, ret);
+    }
+    job->state = JOB_FINISHED;
+    xSemaphoreGive(g_jobs_mutex);
+}
+
+static void export_task(void* pvParameters)
+{
+    ESP_LOGI(TAG, "Tâche d'export démarrée");
+    
+    while (1) {
+        xSemaphoreTake(g_jobs_pending, portMAX_DELAY);
+        
+        // Aucun export si celui du jeton a été annulé avant de démarrer
+        export_job_t* job = take_next_job();
+        if (job == NULL) {
+            continue;
+        }
+        
+        // L'emplacement n'est pas réattribué tant que l'export est en cours : params sans verrou
+        ESP_LOGI(TAG, "Export %" PRIu32 " démarré: %s", job->status.export_id, job->params.output_path);
+        system_error_t ret = g_run(&job->params, &job->progress);
+        finish_job(job, ret);
+    }
+}
+
+system_error_t export_jobs_init(export_job_fn_t run)
+{
+    g_jobs = heap_caps_calloc(EXPORT_MAX_JOBS, sizeof(export_job_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_jobs == NULL) {
+        g_jobs = heap_caps_calloc(EXPORT_MAX_JOBS, sizeof(export_job_t), MALLOC_CAP_8BIT);
+    }
+    if (g_jobs == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer la table des exports");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    g_jobs_mutex = xSemaphoreCreateMutex();
+    g_jobs_pending = xSemaphoreCreateCounting(EXPORT_QUEUE_LENGTH, 0);
+    if (g_jobs_mutex == NULL || g_jobs_pending == NULL) {
+        ESP_LOGE(TAG, "Échec création des sémaphores d'export");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    g_run = run;
+    g_next_job_id = 1;
+    
+    // Priorité basse, hors du cœur de LVGL : un export long ne retarde ni l'interface ni le serveur web
+    for (uint32_t i = 0; i < EXPORT_WORKER_COUNT; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "export_%" PRIu32, i);
+        BaseType_t ret = xTaskCreatePinnedToCore(export_task, name, EXPORT_TASK_STACK_SIZE, NULL,
+                                                 EXPORT_TASK_PRIORITY, &g_workers[i], EXPORT_TASK_CORE);
+        if (ret != pdPASS) {
+            ESP_LOGE(TAG, "Échec création tâche d'export");
+            return SYSTEM_ERROR_MEMORY;
+        }
+    }
+    
+    ESP_LOGI(TAG, "Exports en tâche de fond: %d tâche(s), file de %d", EXPORT_WORKER_COUNT, EXPORT_QUEUE_LENGTH);
+    return SYSTEM_OK;
+}
+
+system_error_t export_jobs_submit(const export_params_t* params, uint32_t total_records, uint32_t* job_id)
+{
+    xSemaphoreTake(g_jobs_mutex, portMAX_DELAY);
+    
+    if (path_in_use(params->output_path)) {
+        xSemaphoreGive(g_jobs_mutex);
+        ESP_LOGW(TAG, "Export déjà prévu vers %s", params->output_path);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    export_job_t* job = (count_queued() < EXPORT_QUEUE_LENGTH) ? allocate_job() : NULL;
+    if (job == NULL) {
+        xSemaphoreGive(g_jobs_mutex);
+        ESP_LOGW(TAG, "File d'export pleine");
+        return SYSTEM_ERROR_TIMEOUT;
+    }
+    
+    memset(job, 0, sizeof(export_job_t));
+    job->state = JOB_QUEUED;
+    job->params = *params;
+    job->status.export_id = g_next_job_id++;
+    job->status.type = params->type;
+    job->status.format = params->format;
+    job->status.total_records = total_records;
+    snprintf(job->status.output_file, sizeof(job->status.output_file), "%s", params->output_path);
+    *job_id = job->status.export_id;
+    
+    xSemaphoreGive(g_jobs_mutex);
+    
+    // Compteur plafonné à EXPORT_QUEUE_LENGTH, jamais inférieur au nombre d'exports en attente
+    xSemaphoreGive(g_jobs_pending);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t export_jobs_get_status(uint32_t job_id, export_status_t* status)
+{
+    xSemaphoreTake(g_jobs_mutex, portMAX_DELAY);
+    
+    export_job_t* job = find_job(job_id);
+    if (job == NULL) {
+        xSemaphoreGive(g_jobs_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    *status = job->status;
+    if (job->state == JOB_RUNNING) {
+        status->records_processed = job->progress.records;
+        // Estimation dépassée (enregistrements ajoutés pendant l'export)
+        if (status->total_records < status->records_processed) {
+            status->total_records = status->records_processed;
+        }
+    }
+    
+    xSemaphoreGive(g_jobs_mutex);
+    return SYSTEM_OK;
+}
+
+system_error_t export_jobs_cancel(uint32_t job_id)
+{
+    xSemaphoreTake(g_jobs_mutex, portMAX_DELAY);
+    
+    export_job_t* job = find_job(job_id);
+    if (job == NULL) {
+        xSemaphoreGive(g_jobs_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    if (job->state == JOB_QUEUED) {
+        job->state = JOB_FINISHED;
+        job->status.end_time = time(NULL);
+        job->status.is_complete = true;
+        job->status.is_cancelled = true;
+        snprintf(job->status.error_message, sizeof(job->status.error_message), "Export annulé");
+        ESP_LOGI(TAG, "Export %" PRIu32 " retiré de la file", job_id);
+    } else if (job->state == JOB_RUNNING) {
+        // Pris en compte par l'exporteur à l'enregistrement suivant
+        job->progress.cancelled = true;
+        ESP_LOGI(TAG, "Annulation de l'export %" PRIu32 " demandée", job_id);
+    }
+    
+    xSemaphoreGive(g_jobs_mutex);
+    return SYSTEM_OK;
+}
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef EXPORT_JOBS_H
+#define EXPORT_JOBS_H
+
+#include "export_writer.h"
+
+/**
+ * @brief Exécute un export, appelée depuis une tâche d'export
+ * @param params Paramètres de l'export
+ * @param progress Avancement à tenir à jour, porte la demande d'annulation
+ * @return SYSTEM_OK en cas de succès
+ */
+typedef system_error_t (*export_job_fn_t)(const export_params_t* params, export_progress_t* progress);
+
+/**
+ * @brief Alloue la table des exports et démarre les tâches d'export
+ * @param run Fonction exécutant un export
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t export_jobs_init(export_job_fn_t run);
+
+/**
+ * @brief Met un export en file d'attente, sans attendre
+ * @param params Paramètres de l'export (copiés)
+ * @param total_records Estimation du nombre d'enregistrements (0 si inconnu)
+ * @param job_id Pointeur vers l'ID d'export attribué
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_TIMEOUT si la file est pleine,
+ *         SYSTEM_ERROR_INVALID_PARAM si un export vers le même fichier est déjà prévu
+ */
+system_error_t export_jobs_submit(const export_params_t* params, uint32_t total_records, uint32_t* job_id);
+
+/**
+ * @brief Copie le statut d'un export, avancement compris
+ * @param job_id ID de l'export
+ * @param status Statut à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si l'export n'est plus suivi
+ */
+system_error_t export_jobs_get_status(uint32_t job_id, export_status_t* status);
+
+/**
+ * @brief Annule un export : retiré de la file s'il attend, arrêté à l'enregistrement suivant s'il est en cours
+ * @param job_id ID de l'export
+ * @return SYSTEM_OK en cas de succès (export déjà terminé compris), SYSTEM_ERROR_NOT_FOUND sinon
+ */
+system_error_t export_jobs_cancel(uint32_t job_id);
+
+#endif // EXPORT_JOBS_H
\ No newline at end of file
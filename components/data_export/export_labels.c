@@ -0,0 +1,14 @@
+#include "export_labels.h"
+
+const char* const k_animal_type_labels[6] = { "Serpent", "Lézard", "Tortue", "Gecko", "Iguane", "Autre" };
+const char* const k_animal_sex_labels[3] = { "Inconnu", "Mâle", "Femelle" };
+const char* const k_animal_status_labels[5] = { "Actif", "Vendu", "Décédé", "Quarantaine", "Reproduction" };
+const char* const k_stock_type_labels[6] = { "Nourriture", "Médicament", "Substrat", "Équipement", "Complément", "Autre" };
+const char* const k_stock_unit_labels[6] = { "pcs", "g", "kg", "mL", "L", "m" };
+const char* const k_transaction_type_labels[7] = { "Achat", "Vente", "Échange", "Don", "Naissance", "Décès", "Fuite" };
+const char* const k_transaction_status_labels[4] = { "En attente", "Terminée", "Annulée", "Remboursée" };
+
+const char* export_label(const char* const* labels, uint32_t count, uint32_t value)
+{
+    return (value < count) ? labels[value] : "";
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#ifndef EXPORT_LABELS_H
+#define EXPORT_LABELS_H
+
+#include <stdint.h>
+
+// Libellé d'une valeur d'énumération, vide si elle est hors de la table
+#define EXPORT_LABEL(labels, value) export_label(labels, sizeof(labels) / sizeof(labels[0]), (uint32_t)(value))
+
+// Libellés français des énumérations, communs aux exports destinés aux utilisateurs (CSV, PDF)
+extern const char* const k_animal_type_labels[6];
+extern const char* const k_animal_sex_labels[3];
+extern const char* const k_animal_status_labels[5];
+extern const char* const k_stock_type_labels[6];
+extern const char* const k_stock_unit_labels[6];
+extern const char* const k_transaction_type_labels[7];
+extern const char* const k_transaction_status_labels[4];
+
+/**
+ * @brief Libellé d'une valeur d'énumération
+ * @param labels Table des libellés
+ * @param count Nombre de libellés
+ * @param value Valeur
+ * @return Libellé, chaîne vide si la valeur est inconnue
+ */
+const char* export_label(const char* const* labels, uint32_t count, uint32_t value);
+
+#endif // EXPORT_LABELS_H
\ No newline at end of file
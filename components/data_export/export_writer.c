@@ -0,0 +1,148 @@
+#include "export_writer.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+static const char* TAG = "EXPORT_WRITER";
+
+#ifdef CONFIG_WL_SECTOR_SIZE
+// La partition FAT est montée avec allocation_unit_size = CONFIG_WL_SECTOR_SIZE
+_Static_assert(EXPORT_BUFFER_SIZE % CONFIG_WL_SECTOR_SIZE == 0, "Tampon d'export non aligné sur les clusters FAT");
+#endif
+
+static void flush_buffer(export_writer_t* out)
+{
+    if (out->used > 0 && !out->failed) {
+        if (out->sink != NULL) {
+            out->failed = !out->sink(out->buffer, out->used, out->sink_context);
+        } else if (fwrite(out->buffer, 1, out->used, out->file) != out->used) {
+            out->failed = true;
+        }
+    }
+    out->used = 0;
+}
+
+static system_error_t allocate_buffer(export_writer_t* out)
+{
+    memset(out, 0, sizeof(export_writer_t));
+    
+    out->buffer = heap_caps_malloc(EXPORT_BUFFER_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (out->buffer == NULL) {
+        out->buffer = heap_caps_malloc(EXPORT_BUFFER_SIZE, MALLOC_CAP_8BIT);
+    }
+    
+    return (out->buffer != NULL) ? SYSTEM_OK : SYSTEM_ERROR_MEMORY;
+}
+
+system_error_t export_writer_open(export_writer_t* out, const char* path)
+{
+    system_error_t ret = allocate_buffer(out);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    out->file = fopen(path, "wb");
+    if (out->file == NULL) {
+        ESP_LOGE(TAG, "Impossible de créer %s", path);
+        heap_caps_free(out->buffer);
+        out->buffer = NULL;
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // Les blocs complets vont directement au système de fichiers, sans second tampon
+    setvbuf(out->file, NULL, _IONBF, 0);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t export_writer_open_sink(export_writer_t* out, export_sink_fn_t sink, void* context)
+{
+    system_error_t ret = allocate_buffer(out);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    out->sink = sink;
+    out->sink_context = context;
+    
+    return SYSTEM_OK;
+}
+
+void export_writer_write(export_writer_t* out, const char* data, size_t length)
+{
+    out->size += length;
+    while (length > 0) {
+        size_t room = EXPORT_BUFFER_SIZE - out->used;
+        size_t part = (length < room) ? length : room;
+        memcpy(&out->buffer[out->used], data, part);
+        out->used += part;
+        data += part;
+        length -= part;
+        if (out->used == EXPORT_BUFFER_SIZE) {
+            flush_buffer(out);
+        }
+    }
+}
+
+void export_writer_printf(export_writer_t* out, const char* format, ...)
+{
+    char text[EXPORT_FORMAT_SIZE];
+    va_list args;
+    
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    
+    if (length > 0) {
+        export_writer_write(out, text, ((size_t)length < sizeof(text)) ? (size_t)length : sizeof(text) - 1);
+    }
+}
+
+bool export_writer_record(export_writer_t* out)
+{
+    if (out->progress != NULL) {
+        out->progress->records++;
+        if (out->progress->cancelled) {
+            // La sortie est abandonnée comme après une erreur : le fichier partiel sera supprimé
+            out->failed = true;
+        }
+    }
+    
+    return !out->failed;
+}
+
+system_error_t export_writer_close(export_writer_t* out, const char* path)
+{
+    flush_buffer(out);
+    
+    bool failed = out->failed;
+    if (out->sink != NULL) {
+        heap_caps_free(out->buffer);
+        out->buffer = NULL;
+        return failed ? SYSTEM_ERROR_NETWORK : SYSTEM_OK;
+    }
+    
+    if (fflush(out->file) != 0 || fsync(fileno(out->file)) != 0) {
+        failed = true;
+    }
+    if (fclose(out->file) != 0) {
+        failed = true;
+    }
+    heap_caps_free(out->buffer);
+    out->file = NULL;
+    out->buffer = NULL;
+    
+    if (failed) {
+        if (out->progress != NULL && out->progress->cancelled) {
+            ESP_LOGI(TAG, "Export annulé, fichier supprimé: %s", path);
+        } else {
+            ESP_LOGE(TAG, "Échec d'écriture de l'export: %s", path);
+        }
+        remove(path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    return SYSTEM_OK;
+}
\ No newline at end of file
@@ -0,0 +1,74 @@
+#ifndef EXPORT_WRITER_H
+#define EXPORT_WRITER_H
+
+#include "data_export.h"
+#include <stdio.h>
+
+#define EXPORT_FORMAT_SIZE      64
+
+// Avancement d'un export, lu par data_export_get_status pendant l'écriture
+typedef struct {
+    volatile uint32_t records;      // Enregistrements écrits
+    volatile bool cancelled;        // Annulation demandée, prise en compte à l'enregistrement suivant
+} export_progress_t;
+
+// Sortie d'un export : le fichier ou la destination ne reçoit que des blocs pleins de EXPORT_BUFFER_SIZE octets
+typedef struct {
+    FILE* file;
+    export_sink_fn_t sink;  // Destination à la place du fichier (NULL pour un fichier)
+    void* sink_context;
+    char* buffer;
+    size_t used;
+    size_t size;            // Octets produits depuis l'ouverture
+    export_progress_t* progress;  // Avancement à tenir à jour (NULL pour aucun)
+    bool failed;
+} export_writer_t;
+
+/**
+ * @brief Crée le fichier de sortie et alloue le tampon d'écriture
+ * @param out Sortie à initialiser
+ * @param path Chemin du fichier
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE ou SYSTEM_ERROR_MEMORY sinon
+ */
+system_error_t export_writer_open(export_writer_t* out, const char* path);
+
+/**
+ * @brief Alloue le tampon d'écriture d'une sortie vers une destination
+ * @param out Sortie à initialiser
+ * @param sink Fonction recevant les blocs
+ * @param context Contexte transmis à sink
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY sinon
+ */
+system_error_t export_writer_open_sink(export_writer_t* out, export_sink_fn_t sink, void* context);
+
+/**
+ * @brief Ajoute des octets à la sortie
+ * @param out Sortie
+ * @param data Données
+ * @param length Nombre d'octets
+ */
+void export_writer_write(export_writer_t* out, const char* data, size_t length);
+
+/**
+ * @brief Ajoute une valeur mise en forme (nombre, date)
+ * @param out Sortie
+ * @param format Format printf (résultat limité à EXPORT_FORMAT_SIZE - 1 octets)
+ */
+void export_writer_printf(export_writer_t* out, const char* format, ...);
+
+/**
+ * @brief Compte un enregistrement terminé et vérifie qu'aucune annulation n'est demandée
+ * @param out Sortie
+ * @return true pour continuer, false si l'écriture a échoué ou si l'export est annulé
+ */
+bool export_writer_record(export_writer_t* out);
+
+/**
+ * @brief Écrit le dernier bloc, synchronise et ferme le fichier
+ * @param out Sortie
+ * @param path Chemin du fichier, supprimé en cas d'échec (ignoré pour une destination)
+ * @return SYSTEM_OK si tout le contenu est écrit, SYSTEM_ERROR_STORAGE (fichier) ou SYSTEM_ERROR_NETWORK (destination) sinon
+ */
+system_error_t export_writer_close(export_writer_t* out, const char* path);
+
+#endif // EXPORT_WRITER_H
\ No newline at end of file
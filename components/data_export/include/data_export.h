@@ -11,7 +11,8 @@ typedef enum {
     EXPORT_TYPE_STOCKS,
     EXPORT_TYPE_TRANSACTIONS,
     EXPORT_TYPE_COMPLIANCE,
-    EXPORT_TYPE_FULL_BACKUP
+    EXPORT_TYPE_FULL_BACKUP,
+    EXPORT_TYPE_INCREMENTAL_BACKUP  // Sauvegarde suivante de la chaîne automatique (incrément ou complète)
 } export_type_t;
 
 // Formats d'export
@@ -42,14 +43,24 @@ typedef struct {
     time_t start_time;
     time_t end_time;
     uint32_t records_processed;
-    uint32_t total_records;
+    uint32_t total_records;     // Estimation pendant l'export, exact une fois terminé
     bool is_complete;
     bool has_error;
+    bool is_cancelled;
     char error_message[256];
     char output_file[256];
     size_t file_size;
 } export_status_t;
 
+/**
+ * @brief Destination d'un export diffusé (réponse HTTP par morceaux, ...)
+ * @param data Bloc de données
+ * @param length Taille du bloc
+ * @param context Contexte de l'appelant
+ * @return true si le bloc est transmis, false pour interrompre l'export
+ */
+typedef bool (*export_sink_fn_t)(const char* data, size_t length, void* context);
+
 // Structure pour les sauvegardes
 typedef struct {
     uint32_t backup_id;
@@ -60,6 +71,8 @@ typedef struct {
     bool is_encrypted;
     char description[128];
     bool is_valid;
+    uint32_t base_id;       // Sauvegarde complète de la chaîne (backup_id pour une complète)
+    uint32_t parent_id;     // Sauvegarde précédente de la chaîne (0 pour une complète)
 } backup_info_t;
 
 /**
@@ -69,25 +82,26 @@ typedef struct {
 system_error_t data_export_init(void);
 
 /**
- * @brief Lance un export de données
+ * @brief Met un export en file pour une tâche de fond et rend la main aussitôt
  * @param params Paramètres d'export
  * @param export_id Pointeur vers l'ID d'export généré
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_TIMEOUT si la file est pleine,
+ *         SYSTEM_ERROR_INVALID_PARAM si l'export n'est pas pris en charge ou vise un fichier déjà prévu
  */
 system_error_t data_export_start(const export_params_t* params, uint32_t* export_id);
 
 /**
- * @brief Récupère le statut d'un export
+ * @brief Récupère le statut d'un export, avancement compris
  * @param export_id ID de l'export
  * @param status Pointeur vers la structure statut à remplir
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si l'export n'est plus suivi
  */
 system_error_t data_export_get_status(uint32_t export_id, export_status_t* status);
 
 /**
- * @brief Annule un export en cours
+ * @brief Annule un export en attente ou en cours (fichier partiel supprimé)
  * @param export_id ID de l'export
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si l'export n'est plus suivi
  */
 system_error_t data_export_cancel(uint32_t export_id);
 
@@ -130,10 +144,28 @@ system_error_t data_export_transactions(export_format_t format, const char* outp
                                        time_t start_date, time_t end_date);
 
 /**
- * @brief Crée une sauvegarde complète
+ * @brief Diffuse un export par blocs à une destination, sans fichier intermédiaire
+ * @param type Données exportées (animaux ou transactions)
+ * @param format Format d'export (JSON uniquement)
+ * @param start_date Date de début (0 pour toutes)
+ * @param end_date Date de fin (0 pour toutes)
+ * @param sink Fonction recevant les blocs
+ * @param context Contexte transmis à sink
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NETWORK si la destination a refusé un bloc
+ */
+system_error_t data_export_stream(export_type_t type, export_format_t format, time_t start_date, time_t end_date,
+                                  export_sink_fn_t sink, void* context);
+
+/**
+ * @brief Crée une sauvegarde complète (conteneur binaire à blocs vérifiés par CRC32)
+ *
+ * Seules les sauvegardes écrites dans BACKUP_DIRECTORY sont listées et retrouvées par ID.
+ * La même sauvegarde peut être lancée en tâche de fond par data_export_start
+ * (EXPORT_TYPE_FULL_BACKUP, EXPORT_FORMAT_BINARY).
+ *
  * @param backup_path Chemin de la sauvegarde
- * @param compress Compresser la sauvegarde
- * @param encrypt Chiffrer la sauvegarde
+ * @param compress Ignoré : les blocs sont écrits bruts
+ * @param encrypt Non pris en charge (SYSTEM_ERROR_INVALID_PARAM)
  * @param password Mot de passe de chiffrement (si encrypt = true)
  * @param backup_id Pointeur vers l'ID de sauvegarde généré
  * @return SYSTEM_OK en cas de succès
@@ -142,15 +174,19 @@ system_error_t data_export_create_backup(const char* backup_path, bool compress,
                                         const char* password, uint32_t* backup_id);
 
 /**
- * @brief Restaure une sauvegarde
+ * @brief Restaure une sauvegarde : les enregistrements sont remplacés ou ajoutés par ID
+ *
+ * Un incrément est restauré avec sa chaîne (la sauvegarde complète puis les incréments jusqu'à lui).
+ *
  * @param backup_path Chemin de la sauvegarde
- * @param password Mot de passe de déchiffrement (si nécessaire)
- * @return SYSTEM_OK en cas de succès
+ * @param password Mot de passe de déchiffrement (inutilisé)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE si la sauvegarde est corrompue,
+ *         SYSTEM_ERROR_NOT_FOUND si un fichier de sa chaîne manque
  */
 system_error_t data_export_restore_backup(const char* backup_path, const char* password);
 
 /**
- * @brief Récupère la liste des sauvegardes
+ * @brief Récupère la liste des sauvegardes de BACKUP_DIRECTORY, chaque sauvegarde complète suivie de ses incréments
  * @param backups Tableau de sauvegardes à remplir
  * @param max_count Nombre maximum de sauvegardes
  * @param count Pointeur vers le nombre de sauvegardes récupérées
@@ -159,20 +195,28 @@ system_error_t data_export_restore_backup(const char* backup_path, const char* p
 system_error_t data_export_get_backups(backup_info_t* backups, uint32_t max_count, uint32_t* count);
 
 /**
- * @brief Supprime une sauvegarde
+ * @brief Supprime une sauvegarde et les incréments suivants de sa chaîne
  * @param backup_id ID de la sauvegarde
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si elle n'existe pas
  */
 system_error_t data_export_delete_backup(uint32_t backup_id);
 
 /**
- * @brief Valide l'intégrité d'une sauvegarde
+ * @brief Valide l'intégrité d'une sauvegarde en relisant les CRC32 de tous ses blocs, sans décoder les enregistrements
  * @param backup_id ID de la sauvegarde
  * @param is_valid Pointeur vers le résultat de validation
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si elle n'existe pas
  */
 system_error_t data_export_validate_backup(uint32_t backup_id, bool* is_valid);
 
+/**
+ * @brief Met en file la sauvegarde automatique suivante dans BACKUP_DIRECTORY : un incrément de la chaîne
+ *        en cours, ou une sauvegarde complète après BACKUP_MAX_INCREMENTS incréments
+ * @param export_id Pointeur vers l'ID d'export généré
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_TIMEOUT si la file d'export est pleine
+ */
+system_error_t data_export_auto_backup(uint32_t* export_id);
+
 /**
  * @brief Programme une sauvegarde automatique
  * @param interval_hours Intervalle en heures
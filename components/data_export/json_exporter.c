@@ -1,9 +1,481 @@
-#include "data_export.h"
+#include "json_exporter.h"
+#include "animals_manager.h"
+#include "transaction_manager.h"
 #include "esp_log.h"
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
 
 static const char* TAG = "JSON_EXPORTER";
 
+#define CODE(codes, value) code_of(codes, sizeof(codes) / sizeof(codes[0]), (uint32_t)(value))
+
+// Classes d'octets pour l'échappement des chaînes
+#define JSON_CHAR_PLAIN         0   // Copié tel quel
+#define JSON_CHAR_CONTROL       1   // Caractère de contrôle, échappé
+#define JSON_CHAR_ESCAPE        2   // Guillemet ou barre oblique inverse
+#define JSON_CHAR_UTF8          3   // Début d'une séquence multi-octet à valider
+
+static const uint8_t k_json_class[256] = {
+    [0x00 ... 0x1F] = JSON_CHAR_CONTROL,
+    ['"'] = JSON_CHAR_ESCAPE,
+    ['\\'] = JSON_CHAR_ESCAPE,
+    [0x80 ... 0xFF] = JSON_CHAR_UTF8,
+};
+
+static const char k_hex_digits[] = "0123456789abcdef";
+
+// Codes stables des énumérations, indépendants de la langue de l'interface
+static const char* const k_animal_types[] = { "snake", "lizard", "turtle", "gecko", "iguana", "other" };
+static const char* const k_animal_sexes[] = { "unknown", "male", "female" };
+static const char* const k_animal_statuses[] = { "active", "sold", "deceased", "quarantine", "breeding" };
+static const char* const k_transaction_types[] = { "purchase", "sale", "exchange", "gift", "breeding", "death", "escape" };
+static const char* const k_transaction_statuses[] = { "pending", "completed", "cancelled", "refunded" };
+
+// Parcours d'un export : document, filtre de dates et enregistrements écrits
+typedef struct {
+    json_writer_t json;
+    time_t start_date;
+    time_t end_date;
+    uint32_t rows;
+} json_export_t;
+
+static const char* code_of(const char* const* codes, uint32_t count, uint32_t value)
+{
+    return (value < count) ? codes[value] : NULL;
+}
+
+// Virgule avant chaque élément d'un objet ou d'un tableau sauf le premier, rien après une clé
+static void value_prefix(json_writer_t* json)
+{
+    if (json->after_key) {
+        json->after_key = false;
+        return;
+    }
+    
+    uint32_t bit = 1u << json->depth;
+    if (json->has_items & bit) {
+        export_writer_write(&json->out, ",", 1);
+    }
+    json->has_items |= bit;
+}
+
+// Longueur d'une séquence UTF-8 bien formée (RFC 3629), 0 si elle ne l'est pas
+static size_t utf8_sequence_length(const unsigned char* p)
+{
+    unsigned char c = p[0];
+    
+    if (c >= 0xC2 && c <= 0xDF) {
+        return ((p[1] & 0xC0) == 0x80) ? 2 : 0;
+    }
+    if (c >= 0xE0 && c <= 0xEF) {
+        // Ni forme trop longue (E0) ni demi-codet de substitution (ED)
+        unsigned char low = (c == 0xE0) ? 0xA0 : 0x80;
+        unsigned char high = (c == 0xED) ? 0x9F : 0xBF;
+        return (p[1] >= low && p[1] <= high && (p[2] & 0xC0) == 0x80) ? 3 : 0;
+    }
+    if (c >= 0xF0 && c <= 0xF4) {
+        // Ni forme trop longue (F0) ni point de code au-delà de U+10FFFF (F4)
+        unsigned char low = (c == 0xF0) ? 0x90 : 0x80;
+        unsigned char high = (c == 0xF4) ? 0x8F : 0xBF;
+        return (p[1] >= low && p[1] <= high && (p[2] & 0xC0) == 0x80 && (p[3] & 0xC0) == 0x80) ? 4 : 0;
+    }
+    
+    return 0;
+}
+
+static void write_escaped(json_writer_t* json, const char* value)
+{
+    const unsigned char* p = (const unsigned char*)value;
+    
+    export_writer_write(&json->out, "\"", 1);
+    for (;;) {
+        // Chemin rapide : les suites ASCII sans caractère spécial sont copiées d'un bloc
+        const unsigned char* run = p;
+        while (k_json_class[*p] == JSON_CHAR_PLAIN) {
+            p++;
+        }
+        if (p > run) {
+            export_writer_write(&json->out, (const char*)run, (size_t)(p - run));
+        }
+        if (*p == '\0') {
+            break;
+        }
+        
+        switch (k_json_class[*p]) {
+            case JSON_CHAR_ESCAPE: {
+                char escape[2] = { '\\', (char)*p };
+                export_writer_write(&json->out, escape, sizeof(escape));
+                p++;
+                break;
+            }
+            case JSON_CHAR_CONTROL: {
+                char escape[6] = { '\\', 'u', '0', '0', k_hex_digits[*p >> 4], k_hex_digits[*p & 0x0F] };
+                switch (*p) {
+                    case '\n': export_writer_write(&json->out, "\\n", 2); break;
+                    case '\r': export_writer_write(&json->out, "\\r", 2); break;
+                    case '\t': export_writer_write(&json->out, "\\t", 2); break;
+                    default: export_writer_write(&json->out, escape, sizeof(escape)); break;
+                }
+                p++;
+                break;
+            }
+            default: {
+                size_t length = utf8_sequence_length(p);
+                if (length == 0) {
+                    // Octet isolé (champ tronqué au milieu d'un caractère, encodage Latin-1)
+                    export_writer_write(&json->out, "\\ufffd", 6);
+                    p++;
+                } else {
+                    export_writer_write(&json->out, (const char*)p, length);
+                    p += length;
+                }
+                break;
+            }
+        }
+    }
+    export_writer_write(&json->out, "\"", 1);
+}
+
 void json_exporter_init(void)
 {
     ESP_LOGI(TAG, "Exporteur JSON initialisé");
+}
+
+system_error_t json_writer_open(json_writer_t* json, const char* path)
+{
+    memset(json, 0, sizeof(json_writer_t));
+    return export_writer_open(&json->out, path);
+}
+
+system_error_t json_writer_open_sink(json_writer_t* json, export_sink_fn_t sink, void* context)
+{
+    memset(json, 0, sizeof(json_writer_t));
+    return export_writer_open_sink(&json->out, sink, context);
+}
+
+static void begin_container(json_writer_t* json, const char* open)
+{
+    value_prefix(json);
+    export_writer_write(&json->out, open, 1);
+    
+    if (json->depth + 1 >= JSON_MAX_DEPTH) {
+        ESP_LOGE(TAG, "Imbrication JSON trop profonde");
+        json->out.failed = true;
+        return;
+    }
+    json->depth++;
+    json->has_items &= ~(1u << json->depth);
+}
+
+static void end_container(json_writer_t* json, const char* close)
+{
+    if (json->depth > 0) {
+        json->depth--;
+    }
+    export_writer_write(&json->out, close, 1);
+}
+
+void json_writer_begin_object(json_writer_t* json)
+{
+    begin_container(json, "{");
+}
+
+void json_writer_end_object(json_writer_t* json)
+{
+    end_container(json, "}");
+}
+
+void json_writer_begin_array(json_writer_t* json)
+{
+    begin_container(json, "[");
+}
+
+void json_writer_end_array(json_writer_t* json)
+{
+    end_container(json, "]");
+}
+
+void json_writer_key(json_writer_t* json, const char* key)
+{
+    value_prefix(json);
+    write_escaped(json, key);
+    export_writer_write(&json->out, ":", 1);
+    json->after_key = true;
+}
+
+void json_writer_string(json_writer_t* json, const char* value)
+{
+    if (value == NULL) {
+        json_writer_null(json);
+        return;
+    }
+    
+    value_prefix(json);
+    write_escaped(json, value);
+}
+
+void json_writer_uint(json_writer_t* json, uint32_t value)
+{
+    value_prefix(json);
+    export_writer_printf(&json->out, "%" PRIu32, value);
+}
+
+void json_writer_number(json_writer_t* json, float value, int decimals)
+{
+    if (!isfinite(value)) {
+        json_writer_null(json);
+        return;
+    }
+    
+    value_prefix(json);
+    export_writer_printf(&json->out, "%.*f", decimals, (double)value);
+}
+
+void json_writer_bool(json_writer_t* json, bool value)
+{
+    value_prefix(json);
+    if (value) {
+        export_writer_write(&json->out, "true", 4);
+    } else {
+        export_writer_write(&json->out, "false", 5);
+    }
+}
+
+void json_writer_null(json_writer_t* json)
+{
+    value_prefix(json);
+    export_writer_write(&json->out, "null", 4);
+}
+
+void json_writer_date(json_writer_t* json, time_t date)
+{
+    if (date == 0) {
+        json_writer_null(json);
+        return;
+    }
+    
+    struct tm tm_info;
+    gmtime_r(&date, &tm_info);
+    value_prefix(json);
+    export_writer_printf(&json->out, "\"%04d-%02d-%02dT%02d:%02d:%02dZ\"", tm_info.tm_year + 1900, tm_info.tm_mon + 1,
+                         tm_info.tm_mday, tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+}
+
+system_error_t json_writer_close(json_writer_t* json, const char* path)
+{
+    export_writer_write(&json->out, "\n", 1);
+    return export_writer_close(&json->out, path);
+}
+
+static bool in_range(const json_export_t* export, time_t date)
+{
+    return (export->start_date == 0 || date >= export->start_date) &&
+           (export->end_date == 0 || date <= export->end_date);
+}
+
+static bool write_animal(const animal_t* animal, void* context)
+{
+    json_export_t* export = (json_export_t*)context;
+    json_writer_t* json = &export->json;
+    
+    if (!in_range(export, (animal->acquisition_date != 0) ? animal->acquisition_date : animal->birth_date)) {
+        return true;
+    }
+    
+    json_writer_begin_object(json);
+    json_writer_key(json, "id");
+    json_writer_uint(json, animal->id);
+    json_writer_key(json, "name");
+    json_writer_string(json, animal->name);
+    json_writer_key(json, "species");
+    json_writer_string(json, animal->species);
+    json_writer_key(json, "type");
+    json_writer_string(json, CODE(k_animal_types, animal->type));
+    json_writer_key(json, "sex");
+    json_writer_string(json, CODE(k_animal_sexes, animal->sex));
+    json_writer_key(json, "status");
+    json_writer_string(json, CODE(k_animal_statuses, animal->status));
+    json_writer_key(json, "birth_date");
+    json_writer_date(json, animal->birth_date);
+    json_writer_key(json, "acquisition_date");
+    json_writer_date(json, animal->acquisition_date);
+    json_writer_key(json, "origin");
+    json_writer_string(json, animal->origin);
+    json_writer_key(json, "microchip_id");
+    json_writer_string(json, animal->microchip_id);
+    json_writer_key(json, "terrarium_id");
+    json_writer_uint(json, animal->terrarium_id);
+    json_writer_key(json, "weight_grams");
+    json_writer_number(json, animal->weight_grams, 1);
+    json_writer_key(json, "length_cm");
+    json_writer_number(json, animal->length_cm, 1);
+    json_writer_key(json, "last_feeding");
+    json_writer_date(json, animal->last_feeding);
+    json_writer_key(json, "last_shedding");
+    json_writer_date(json, animal->last_shedding);
+    json_writer_key(json, "last_medical_check");
+    json_writer_date(json, animal->last_medical_check);
+    json_writer_key(json, "cites_required");
+    json_writer_bool(json, animal->cites_required);
+    json_writer_key(json, "cites_number");
+    json_writer_string(json, animal->cites_number);
+    json_writer_key(json, "notes");
+    json_writer_string(json, animal->notes);
+    json_writer_key(json, "created_at");
+    json_writer_date(json, animal->created_at);
+    json_writer_key(json, "updated_at");
+    json_writer_date(json, animal->updated_at);
+    json_writer_end_object(json);
+    export->rows++;
+    
+    return export_writer_record(&json->out);
+}
+
+static bool write_transaction(const transaction_t* transaction, void* context)
+{
+    json_export_t* export = (json_export_t*)context;
+    json_writer_t* json = &export->json;
+    
+    json_writer_begin_object(json);
+    json_writer_key(json, "id");
+    json_writer_uint(json, transaction->id);
+    json_writer_key(json, "date");
+    json_writer_date(json, transaction->transaction_date);
+    json_writer_key(json, "type");
+    json_writer_string(json, CODE(k_transaction_types, transaction->type));
+    json_writer_key(json, "status");
+    json_writer_string(json, CODE(k_transaction_statuses, transaction->status));
+    json_writer_key(json, "animal_id");
+    json_writer_uint(json, transaction->animal_id);
+    json_writer_key(json, "animal_name");
+    json_writer_string(json, transaction->animal_name);
+    json_writer_key(json, "animal_species");
+    json_writer_string(json, transaction->animal_species);
+    json_writer_key(json, "amount");
+    json_writer_number(json, transaction->amount, 2);
+    json_writer_key(json, "currency");
+    json_writer_string(json, transaction->currency);
+    json_writer_key(json, "counterpart_id");
+    json_writer_uint(json, transaction->counterpart_id);
+    json_writer_key(json, "counterpart_name");
+    json_writer_string(json, transaction->counterpart_name);
+    json_writer_key(json, "counterpart_address");
+    json_writer_string(json, transaction->counterpart_address);
+    json_writer_key(json, "counterpart_phone");
+    json_writer_string(json, transaction->counterpart_phone);
+    json_writer_key(json, "counterpart_email");
+    json_writer_string(json, transaction->counterpart_email);
+    json_writer_key(json, "cites_required");
+    json_writer_bool(json, transaction->cites_required);
+    json_writer_key(json, "cites_permit_number");
+    json_writer_string(json, transaction->cites_permit_number);
+    json_writer_key(json, "certificate_number");
+    json_writer_string(json, transaction->certificate_number);
+    json_writer_key(json, "notes");
+    json_writer_string(json, transaction->notes);
+    json_writer_key(json, "documents");
+    json_writer_string(json, transaction->documents);
+    json_writer_key(json, "created_at");
+    json_writer_date(json, transaction->created_at);
+    json_writer_key(json, "updated_at");
+    json_writer_date(json, transaction->updated_at);
+    json_writer_end_object(json);
+    export->rows++;
+    
+    return export_writer_record(&json->out);
+}
+
+// Document : {"export": ..., "generated_at": ..., "records": [...], "count": n}
+static system_error_t write_document(json_export_t* export, export_type_t type)
+{
+    json_writer_t* json = &export->json;
+    system_error_t ret;
+    
+    json_writer_begin_object(json);
+    json_writer_key(json, "export");
+    json_writer_string(json, (type == EXPORT_TYPE_ANIMALS) ? "animals" : "transactions");
+    json_writer_key(json, "generated_at");
+    json_writer_date(json, time(NULL));
+    json_writer_key(json, "start_date");
+    json_writer_date(json, export->start_date);
+    json_writer_key(json, "end_date");
+    json_writer_date(json, export->end_date);
+    json_writer_key(json, "records");
+    json_writer_begin_array(json);
+    
+    if (type == EXPORT_TYPE_ANIMALS) {
+        ret = animals_for_each(write_animal, export);
+    } else {
+        ret = transaction_for_each(export->start_date, export->end_date, write_transaction, export);
+    }
+    
+    json_writer_end_array(json);
+    json_writer_key(json, "count");
+    json_writer_uint(json, export->rows);
+    json_writer_end_object(json);
+    
+    return ret;
+}
+
+static system_error_t finish_export(json_export_t* export, system_error_t ret, const char* path)
+{
+    system_error_t close_ret = json_writer_close(&export->json, path);
+    if (ret != SYSTEM_OK) {
+        if (path != NULL) {
+            remove(path);
+        }
+        return ret;
+    }
+    if (close_ret != SYSTEM_OK) {
+        return close_ret;
+    }
+    
+    ESP_LOGI(TAG, "Export JSON %s: %" PRIu32 " enregistrements, %u octets",
+             (path != NULL) ? path : "(flux)", export->rows, (unsigned)export->json.out.size);
+    return SYSTEM_OK;
+}
+
+static system_error_t export_to_file(export_type_t type, const char* path, time_t start_date, time_t end_date,
+                                     export_progress_t* progress)
+{
+    json_export_t export = { .start_date = start_date, .end_date = end_date };
+    system_error_t ret = json_writer_open(&export.json, path);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    export.json.out.progress = progress;
+    
+    ret = write_document(&export, type);
+    return finish_export(&export, ret, path);
+}
+
+system_error_t json_export_animals(const char* path, time_t start_date, time_t end_date, export_progress_t* progress)
+{
+    return export_to_file(EXPORT_TYPE_ANIMALS, path, start_date, end_date, progress);
+}
+
+system_error_t json_export_transactions(const char* path, time_t start_date, time_t end_date, export_progress_t* progress)
+{
+    return export_to_file(EXPORT_TYPE_TRANSACTIONS, path, start_date, end_date, progress);
+}
+
+system_error_t json_export_stream(export_type_t type, time_t start_date, time_t end_date,
+                                  export_sink_fn_t sink, void* context, export_progress_t* progress)
+{
+    if (type != EXPORT_TYPE_ANIMALS && type != EXPORT_TYPE_TRANSACTIONS) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    json_export_t export = { .start_date = start_date, .end_date = end_date };
+    system_error_t ret = json_writer_open_sink(&export.json, sink, context);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    export.json.out.progress = progress;
+    
+    ret = write_document(&export, type);
+    return finish_export(&export, ret, NULL);
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#ifndef JSON_EXPORTER_H
+#define JSON_EXPORTER_H
+
+#include "export_writer.h"
+
+#define JSON_MAX_DEPTH          32
+
+// Document JSON en cours d'écriture, sans arbre intermédiaire
+typedef struct {
+    export_writer_t out;
+    uint32_t depth;
+    uint32_t has_items;     // Bit n : le niveau n contient déjà un élément
+    bool after_key;         // La prochaine valeur suit une clé
+} json_writer_t;
+
+/**
+ * @brief Initialise l'exporteur JSON
+ */
+void json_exporter_init(void);
+
+/**
+ * @brief Crée un fichier JSON
+ * @param json Document à initialiser
+ * @param path Chemin du fichier
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t json_writer_open(json_writer_t* json, const char* path);
+
+/**
+ * @brief Prépare un document JSON envoyé par blocs à une destination
+ * @param json Document à initialiser
+ * @param sink Fonction recevant les blocs
+ * @param context Contexte transmis à sink
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t json_writer_open_sink(json_writer_t* json, export_sink_fn_t sink, void* context);
+
+/**
+ * @brief Ouvre un objet
+ * @param json Document JSON
+ */
+void json_writer_begin_object(json_writer_t* json);
+
+/**
+ * @brief Ferme l'objet en cours
+ * @param json Document JSON
+ */
+void json_writer_end_object(json_writer_t* json);
+
+/**
+ * @brief Ouvre un tableau
+ * @param json Document JSON
+ */
+void json_writer_begin_array(json_writer_t* json);
+
+/**
+ * @brief Ferme le tableau en cours
+ * @param json Document JSON
+ */
+void json_writer_end_array(json_writer_t* json);
+
+/**
+ * @brief Écrit la clé du prochain membre de l'objet en cours
+ * @param json Document JSON
+ * @param key Nom du membre
+ */
+void json_writer_key(json_writer_t* json, const char* key);
+
+/**
+ * @brief Écrit une chaîne, échappée au fil de l'écriture (UTF-8 invalide remplacé par U+FFFD)
+ * @param json Document JSON
+ * @param value Texte UTF-8
+ */
+void json_writer_string(json_writer_t* json, const char* value);
+
+/**
+ * @brief Écrit un entier
+ * @param json Document JSON
+ * @param value Valeur
+ */
+void json_writer_uint(json_writer_t* json, uint32_t value);
+
+/**
+ * @brief Écrit un nombre décimal (null s'il n'est pas fini)
+ * @param json Document JSON
+ * @param value Valeur
+ * @param decimals Nombre de décimales
+ */
+void json_writer_number(json_writer_t* json, float value, int decimals);
+
+/**
+ * @brief Écrit un booléen
+ * @param json Document JSON
+ * @param value Valeur
+ */
+void json_writer_bool(json_writer_t* json, bool value);
+
+/**
+ * @brief Écrit null
+ * @param json Document JSON
+ */
+void json_writer_null(json_writer_t* json);
+
+/**
+ * @brief Écrit une date ISO 8601 en UTC (null si la date est nulle)
+ * @param json Document JSON
+ * @param date Date
+ */
+void json_writer_date(json_writer_t* json, time_t date);
+
+/**
+ * @brief Écrit la fin du document et le ferme
+ * @param json Document JSON
+ * @param path Chemin du fichier, supprimé en cas d'échec (NULL pour une destination)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t json_writer_close(json_writer_t* json, const char* path);
+
+/**
+ * @brief Exporte les animaux entrés dans l'élevage (acquisition, à défaut naissance) sur une période
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t json_export_animals(const char* path, time_t start_date, time_t end_date, export_progress_t* progress);
+
+/**
+ * @brief Exporte les transactions d'une période, archive comprise, par date croissante
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t json_export_transactions(const char* path, time_t start_date, time_t end_date, export_progress_t* progress);
+
+/**
+ * @brief Envoie un export JSON à une destination (réponse HTTP, ...)
+ * @param type Données exportées (EXPORT_TYPE_ANIMALS ou EXPORT_TYPE_TRANSACTIONS)
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param sink Fonction recevant les blocs
+ * @param context Contexte transmis à sink
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NETWORK si la destination a refusé un bloc
+ */
+system_error_t json_export_stream(export_type_t type, time_t start_date, time_t end_date,
+                                  export_sink_fn_t sink, void* context, export_progress_t* progress);
+
+#endif // JSON_EXPORTER_H
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "pdf_deflate.h"
+#include <string.h>
+#include <stdbool.h>
+
+#define DEFLATE_MIN_MATCH       3
+#define DEFLATE_MAX_MATCH       258
+#define DEFLATE_HASH_SHIFT      (32 - 12)  // log2(PDF_DEFLATE_HASH_SIZE)
+#define ADLER_MODULO            65521
+#define ADLER_BLOCK             5552       // Octets sommables sans dépassement sur 32 bits
+
+// Codes de longueur 257 à 285 et de distance 0 à 29 : valeur de base et bits supplémentaires
+static const uint16_t k_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const uint8_t k_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const uint16_t k_distance_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+    4097, 6145, 8193, 12289, 16385, 24577
+};
+static const uint8_t k_distance_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// Sortie bit à bit, bits de poids faible en premier
+typedef struct {
+    uint8_t* out;
+    size_t capacity;
+    size_t used;
+    uint32_t bits;
+    uint32_t count;
+    bool overflow;
+} bit_writer_t;
+
+static void put_byte(bit_writer_t* writer, uint8_t value)
+{
+    if (writer->used < writer->capacity) {
+        writer->out[writer->used++] = value;
+    } else {
+        writer->overflow = true;
+    }
+}
+
+static void put_bits(bit_writer_t* writer, uint32_t value, uint32_t count)
+{
+    writer->bits |= value << writer->count;
+    writer->count += count;
+    while (writer->count >= 8) {
+        put_byte(writer, (uint8_t)writer->bits);
+        writer->bits >>= 8;
+        writer->count -= 8;
+    }
+}
+
+// Les codes de Huffman sont écrits bit de poids fort en premier
+static void put_code(bit_writer_t* writer, uint32_t code, uint32_t length)
+{
+    uint32_t reversed = 0;
+    for (uint32_t i = 0; i < length; i++) {
+        reversed = (reversed << 1) | ((code >> i) & 1);
+    }
+    put_bits(writer, reversed, length);
+}
+
+// Code fixe d'un symbole littéral/longueur (RFC 1951 §3.2.6)
+static void put_symbol(bit_writer_t* writer, uint32_t symbol)
+{
+    if (symbol < 144) {
+        put_code(writer, 0x30 + symbol, 8);
+    } else if (symbol < 256) {
+        put_code(writer, 0x190 + symbol - 144, 9);
+    } else if (symbol < 280) {
+        put_code(writer, symbol - 256, 7);
+    } else {
+        put_code(writer, 0xC0 + symbol - 280, 8);
+    }
+}
+
+static void put_match(bit_writer_t* writer, uint32_t length, uint32_t distance)
+{
+    uint32_t code = 28;
+    while (k_length_base[code] > length) {
+        code--;
+    }
+    put_symbol(writer, 257 + code);
+    put_bits(writer, length - k_length_base[code], k_length_extra[code]);
+    
+    code = 29;
+    while (k_distance_base[code] > distance) {
+        code--;
+    }
+    put_code(writer, code, 5);
+    put_bits(writer, distance - k_distance_base[code], k_distance_extra[code]);
+}
+
+static uint32_t hash3(const uint8_t* p)
+{
+    uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (value * 2654435761u) >> DEFLATE_HASH_SHIFT;
+}
+
+static uint32_t adler32(const uint8_t* data, size_t length)
+{
+    uint32_t a = 1;
+    uint32_t b = 0;
+    
+    while (length > 0) {
+        size_t block = (length < ADLER_BLOCK) ? length : ADLER_BLOCK;
+        length -= block;
+        while (block-- > 0) {
+            a += *data++;
+            b += a;
+        }
+        a %= ADLER_MODULO;
+        b %= ADLER_MODULO;
+    }
+    
+    return (b << 16) | a;
+}
+
+size_t pdf_deflate(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity, uint16_t* table)
+{
+    bit_writer_t writer = { .out = dst, .capacity = capacity };
+    size_t pos = 0;
+    
+    if (length > PDF_DEFLATE_MAX_INPUT) {
+        return 0;
+    }
+    
+    // En-tête zlib : fenêtre de 32 Ko, sans dictionnaire, niveau rapide
+    put_byte(&writer, 0x78);
+    put_byte(&writer, 0x01);
+    
+    // Bloc unique et final à codes fixes : pas de table à transmettre
+    put_bits(&writer, 1, 1);
+    put_bits(&writer, 1, 2);
+    
+    // Positions stockées plus un : 0 signifie une entrée vide
+    memset(table, 0, PDF_DEFLATE_HASH_SIZE * sizeof(uint16_t));
+    
+    while (pos + DEFLATE_MIN_MATCH <= length && !writer.overflow) {
+        uint32_t hash = hash3(&src[pos]);
+        size_t candidate = table[hash];
+        table[hash] = (uint16_t)(pos + 1);
+        
+        if (candidate == 0 || memcmp(&src[candidate - 1], &src[pos], DEFLATE_MIN_MATCH) != 0) {
+            put_symbol(&writer, src[pos++]);
+            continue;
+        }
+        
+        candidate--;
+        size_t limit = (length - pos < DEFLATE_MAX_MATCH) ? length - pos : DEFLATE_MAX_MATCH;
+        size_t match_length = DEFLATE_MIN_MATCH;
+        while (match_length < limit && src[candidate + match_length] == src[pos + match_length]) {
+            match_length++;
+        }
+        put_match(&writer, (uint32_t)match_length, (uint32_t)(pos - candidate));
+        
+        // Les positions couvertes par la correspondance restent des points de départ possibles
+        size_t end = pos + match_length;
+        for (pos++; pos < end && pos + DEFLATE_MIN_MATCH <= length; pos++) {
+            table[hash3(&src[pos])] = (uint16_t)(pos + 1);
+        }
+        pos = end;
+    }
+    while (pos < length) {
+        put_symbol(&writer, src[pos++]);
+    }
+    
+    // Fin de bloc, complément à l'octet puis somme Adler-32 (poids fort en premier)
+    put_symbol(&writer, 256);
+    put_bits(&writer, 0, 7);
+    uint32_t checksum = adler32(src, length);
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        put_byte(&writer, (uint8_t)(checksum >> shift));
+    }
+    
+    return writer.overflow ? 0 : writer.used;
+}
\ No newline at end of file
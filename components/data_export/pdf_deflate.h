@@ -0,0 +1,24 @@
+#ifndef PDF_DEFLATE_H
+#define PDF_DEFLATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Taille de la table de hachage du compresseur (entrées de 16 bits)
+#define PDF_DEFLATE_HASH_SIZE   4096
+
+// Taille maximale d'un bloc compressé : fenêtre de correspondance de DEFLATE
+#define PDF_DEFLATE_MAX_INPUT   32768
+
+/**
+ * @brief Compresse un flux au format zlib (RFC 1950/1951, codes de Huffman fixes) pour /FlateDecode
+ * @param src Données à compresser (PDF_DEFLATE_MAX_INPUT octets au plus)
+ * @param length Taille des données
+ * @param dst Tampon de sortie
+ * @param capacity Taille du tampon de sortie
+ * @param table Table de travail de PDF_DEFLATE_HASH_SIZE entrées
+ * @return Taille compressée, 0 si la sortie ne tient pas dans le tampon
+ */
+size_t pdf_deflate(const uint8_t* src, size_t length, uint8_t* dst, size_t capacity, uint16_t* table);
+
+#endif // PDF_DEFLATE_H
\ No newline at end of file
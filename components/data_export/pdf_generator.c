@@ -1,9 +1,627 @@
-#include "data_export.h"
+#include "pdf_generator.h"
+#include "pdf_deflate.h"
+#include "export_labels.h"
+#include "animals_manager.h"
+#include "transaction_manager.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <stdarg.h>
+#include <inttypes.h>
 
 static const char* TAG = "PDF_GENERATOR";
 
+_Static_assert(PDF_PAGE_BUFFER_SIZE <= PDF_DEFLATE_MAX_INPUT, "Page PDF plus grande que la fenêtre DEFLATE");
+
+// Numéros d'objets : l'arbre des pages et le catalogue sont écrits en dernier
+#define PDF_OBJ_PAGES           1
+#define PDF_OBJ_CATALOG         2
+#define PDF_OBJ_FIRST_FONT      3
+#define PDF_OBJ_FIRST_PAGE      (PDF_OBJ_FIRST_FONT + PDF_FONT_COUNT)  // Puis, par page : contenu et page
+#define PDF_XREF_ENTRY_SIZE     20
+#define PDF_ESCAPED_CHAR_SIZE   4       // Caractère le plus long une fois échappé : \ooo
+
+// Mise en page des tableaux exportés : A4 paysage, Helvetica 8 points
+#define TABLE_MARGIN            30
+#define TABLE_TITLE_SIZE        12
+#define TABLE_FONT_SIZE         8
+#define TABLE_LINE_HEIGHT       11
+#define TABLE_CELL_PADDING      3
+
+static const char* const k_font_names[PDF_FONT_COUNT] = { "Helvetica", "Helvetica-Bold", "Courier" };
+
+// Chasse moyenne d'un caractère en fraction du corps, pour tronquer le texte sans table de métriques
+static const float k_font_char_width[PDF_FONT_COUNT] = { 0.52f, 0.58f, 0.60f };
+
+// Caractères WinAnsi de 0x80 à 0x9F (les autres codes au-delà de 0x9F sont ceux de Latin-1)
+static const struct {
+    uint16_t unicode;
+    uint8_t code;
+} k_winansi_extra[] = {
+    { 0x20AC, 0x80 }, { 0x201A, 0x82 }, { 0x0192, 0x83 }, { 0x201E, 0x84 }, { 0x2026, 0x85 }, { 0x2020, 0x86 },
+    { 0x2021, 0x87 }, { 0x02C6, 0x88 }, { 0x2030, 0x89 }, { 0x0160, 0x8A }, { 0x2039, 0x8B }, { 0x0152, 0x8C },
+    { 0x017D, 0x8E }, { 0x2018, 0x91 }, { 0x2019, 0x92 }, { 0x201C, 0x93 }, { 0x201D, 0x94 }, { 0x2022, 0x95 },
+    { 0x2013, 0x96 }, { 0x2014, 0x97 }, { 0x02DC, 0x98 }, { 0x2122, 0x99 }, { 0x0161, 0x9A }, { 0x203A, 0x9B },
+    { 0x0153, 0x9C }, { 0x017E, 0x9E }, { 0x0178, 0x9F }
+};
+
+// Colonne d'un tableau exporté
+typedef struct {
+    const char* title;
+    uint16_t width;             // Largeur en points
+} pdf_column_t;
+
+static const pdf_column_t k_animal_columns[] = {
+    { "ID", 30 }, { "Nom", 110 }, { "Espèce", 130 }, { "Type", 50 }, { "Sexe", 45 }, { "Statut", 60 },
+    { "Naissance", 55 }, { "Acquisition", 55 }, { "Origine", 110 }, { "Puce", 80 }, { "CITES", 57 }
+};
+
+static const pdf_column_t k_transaction_columns[] = {
+    { "ID", 30 }, { "Date", 55 }, { "Type", 55 }, { "Statut", 60 }, { "Animal", 100 }, { "Espèce", 120 },
+    { "Montant", 60 }, { "Contrepartie", 130 }, { "Permis CITES", 85 }, { "Certificat", 87 }
+};
+
+#define ANIMAL_COLUMN_COUNT         (sizeof(k_animal_columns) / sizeof(k_animal_columns[0]))
+#define TRANSACTION_COLUMN_COUNT    (sizeof(k_transaction_columns) / sizeof(k_transaction_columns[0]))
+
+// Parcours d'un export : document, mise en page du tableau et filtre de dates
+typedef struct {
+    pdf_writer_t pdf;
+    const char* title;
+    const pdf_column_t* columns;
+    uint32_t column_count;
+    float row_y;                // Ordonnée de la prochaine ligne (0 si aucune page ouverte)
+    time_t start_date;
+    time_t end_date;
+    uint32_t rows;
+} pdf_export_t;
+
+static void* allocate(size_t size)
+{
+    void* buffer = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer == NULL) {
+        buffer = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    return buffer;
+}
+
+static void release_buffers(pdf_writer_t* pdf)
+{
+    heap_caps_free(pdf->page);
+    heap_caps_free(pdf->deflated);
+    heap_caps_free(pdf->hash_table);
+    pdf->page = NULL;
+    pdf->deflated = NULL;
+    pdf->hash_table = NULL;
+}
+
+static void write_string(pdf_writer_t* pdf, const char* text)
+{
+    export_writer_write(&pdf->out, text, strlen(text));
+}
+
+static uint8_t winansi_code(uint32_t unicode)
+{
+    if ((unicode >= 0x20 && unicode < 0x7F) || (unicode >= 0xA0 && unicode <= 0xFF)) {
+        return (uint8_t)unicode;
+    }
+    for (size_t i = 0; i < sizeof(k_winansi_extra) / sizeof(k_winansi_extra[0]); i++) {
+        if (k_winansi_extra[i].unicode == unicode) {
+            return k_winansi_extra[i].code;
+        }
+    }
+    return '?';
+}
+
+// Caractère UTF-8 suivant converti en WinAnsi : '?' s'il n'y figure pas, espace pour un caractère de contrôle
+static uint8_t next_winansi(const uint8_t** text)
+{
+    const uint8_t* p = *text;
+    uint32_t code = *p++;
+    
+    if (code < 0x20) {
+        code = ' ';
+    } else if (code >= 0x80) {
+        uint32_t extra = (code >= 0xF0) ? 3 : (code >= 0xE0) ? 2 : (code >= 0xC0) ? 1 : 0;
+        uint32_t value = code & (0x3F >> extra);
+        uint32_t read = 0;
+        while (read < extra && (*p & 0xC0) == 0x80) {
+            value = (value << 6) | (*p++ & 0x3F);
+            read++;
+        }
+        code = (extra > 0 && read == extra) ? winansi_code(value) : '?';
+    }
+    
+    *text = p;
+    return (uint8_t)code;
+}
+
+// Chaîne littérale PDF (sans parenthèses) : WinAnsi, parenthèses et barres obliques échappées, octets hauts en octal
+static size_t encode_text(const char* text, uint32_t max_chars, char* dst, size_t size, bool* complete)
+{
+    const uint8_t* src = (const uint8_t*)text;
+    size_t length = 0;
+    
+    for (uint32_t chars = 0; *src != '\0' && chars < max_chars; chars++) {
+        if (length + PDF_ESCAPED_CHAR_SIZE > size) {
+            *complete = false;
+            return length;
+        }
+        uint8_t code = next_winansi(&src);
+        if (code == '(' || code == ')' || code == '\\') {
+            dst[length++] = '\\';
+            dst[length++] = (char)code;
+        } else if (code >= 0x80) {
+            dst[length++] = '\\';
+            dst[length++] = (char)('0' + (code >> 6));
+            dst[length++] = (char)('0' + ((code >> 3) & 7));
+            dst[length++] = (char)('0' + (code & 7));
+        } else {
+            dst[length++] = (char)code;
+        }
+    }
+    
+    *complete = true;
+    return length;
+}
+
+static void page_overflow(pdf_writer_t* pdf)
+{
+    if (!pdf->out.failed) {
+        ESP_LOGE(TAG, "Contenu de la page %" PRIu32 " au-delà de %d octets", pdf->page_count, PDF_PAGE_BUFFER_SIZE);
+    }
+    pdf->out.failed = true;
+}
+
+static void page_write(pdf_writer_t* pdf, const char* data, size_t length)
+{
+    if (pdf->page_used + length > PDF_PAGE_BUFFER_SIZE) {
+        page_overflow(pdf);
+        return;
+    }
+    memcpy(&pdf->page[pdf->page_used], data, length);
+    pdf->page_used += length;
+}
+
+static void page_printf(pdf_writer_t* pdf, const char* format, ...)
+{
+    size_t room = PDF_PAGE_BUFFER_SIZE - pdf->page_used;
+    va_list args;
+    
+    va_start(args, format);
+    int length = vsnprintf(&pdf->page[pdf->page_used], room, format, args);
+    va_end(args);
+    
+    if (length < 0 || (size_t)length >= room) {
+        page_overflow(pdf);
+        return;
+    }
+    pdf->page_used += (size_t)length;
+}
+
+// Section de références : positions des objets écrits depuis la précédente, chaînée par /Prev
+static void write_xref_section(pdf_writer_t* pdf, uint32_t pages_offset, uint32_t catalog_offset, uint32_t info_object)
+{
+    char entry[PDF_XREF_ENTRY_SIZE + 1];
+    bool final = (pages_offset != 0);
+    uint32_t offset = (uint32_t)pdf->out.size;
+    
+    write_string(pdf, "xref\n");
+    
+    // Chaque section commence par l'objet 0, la dernière porte aussi l'arbre des pages et le catalogue
+    export_writer_printf(&pdf->out, "0 %d\n0000000000 65535 f \n", final ? PDF_OBJ_FIRST_FONT : 1);
+    if (final) {
+        snprintf(entry, sizeof(entry), "%010" PRIu32 " 00000 n \n", pages_offset);
+        export_writer_write(&pdf->out, entry, PDF_XREF_ENTRY_SIZE);
+        snprintf(entry, sizeof(entry), "%010" PRIu32 " 00000 n \n", catalog_offset);
+        export_writer_write(&pdf->out, entry, PDF_XREF_ENTRY_SIZE);
+    }
+    
+    if (pdf->xref_count > 0) {
+        export_writer_printf(&pdf->out, "%" PRIu32 " %" PRIu32 "\n", pdf->xref_first, pdf->xref_count);
+        for (uint32_t i = 0; i < pdf->xref_count; i++) {
+            snprintf(entry, sizeof(entry), "%010" PRIu32 " 00000 n \n", pdf->xref_offsets[i]);
+            export_writer_write(&pdf->out, entry, PDF_XREF_ENTRY_SIZE);
+        }
+    }
+    
+    export_writer_printf(&pdf->out, "trailer\n<< /Size %" PRIu32 " /Root %d 0 R", pdf->next_object, PDF_OBJ_CATALOG);
+    if (pdf->prev_xref != 0) {
+        export_writer_printf(&pdf->out, " /Prev %" PRIu32, pdf->prev_xref);
+    }
+    if (info_object != 0) {
+        export_writer_printf(&pdf->out, " /Info %" PRIu32 " 0 R", info_object);
+    }
+    export_writer_printf(&pdf->out, " >>\nstartxref\n%" PRIu32 "\n%%%%EOF\n", offset);
+    
+    pdf->prev_xref = offset;
+    pdf->xref_count = 0;
+}
+
+// Enregistre la position de l'objet suivant ; une section pleine est d'abord écrite
+static uint32_t begin_object(pdf_writer_t* pdf)
+{
+    if (pdf->xref_count == PDF_XREF_SECTION_SIZE) {
+        write_xref_section(pdf, 0, 0, 0);
+    }
+    
+    uint32_t number = pdf->next_object++;
+    if (pdf->xref_count == 0) {
+        pdf->xref_first = number;
+    }
+    pdf->xref_offsets[pdf->xref_count++] = (uint32_t)pdf->out.size;
+    export_writer_printf(&pdf->out, "%" PRIu32 " 0 obj\n", number);
+    
+    return number;
+}
+
 void pdf_generator_init(void)
 {
     ESP_LOGI(TAG, "Générateur PDF initialisé");
+}
+
+static system_error_t start_document(pdf_writer_t* pdf, uint16_t width, uint16_t height, bool compress)
+{
+    pdf->page = allocate(PDF_PAGE_BUFFER_SIZE);
+    if (compress) {
+        pdf->deflated = allocate(PDF_PAGE_BUFFER_SIZE);
+        pdf->hash_table = allocate(PDF_DEFLATE_HASH_SIZE * sizeof(uint16_t));
+    }
+    if (pdf->page == NULL || (compress && (pdf->deflated == NULL || pdf->hash_table == NULL))) {
+        release_buffers(pdf);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    pdf->width = width;
+    pdf->height = height;
+    pdf->next_object = PDF_OBJ_FIRST_FONT;
+    
+    export_writer_write(&pdf->out, "%PDF-1.4\n%\xE2\xE3\xCF\xD3\n", 15);
+    for (uint32_t f = 0; f < PDF_FONT_COUNT; f++) {
+        begin_object(pdf);
+        export_writer_printf(&pdf->out, "<< /Type /Font /Subtype /Type1 /BaseFont /%s", k_font_names[f]);
+        write_string(pdf, " /Encoding /WinAnsiEncoding >>\nendobj\n");
+    }
+    
+    return SYSTEM_OK;
+}
+
+system_error_t pdf_writer_open(pdf_writer_t* pdf, const char* path, uint16_t width, uint16_t height, bool compress)
+{
+    memset(pdf, 0, sizeof(pdf_writer_t));
+    
+    system_error_t ret = export_writer_open(&pdf->out, path);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = start_document(pdf, width, height, compress);
+    if (ret != SYSTEM_OK) {
+        export_writer_close(&pdf->out, path);
+        remove(path);
+    }
+    return ret;
+}
+
+void pdf_writer_begin_page(pdf_writer_t* pdf)
+{
+    pdf_writer_end_page(pdf);
+    
+    pdf->page_open = true;
+    pdf->page_used = 0;
+    pdf->page_count++;
+}
+
+// Flux de contenu, compressé s'il y gagne, puis l'objet page qui y renvoie
+void pdf_writer_end_page(pdf_writer_t* pdf)
+{
+    if (!pdf->page_open) {
+        return;
+    }
+    pdf->page_open = false;
+    
+    const char* content = pdf->page;
+    size_t length = pdf->page_used;
+    bool deflated = false;
+    if (pdf->deflated != NULL && length > 0) {
+        size_t size = pdf_deflate((const uint8_t*)pdf->page, length, pdf->deflated, length, pdf->hash_table);
+        if (size > 0) {
+            content = (const char*)pdf->deflated;
+            length = size;
+            deflated = true;
+        }
+    }
+    
+    uint32_t contents = begin_object(pdf);
+    export_writer_printf(&pdf->out, "<< /Length %u", (unsigned)length);
+    write_string(pdf, deflated ? " /Filter /FlateDecode >>\nstream\n" : " >>\nstream\n");
+    export_writer_write(&pdf->out, content, length);
+    write_string(pdf, "\nendstream\nendobj\n");
+    
+    begin_object(pdf);
+    export_writer_printf(&pdf->out, "<< /Type /Page /Parent %d 0 R /MediaBox [0 0 %u %u]",
+                         PDF_OBJ_PAGES, pdf->width, pdf->height);
+    write_string(pdf, " /Resources << /Font <<");
+    for (uint32_t f = 0; f < PDF_FONT_COUNT; f++) {
+        export_writer_printf(&pdf->out, " /F%" PRIu32 " %" PRIu32 " 0 R", f + 1, PDF_OBJ_FIRST_FONT + f);
+    }
+    export_writer_printf(&pdf->out, " >> >> /Contents %" PRIu32 " 0 R >>\nendobj\n", contents);
+}
+
+void pdf_writer_text(pdf_writer_t* pdf, pdf_font_t font, uint32_t size, float x, float y,
+                     const char* text, float max_width)
+{
+    if (!pdf->page_open) {
+        pdf_writer_begin_page(pdf);
+    }
+    
+    uint32_t max_chars = UINT32_MAX;
+    if (max_width > 0) {
+        max_chars = (uint32_t)(max_width / ((float)size * k_font_char_width[font]));
+    }
+    
+    page_printf(pdf, "BT /F%d %" PRIu32 " Tf %.1f %.1f Td (", (int)font + 1, size, (double)x, (double)y);
+    if (pdf->out.failed) {
+        return;
+    }
+    
+    bool complete;
+    pdf->page_used += encode_text(text, max_chars, &pdf->page[pdf->page_used],
+                                  PDF_PAGE_BUFFER_SIZE - pdf->page_used, &complete);
+    if (!complete) {
+        page_overflow(pdf);
+        return;
+    }
+    page_write(pdf, ") Tj ET\n", 8);
+}
+
+void pdf_writer_line(pdf_writer_t* pdf, float x1, float y1, float x2, float y2, float width)
+{
+    if (!pdf->page_open) {
+        pdf_writer_begin_page(pdf);
+    }
+    
+    page_printf(pdf, "%.2f w %.1f %.1f m %.1f %.1f l S\n", (double)width, (double)x1, (double)y1, (double)x2, (double)y2);
+}
+
+system_error_t pdf_writer_close(pdf_writer_t* pdf, const char* title, const char* path)
+{
+    char text[128];
+    bool complete;
+    
+    // Un document sans page n'est pas lisible partout
+    if (pdf->page_count == 0) {
+        pdf_writer_begin_page(pdf);
+    }
+    pdf_writer_end_page(pdf);
+    
+    time_t now = time(NULL);
+    struct tm tm_info;
+    gmtime_r(&now, &tm_info);
+    uint32_t info = begin_object(pdf);
+    write_string(pdf, "<< /Producer (LizardB) /Title (");
+    export_writer_write(&pdf->out, text, encode_text(title, UINT32_MAX, text, sizeof(text), &complete));
+    export_writer_printf(&pdf->out, ") /CreationDate (D:%04d%02d%02d%02d%02d%02dZ) >>\nendobj\n",
+                         tm_info.tm_year + 1900, tm_info.tm_mon + 1, tm_info.tm_mday,
+                         tm_info.tm_hour, tm_info.tm_min, tm_info.tm_sec);
+    
+    // Les pages occupent chacune deux objets à partir de PDF_OBJ_FIRST_PAGE
+    uint32_t pages_offset = (uint32_t)pdf->out.size;
+    export_writer_printf(&pdf->out, "%d 0 obj\n<< /Type /Pages /Count %" PRIu32 " /Kids [",
+                         PDF_OBJ_PAGES, pdf->page_count);
+    for (uint32_t p = 0; p < pdf->page_count; p++) {
+        export_writer_printf(&pdf->out, " %" PRIu32 " 0 R", PDF_OBJ_FIRST_PAGE + 2 * p + 1);
+    }
+    write_string(pdf, " ] >>\nendobj\n");
+    
+    uint32_t catalog_offset = (uint32_t)pdf->out.size;
+    export_writer_printf(&pdf->out, "%d 0 obj\n<< /Type /Catalog /Pages %d 0 R >>\nendobj\n",
+                         PDF_OBJ_CATALOG, PDF_OBJ_PAGES);
+    
+    write_xref_section(pdf, pages_offset, catalog_offset, info);
+    
+    release_buffers(pdf);
+    return export_writer_close(&pdf->out, path);
+}
+
+static void format_date(char* buffer, size_t size, time_t date)
+{
+    buffer[0] = '\0';
+    if (date != 0) {
+        struct tm tm_info;
+        localtime_r(&date, &tm_info);
+        strftime(buffer, size, "%d/%m/%Y", &tm_info);
+    }
+}
+
+// En-tête de page : titre, période, numéro de page et titres des colonnes
+static void table_open_page(pdf_export_t* export)
+{
+    pdf_writer_t* pdf = &export->pdf;
+    char start[16];
+    char end[16];
+    char line[96];
+    float top = (float)(pdf->height - TABLE_MARGIN - TABLE_TITLE_SIZE);
+    
+    pdf_writer_begin_page(pdf);
+    pdf_writer_text(pdf, PDF_FONT_HELVETICA_BOLD, TABLE_TITLE_SIZE, TABLE_MARGIN, top, export->title, 0);
+    snprintf(line, sizeof(line), "Page %" PRIu32, pdf->page_count);
+    pdf_writer_text(pdf, PDF_FONT_HELVETICA, TABLE_FONT_SIZE, (float)(pdf->width - TABLE_MARGIN - 40), top, line, 0);
+    
+    format_date(start, sizeof(start), export->start_date);
+    format_date(end, sizeof(end), export->end_date);
+    if (export->start_date == 0 && export->end_date == 0) {
+        snprintf(line, sizeof(line), "Toutes dates");
+    } else {
+        snprintf(line, sizeof(line), "Période : %s - %s", (start[0] != '\0') ? start : "origine",
+                 (end[0] != '\0') ? end : "aujourd'hui");
+    }
+    pdf_writer_text(pdf, PDF_FONT_HELVETICA, TABLE_FONT_SIZE, TABLE_MARGIN, top - 14, line, 0);
+    
+    float header_y = top - 14 - 2 * TABLE_LINE_HEIGHT;
+    float x = TABLE_MARGIN;
+    for (uint32_t c = 0; c < export->column_count; c++) {
+        pdf_writer_text(pdf, PDF_FONT_HELVETICA_BOLD, TABLE_FONT_SIZE, x + TABLE_CELL_PADDING, header_y,
+                        export->columns[c].title, export->columns[c].width - 2 * TABLE_CELL_PADDING);
+        x += export->columns[c].width;
+    }
+    pdf_writer_line(pdf, TABLE_MARGIN, header_y - 4, x, header_y - 4, 0.5f);
+    
+    export->row_y = header_y - TABLE_LINE_HEIGHT - 2;
+}
+
+static void table_row(pdf_export_t* export, const char* const* values)
+{
+    if (export->row_y < TABLE_MARGIN) {
+        table_open_page(export);
+    }
+    
+    float x = TABLE_MARGIN;
+    for (uint32_t c = 0; c < export->column_count; c++) {
+        if (values[c][0] != '\0') {
+            pdf_writer_text(&export->pdf, PDF_FONT_HELVETICA, TABLE_FONT_SIZE, x + TABLE_CELL_PADDING, export->row_y,
+                            values[c], export->columns[c].width - 2 * TABLE_CELL_PADDING);
+        }
+        x += export->columns[c].width;
+    }
+    export->row_y -= TABLE_LINE_HEIGHT;
+    export->rows++;
+}
+
+static bool in_range(const pdf_export_t* export, time_t date)
+{
+    return (export->start_date == 0 || date >= export->start_date) &&
+           (export->end_date == 0 || date <= export->end_date);
+}
+
+static bool write_animal(const animal_t* animal, void* context)
+{
+    pdf_export_t* export = (pdf_export_t*)context;
+    const char* values[ANIMAL_COLUMN_COUNT];
+    char id[12];
+    char birth[16];
+    char acquisition[16];
+    
+    if (!in_range(export, (animal->acquisition_date != 0) ? animal->acquisition_date : animal->birth_date)) {
+        return true;
+    }
+    
+    snprintf(id, sizeof(id), "%" PRIu32, animal->id);
+    format_date(birth, sizeof(birth), animal->birth_date);
+    format_date(acquisition, sizeof(acquisition), animal->acquisition_date);
+    
+    values[0] = id;
+    values[1] = animal->name;
+    values[2] = animal->species;
+    values[3] = EXPORT_LABEL(k_animal_type_labels, animal->type);
+    values[4] = EXPORT_LABEL(k_animal_sex_labels, animal->sex);
+    values[5] = EXPORT_LABEL(k_animal_status_labels, animal->status);
+    values[6] = birth;
+    values[7] = acquisition;
+    values[8] = animal->origin;
+    values[9] = animal->microchip_id;
+    values[10] = !animal->cites_required ? "Non" : (animal->cites_number[0] != '\0') ? animal->cites_number : "Oui";
+    table_row(export, values);
+    
+    return export_writer_record(&export->pdf.out);
+}
+
+static bool write_transaction(const transaction_t* transaction, void* context)
+{
+    pdf_export_t* export = (pdf_export_t*)context;
+    const char* values[TRANSACTION_COLUMN_COUNT];
+    char id[12];
+    char date[16];
+    char amount[32];
+    
+    snprintf(id, sizeof(id), "%" PRIu32, transaction->id);
+    format_date(date, sizeof(date), transaction->transaction_date);
+    snprintf(amount, sizeof(amount), "%.2f %s", (double)transaction->amount, transaction->currency);
+    char* point = strchr(amount, '.');
+    if (point != NULL) {
+        *point = ',';
+    }
+    
+    values[0] = id;
+    values[1] = date;
+    values[2] = EXPORT_LABEL(k_transaction_type_labels, transaction->type);
+    values[3] = EXPORT_LABEL(k_transaction_status_labels, transaction->status);
+    values[4] = transaction->animal_name;
+    values[5] = transaction->animal_species;
+    values[6] = amount;
+    values[7] = transaction->counterpart_name;
+    values[8] = transaction->cites_permit_number;
+    values[9] = transaction->certificate_number;
+    table_row(export, values);
+    
+    return export_writer_record(&export->pdf.out);
+}
+
+static system_error_t finish_export(pdf_export_t* export, system_error_t ret, const char* path)
+{
+    // Tableau vide : une page avec son en-tête
+    if (export->rows == 0) {
+        table_open_page(export);
+        pdf_writer_text(&export->pdf, PDF_FONT_HELVETICA, TABLE_FONT_SIZE, TABLE_MARGIN + TABLE_CELL_PADDING,
+                        export->row_y, "Aucun enregistrement", 0);
+    }
+    
+    system_error_t close_ret = pdf_writer_close(&export->pdf, export->title, path);
+    if (ret != SYSTEM_OK) {
+        remove(path);
+        return ret;
+    }
+    if (close_ret != SYSTEM_OK) {
+        return close_ret;
+    }
+    
+    ESP_LOGI(TAG, "Export PDF %s: %" PRIu32 " lignes, %" PRIu32 " pages, %u octets",
+             path, export->rows, export->pdf.page_count, (unsigned)export->pdf.out.size);
+    return SYSTEM_OK;
+}
+
+static system_error_t start_export(pdf_export_t* export, const char* path, bool compress,
+                                   export_progress_t* progress)
+{
+    system_error_t ret = pdf_writer_open(&export->pdf, path, PDF_A4_LONG_SIDE, PDF_A4_SHORT_SIDE, compress);
+    export->pdf.out.progress = progress;
+    return ret;
+}
+
+system_error_t pdf_export_animals(const char* path, time_t start_date, time_t end_date, bool compress,
+                                  export_progress_t* progress)
+{
+    pdf_export_t export = {
+        .title = "Registre des animaux",
+        .columns = k_animal_columns,
+        .column_count = ANIMAL_COLUMN_COUNT,
+        .start_date = start_date,
+        .end_date = end_date
+    };
+    system_error_t ret = start_export(&export, path, compress, progress);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = animals_for_each(write_animal, &export);
+    return finish_export(&export, ret, path);
+}
+
+system_error_t pdf_export_transactions(const char* path, time_t start_date, time_t end_date, bool compress,
+                                       export_progress_t* progress)
+{
+    pdf_export_t export = {
+        .title = "Journal des transactions",
+        .columns = k_transaction_columns,
+        .column_count = TRANSACTION_COLUMN_COUNT,
+        .start_date = start_date,
+        .end_date = end_date
+    };
+    system_error_t ret = start_export(&export, path, compress, progress);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = transaction_for_each(start_date, end_date, write_transaction, &export);
+    return finish_export(&export, ret, path);
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+#ifndef PDF_GENERATOR_H
+#define PDF_GENERATOR_H
+
+#include "export_writer.h"
+
+// Formats de page en points (1/72 de pouce)
+#define PDF_A4_SHORT_SIDE       595
+#define PDF_A4_LONG_SIDE        842
+
+#define PDF_XREF_SECTION_SIZE   64      // Positions d'objets gardées avant l'écriture d'une section de références
+
+// Polices standard (base 14), disponibles dans tout lecteur sans être incorporées
+typedef enum {
+    PDF_FONT_HELVETICA,
+    PDF_FONT_HELVETICA_BOLD,
+    PDF_FONT_COURIER,
+    PDF_FONT_COUNT
+} pdf_font_t;
+
+// Document PDF écrit au fil de l'eau : seul le contenu de la page en cours est gardé en mémoire
+typedef struct {
+    export_writer_t out;
+    char* page;                 // Flux de contenu de la page ouverte (PDF_PAGE_BUFFER_SIZE octets)
+    size_t page_used;
+    bool page_open;
+    uint8_t* deflated;          // Flux compressé (NULL sans compression)
+    uint16_t* hash_table;
+    uint16_t width;
+    uint16_t height;
+    uint32_t page_count;
+    uint32_t next_object;
+    uint32_t xref_first;        // Premier objet de la section de références en cours
+    uint32_t xref_count;
+    uint32_t xref_offsets[PDF_XREF_SECTION_SIZE];
+    uint32_t prev_xref;         // Position de la dernière section écrite (0 pour aucune)
+} pdf_writer_t;
+
+/**
+ * @brief Initialise le générateur PDF
+ */
+void pdf_generator_init(void);
+
+/**
+ * @brief Crée un fichier PDF
+ * @param pdf Document à initialiser
+ * @param path Chemin du fichier
+ * @param width Largeur des pages en points
+ * @param height Hauteur des pages en points
+ * @param compress Compresser les flux de contenu (/FlateDecode)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t pdf_writer_open(pdf_writer_t* pdf, const char* path, uint16_t width, uint16_t height, bool compress);
+
+/**
+ * @brief Commence une nouvelle page (la page ouverte est terminée)
+ * @param pdf Document PDF
+ */
+void pdf_writer_begin_page(pdf_writer_t* pdf);
+
+/**
+ * @brief Termine la page ouverte et l'écrit dans le document
+ * @param pdf Document PDF
+ */
+void pdf_writer_end_page(pdf_writer_t* pdf);
+
+/**
+ * @brief Écrit une ligne de texte sur la page ouverte (UTF-8 converti en WinAnsi)
+ * @param pdf Document PDF
+ * @param font Police
+ * @param size Corps en points
+ * @param x Abscisse de la ligne de base
+ * @param y Ordonnée de la ligne de base
+ * @param text Texte UTF-8
+ * @param max_width Largeur disponible en points, texte tronqué au-delà (0 pour aucune limite)
+ */
+void pdf_writer_text(pdf_writer_t* pdf, pdf_font_t font, uint32_t size, float x, float y,
+                     const char* text, float max_width);
+
+/**
+ * @brief Trace un segment sur la page ouverte
+ * @param pdf Document PDF
+ * @param x1 Abscisse de départ
+ * @param y1 Ordonnée de départ
+ * @param x2 Abscisse d'arrivée
+ * @param y2 Ordonnée d'arrivée
+ * @param width Épaisseur du trait en points
+ */
+void pdf_writer_line(pdf_writer_t* pdf, float x1, float y1, float x2, float y2, float width);
+
+/**
+ * @brief Termine la dernière page, écrit l'arbre des pages et la fin du document puis le ferme
+ * @param pdf Document PDF
+ * @param title Titre du document (métadonnées)
+ * @param path Chemin du fichier, supprimé en cas d'échec
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t pdf_writer_close(pdf_writer_t* pdf, const char* title, const char* path);
+
+/**
+ * @brief Exporte les animaux entrés dans l'élevage (acquisition, à défaut naissance) sur une période
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param compress Compresser les flux de contenu
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t pdf_export_animals(const char* path, time_t start_date, time_t end_date, bool compress,
+                                  export_progress_t* progress);
+
+/**
+ * @brief Exporte les transactions d'une période, archive comprise, par date croissante
+ * @param path Chemin du fichier
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param compress Compresser les flux de contenu
+ * @param progress Avancement tenu à jour pendant l'export (NULL pour aucun)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t pdf_export_transactions(const char* path, time_t start_date, time_t end_date, bool compress,
+                                       export_progress_t* progress);
+
+#endif // PDF_GENERATOR_H
\ No newline at end of file
@@ -121,7 +121,7 @@ system_error_t lvgl_start(void)
         NULL,
         5,
         &g_lvgl_task_handle,
-        1  // Core 1
+        LVGL_TASK_CORE
     );
     
     if (ret != pdPASS) {
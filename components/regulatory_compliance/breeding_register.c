@@ -0,0 +1,496 @@
+#include "register_generator.h"
+#include "esp_log.h"
+#include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <inttypes.h>
+
+static const char* TAG = "BREEDING_REGISTER";
+
+// Mise en page PDF : A4 paysage, Helvetica 8 points
+#define PDF_PAGE_WIDTH      842
+#define PDF_PAGE_HEIGHT     595
+#define PDF_MARGIN          30
+#define PDF_LINE_HEIGHT     11
+#define PDF_FONT_SIZE       8
+#define PDF_CHAR_WIDTH      4.5f    // Largeur moyenne d'un caractère Helvetica 8 points
+#define PDF_TOP_Y           (PDF_PAGE_HEIGHT - PDF_MARGIN)
+#define PDF_FIRST_ROW_Y     (PDF_TOP_Y - 3 * PDF_LINE_HEIGHT)
+#define PDF_XREF_ENTRY_SIZE 20
+
+// Numéros d'objets : l'arbre des pages et le catalogue sont écrits en dernier
+#define PDF_OBJ_PAGES       1
+#define PDF_OBJ_CATALOG     2
+#define PDF_OBJ_FONT        3
+#define PDF_OBJ_FIRST_PAGE  4       // Puis, par page : contenu, longueur du contenu, page
+
+#define COLUMN_COUNT 7
+
+static const char* const k_column_titles[COLUMN_COUNT] = {
+    "Date", "Mouvement", "Motif", "Espèce", "Identification", "Provenance / destination", "Document"
+};
+
+static const uint16_t k_column_x[COLUMN_COUNT + 1] = { 30, 80, 125, 200, 390, 520, 720, 812 };
+
+static register_fetch_fn_t g_sources[REGISTER_SOURCE_COUNT];
+
+// Sortie découpée en blocs de taille fixe
+typedef struct {
+    FILE* file;
+    char buffer[REGISTER_CHUNK_SIZE];
+    size_t used;
+    uint32_t offset;        // Octets produits depuis le début du fichier
+    bool failed;
+} chunk_writer_t;
+
+// État du document PDF en cours
+typedef struct {
+    FILE* xref;             // Positions des objets 3 et suivants, dans l'ordre des numéros
+    uint32_t next_object;
+    uint32_t page_count;
+    uint32_t content_start; // Début du flux de la page ouverte
+    int32_t row_y;          // Ordonnée de la prochaine ligne (0 si aucune page ouverte)
+} pdf_state_t;
+
+// Contexte de génération : seule allocation, indépendante de la longueur du registre
+typedef struct {
+    chunk_writer_t out;
+    register_entry_t entries[REGISTER_SOURCE_COUNT][REGISTER_BATCH_SIZE];
+    register_batch_t batches[REGISTER_SOURCE_COUNT];
+    uint32_t positions[REGISTER_SOURCE_COUNT];
+    bool exhausted[REGISTER_SOURCE_COUNT];
+    pdf_state_t pdf;
+    char line[REGISTER_LINE_SIZE];
+} register_context_t;
+
+void breeding_register_set_source(register_source_t source, register_fetch_fn_t fetch)
+{
+    if (source < REGISTER_SOURCE_COUNT) {
+        g_sources[source] = fetch;
+    }
+}
+
+static int compare_position(time_t date_a, uint32_t key_a, time_t date_b, uint32_t key_b)
+{
+    if (date_a != date_b) {
+        return (date_a < date_b) ? -1 : 1;
+    }
+    if (key_a != key_b) {
+        return (key_a < key_b) ? -1 : 1;
+    }
+    return 0;
+}
+
+bool register_batch_accepts(const register_batch_t* batch, time_t date, uint32_t key)
+{
+    if (batch->started && compare_position(date, key, batch->after_date, batch->after_key) <= 0) {
+        return false;
+    }
+    if (batch->count == batch->max_count) {
+        const register_entry_t* last = &batch->entries[batch->count - 1];
+        return compare_position(date, key, last->date, last->key) < 0;
+    }
+    return true;
+}
+
+void register_batch_offer(register_batch_t* batch, const register_entry_t* entry)
+{
+    if (batch->max_count == 0 || !register_batch_accepts(batch, entry->date, entry->key)) {
+        return;
+    }
+    
+    uint32_t pos = batch->count;
+    while (pos > 0 && compare_position(entry->date, entry->key,
+                                       batch->entries[pos - 1].date, batch->entries[pos - 1].key) <= 0) {
+        pos--;
+    }
+    if (pos < batch->count && compare_position(entry->date, entry->key,
+                                               batch->entries[pos].date, batch->entries[pos].key) == 0) {
+        return;
+    }
+    
+    // Lot plein : la dernière ligne laisse sa place
+    uint32_t count = (batch->count < batch->max_count) ? batch->count + 1 : batch->max_count;
+    memmove(&batch->entries[pos + 1], &batch->entries[pos], (count - 1 - pos) * sizeof(register_entry_t));
+    batch->entries[pos] = *entry;
+    batch->count = count;
+}
+
+bool register_batch_complete(const register_batch_t* batch, time_t date)
+{
+    return batch->count == batch->max_count && date > batch->entries[batch->count - 1].date;
+}
+
+static void chunk_flush(chunk_writer_t* out)
+{
+    if (out->used > 0 && !out->failed && fwrite(out->buffer, 1, out->used, out->file) != out->used) {
+        out->failed = true;
+    }
+    out->used = 0;
+}
+
+static void chunk_write(chunk_writer_t* out, const char* data, size_t length)
+{
+    out->offset += (uint32_t)length;
+    while (length > 0) {
+        size_t room = sizeof(out->buffer) - out->used;
+        size_t part = (length < room) ? length : room;
+        memcpy(&out->buffer[out->used], data, part);
+        out->used += part;
+        data += part;
+        length -= part;
+        if (out->used == sizeof(out->buffer)) {
+            chunk_flush(out);
+        }
+    }
+}
+
+static void chunk_printf(chunk_writer_t* out, char* scratch, size_t size, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(scratch, size, format, args);
+    va_end(args);
+    
+    if (length > 0) {
+        chunk_write(out, scratch, ((size_t)length < size) ? (size_t)length : size - 1);
+    }
+}
+
+static void format_date(char* buffer, size_t size, time_t date)
+{
+    struct tm tm_info;
+    localtime_r(&date, &tm_info);
+    strftime(buffer, size, "%d/%m/%Y", &tm_info);
+}
+
+static const char* movement_label(register_movement_t movement)
+{
+    return (movement == REGISTER_MOVEMENT_ENTRY) ? "Entrée" : "Sortie";
+}
+
+// Champ CSV : entre guillemets s'il contient un séparateur, un guillemet ou un saut de ligne
+static void csv_field(chunk_writer_t* out, const char* value, bool last)
+{
+    if (strpbrk(value, ";\"\r\n") == NULL) {
+        chunk_write(out, value, strlen(value));
+    } else {
+        chunk_write(out, "\"", 1);
+        for (const char* quote; (quote = strchr(value, '"')) != NULL; value = quote + 1) {
+            chunk_write(out, value, (size_t)(quote - value) + 1);
+            chunk_write(out, "\"", 1);
+        }
+        chunk_write(out, value, strlen(value));
+        chunk_write(out, "\"", 1);
+    }
+    chunk_write(out, last ? "\r\n" : ";", last ? 2 : 1);
+}
+
+static void csv_begin(register_context_t* ctx)
+{
+    // BOM UTF-8 et séparateur point-virgule pour les tableurs configurés en français
+    chunk_write(&ctx->out, "\xEF\xBB\xBF", 3);
+    for (uint32_t c = 0; c < COLUMN_COUNT; c++) {
+        csv_field(&ctx->out, k_column_titles[c], c == COLUMN_COUNT - 1);
+    }
+}
+
+static void csv_row(register_context_t* ctx, const register_entry_t* entry)
+{
+    char date[16];
+    format_date(date, sizeof(date), entry->date);
+    
+    csv_field(&ctx->out, date, false);
+    csv_field(&ctx->out, movement_label(entry->movement), false);
+    csv_field(&ctx->out, entry->reason, false);
+    csv_field(&ctx->out, entry->species_name, false);
+    csv_field(&ctx->out, entry->identification, false);
+    csv_field(&ctx->out, entry->counterpart, false);
+    csv_field(&ctx->out, entry->document, true);
+}
+
+// Enregistre la position de l'objet suivant dans la table des références
+static uint32_t pdf_begin_object(register_context_t* ctx)
+{
+    char entry[PDF_XREF_ENTRY_SIZE + 1];
+    uint32_t number = ctx->pdf.next_object++;
+    
+    snprintf(entry, sizeof(entry), "%010" PRIu32 " 00000 n \n", ctx->out.offset);
+    if (fwrite(entry, 1, PDF_XREF_ENTRY_SIZE, ctx->pdf.xref) != PDF_XREF_ENTRY_SIZE) {
+        ctx->out.failed = true;
+    }
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "%" PRIu32 " 0 obj\n", number);
+    return number;
+}
+
+// Texte PDF : UTF-8 converti en WinAnsi, tronqué à max_chars caractères
+static void pdf_text(register_context_t* ctx, uint32_t x, int32_t y, const char* text, uint32_t max_chars)
+{
+    char* line = ctx->line;
+    size_t size = sizeof(ctx->line);
+    int length = snprintf(line, size, "BT /F1 %d Tf %" PRIu32 " %" PRId32 " Td (", PDF_FONT_SIZE, x, y);
+    size_t pos = (size_t)length;
+    const uint8_t* src = (const uint8_t*)text;
+    
+    for (uint32_t chars = 0; *src != '\0' && chars < max_chars && pos + 16 < size; chars++) {
+        uint32_t code = *src++;
+        if (code >= 0x80) {
+            // Séquences de deux octets jusqu'à U+00FF, tout autre caractère devient '?'
+            uint32_t extra = (code >= 0xF0) ? 3 : (code >= 0xE0) ? 2 : 1;
+            uint32_t value = code & (0x3F >> extra);
+            for (uint32_t i = 0; i < extra && (*src & 0xC0) == 0x80; i++) {
+                value = (value << 6) | (*src++ & 0x3F);
+            }
+            code = (extra == 1 && value >= 0xA0 && value <= 0xFF) ? value : '?';
+        }
+        if (code == '(' || code == ')' || code == '\\') {
+            line[pos++] = '\\';
+            line[pos++] = (char)code;
+        } else if (code >= 0x80) {
+            pos += (size_t)snprintf(&line[pos], size - pos, "\\%03" PRIo32, code);
+        } else if (code >= 0x20) {
+            line[pos++] = (char)code;
+        }
+    }
+    
+    pos += (size_t)snprintf(&line[pos], size - pos, ") Tj ET\n");
+    chunk_write(&ctx->out, line, pos);
+}
+
+static uint32_t column_chars(uint32_t column)
+{
+    return (uint32_t)((k_column_x[column + 1] - k_column_x[column]) / PDF_CHAR_WIDTH) - 1;
+}
+
+static void pdf_open_page(register_context_t* ctx)
+{
+    char page[32];
+    
+    pdf_begin_object(ctx);
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "<< /Length %" PRIu32 " 0 R >>\nstream\n",
+                 ctx->pdf.next_object);
+    ctx->pdf.content_start = ctx->out.offset;
+    ctx->pdf.page_count++;
+    
+    pdf_text(ctx, PDF_MARGIN, PDF_TOP_Y, "Registre d'entrées et de sorties des animaux", 80);
+    snprintf(page, sizeof(page), "Page %" PRIu32, ctx->pdf.page_count);
+    pdf_text(ctx, PDF_PAGE_WIDTH - PDF_MARGIN - 40, PDF_TOP_Y, page, 16);
+    for (uint32_t c = 0; c < COLUMN_COUNT; c++) {
+        pdf_text(ctx, k_column_x[c], PDF_TOP_Y - 2 * PDF_LINE_HEIGHT, k_column_titles[c], column_chars(c));
+    }
+    ctx->pdf.row_y = PDF_FIRST_ROW_Y;
+}
+
+// Ferme le flux de la page ouverte : sa longueur puis l'objet page
+static void pdf_close_page(register_context_t* ctx)
+{
+    uint32_t length = ctx->out.offset - ctx->pdf.content_start;
+    
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "endstream\nendobj\n");
+    pdf_begin_object(ctx);
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "%" PRIu32 "\nendobj\n", length);
+    pdf_begin_object(ctx);
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line),
+                 "<< /Type /Page /Parent %d 0 R /MediaBox [0 0 %d %d] "
+                 "/Resources << /Font << /F1 %d 0 R >> >> /Contents %" PRIu32 " 0 R >>\nendobj\n",
+                 PDF_OBJ_PAGES, PDF_PAGE_WIDTH, PDF_PAGE_HEIGHT, PDF_OBJ_FONT, ctx->pdf.next_object - 3);
+    ctx->pdf.row_y = 0;
+}
+
+static void pdf_begin(register_context_t* ctx)
+{
+    ctx->pdf.next_object = PDF_OBJ_FONT;
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "%%PDF-1.4\n%%\xE2\xE3\xCF\xD3\n");
+    pdf_begin_object(ctx);
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line),
+                 "<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>\nendobj\n");
+}
+
+static void pdf_row(register_context_t* ctx, const register_entry_t* entry)
+{
+    const char* values[COLUMN_COUNT];
+    char date[16];
+    
+    if (ctx->pdf.row_y < PDF_MARGIN) {
+        if (ctx->pdf.row_y != 0) {
+            pdf_close_page(ctx);
+        }
+        pdf_open_page(ctx);
+    }
+    
+    format_date(date, sizeof(date), entry->date);
+    values[0] = date;
+    values[1] = movement_label(entry->movement);
+    values[2] = entry->reason;
+    values[3] = entry->species_name;
+    values[4] = entry->identification;
+    values[5] = entry->counterpart;
+    values[6] = entry->document;
+    for (uint32_t c = 0; c < COLUMN_COUNT; c++) {
+        if (values[c][0] != '\0') {
+            pdf_text(ctx, k_column_x[c], ctx->pdf.row_y, values[c], column_chars(c));
+        }
+    }
+    ctx->pdf.row_y -= PDF_LINE_HEIGHT;
+}
+
+// Termine le document : arbre des pages, catalogue, table des références et fin de fichier
+static void pdf_end(register_context_t* ctx)
+{
+    if (ctx->pdf.page_count == 0) {
+        pdf_open_page(ctx);
+        pdf_text(ctx, PDF_MARGIN, PDF_FIRST_ROW_Y, "Aucun mouvement", 32);
+    }
+    if (ctx->pdf.row_y != 0) {
+        pdf_close_page(ctx);
+    }
+    
+    // Les pages occupent chacune trois objets à partir de PDF_OBJ_FIRST_PAGE
+    uint32_t pages_offset = ctx->out.offset;
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "%d 0 obj\n<< /Type /Pages /Count %" PRIu32 " /Kids [",
+                 PDF_OBJ_PAGES, ctx->pdf.page_count);
+    for (uint32_t p = 0; p < ctx->pdf.page_count; p++) {
+        chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), " %" PRIu32 " 0 R", PDF_OBJ_FIRST_PAGE + 3 * p + 2);
+    }
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), " ] >>\nendobj\n");
+    uint32_t catalog_offset = ctx->out.offset;
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line), "%d 0 obj\n<< /Type /Catalog /Pages %d 0 R >>\nendobj\n",
+                 PDF_OBJ_CATALOG, PDF_OBJ_PAGES);
+    
+    uint32_t xref_offset = ctx->out.offset;
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line),
+                 "xref\n0 %d\n0000000000 65535 f \n%010" PRIu32 " 00000 n \n%010" PRIu32 " 00000 n \n%d %" PRIu32 "\n",
+                 PDF_OBJ_FONT, pages_offset, catalog_offset, PDF_OBJ_FONT, ctx->pdf.next_object - PDF_OBJ_FONT);
+    
+    // Recopie des positions mises de côté, par blocs
+    rewind(ctx->pdf.xref);
+    size_t length;
+    while ((length = fread(ctx->line, 1, sizeof(ctx->line), ctx->pdf.xref)) > 0) {
+        chunk_write(&ctx->out, ctx->line, length);
+    }
+    
+    chunk_printf(&ctx->out, ctx->line, sizeof(ctx->line),
+                 "trailer\n<< /Size %" PRIu32 " /Root %d 0 R >>\nstartxref\n%" PRIu32 "\n%%%%EOF\n",
+                 ctx->pdf.next_object, PDF_OBJ_CATALOG, xref_offset);
+}
+
+// Recharge le lot d'une source à partir de sa dernière ligne émise
+static void refill(register_context_t* ctx, uint32_t source)
+{
+    register_batch_t* batch = &ctx->batches[source];
+    
+    if (batch->count > 0) {
+        batch->after_date = batch->entries[batch->count - 1].date;
+        batch->after_key = batch->entries[batch->count - 1].key;
+        batch->started = true;
+    }
+    batch->count = 0;
+    ctx->positions[source] = 0;
+    
+    g_sources[source](batch);
+    
+    // Un lot incomplet signifie que la source n'a plus rien à livrer
+    ctx->exhausted[source] = (batch->count < batch->max_count);
+}
+
+// Source dont la prochaine ligne est la plus ancienne (-1 quand toutes sont épuisées)
+static int32_t next_source(register_context_t* ctx)
+{
+    int32_t best = -1;
+    
+    for (uint32_t s = 0; s < REGISTER_SOURCE_COUNT; s++) {
+        if (g_sources[s] == NULL) {
+            continue;
+        }
+        if (ctx->positions[s] == ctx->batches[s].count) {
+            if (ctx->exhausted[s]) {
+                continue;
+            }
+            refill(ctx, s);
+            if (ctx->batches[s].count == 0) {
+                continue;
+            }
+        }
+        
+        const register_entry_t* entry = &ctx->entries[s][ctx->positions[s]];
+        if (best < 0 || entry->date < ctx->entries[best][ctx->positions[best]].date) {
+            best = (int32_t)s;
+        }
+    }
+    
+    return best;
+}
+
+system_error_t breeding_register_generate(const char* file_path, bool pdf, uint32_t* row_count)
+{
+    register_context_t* ctx = calloc(1, sizeof(register_context_t));
+    if (ctx == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    ctx->out.file = fopen(file_path, "wb");
+    if (ctx->out.file == NULL) {
+        free(ctx);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    // Les blocs de taille fixe sont écrits tels quels
+    setvbuf(ctx->out.file, NULL, _IONBF, 0);
+    
+    char xref_path[128];
+    snprintf(xref_path, sizeof(xref_path), "%s.xref", file_path);
+    if (pdf) {
+        ctx->pdf.xref = fopen(xref_path, "w+b");
+        if (ctx->pdf.xref == NULL) {
+            fclose(ctx->out.file);
+            remove(file_path);
+            free(ctx);
+            return SYSTEM_ERROR_STORAGE;
+        }
+    }
+    
+    for (uint32_t s = 0; s < REGISTER_SOURCE_COUNT; s++) {
+        ctx->batches[s].entries = ctx->entries[s];
+        ctx->batches[s].max_count = REGISTER_BATCH_SIZE;
+        ctx->exhausted[s] = false;
+    }
+    
+    if (pdf) {
+        pdf_begin(ctx);
+    } else {
+        csv_begin(ctx);
+    }
+    
+    uint32_t rows = 0;
+    for (int32_t s; !ctx->out.failed && (s = next_source(ctx)) >= 0; rows++) {
+        const register_entry_t* entry = &ctx->entries[s][ctx->positions[s]++];
+        if (pdf) {
+            pdf_row(ctx, entry);
+        } else {
+            csv_row(ctx, entry);
+        }
+    }
+    
+    if (pdf) {
+        pdf_end(ctx);
+        fclose(ctx->pdf.xref);
+        remove(xref_path);
+    }
+    chunk_flush(&ctx->out);
+    
+    bool failed = ctx->out.failed;
+    if (fclose(ctx->out.file) != 0) {
+        failed = true;
+    }
+    free(ctx);
+    
+    if (failed) {
+        ESP_LOGE(TAG, "Échec d'écriture du registre: %s", file_path);
+        remove(file_path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    *row_count = rows;
+    return SYSTEM_OK;
+}
\ No newline at end of file
@@ -1,9 +1,270 @@
-#include "regulatory_compliance.h"
+#include "cites_checker.h"
 #include "esp_log.h"
+#include <string.h>
+#include <inttypes.h>
 
 static const char* TAG = "CITES_CHECKER";
 
+#define MATCH_ALPHABET_SIZE     37    // a-z, 0-9 et espace après normalisation
+#define MATCH_MIN_LENGTH        4     // En deçà, aucune recherche approchée
+#define MATCH_WORD_PENALTY      10    // Confiance retirée par mot ignoré (sous-espèce, genre)
+
+// Repli des lettres latines accentuées U+00C0 à U+00FF, identique à LATIN1_FOLD de tools/gen_species_table.py
+static const char k_latin1_fold[] = "aaaaaaaceeeeiiiidnooooo ouuuuy saaaaaaaceeeeiiiidnooooo ouuuuy y";
+
+// Motif de la recherche approchée : masque des positions de chaque symbole dans le nom cherché
+typedef struct {
+    uint64_t peq[MATCH_ALPHABET_SIZE];
+    uint32_t length;
+    uint32_t letters;
+} match_pattern_t;
+
+// Minuscules sans accents, autres signes remplacés par des espaces réduits, comme tools/gen_species_table.py
+static void normalize_name(const char* name, char* key, size_t key_size)
+{
+    size_t length = 0;
+    bool space = false;
+    
+    for (const unsigned char* p = (const unsigned char*)name; *p != '\0' && length + 1 < key_size; p++) {
+        unsigned char c = *p;
+        char folded = ' ';
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            folded = (char)c;
+        } else if (c >= 'A' && c <= 'Z') {
+            folded = (char)(c - 'A' + 'a');
+        } else if (c == 0xC3 && (p[1] & 0xC0) == 0x80) {
+            // UTF-8 de U+00C0 à U+00FF
+            folded = k_latin1_fold[p[1] & 0x3F];
+            p++;
+        } else if (c >= 0xC0) {
+            // Autre caractère multi-octet : un seul espace pour toute la séquence
+            while ((p[1] & 0xC0) == 0x80) {
+                p++;
+            }
+        }
+        if (folded == ' ') {
+            space = (length > 0);
+            continue;
+        }
+        if (space) {
+            if (length + 2 >= key_size) {
+                break;
+            }
+            key[length++] = ' ';
+            space = false;
+        }
+        key[length++] = folded;
+    }
+    
+    key[length] = '\0';
+}
+
+// Un nom de genre suivi de "spp." ou "sp." désigne la règle du genre, comme dans la table
+static void strip_genus_suffix(char* key)
+{
+    static const char* const suffixes[] = { " spp", " sp" };
+    size_t length = strlen(key);
+    
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++) {
+        size_t suffix_length = strlen(suffixes[i]);
+        if (length > suffix_length && strcmp(key + length - suffix_length, suffixes[i]) == 0) {
+            key[length - suffix_length] = '\0';
+            return;
+        }
+    }
+}
+
+static uint32_t match_symbol(char c)
+{
+    if (c >= 'a' && c <= 'z') {
+        return (uint32_t)(c - 'a');
+    }
+    if (c >= '0' && c <= '9') {
+        return 26 + (uint32_t)(c - '0');
+    }
+    return 36;
+}
+
+uint32_t species_name_letters(const char* key)
+{
+    uint32_t letters = 0;
+    
+    for (const char* p = key; *p != '\0'; p++) {
+        if (*p >= 'a' && *p <= 'z') {
+            letters |= 1u << (*p - 'a');
+        }
+    }
+    
+    return letters;
+}
+
+static const species_name_t* find_name(const char* key)
+{
+    uint32_t low = 0;
+    uint32_t high = g_species_name_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        int cmp = strcmp(g_species_names[mid].key, key);
+        if (cmp == 0) {
+            return &g_species_names[mid];
+        }
+        if (cmp < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return NULL;
+}
+
+static void match_pattern_init(match_pattern_t* pattern, const char* key, uint32_t length)
+{
+    memset(pattern->peq, 0, sizeof(pattern->peq));
+    for (uint32_t i = 0; i < length; i++) {
+        pattern->peq[match_symbol(key[i])] |= (uint64_t)1 << i;
+    }
+    pattern->length = length;
+    pattern->letters = species_name_letters(key);
+}
+
+// Distance d'édition entre le motif et un nom, par l'algorithme bit-parallèle de Myers (une colonne
+// de la matrice par mot machine) ; au-delà de max_distance le calcul s'arrête et renvoie max_distance + 1
+static uint32_t match_distance(const match_pattern_t* pattern, const char* text, uint32_t text_length,
+                               uint32_t max_distance)
+{
+    uint64_t vp = ~(uint64_t)0;
+    uint64_t vn = 0;
+    uint64_t last = (uint64_t)1 << (pattern->length - 1);
+    uint32_t score = pattern->length;
+    
+    for (uint32_t j = 0; j < text_length; j++) {
+        uint64_t eq = pattern->peq[match_symbol(text[j])];
+        uint64_t xv = eq | vn;
+        uint64_t xh = (((eq & vp) + vp) ^ vp) | eq;
+        uint64_t ph = vn | ~(xh | vp);
+        uint64_t mh = vp & xh;
+        
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        // La distance finale ne peut baisser que d'une unité par caractère restant
+        if (score > max_distance + (text_length - j - 1)) {
+            return max_distance + 1;
+        }
+        
+        // Première ligne de la matrice : distance au préfixe vide croissante
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        vp = mh | ~(xv | ph);
+        vn = ph & xv;
+    }
+    
+    return (score > max_distance) ? max_distance + 1 : score;
+}
+
+// Nom le plus proche ; NULL si aucun n'est assez proche ou si deux espèces sont à égalité
+static const species_rule_t* find_closest(const char* key, uint8_t* confidence)
+{
+    uint32_t length = (uint32_t)strlen(key);
+    uint32_t max_distance = length * (100 - SPECIES_MATCH_MIN_CONFIDENCE) / 100;
+    
+    if (length < MATCH_MIN_LENGTH || length > 64 || max_distance == 0) {
+        return NULL;
+    }
+    
+    match_pattern_t pattern;
+    match_pattern_init(&pattern, key, length);
+    
+    const species_name_t* best = NULL;
+    uint32_t best_distance = max_distance;
+    bool ambiguous = false;
+    
+    for (uint32_t i = 0; i < g_species_name_count; i++) {
+        const species_name_t* name = &g_species_names[i];
+        uint32_t difference = (name->length > length) ? name->length - length : length - name->length;
+        if (difference > best_distance) {
+            continue;
+        }
+        
+        // Chaque lettre absente de l'un des noms coûte au moins une opération
+        uint32_t missing = (uint32_t)__builtin_popcount(pattern.letters & ~name->letters);
+        uint32_t extra = (uint32_t)__builtin_popcount(name->letters & ~pattern.letters);
+        if (missing > best_distance || extra > best_distance) {
+            continue;
+        }
+        
+        uint32_t distance = match_distance(&pattern, name->key, name->length, best_distance);
+        if (distance > best_distance) {
+            continue;
+        }
+        if (best == NULL || distance < best_distance) {
+            best = name;
+            best_distance = distance;
+            ambiguous = false;
+        } else if (name->species_id != best->species_id) {
+            ambiguous = true;
+        }
+    }
+    
+    if (best == NULL || ambiguous) {
+        return NULL;
+    }
+    
+    uint32_t longest = (best->length > length) ? best->length : length;
+    *confidence = (uint8_t)(100 * (longest - best_distance) / longest);
+    return &g_species_rules[best->species_id];
+}
+
 void cites_checker_init(void)
 {
-    ESP_LOGI(TAG, "Vérificateur CITES initialisé");
+    ESP_LOGI(TAG, "Vérificateur CITES initialisé: %" PRIu32 " espèces, %" PRIu32 " noms",
+             g_species_rule_count, g_species_name_count);
+}
+
+const species_rule_t* cites_checker_match(const char* species_name, uint8_t* confidence)
+{
+    char key[MAX_SPECIES_NAME_LEN];
+    const species_rule_t* rule = NULL;
+    uint8_t score = 100;
+    uint32_t dropped = 0;
+    
+    normalize_name(species_name, key, sizeof(key));
+    strip_genus_suffix(key);
+    
+    // Nom complet puis sans ses derniers mots (sous-espèce, puis genre)
+    while (key[0] != '\0') {
+        const species_name_t* name = find_name(key);
+        if (name != NULL) {
+            rule = &g_species_rules[name->species_id];
+            score = 100;
+            break;
+        }
+        rule = find_closest(key, &score);
+        if (rule != NULL) {
+            break;
+        }
+        
+        char* space = strrchr(key, ' ');
+        if (space == NULL) {
+            break;
+        }
+        *space = '\0';
+        dropped++;
+    }
+    
+    if (confidence != NULL) {
+        uint32_t penalty = dropped * MATCH_WORD_PENALTY;
+        *confidence = (rule == NULL) ? 0 : (uint8_t)((score > penalty) ? score - penalty : 0);
+    }
+    
+    return rule;
+}
+
+const species_rule_t* cites_checker_find(const char* species_name)
+{
+    return cites_checker_match(species_name, NULL);
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#ifndef CITES_CHECKER_H
+#define CITES_CHECKER_H
+
+#include "regulatory_compliance.h"
+
+// Règles applicables à une espèce
+#define SPECIES_RULE_PERMIT     0x01  // Permis ou certificat exigé pour l'acquisition
+#define SPECIES_RULE_BREEDING   0x02  // Reproduction autorisée
+#define SPECIES_RULE_TRADE      0x04  // Commerce autorisé
+
+// Entrée de la table générée depuis data/species_regulations.csv
+typedef struct {
+    const char* key;              // Nom scientifique normalisé (clé de tri, genre seul pour "spp.")
+    const char* scientific_name;
+    const char* common_name;
+    cites_level_t cites_level;
+    eu_annex_t eu_annex;
+    french_status_t french_status;
+    uint8_t flags;
+    const char* restrictions;
+} species_rule_t;
+
+// Nom recherchable : nom scientifique, nom commun ou synonyme (data/species_synonyms.csv)
+typedef struct {
+    const char* key;              // Nom normalisé
+    uint32_t letters;             // Ensemble des lettres du nom (voir species_name_letters)
+    uint16_t species_id;          // Indice de l'espèce dans g_species_rules
+    uint8_t length;
+} species_name_t;
+
+// Tables générées à la compilation (species_table.c)
+extern const species_rule_t g_species_rules[];      // Triée par clé
+extern const uint32_t g_species_rule_count;
+extern const species_name_t g_species_names[];      // Triée par nom normalisé
+extern const uint32_t g_species_name_count;
+extern const time_t g_species_table_date;           // Date des fichiers sources de la table
+
+/**
+ * @brief Ensemble des lettres d'un nom normalisé, pour écarter un nom sans calculer sa distance
+ * @param key Nom normalisé
+ * @return Bit i positionné si la lettre 'a' + i figure dans le nom
+ */
+uint32_t species_name_letters(const char* key);
+
+/**
+ * @brief Initialise le vérificateur CITES
+ */
+void cites_checker_init(void);
+
+/**
+ * @brief Reconnaît une espèce et évalue la confiance de la reconnaissance
+ *
+ * Le nom est comparé sans tenir compte de la casse, des accents ni de la ponctuation aux noms
+ * scientifiques, communs et synonymes. À défaut, le nom le plus proche est retenu si sa distance
+ * d'édition reste sous le seuil SPECIES_MATCH_MIN_CONFIDENCE et qu'aucune autre espèce n'est
+ * aussi proche. Sinon les derniers mots sont retirés un à un pour retrouver l'espèce d'une
+ * sous-espèce ou la règle du genre (10 points de confiance en moins par mot retiré).
+ *
+ * @param species_name Nom saisi
+ * @param confidence Confiance de 0 à 100 (100 : nom exact), peut être NULL
+ * @return Règles de l'espèce, NULL si elle n'est pas reconnue
+ */
+const species_rule_t* cites_checker_match(const char* species_name, uint8_t* confidence);
+
+/**
+ * @brief Recherche les règles d'une espèce (voir cites_checker_match)
+ * @param species_name Nom scientifique, commun ou synonyme
+ * @return Règles de l'espèce, NULL si elle n'est pas répertoriée
+ */
+const species_rule_t* cites_checker_find(const char* species_name);
+
+#endif // CITES_CHECKER_H
\ No newline at end of file
@@ -0,0 +1,587 @@
+#include "compliance_tracker.h"
+#include "cites_checker.h"
+#include "document_store.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char* TAG = "COMPLIANCE_TRACKER";
+
+#define PERMIT_NO_EXPIRY ((time_t)INT64_MAX)
+
+// Valeurs de l'attribut permis
+#define PERMIT_NONE     0
+#define PERMIT_VALID    1
+#define PERMIT_EXPIRED  2
+
+// Catégories qui rendent un sujet non conforme (une démarche en attente ne l'est pas)
+#define FAILING_CATEGORIES ((uint8_t)~RULE_CATEGORY_PENDING)
+
+// État suivi d'un animal : faits reçus et dernier résultat
+typedef struct {
+    uint32_t animal_id;
+    char species_name[MAX_SPECIES_NAME_LEN];
+    const species_rule_t* rule;
+    rule_facts_t facts;             // Faits fixes : espèce et éléments transmis
+    time_t permit_expiry;           // Expiration du permis valide le plus durable (0 si aucun)
+    time_t last_check;
+    uint32_t codes;                 // Codes de manquement relevés
+    uint16_t failed_transactions;   // Transactions non conformes de l'animal
+    uint8_t categories;
+    bool cites_subject;
+    bool evaluated;                 // Résultat compté dans les statistiques
+} tracked_animal_t;
+
+// Transaction suivie (les faits sont conservés pour réévaluer après un changement de règles)
+typedef struct {
+    uint32_t transaction_id;
+    uint32_t animal_id;
+    rule_facts_t facts;
+    uint32_t codes;
+    uint8_t categories;
+} tracked_transaction_t;
+
+static bool g_initialized = false;
+static SemaphoreHandle_t g_mutex = NULL;
+static rule_set_t g_rules;
+
+// Animaux triés par ID, et ensemble trié des animaux à réévaluer
+static tracked_animal_t g_animals[MAX_ANIMALS];
+static uint32_t g_animals_count = 0;
+static uint32_t g_dirty_ids[MAX_ANIMALS];
+static uint32_t g_dirty_count = 0;
+
+static tracked_transaction_t* g_transactions = NULL;  // En PSRAM, trié par ID
+static uint32_t g_transactions_count = 0;
+
+static compliance_stats_t g_stats;
+static time_t g_next_permit_expiry = PERMIT_NO_EXPIRY;  // Prochaine expiration pouvant changer un résultat
+
+static uint32_t animal_lower_bound(uint32_t animal_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_animals_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_animals[mid].animal_id < animal_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static tracked_animal_t* find_animal(uint32_t animal_id)
+{
+    uint32_t pos = animal_lower_bound(animal_id);
+    return (pos < g_animals_count && g_animals[pos].animal_id == animal_id) ? &g_animals[pos] : NULL;
+}
+
+static uint32_t dirty_lower_bound(uint32_t animal_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_dirty_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_dirty_ids[mid] < animal_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void dirty_set(uint32_t animal_id, bool dirty)
+{
+    uint32_t pos = dirty_lower_bound(animal_id);
+    bool present = (pos < g_dirty_count && g_dirty_ids[pos] == animal_id);
+    
+    if (dirty && !present && g_dirty_count < MAX_ANIMALS) {
+        memmove(&g_dirty_ids[pos + 1], &g_dirty_ids[pos], (g_dirty_count - pos) * sizeof(uint32_t));
+        g_dirty_ids[pos] = animal_id;
+        g_dirty_count++;
+    } else if (!dirty && present) {
+        memmove(&g_dirty_ids[pos], &g_dirty_ids[pos + 1], (g_dirty_count - pos - 1) * sizeof(uint32_t));
+        g_dirty_count--;
+    }
+}
+
+static uint32_t transaction_lower_bound(uint32_t transaction_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_transactions_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_transactions[mid].transaction_id < transaction_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static tracked_transaction_t* find_transaction(uint32_t transaction_id)
+{
+    uint32_t pos = transaction_lower_bound(transaction_id);
+    return (pos < g_transactions_count && g_transactions[pos].transaction_id == transaction_id) ?
+           &g_transactions[pos] : NULL;
+}
+
+static uint16_t count_failed_transactions(uint32_t animal_id)
+{
+    uint16_t count = 0;
+    
+    for (uint32_t i = 0; i < g_transactions_count; i++) {
+        if (g_transactions[i].animal_id == animal_id && (g_transactions[i].categories & FAILING_CATEGORIES)) {
+            count++;
+        }
+    }
+    
+    return count;
+}
+
+// Faits liés à l'espèce ; renvoie vrai si le sujet relève de la CITES
+static bool species_facts(const species_rule_t* rule, bool cites_declared, rule_facts_t* facts)
+{
+    bool cites_subject = cites_declared ||
+                         (rule != NULL && (rule->cites_level != CITES_NONE || (rule->flags & SPECIES_RULE_PERMIT)));
+    
+    // Une espèce non répertoriée relève du régime libre
+    rule_facts_set(facts, RULE_ATTR_CITES, (rule != NULL) ? rule->cites_level : CITES_NONE);
+    rule_facts_set(facts, RULE_ATTR_EU_ANNEX, (rule != NULL) ? rule->eu_annex : EU_ANNEX_NONE);
+    rule_facts_set(facts, RULE_ATTR_FRENCH_STATUS, (rule != NULL) ? rule->french_status : FRENCH_STATUS_FREE);
+    rule_facts_set(facts, RULE_ATTR_LISTED, rule != NULL);
+    rule_facts_set(facts, RULE_ATTR_SPECIES_PERMIT, rule != NULL && (rule->flags & SPECIES_RULE_PERMIT));
+    rule_facts_set(facts, RULE_ATTR_SPECIES_BREEDING, rule == NULL || (rule->flags & SPECIES_RULE_BREEDING));
+    rule_facts_set(facts, RULE_ATTR_SPECIES_TRADE, rule == NULL || (rule->flags & SPECIES_RULE_TRADE));
+    rule_facts_set(facts, RULE_ATTR_CITES_SUBJECT, cites_subject);
+    
+    return cites_subject;
+}
+
+// Ajoute (sign = 1) ou retire (sign = -1) la contribution d'un animal évalué aux statistiques
+static void apply_stats(const tracked_animal_t* animal, int32_t sign)
+{
+    g_stats.total_animals_checked += sign;
+    if (animal->categories & FAILING_CATEGORIES) {
+        g_stats.non_compliant_animals += sign;
+    } else {
+        g_stats.compliant_animals += sign;
+    }
+    if (animal->cites_subject) {
+        g_stats.cites_animals += sign;
+    }
+    if (animal->categories & RULE_CATEGORY_PERMIT_MISSING) {
+        g_stats.missing_permits += sign;
+    }
+    if (animal->categories & RULE_CATEGORY_PERMIT_EXPIRED) {
+        g_stats.expired_permits += sign;
+    }
+}
+
+static void evaluate_animal(tracked_animal_t* animal, time_t now)
+{
+    rule_facts_t facts = animal->facts;
+    uint32_t permit = (animal->permit_expiry == 0) ? PERMIT_NONE :
+                      (animal->permit_expiry <= now) ? PERMIT_EXPIRED : PERMIT_VALID;
+    rule_facts_set(&facts, RULE_ATTR_PERMIT, permit);
+    rule_facts_set(&facts, RULE_ATTR_FAILED_TRANSACTIONS, animal->failed_transactions > 0);
+    
+    if (animal->evaluated) {
+        apply_stats(animal, -1);
+    }
+    animal->codes = rule_set_evaluate(&g_rules, RULE_SUBJECT_ANIMAL, facts);
+    animal->categories = rule_set_categories(&g_rules, animal->codes);
+    animal->last_check = now;
+    animal->evaluated = true;
+    apply_stats(animal, 1);
+    
+    if (animal->permit_expiry > now && animal->permit_expiry < g_next_permit_expiry) {
+        g_next_permit_expiry = animal->permit_expiry;
+    }
+}
+
+// Marque les animaux dont un permis a expiré depuis le dernier passage
+static void mark_expired_permits(time_t now)
+{
+    if (now < g_next_permit_expiry) {
+        return;
+    }
+    
+    g_next_permit_expiry = PERMIT_NO_EXPIRY;
+    for (uint32_t i = 0; i < g_animals_count; i++) {
+        const tracked_animal_t* animal = &g_animals[i];
+        if (animal->permit_expiry == 0) {
+            continue;
+        }
+        if (animal->permit_expiry <= now) {
+            if (animal->last_check < animal->permit_expiry) {
+                dirty_set(animal->animal_id, true);
+            }
+        } else if (animal->permit_expiry < g_next_permit_expiry) {
+            g_next_permit_expiry = animal->permit_expiry;
+        }
+    }
+}
+
+static void process_locked(time_t now)
+{
+    mark_expired_permits(now);
+    
+    for (uint32_t i = 0; i < g_dirty_count; i++) {
+        tracked_animal_t* animal = find_animal(g_dirty_ids[i]);
+        if (animal != NULL) {
+            evaluate_animal(animal, now);
+        }
+    }
+    g_dirty_count = 0;
+}
+
+// Met à jour le compteur de transactions non conformes d'un animal et le marque à réévaluer
+static void adjust_failed(uint32_t animal_id, int32_t delta)
+{
+    tracked_animal_t* animal = find_animal(animal_id);
+    if (animal != NULL) {
+        animal->failed_transactions = (uint16_t)(animal->failed_transactions + delta);
+        dirty_set(animal_id, true);
+    }
+}
+
+// Répercute le changement de résultat d'une transaction sur les statistiques et son animal
+static void apply_transaction_change(uint32_t old_animal_id, uint8_t old_categories,
+                                     uint32_t new_animal_id, uint8_t new_categories)
+{
+    bool was_pending = (old_categories & RULE_CATEGORY_PENDING) != 0;
+    bool now_pending = (new_categories & RULE_CATEGORY_PENDING) != 0;
+    if (was_pending != now_pending) {
+        g_stats.pending_applications += now_pending ? 1 : -1;
+    }
+    
+    bool was_failed = (old_categories & FAILING_CATEGORIES) != 0;
+    bool now_failed = (new_categories & FAILING_CATEGORIES) != 0;
+    if (was_failed && (!now_failed || old_animal_id != new_animal_id)) {
+        adjust_failed(old_animal_id, -1);
+    }
+    if (now_failed && (!was_failed || old_animal_id != new_animal_id)) {
+        adjust_failed(new_animal_id, 1);
+    }
+}
+
+static void full_sweep_locked(time_t now)
+{
+    // Tout est recompté à partir des faits reçus
+    memset(&g_stats, 0, sizeof(g_stats));
+    for (uint32_t i = 0; i < g_transactions_count; i++) {
+        if (g_transactions[i].categories & RULE_CATEGORY_PENDING) {
+            g_stats.pending_applications++;
+        }
+    }
+    g_dirty_count = 0;
+    for (uint32_t i = 0; i < g_animals_count; i++) {
+        g_animals[i].evaluated = false;
+        g_animals[i].failed_transactions = count_failed_transactions(g_animals[i].animal_id);
+        g_dirty_ids[g_dirty_count++] = g_animals[i].animal_id;
+    }
+    g_next_permit_expiry = PERMIT_NO_EXPIRY;
+    process_locked(now);
+    g_stats.last_full_check = now;
+}
+
+system_error_t compliance_tracker_init(void)
+{
+    if (g_initialized) {
+        return SYSTEM_OK;
+    }
+    
+    g_transactions = heap_caps_calloc(MAX_TRANSACTIONS, sizeof(tracked_transaction_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_transactions == NULL) {
+        g_transactions = heap_caps_calloc(MAX_TRANSACTIONS, sizeof(tracked_transaction_t), MALLOC_CAP_8BIT);
+    }
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_transactions == NULL || g_mutex == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer le suivi de conformité");
+        heap_caps_free(g_transactions);
+        g_transactions = NULL;
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    rule_set_init(&g_rules);
+    g_animals_count = 0;
+    g_dirty_count = 0;
+    g_transactions_count = 0;
+    g_next_permit_expiry = PERMIT_NO_EXPIRY;
+    memset(&g_stats, 0, sizeof(g_stats));
+    
+    g_initialized = true;
+    ESP_LOGI(TAG, "Suivi de conformité initialisé");
+    
+    return SYSTEM_OK;
+}
+
+void compliance_tracker_set_rules(const rule_set_t* rules)
+{
+    if (!g_initialized || rules == NULL) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    memcpy(&g_rules, rules, sizeof(rule_set_t));
+    for (uint32_t i = 0; i < g_transactions_count; i++) {
+        tracked_transaction_t* transaction = &g_transactions[i];
+        transaction->codes = rule_set_evaluate(&g_rules, RULE_SUBJECT_TRANSACTION, transaction->facts);
+        transaction->categories = rule_set_categories(&g_rules, transaction->codes);
+    }
+    full_sweep_locked(time(NULL));
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_animal_changed(const compliance_animal_info_t* info)
+{
+    if (!g_initialized || info == NULL || info->animal_id == 0) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    uint32_t pos = animal_lower_bound(info->animal_id);
+    tracked_animal_t* animal = &g_animals[pos];
+    if (pos >= g_animals_count || animal->animal_id != info->animal_id) {
+        if (g_animals_count >= MAX_ANIMALS) {
+            xSemaphoreGive(g_mutex);
+            ESP_LOGW(TAG, "Suivi plein, animal ID=%" PRIu32 " ignoré", info->animal_id);
+            return;
+        }
+        memmove(&g_animals[pos + 1], &g_animals[pos], (g_animals_count - pos) * sizeof(tracked_animal_t));
+        g_animals_count++;
+        memset(animal, 0, sizeof(tracked_animal_t));
+        animal->animal_id = info->animal_id;
+        animal->failed_transactions = count_failed_transactions(info->animal_id);
+        animal->permit_expiry = document_store_permit_expiry(info->animal_id);
+        animal->rule = cites_checker_find(info->species_name);
+        snprintf(animal->species_name, sizeof(animal->species_name), "%s", info->species_name);
+    } else if (strncmp(animal->species_name, info->species_name, sizeof(animal->species_name) - 1) != 0) {
+        // L'espèce n'est recherchée dans la table que si elle change
+        animal->rule = cites_checker_find(info->species_name);
+        memset(animal->species_name, 0, sizeof(animal->species_name));
+        snprintf(animal->species_name, sizeof(animal->species_name), "%s", info->species_name);
+    }
+    
+    animal->facts = 0;
+    animal->cites_subject = species_facts(animal->rule, info->cites_declared, &animal->facts);
+    rule_facts_set(&animal->facts, RULE_ATTR_ANIMAL_STATUS, info->status);
+    rule_facts_set(&animal->facts, RULE_ATTR_CITES_NUMBER, info->has_cites_number);
+    dirty_set(info->animal_id, true);
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_animal_removed(uint32_t animal_id)
+{
+    if (!g_initialized) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    uint32_t pos = animal_lower_bound(animal_id);
+    if (pos < g_animals_count && g_animals[pos].animal_id == animal_id) {
+        if (g_animals[pos].evaluated) {
+            apply_stats(&g_animals[pos], -1);
+        }
+        memmove(&g_animals[pos], &g_animals[pos + 1], (g_animals_count - pos - 1) * sizeof(tracked_animal_t));
+        g_animals_count--;
+    }
+    dirty_set(animal_id, false);
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_transaction_changed(const compliance_transaction_info_t* info)
+{
+    if (!g_initialized || info == NULL) {
+        return;
+    }
+    
+    rule_facts_t facts = 0;
+    species_facts(cites_checker_find(info->species_name), info->cites_required, &facts);
+    rule_facts_set(&facts, RULE_ATTR_TRANSACTION_TYPE, info->type);
+    rule_facts_set(&facts, RULE_ATTR_TRANSACTION_STATUS, info->status);
+    rule_facts_set(&facts, RULE_ATTR_PERMIT_NUMBER, info->has_permit_number);
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    uint32_t pos = transaction_lower_bound(info->transaction_id);
+    tracked_transaction_t* transaction = &g_transactions[pos];
+    tracked_transaction_t previous = { 0 };
+    if (pos < g_transactions_count && transaction->transaction_id == info->transaction_id) {
+        previous = *transaction;
+    } else if (g_transactions_count < MAX_TRANSACTIONS) {
+        memmove(&g_transactions[pos + 1], &g_transactions[pos],
+                (g_transactions_count - pos) * sizeof(tracked_transaction_t));
+        g_transactions_count++;
+    } else {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGW(TAG, "Suivi plein, transaction ID=%" PRIu32 " ignorée", info->transaction_id);
+        return;
+    }
+    
+    transaction->transaction_id = info->transaction_id;
+    transaction->animal_id = info->animal_id;
+    transaction->facts = facts;
+    transaction->codes = rule_set_evaluate(&g_rules, RULE_SUBJECT_TRANSACTION, facts);
+    transaction->categories = rule_set_categories(&g_rules, transaction->codes);
+    apply_transaction_change(previous.animal_id, previous.categories, transaction->animal_id, transaction->categories);
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_transaction_removed(uint32_t transaction_id)
+{
+    if (!g_initialized) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    uint32_t pos = transaction_lower_bound(transaction_id);
+    if (pos < g_transactions_count && g_transactions[pos].transaction_id == transaction_id) {
+        apply_transaction_change(g_transactions[pos].animal_id, g_transactions[pos].categories, 0, 0);
+        memmove(&g_transactions[pos], &g_transactions[pos + 1],
+                (g_transactions_count - pos - 1) * sizeof(tracked_transaction_t));
+        g_transactions_count--;
+    }
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_permit_issued(uint32_t animal_id)
+{
+    if (!g_initialized) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    // Relue du magasin : un renouvellement remplace les anciens permis et peut avancer l'expiration
+    tracked_animal_t* animal = find_animal(animal_id);
+    if (animal != NULL) {
+        time_t expiry = document_store_permit_expiry(animal_id);
+        if (expiry != animal->permit_expiry) {
+            animal->permit_expiry = expiry;
+            dirty_set(animal_id, true);
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_process(time_t now)
+{
+    if (!g_initialized) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    process_locked(now);
+    xSemaphoreGive(g_mutex);
+}
+
+void compliance_tracker_full_sweep(time_t now)
+{
+    if (!g_initialized) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    full_sweep_locked(now);
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Vérification complète: %" PRIu32 " animaux, %" PRIu32 " non conformes",
+             g_stats.total_animals_checked, g_stats.non_compliant_animals);
+}
+
+system_error_t compliance_tracker_get_animal(uint32_t animal_id, compliance_check_t* check)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    process_locked(time(NULL));
+    const tracked_animal_t* animal = find_animal(animal_id);
+    if (animal == NULL) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    memset(check, 0, sizeof(compliance_check_t));
+    check->animal_id = animal_id;
+    snprintf(check->species_name, sizeof(check->species_name), "%s", animal->species_name);
+    check->is_compliant = !(animal->categories & FAILING_CATEGORIES);
+    check->requires_cites = animal->cites_subject;
+    check->has_valid_permits = !(animal->categories & (RULE_CATEGORY_PERMIT_MISSING | RULE_CATEGORY_PERMIT_EXPIRED));
+    check->breeding_compliant = !(animal->categories & RULE_CATEGORY_BREEDING);
+    check->sale_compliant = !(animal->categories & RULE_CATEGORY_TRADE);
+    check->last_check = animal->last_check;
+    rule_set_describe(&g_rules, animal->codes, check->violations, sizeof(check->violations));
+    
+    xSemaphoreGive(g_mutex);
+    return SYSTEM_OK;
+}
+
+void compliance_tracker_get_transaction(uint32_t transaction_id, bool* is_compliant,
+                                        char* violations, size_t violations_size)
+{
+    uint32_t codes = 0;
+    uint8_t categories = 0;
+    
+    if (violations != NULL && violations_size > 0) {
+        violations[0] = '\0';
+    }
+    if (!g_initialized) {
+        *is_compliant = true;
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    const tracked_transaction_t* transaction = find_transaction(transaction_id);
+    if (transaction != NULL) {
+        codes = transaction->codes;
+        categories = transaction->categories;
+    }
+    if (violations != NULL && violations_size > 0) {
+        rule_set_describe(&g_rules, codes, violations, violations_size);
+    }
+    xSemaphoreGive(g_mutex);
+    
+    *is_compliant = !(categories & FAILING_CATEGORIES);
+}
+
+void compliance_tracker_get_stats(compliance_stats_t* stats)
+{
+    if (!g_initialized) {
+        memset(stats, 0, sizeof(compliance_stats_t));
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    process_locked(time(NULL));
+    *stats = g_stats;
+    xSemaphoreGive(g_mutex);
+}
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef COMPLIANCE_TRACKER_H
+#define COMPLIANCE_TRACKER_H
+
+#include "regulatory_compliance.h"
+#include "rule_engine.h"
+
+/**
+ * @brief Initialise le suivi incrémental de la conformité
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t compliance_tracker_init(void);
+
+/**
+ * @brief Remplace les règles actives puis réévalue tous les animaux et transactions suivis
+ * @param rules Règles compilées (copiées)
+ */
+void compliance_tracker_set_rules(const rule_set_t* rules);
+
+/**
+ * @brief Enregistre l'état d'un animal et le marque à réévaluer
+ * @param info Éléments de conformité de l'animal
+ */
+void compliance_tracker_animal_changed(const compliance_animal_info_t* info);
+
+/**
+ * @brief Retire un animal du suivi et des statistiques
+ * @param animal_id ID de l'animal
+ */
+void compliance_tracker_animal_removed(uint32_t animal_id);
+
+/**
+ * @brief Évalue une transaction et marque son animal à réévaluer
+ * @param info Éléments de conformité de la transaction
+ */
+void compliance_tracker_transaction_changed(const compliance_transaction_info_t* info);
+
+/**
+ * @brief Retire une transaction du suivi
+ * @param transaction_id ID de la transaction
+ */
+void compliance_tracker_transaction_removed(uint32_t transaction_id);
+
+/**
+ * @brief Prend en compte un permis délivré pour un animal
+ *
+ * L'expiration suivie est recalculée à partir des permis valides du magasin de documents.
+ *
+ * @param animal_id ID de l'animal
+ */
+void compliance_tracker_permit_issued(uint32_t animal_id);
+
+/**
+ * @brief Réévalue les animaux modifiés et ceux dont un permis vient d'expirer
+ * @param now Date de référence
+ */
+void compliance_tracker_process(time_t now);
+
+/**
+ * @brief Réévalue tous les animaux et recalcule les statistiques depuis zéro (filet de sécurité)
+ * @param now Date de référence
+ */
+void compliance_tracker_full_sweep(time_t now);
+
+/**
+ * @brief Récupère le dernier résultat d'un animal (après traitement des modifications)
+ * @param animal_id ID de l'animal
+ * @param check Résultat à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si l'animal n'est pas suivi
+ */
+system_error_t compliance_tracker_get_animal(uint32_t animal_id, compliance_check_t* check);
+
+/**
+ * @brief Récupère le résultat d'une transaction
+ * @param transaction_id ID de la transaction
+ * @param is_compliant Résultat de conformité (vrai si la transaction n'a aucun manquement connu)
+ * @param violations Buffer pour les manquements détectés (peut être NULL)
+ * @param violations_size Taille du buffer de manquements
+ */
+void compliance_tracker_get_transaction(uint32_t transaction_id, bool* is_compliant,
+                                        char* violations, size_t violations_size);
+
+/**
+ * @brief Récupère les statistiques tenues à jour
+ * @param stats Statistiques à remplir
+ */
+void compliance_tracker_get_stats(compliance_stats_t* stats);
+
+#endif // COMPLIANCE_TRACKER_H
\ No newline at end of file
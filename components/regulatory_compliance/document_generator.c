@@ -1,9 +1,121 @@
-#include "regulatory_compliance.h"
+#include "document_generator.h"
 #include "esp_log.h"
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
 
 static const char* TAG = "DOCUMENT_GENERATOR";
 
-void document_generator_init(void)
+// Champs disponibles dans les modèles de documents
+typedef enum {
+    DOC_FIELD_NUMBER,
+    DOC_FIELD_TITLE,
+    DOC_FIELD_ISSUE_DATE,
+    DOC_FIELD_EXPIRY_DATE,
+    DOC_FIELD_ANIMAL_ID,
+    DOC_FIELD_TRANSACTION_ID,
+    DOC_FIELD_AUTHORITY,
+    DOC_FIELD_COUNT
+} document_field_t;
+
+static const char* const k_field_names[DOC_FIELD_COUNT] = {
+    "numero",
+    "titre",
+    "date_emission",
+    "date_expiration",
+    "animal_id",
+    "transaction_id",
+    "autorite"
+};
+
+#define DOCUMENT_TYPE_COUNT 6
+
+static const char* const k_titles[DOCUMENT_TYPE_COUNT] = {
+    "Registre d'entrées et de sorties des animaux",
+    "Attestation de cession - Acquisition",
+    "Attestation de cession - Vente",
+    "Permis CITES",
+    "Certificat sanitaire",
+    "Autorisation de transport"
+};
+
+static const char* const k_sources[DOCUMENT_TYPE_COUNT] = {
+    "{{titre}}\nN° {{numero}} - établi le {{date_emission}}\nAutorité: {{autorite}}\n",
+    "{{titre}}\nN° {{numero}} - établi le {{date_emission}}\n"
+    "Animal n° {{animal_id}} acquis par la transaction n° {{transaction_id}}\n"
+    "Autorité: {{autorite}}\n",
+    "{{titre}}\nN° {{numero}} - établi le {{date_emission}}\n"
+    "Animal n° {{animal_id}} cédé par la transaction n° {{transaction_id}}\n"
+    "Autorité: {{autorite}}\n",
+    "{{titre}}\nN° {{numero}} - délivré le {{date_emission}}, valable jusqu'au {{date_expiration}}\n"
+    "Animal n° {{animal_id}}\nAutorité de délivrance: {{autorite}}\n",
+    "{{titre}}\nN° {{numero}} - établi le {{date_emission}}, valable jusqu'au {{date_expiration}}\n"
+    "Animal n° {{animal_id}}\nVétérinaire: {{autorite}}\n",
+    "{{titre}}\nN° {{numero}} - délivrée le {{date_emission}}, valable jusqu'au {{date_expiration}}\n"
+    "Animal n° {{animal_id}}, transaction n° {{transaction_id}}\nAutorité: {{autorite}}\n"
+};
+
+// Modèles compilés une seule fois à l'initialisation
+static document_template_t g_templates[DOCUMENT_TYPE_COUNT];
+static bool g_templates_ready = false;
+
+static void format_date(char* buffer, size_t size, time_t date)
+{
+    if (date == 0) {
+        buffer[0] = '\0';
+        return;
+    }
+    
+    struct tm date_tm;
+    localtime_r(&date, &date_tm);
+    strftime(buffer, size, "%d/%m/%Y", &date_tm);
+}
+
+system_error_t document_generator_init(void)
 {
+    for (uint32_t i = 0; i < DOCUMENT_TYPE_COUNT; i++) {
+        system_error_t ret = document_template_compile(&g_templates[i], k_sources[i], k_field_names, DOC_FIELD_COUNT);
+        if (ret != SYSTEM_OK) {
+            ESP_LOGE(TAG, "Modèle de document %" PRIu32 " invalide", i);
+            return ret;
+        }
+    }
+    
+    g_templates_ready = true;
     ESP_LOGI(TAG, "Générateur de documents initialisé");
+    
+    return SYSTEM_OK;
+}
+
+system_error_t document_generator_render(const regulatory_document_t* document, const document_sink_t* sink)
+{
+    if (!g_templates_ready || document == NULL || sink == NULL || (uint32_t)document->type >= DOCUMENT_TYPE_COUNT) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    char issue_date[16];
+    char expiry_date[16];
+    char animal_id[12] = "";
+    char transaction_id[12] = "";
+    
+    format_date(issue_date, sizeof(issue_date), document->issue_date);
+    format_date(expiry_date, sizeof(expiry_date), document->expiry_date);
+    if (document->animal_id != 0) {
+        snprintf(animal_id, sizeof(animal_id), "%" PRIu32, document->animal_id);
+    }
+    if (document->transaction_id != 0) {
+        snprintf(transaction_id, sizeof(transaction_id), "%" PRIu32, document->transaction_id);
+    }
+    
+    const char* values[DOC_FIELD_COUNT] = {
+        [DOC_FIELD_NUMBER] = document->document_number,
+        [DOC_FIELD_TITLE] = k_titles[document->type],
+        [DOC_FIELD_ISSUE_DATE] = issue_date,
+        [DOC_FIELD_EXPIRY_DATE] = expiry_date,
+        [DOC_FIELD_ANIMAL_ID] = animal_id,
+        [DOC_FIELD_TRANSACTION_ID] = transaction_id,
+        [DOC_FIELD_AUTHORITY] = document->issuing_authority
+    };
+    
+    return document_template_render(&g_templates[document->type], values, sink);
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#ifndef DOCUMENT_GENERATOR_H
+#define DOCUMENT_GENERATOR_H
+
+#include "regulatory_compliance.h"
+
+/**
+ * @brief Compile les modèles des documents réglementaires
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t document_generator_init(void);
+
+/**
+ * @brief Produit le texte d'un document réglementaire vers une destination
+ * @param document Document à produire
+ * @param sink Destination du rendu
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t document_generator_render(const regulatory_document_t* document, const document_sink_t* sink);
+
+#endif // DOCUMENT_GENERATOR_H
\ No newline at end of file
@@ -0,0 +1,619 @@
+#include "document_store.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+static const char* TAG = "DOCUMENT_STORE";
+
+#define STORE_MAGIC         0x434F4452u  // "RDOC"
+#define STORE_MAX_PAYLOAD   1536
+#define PERMIT_NO_EXPIRY    ((time_t)INT64_MAX)
+
+// Types d'enregistrements du fichier
+typedef enum {
+    STORE_RECORD_DOCUMENT,      // Document complet
+    STORE_RECORD_STATUS         // Changement de validité d'un document déjà enregistré
+} store_record_type_t;
+
+// En-tête d'un enregistrement, suivi de la charge utile puis du CRC32 de l'ensemble
+typedef struct {
+    uint32_t magic;
+    uint8_t type;
+    uint8_t reserved;
+    uint16_t length;
+} store_record_header_t;
+
+// Entrée des index par animal et par transaction (triés par clé puis par ID)
+typedef struct {
+    uint32_t key;
+    uint32_t document_id;
+} document_key_entry_t;
+
+// Entrée de l'index des expirations (trié par date puis par ID)
+typedef struct {
+    time_t expiry_date;
+    uint32_t document_id;
+} document_expiry_entry_t;
+
+// Variables globales
+static SemaphoreHandle_t g_mutex = NULL;
+static char g_path[64];
+static FILE* g_file = NULL;                     // Ouvert en ajout et lecture
+static long g_file_size = 0;
+static document_header_t* g_headers = NULL;     // En PSRAM, trié par ID croissant
+static uint32_t g_count = 0;
+static document_key_entry_t* g_by_animal = NULL;
+static uint32_t g_by_animal_count = 0;
+static document_key_entry_t* g_by_transaction = NULL;
+static uint32_t g_by_transaction_count = 0;
+static document_expiry_entry_t* g_by_expiry = NULL;
+static uint32_t g_by_expiry_count = 0;
+static uint8_t g_frame[sizeof(store_record_header_t) + STORE_MAX_PAYLOAD + sizeof(uint32_t)];
+static regulatory_document_t g_document;        // Document en cours de décodage (relecture)
+
+static void* alloc_table(size_t count, size_t size)
+{
+    void* table = heap_caps_calloc(count, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (table == NULL) {
+        table = heap_caps_calloc(count, size, MALLOC_CAP_8BIT);
+    }
+    return table;
+}
+
+static int32_t find_header_index(uint32_t document_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_headers[mid].id < document_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    if (low < g_count && g_headers[low].id == document_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+// Première position dont l'entrée n'est pas strictement inférieure à (key, document_id)
+static uint32_t key_lower_bound(const document_key_entry_t* index, uint32_t count, uint32_t key, uint32_t document_id)
+{
+    uint32_t low = 0;
+    uint32_t high = count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (index[mid].key < key || (index[mid].key == key && index[mid].document_id < document_id)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void key_insert(document_key_entry_t* index, uint32_t* count, uint32_t key, uint32_t document_id)
+{
+    if (key == 0) {
+        return;
+    }
+    
+    uint32_t pos = key_lower_bound(index, *count, key, document_id);
+    memmove(&index[pos + 1], &index[pos], (*count - pos) * sizeof(document_key_entry_t));
+    index[pos].key = key;
+    index[pos].document_id = document_id;
+    (*count)++;
+}
+
+static uint32_t expiry_lower_bound(time_t date, uint32_t document_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_by_expiry_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_by_expiry[mid].expiry_date < date ||
+            (g_by_expiry[mid].expiry_date == date && g_by_expiry[mid].document_id < document_id)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+// Seuls les documents valides à durée limitée figurent dans l'index des expirations
+static void expiry_set(const document_header_t* header, bool present)
+{
+    if (header->expiry_date == 0) {
+        return;
+    }
+    
+    uint32_t pos = expiry_lower_bound(header->expiry_date, header->id);
+    bool found = (pos < g_by_expiry_count && g_by_expiry[pos].document_id == header->id &&
+                  g_by_expiry[pos].expiry_date == header->expiry_date);
+    
+    if (present && !found) {
+        memmove(&g_by_expiry[pos + 1], &g_by_expiry[pos], (g_by_expiry_count - pos) * sizeof(document_expiry_entry_t));
+        g_by_expiry[pos].expiry_date = header->expiry_date;
+        g_by_expiry[pos].document_id = header->id;
+        g_by_expiry_count++;
+    } else if (!present && found) {
+        memmove(&g_by_expiry[pos], &g_by_expiry[pos + 1], (g_by_expiry_count - pos - 1) * sizeof(document_expiry_entry_t));
+        g_by_expiry_count--;
+    }
+}
+
+static size_t put_bytes(size_t pos, const void* data, size_t length)
+{
+    memcpy(&g_frame[sizeof(store_record_header_t) + pos], data, length);
+    return pos + length;
+}
+
+static size_t put_string(size_t pos, const char* str, size_t max_len)
+{
+    uint16_t length = (uint16_t)strnlen(str, max_len - 1);
+    pos = put_bytes(pos, &length, sizeof(length));
+    return put_bytes(pos, str, length);
+}
+
+static bool get_bytes(const uint8_t* payload, size_t length, size_t* pos, void* data, size_t size)
+{
+    if (*pos + size > length) {
+        return false;
+    }
+    memcpy(data, payload + *pos, size);
+    *pos += size;
+    return true;
+}
+
+static bool get_string(const uint8_t* payload, size_t length, size_t* pos, char* dst, size_t size)
+{
+    uint16_t str_length;
+    if (!get_bytes(payload, length, pos, &str_length, sizeof(str_length)) || str_length >= size ||
+        *pos + str_length > length) {
+        return false;
+    }
+    memcpy(dst, payload + *pos, str_length);
+    dst[str_length] = '\0';
+    *pos += str_length;
+    return true;
+}
+
+static size_t encode_document(const regulatory_document_t* document)
+{
+    int64_t dates[2] = { document->issue_date, document->expiry_date };
+    uint8_t type = (uint8_t)document->type;
+    size_t pos = 0;
+    
+    pos = put_bytes(pos, &document->id, sizeof(document->id));
+    pos = put_bytes(pos, &type, sizeof(type));
+    pos = put_bytes(pos, &document->animal_id, sizeof(document->animal_id));
+    pos = put_bytes(pos, &document->transaction_id, sizeof(document->transaction_id));
+    pos = put_bytes(pos, dates, sizeof(dates));
+    pos = put_bytes(pos, &document->is_valid, sizeof(document->is_valid));
+    pos = put_string(pos, document->document_number, sizeof(document->document_number));
+    pos = put_string(pos, document->issuing_authority, sizeof(document->issuing_authority));
+    pos = put_string(pos, document->content, sizeof(document->content));
+    pos = put_string(pos, document->file_path, sizeof(document->file_path));
+    
+    return pos;
+}
+
+static bool decode_document(const uint8_t* payload, size_t length, regulatory_document_t* document)
+{
+    int64_t dates[2];
+    uint8_t type;
+    size_t pos = 0;
+    bool ok = true;
+    
+    memset(document, 0, sizeof(regulatory_document_t));
+    ok = ok && get_bytes(payload, length, &pos, &document->id, sizeof(document->id));
+    ok = ok && get_bytes(payload, length, &pos, &type, sizeof(type));
+    ok = ok && get_bytes(payload, length, &pos, &document->animal_id, sizeof(document->animal_id));
+    ok = ok && get_bytes(payload, length, &pos, &document->transaction_id, sizeof(document->transaction_id));
+    ok = ok && get_bytes(payload, length, &pos, dates, sizeof(dates));
+    ok = ok && get_bytes(payload, length, &pos, &document->is_valid, sizeof(document->is_valid));
+    ok = ok && get_string(payload, length, &pos, document->document_number, sizeof(document->document_number));
+    ok = ok && get_string(payload, length, &pos, document->issuing_authority, sizeof(document->issuing_authority));
+    ok = ok && get_string(payload, length, &pos, document->content, sizeof(document->content));
+    ok = ok && get_string(payload, length, &pos, document->file_path, sizeof(document->file_path));
+    if (!ok) {
+        return false;
+    }
+    
+    document->type = (document_type_t)type;
+    document->issue_date = (time_t)dates[0];
+    document->expiry_date = (time_t)dates[1];
+    
+    return true;
+}
+
+// Termine l'enregistrement préparé dans g_frame et l'ajoute au fichier ; renvoie sa position
+static system_error_t append_frame(store_record_type_t type, size_t length, uint32_t* offset)
+{
+    if (g_file == NULL) {
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    store_record_header_t header = {
+        .magic = STORE_MAGIC,
+        .type = (uint8_t)type,
+        .reserved = 0,
+        .length = (uint16_t)length
+    };
+    memcpy(g_frame, &header, sizeof(header));
+    uint32_t crc = esp_rom_crc32_le(0, g_frame, sizeof(header) + length);
+    memcpy(&g_frame[sizeof(header) + length], &crc, sizeof(crc));
+    size_t size = sizeof(header) + length + sizeof(crc);
+    
+    if (fseek(g_file, 0, SEEK_END) != 0 || fwrite(g_frame, 1, size, g_file) != size ||
+        fflush(g_file) != 0 || fsync(fileno(g_file)) != 0) {
+        ESP_LOGE(TAG, "Écriture du magasin de documents impossible");
+        // Retirer l'écriture partielle : un enregistrement ajouté après elle serait perdu à la relecture
+        clearerr(g_file);
+        if (ftruncate(fileno(g_file), g_file_size) != 0) {
+            ESP_LOGE(TAG, "Impossible de tronquer le magasin de documents, écritures suspendues");
+            fclose(g_file);
+            g_file = NULL;
+        }
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    *offset = (uint32_t)g_file_size;
+    g_file_size += (long)size;
+    return SYSTEM_OK;
+}
+
+// Lit l'enregistrement situé à offset dans g_frame ; renvoie le type et la taille de la charge utile
+static bool read_frame(FILE* file, long offset, uint8_t* type, size_t* length)
+{
+    store_record_header_t header;
+    
+    if (fseek(file, offset, SEEK_SET) != 0 || fread(&header, 1, sizeof(header), file) != sizeof(header) ||
+        header.magic != STORE_MAGIC || header.length > STORE_MAX_PAYLOAD) {
+        return false;
+    }
+    
+    size_t rest = (size_t)header.length + sizeof(uint32_t);
+    memcpy(g_frame, &header, sizeof(header));
+    if (fread(&g_frame[sizeof(header)], 1, rest, file) != rest) {
+        return false;
+    }
+    
+    uint32_t crc;
+    memcpy(&crc, &g_frame[sizeof(header) + header.length], sizeof(crc));
+    if (crc != esp_rom_crc32_le(0, g_frame, sizeof(header) + header.length)) {
+        return false;
+    }
+    
+    *type = header.type;
+    *length = header.length;
+    return true;
+}
+
+static const uint8_t* frame_payload(void)
+{
+    return &g_frame[sizeof(store_record_header_t)];
+}
+
+// Un document n'est indexé que s'il reste de la place et que son ID suit le dernier enregistré
+static bool can_index(const regulatory_document_t* document)
+{
+    return g_count < REGULATORY_MAX_DOCUMENTS && (g_count == 0 || document->id > g_headers[g_count - 1].id);
+}
+
+// Ajoute l'en-tête d'un document et l'inscrit dans les index
+static bool index_document(const regulatory_document_t* document, uint32_t offset)
+{
+    if (!can_index(document)) {
+        return false;
+    }
+    
+    document_header_t* header = &g_headers[g_count++];
+    memset(header, 0, sizeof(document_header_t));
+    header->id = document->id;
+    header->animal_id = document->animal_id;
+    header->transaction_id = document->transaction_id;
+    header->issue_date = document->issue_date;
+    header->expiry_date = document->expiry_date;
+    header->offset = offset;
+    header->type = (uint8_t)document->type;
+    header->is_valid = document->is_valid;
+    snprintf(header->document_number, sizeof(header->document_number), "%s", document->document_number);
+    
+    key_insert(g_by_animal, &g_by_animal_count, header->animal_id, header->id);
+    key_insert(g_by_transaction, &g_by_transaction_count, header->transaction_id, header->id);
+    if (header->is_valid) {
+        expiry_set(header, true);
+    }
+    return true;
+}
+
+static void apply_status(document_header_t* header, bool is_valid)
+{
+    if (header->is_valid != is_valid) {
+        header->is_valid = is_valid;
+        expiry_set(header, is_valid);
+    }
+}
+
+// Relit le fichier ; renvoie la position de fin du dernier enregistrement intact
+static long load_file(FILE* file)
+{
+    long offset = 0;
+    uint8_t type;
+    size_t length;
+    
+    while (read_frame(file, offset, &type, &length)) {
+        const uint8_t* payload = frame_payload();
+        if (type == STORE_RECORD_DOCUMENT) {
+            if (decode_document(payload, length, &g_document) && !index_document(&g_document, (uint32_t)offset)) {
+                ESP_LOGW(TAG, "Document ID=%" PRIu32 " ignoré", g_document.id);
+            }
+        } else if (type == STORE_RECORD_STATUS && length == sizeof(uint32_t) + sizeof(bool)) {
+            uint32_t document_id;
+            bool is_valid;
+            memcpy(&document_id, payload, sizeof(document_id));
+            memcpy(&is_valid, payload + sizeof(document_id), sizeof(is_valid));
+            int32_t index = find_header_index(document_id);
+            if (index >= 0) {
+                apply_status(&g_headers[index], is_valid);
+            }
+        }
+        offset += (long)(sizeof(store_record_header_t) + length + sizeof(uint32_t));
+    }
+    
+    return offset;
+}
+
+system_error_t document_store_init(const char* path)
+{
+    if (path == NULL || strlen(path) >= sizeof(g_path)) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    g_headers = alloc_table(REGULATORY_MAX_DOCUMENTS, sizeof(document_header_t));
+    g_by_animal = alloc_table(REGULATORY_MAX_DOCUMENTS, sizeof(document_key_entry_t));
+    g_by_transaction = alloc_table(REGULATORY_MAX_DOCUMENTS, sizeof(document_key_entry_t));
+    g_by_expiry = alloc_table(REGULATORY_MAX_DOCUMENTS, sizeof(document_expiry_entry_t));
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_headers == NULL || g_by_animal == NULL || g_by_transaction == NULL || g_by_expiry == NULL || g_mutex == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer les index des documents");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    snprintf(g_path, sizeof(g_path), "%s", path);
+    
+    FILE* file = fopen(g_path, "rb");
+    if (file != NULL) {
+        g_file_size = load_file(file);
+        fseek(file, 0, SEEK_END);
+        long file_end = ftell(file);
+        fclose(file);
+        
+        // Coupure pendant une écriture : supprimer la fin incomplète
+        if (file_end > g_file_size) {
+            ESP_LOGW(TAG, "Fin du magasin incomplète ignorée (%ld octets)", file_end - g_file_size);
+            if (truncate(g_path, g_file_size) != 0) {
+                ESP_LOGE(TAG, "Impossible de tronquer le magasin de documents");
+            }
+        }
+    }
+    
+    g_file = fopen(g_path, "a+b");
+    if (g_file == NULL) {
+        ESP_LOGW(TAG, "Magasin de documents %s indisponible, documents non conservés", g_path);
+    }
+    
+    ESP_LOGI(TAG, "Magasin de documents: %" PRIu32 " documents, %" PRIu32 " à échéance",
+             g_count, g_by_expiry_count);
+    return SYSTEM_OK;
+}
+
+uint32_t document_store_max_id(void)
+{
+    return (g_count > 0) ? g_headers[g_count - 1].id : 0;
+}
+
+// Marque invalide un document remplacé (enregistré avant la mise à jour de la mémoire)
+static system_error_t supersede(document_header_t* header)
+{
+    bool is_valid = false;
+    size_t pos = put_bytes(0, &header->id, sizeof(header->id));
+    pos = put_bytes(pos, &is_valid, sizeof(is_valid));
+    
+    uint32_t offset;
+    system_error_t ret = append_frame(STORE_RECORD_STATUS, pos, &offset);
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Remplacement du document %s non enregistré", header->document_number);
+        return ret;
+    }
+    
+    apply_status(header, false);
+    ESP_LOGI(TAG, "Document %s remplacé", header->document_number);
+    return SYSTEM_OK;
+}
+
+system_error_t document_store_add(const regulatory_document_t* document)
+{
+    if (g_headers == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_count >= REGULATORY_MAX_DOCUMENTS) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGE(TAG, "Magasin de documents plein");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    // Vérifié avant l'écriture : un document qui ne pourrait pas être indexé ne reste pas dans le fichier,
+    // où la relecture l'ignorerait
+    if (!can_index(document)) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGE(TAG, "Document ID=%" PRIu32 " rejeté: ID déjà utilisé", document->id);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t offset;
+    system_error_t ret = append_frame(STORE_RECORD_DOCUMENT, encode_document(document), &offset);
+    if (ret == SYSTEM_OK) {
+        index_document(document, offset);
+    }
+    
+    // Renouvellement : les documents à durée limitée de même type de l'animal sont remplacés
+    if (ret == SYSTEM_OK && document->is_valid && document->expiry_date != 0 && document->animal_id != 0) {
+        uint32_t pos = key_lower_bound(g_by_animal, g_by_animal_count, document->animal_id, 0);
+        for (; ret == SYSTEM_OK && pos < g_by_animal_count && g_by_animal[pos].key == document->animal_id; pos++) {
+            int32_t index = find_header_index(g_by_animal[pos].document_id);
+            document_header_t* header = &g_headers[index];
+            if (header->id != document->id && header->is_valid && header->type == (uint8_t)document->type &&
+                header->expiry_date != 0) {
+                ret = supersede(header);
+            }
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return ret;
+}
+
+// Lit le document complet d'un en-tête (appel sous verrou)
+static bool read_document(const document_header_t* header, regulatory_document_t* document)
+{
+    uint8_t type;
+    size_t length;
+    
+    if (g_file == NULL || !read_frame(g_file, (long)header->offset, &type, &length) ||
+        type != STORE_RECORD_DOCUMENT || !decode_document(frame_payload(), length, document)) {
+        ESP_LOGE(TAG, "Document %s illisible", header->document_number);
+        return false;
+    }
+    
+    // La validité la plus récente est celle de l'en-tête
+    document->is_valid = header->is_valid;
+    return true;
+}
+
+system_error_t document_store_get(uint32_t document_id, regulatory_document_t* document)
+{
+    if (g_headers == NULL) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    int32_t index = find_header_index(document_id);
+    system_error_t ret = SYSTEM_ERROR_NOT_FOUND;
+    if (index >= 0) {
+        ret = read_document(&g_headers[index], document) ? SYSTEM_OK : SYSTEM_ERROR_STORAGE;
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return ret;
+}
+
+system_error_t document_store_get_header(uint32_t document_id, document_header_t* header)
+{
+    if (g_headers == NULL) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    int32_t index = find_header_index(document_id);
+    if (index >= 0) {
+        *header = g_headers[index];
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return (index >= 0) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+}
+
+uint32_t document_store_get_related(bool by_transaction, uint32_t key, regulatory_document_t* documents,
+                                    uint32_t max_count)
+{
+    uint32_t found = 0;
+    
+    if (g_headers == NULL || key == 0) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    const document_key_entry_t* index = by_transaction ? g_by_transaction : g_by_animal;
+    uint32_t count = by_transaction ? g_by_transaction_count : g_by_animal_count;
+    for (uint32_t pos = key_lower_bound(index, count, key, 0); pos < count && index[pos].key == key && found < max_count; pos++) {
+        int32_t header_index = find_header_index(index[pos].document_id);
+        if (header_index >= 0 && read_document(&g_headers[header_index], &documents[found])) {
+            found++;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return found;
+}
+
+time_t document_store_permit_expiry(uint32_t animal_id)
+{
+    time_t expiry = 0;
+    
+    if (g_headers == NULL || animal_id == 0) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    uint32_t pos = key_lower_bound(g_by_animal, g_by_animal_count, animal_id, 0);
+    for (; pos < g_by_animal_count && g_by_animal[pos].key == animal_id; pos++) {
+        const document_header_t* header = &g_headers[find_header_index(g_by_animal[pos].document_id)];
+        if (header->type != DOC_TYPE_CITES_PERMIT || !header->is_valid) {
+            continue;
+        }
+        time_t permit_expiry = (header->expiry_date == 0) ? PERMIT_NO_EXPIRY : header->expiry_date;
+        if (permit_expiry > expiry) {
+            expiry = permit_expiry;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return expiry;
+}
+
+uint32_t document_store_visit_expiring(time_t after, time_t until, document_visit_fn_t visit, void* context)
+{
+    uint32_t visited = 0;
+    
+    if (g_headers == NULL || until <= after) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    for (uint32_t pos = expiry_lower_bound(after, UINT32_MAX); pos < g_by_expiry_count; pos++) {
+        if (g_by_expiry[pos].expiry_date > until) {
+            break;
+        }
+        int32_t index = find_header_index(g_by_expiry[pos].document_id);
+        if (index >= 0) {
+            visit(&g_headers[index], context);
+            visited++;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return visited;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#ifndef DOCUMENT_STORE_H
+#define DOCUMENT_STORE_H
+
+#include "regulatory_compliance.h"
+
+// En-tête d'un document gardé en mémoire ; contenu, chemin et autorité restent dans le fichier
+typedef struct {
+    uint32_t id;
+    uint32_t animal_id;
+    uint32_t transaction_id;
+    time_t issue_date;
+    time_t expiry_date;         // 0 si sans expiration
+    uint32_t offset;            // Position de l'enregistrement complet dans le fichier
+    uint8_t type;
+    bool is_valid;              // Faux une fois remplacé par un document plus récent
+    char document_number[32];
+} document_header_t;
+
+/**
+ * @brief Fonction appelée pour chaque document d'un intervalle d'expiration
+ * @param header En-tête du document (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ */
+typedef void (*document_visit_fn_t)(const document_header_t* header, void* context);
+
+/**
+ * @brief Ouvre le magasin de documents et reconstruit les en-têtes et index depuis le fichier
+ * @param path Chemin du fichier des documents
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si les tables ne peuvent être allouées
+ */
+system_error_t document_store_init(const char* path);
+
+/**
+ * @brief Plus grand ID de document enregistré
+ * @return ID maximal (0 si le magasin est vide)
+ */
+uint32_t document_store_max_id(void);
+
+/**
+ * @brief Enregistre un nouveau document
+ *
+ * Un document à durée limitée remplace les documents valides de même type du même animal
+ * (renouvellement) : ils sont marqués invalides et quittent l'index des expirations.
+ *
+ * @param document Document complet (ID déjà attribué)
+ * @return SYSTEM_OK une fois le document et ses remplacements synchronisés, SYSTEM_ERROR_MEMORY si le magasin
+ *         est plein, SYSTEM_ERROR_INVALID_PARAM si l'ID ne suit pas le dernier enregistré (rien n'est écrit),
+ *         SYSTEM_ERROR_STORAGE si le document ou le remplacement d'un ancien n'a pas pu être écrit
+ */
+system_error_t document_store_add(const regulatory_document_t* document);
+
+/**
+ * @brief Lit un document complet
+ * @param document_id ID du document
+ * @param document Document à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si le document est inconnu
+ */
+system_error_t document_store_get(uint32_t document_id, regulatory_document_t* document);
+
+/**
+ * @brief Récupère l'en-tête d'un document sans lire le fichier
+ * @param document_id ID du document
+ * @param header En-tête à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si le document est inconnu
+ */
+system_error_t document_store_get_header(uint32_t document_id, document_header_t* header);
+
+/**
+ * @brief Lit les documents d'un animal ou d'une transaction, par ID croissant
+ * @param by_transaction true pour chercher par transaction, false par animal
+ * @param key ID de l'animal ou de la transaction
+ * @param documents Tableau de documents à remplir
+ * @param max_count Nombre maximum de documents
+ * @return Nombre de documents lus
+ */
+uint32_t document_store_get_related(bool by_transaction, uint32_t key, regulatory_document_t* documents,
+                                    uint32_t max_count);
+
+/**
+ * @brief Expiration du permis CITES valide le plus durable d'un animal
+ * @param animal_id ID de l'animal
+ * @return Date d'expiration, 0 si aucun permis valide, INT64_MAX si un permis est sans expiration
+ */
+time_t document_store_permit_expiry(uint32_t animal_id);
+
+/**
+ * @brief Parcourt les documents valides dont l'expiration tombe dans un intervalle
+ * @param after Borne basse exclue
+ * @param until Borne haute incluse
+ * @param visit Fonction appelée pour chaque document, par date d'expiration croissante
+ * @param context Contexte transmis à visit
+ * @return Nombre de documents visités
+ */
+uint32_t document_store_visit_expiring(time_t after, time_t until, document_visit_fn_t visit, void* context);
+
+#endif // DOCUMENT_STORE_H
\ No newline at end of file
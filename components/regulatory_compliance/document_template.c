@@ -0,0 +1,149 @@
+#include "document_template.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char* TAG = "DOCUMENT_TEMPLATE";
+
+static bool add_op(document_template_t* tpl, document_op_type_t type, uint16_t field,
+                   uint32_t offset, uint32_t length)
+{
+    if (type == DOCUMENT_OP_LITERAL && length == 0) {
+        return true;
+    }
+    
+    if (tpl->op_count >= DOCUMENT_TEMPLATE_MAX_OPS) {
+        ESP_LOGE(TAG, "Modèle trop long (%d instructions maximum)", DOCUMENT_TEMPLATE_MAX_OPS);
+        return false;
+    }
+    
+    document_op_t* op = &tpl->ops[tpl->op_count++];
+    op->type = (uint8_t)type;
+    op->field = field;
+    op->offset = offset;
+    op->length = length;
+    return true;
+}
+
+static int32_t find_field(const char* name, size_t length, const char* const* field_names, uint16_t field_count)
+{
+    for (uint16_t i = 0; i < field_count; i++) {
+        if (strlen(field_names[i]) == length && strncmp(field_names[i], name, length) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+system_error_t document_template_compile(document_template_t* tpl, const char* source,
+                                         const char* const* field_names, uint16_t field_count)
+{
+    if (tpl == NULL || source == NULL || (field_names == NULL && field_count > 0)) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    memset(tpl, 0, sizeof(document_template_t));
+    tpl->source = source;
+    
+    const char* literal = source;
+    const char* cursor = source;
+    
+    while ((cursor = strstr(cursor, "{{")) != NULL) {
+        const char* name = cursor + 2;
+        const char* end = strstr(name, "}}");
+        if (end == NULL) {
+            break;  // Accolades non fermées : recopiées telles quelles
+        }
+        
+        int32_t field = find_field(name, (size_t)(end - name), field_names, field_count);
+        if (field < 0) {
+            ESP_LOGE(TAG, "Champ inconnu: %.*s", (int)(end - name), name);
+            return SYSTEM_ERROR_INVALID_PARAM;
+        }
+        
+        if (!add_op(tpl, DOCUMENT_OP_LITERAL, 0, (uint32_t)(literal - source), (uint32_t)(cursor - literal)) ||
+            !add_op(tpl, DOCUMENT_OP_FIELD, (uint16_t)field, 0, 0)) {
+            return SYSTEM_ERROR_MEMORY;
+        }
+        
+        cursor = end + 2;
+        literal = cursor;
+    }
+    
+    if (!add_op(tpl, DOCUMENT_OP_LITERAL, 0, (uint32_t)(literal - source), (uint32_t)strlen(literal))) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    return SYSTEM_OK;
+}
+
+system_error_t document_template_render(const document_template_t* tpl, const char* const* values,
+                                        const document_sink_t* sink)
+{
+    if (tpl == NULL || sink == NULL || sink->write == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    for (uint16_t i = 0; i < tpl->op_count; i++) {
+        const document_op_t* op = &tpl->ops[i];
+        system_error_t ret = SYSTEM_OK;
+        
+        if (op->type == DOCUMENT_OP_LITERAL) {
+            ret = sink->write(sink->context, tpl->source + op->offset, op->length);
+        } else if (values != NULL && values[op->field] != NULL && values[op->field][0] != '\0') {
+            ret = sink->write(sink->context, values[op->field], strlen(values[op->field]));
+        }
+        
+        if (ret != SYSTEM_OK) {
+            return ret;
+        }
+    }
+    
+    return SYSTEM_OK;
+}
+
+static system_error_t buffer_sink_write(void* context, const char* data, size_t length)
+{
+    document_buffer_sink_t* buffer_sink = context;
+    if (buffer_sink->size == 0) {
+        buffer_sink->truncated = (length > 0);
+        return SYSTEM_OK;
+    }
+    
+    size_t available = buffer_sink->size - 1 - buffer_sink->length;
+    
+    if (length > available) {
+        length = available;
+        buffer_sink->truncated = true;
+    }
+    
+    memcpy(buffer_sink->buffer + buffer_sink->length, data, length);
+    buffer_sink->length += length;
+    buffer_sink->buffer[buffer_sink->length] = '\0';
+    
+    return SYSTEM_OK;
+}
+
+static system_error_t file_sink_write(void* context, const char* data, size_t length)
+{
+    return (fwrite(data, 1, length, (FILE*)context) == length) ? SYSTEM_OK : SYSTEM_ERROR_STORAGE;
+}
+
+void document_sink_buffer(document_sink_t* sink, document_buffer_sink_t* context, char* buffer, size_t size)
+{
+    context->buffer = buffer;
+    context->size = size;
+    context->length = 0;
+    context->truncated = false;
+    if (size > 0) {
+        buffer[0] = '\0';
+    }
+    
+    sink->write = buffer_sink_write;
+    sink->context = context;
+}
+
+void document_sink_file(document_sink_t* sink, FILE* file)
+{
+    sink->write = file_sink_write;
+    sink->context = file;
+}
\ No newline at end of file
@@ -1,9 +1,18 @@
-#include "regulatory_compliance.h"
-#include "esp_log.h"
+#include "rule_engine.h"
 
-static const char* TAG = "EU_REGULATIONS";
-
-void eu_regulations_init(void)
-{
-    ESP_LOGI(TAG, "Réglementations européennes initialisées");
-}
\ No newline at end of file
+// Règlement (CE) n° 338/97 : détention et cession des espèces inscrites aux annexes CITES
+const char* const g_eu_regulation_rules =
+    "# Détention : permis CITES délivré ou numéro CITES saisi sur l'animal\n"
+    "UE-PERMIS animal permis_manquant : statut_animal != {vendu decede}, soumis_cites, !numero_cites, "
+    "permis = aucun => \"Permis CITES manquant\"\n"
+    "UE-PERMIS-EXPIRE animal permis_expire : statut_animal != {vendu decede}, soumis_cites, !numero_cites, "
+    "permis = expire => \"Permis CITES expiré\"\n"
+    "\n"
+    "# Cession : commerce interdit sans dérogation (annexe A), permis exigé pour toute espèce inscrite\n"
+    "UE-COMMERCE transaction commerce : type = {vente echange}, statut_transaction != {annulee remboursee}, "
+    "!commerce_espece => \"Commerce interdit pour l'espèce\"\n"
+    "UE-CESSION-PERMIS transaction : type = {achat vente echange don}, statut_transaction = terminee, "
+    "soumis_cites, !numero_permis => \"Numéro de permis CITES manquant\"\n"
+    "UE-CESSION-ATTENTE transaction en_attente : type = {achat vente echange don}, "
+    "statut_transaction = en_attente, soumis_cites, !numero_permis => \"Permis CITES en attente\"\n"
+    "UE-TRANSACTION animal commerce : transactions_non_conformes => \"Transaction non conforme\"\n";
\ No newline at end of file
@@ -1,9 +1,13 @@
-#include "regulatory_compliance.h"
-#include "esp_log.h"
+#include "rule_engine.h"
 
-static const char* TAG = "FRENCH_REGULATIONS";
-
-void french_regulations_init(void)
-{
-    ESP_LOGI(TAG, "Réglementations françaises initialisées");
-}
\ No newline at end of file
+// Arrêté du 8 octobre 2018 : détention d'animaux d'espèces non domestiques
+const char* const g_french_regulation_rules =
+    "# Espèces dont la détention est interdite (espèces exotiques envahissantes, réservées aux établissements)\n"
+    "FR-DETENTION animal : statut_animal != {vendu decede}, statut_fr = interdit "
+    "=> \"Détention interdite en France\"\n"
+    "FR-CESSION transaction commerce : type = {vente echange don}, statut_transaction != {annulee remboursee}, "
+    "statut_fr = interdit => \"Cession interdite pour l'espèce\"\n"
+    "\n"
+    "# Reproduction\n"
+    "FR-REPRODUCTION animal reproduction : statut_animal = reproduction, !elevage_espece "
+    "=> \"Reproduction non autorisée pour l'espèce\"\n";
\ No newline at end of file
@@ -0,0 +1,88 @@
+#ifndef BREEDING_REGISTER_H
+#define BREEDING_REGISTER_H
+
+#include "system_types.h"
+#include <time.h>
+
+// Sens d'un mouvement du registre d'entrées et de sorties
+typedef enum {
+    REGISTER_MOVEMENT_ENTRY,
+    REGISTER_MOVEMENT_EXIT
+} register_movement_t;
+
+// Ligne du registre
+typedef struct {
+    time_t date;
+    uint32_t key;                           // Départage les lignes de même date d'une source
+    uint32_t animal_id;
+    register_movement_t movement;
+    char species_name[MAX_SPECIES_NAME_LEN];
+    char identification[48];                // Nom ou puce de l'animal
+    char reason[24];                        // Acquisition, naissance, vente...
+    char counterpart[64];                   // Provenance ou destination
+    char document[32];                      // Numéro de permis CITES
+} register_entry_t;
+
+// Sources du registre, fusionnées par date croissante
+typedef enum {
+    REGISTER_SOURCE_ANIMALS,
+    REGISTER_SOURCE_EVENTS,
+    REGISTER_SOURCE_TRANSACTIONS,
+    REGISTER_SOURCE_COUNT
+} register_source_t;
+
+// Lot de lignes demandé à une source : les plus petites (date, clé) après un point de reprise
+typedef struct {
+    register_entry_t* entries;  // Triées par (date, clé)
+    uint32_t count;
+    uint32_t max_count;
+    time_t after_date;
+    uint32_t after_key;
+    bool started;               // Faux pour le premier lot (aucun point de reprise)
+} register_batch_t;
+
+/**
+ * @brief Remplit un lot avec les lignes d'une source suivant le point de reprise
+ *
+ * La source parcourt ses données et propose chaque ligne avec register_batch_offer ;
+ * register_batch_accepts permet d'écarter une ligne avant de la construire.
+ *
+ * @param batch Lot à remplir (vide à l'appel)
+ */
+typedef void (*register_fetch_fn_t)(register_batch_t* batch);
+
+/**
+ * @brief Déclare la fonction de lecture d'une source du registre
+ * @param source Source concernée
+ * @param fetch Fonction de lecture (NULL pour retirer la source)
+ */
+void breeding_register_set_source(register_source_t source, register_fetch_fn_t fetch);
+
+/**
+ * @brief Indique si une ligne de (date, clé) entrerait dans le lot
+ * @param batch Lot en cours de remplissage
+ * @param date Date de la ligne
+ * @param key Clé de la ligne
+ * @return true si la ligne suit le point de reprise et précède la dernière ligne d'un lot plein
+ */
+bool register_batch_accepts(const register_batch_t* batch, time_t date, uint32_t key);
+
+/**
+ * @brief Propose une ligne au lot (insérée à son rang, la dernière est écartée si le lot déborde)
+ * @param batch Lot en cours de remplissage
+ * @param entry Ligne proposée
+ */
+void register_batch_offer(register_batch_t* batch, const register_entry_t* entry);
+
+/**
+ * @brief Indique qu'aucune ligne datée d'au moins date ne peut plus entrer dans le lot
+ *
+ * Permet à une source parcourue par date croissante d'arrêter son parcours.
+ *
+ * @param batch Lot en cours de remplissage
+ * @param date Date de la prochaine ligne de la source
+ * @return true si le parcours peut s'arrêter
+ */
+bool register_batch_complete(const register_batch_t* batch, time_t date);
+
+#endif // BREEDING_REGISTER_H
\ No newline at end of file
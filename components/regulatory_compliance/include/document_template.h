@@ -0,0 +1,83 @@
+#ifndef DOCUMENT_TEMPLATE_H
+#define DOCUMENT_TEMPLATE_H
+
+#include "system_types.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#define DOCUMENT_TEMPLATE_MAX_OPS 64
+
+// Instructions d'un modèle compilé
+typedef enum {
+    DOCUMENT_OP_LITERAL,    // Recopie d'un segment du texte source
+    DOCUMENT_OP_FIELD       // Valeur d'un champ
+} document_op_type_t;
+
+typedef struct {
+    uint8_t type;
+    uint16_t field;
+    uint32_t offset;
+    uint32_t length;
+} document_op_t;
+
+// Modèle compilé : le texte source doit rester valide (chaîne constante)
+typedef struct {
+    const char* source;
+    document_op_t ops[DOCUMENT_TEMPLATE_MAX_OPS];
+    uint16_t op_count;
+} document_template_t;
+
+// Destination du rendu : chaque segment est écrit dès qu'il est produit
+typedef system_error_t (*document_sink_write_t)(void* context, const char* data, size_t length);
+
+typedef struct {
+    document_sink_write_t write;
+    void* context;
+} document_sink_t;
+
+// Contexte d'une destination mémoire (tronquée proprement si trop petite)
+typedef struct {
+    char* buffer;
+    size_t size;
+    size_t length;
+    bool truncated;
+} document_buffer_sink_t;
+
+/**
+ * @brief Compile un modèle en liste d'instructions
+ * @param tpl Modèle à remplir
+ * @param source Texte du modèle, les champs s'écrivent {{nom}}
+ * @param field_names Noms des champs connus (l'indice sert de référence au rendu)
+ * @param field_count Nombre de champs
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_INVALID_PARAM si un champ est inconnu
+ */
+system_error_t document_template_compile(document_template_t* tpl, const char* source,
+                                         const char* const* field_names, uint16_t field_count);
+
+/**
+ * @brief Produit un document vers une destination sans tampon intermédiaire
+ * @param tpl Modèle compilé
+ * @param values Valeurs des champs, dans l'ordre de field_names (NULL pour vide)
+ * @param sink Destination du rendu
+ * @return SYSTEM_OK en cas de succès, erreur de la destination sinon
+ */
+system_error_t document_template_render(const document_template_t* tpl, const char* const* values,
+                                        const document_sink_t* sink);
+
+/**
+ * @brief Prépare une destination vers un tampon mémoire
+ * @param sink Destination à initialiser
+ * @param context Contexte du tampon
+ * @param buffer Tampon de sortie (toujours terminé par un zéro)
+ * @param size Taille du tampon
+ */
+void document_sink_buffer(document_sink_t* sink, document_buffer_sink_t* context, char* buffer, size_t size);
+
+/**
+ * @brief Prépare une destination vers un fichier ouvert
+ * @param sink Destination à initialiser
+ * @param file Fichier ouvert en écriture
+ */
+void document_sink_file(document_sink_t* sink, FILE* file);
+
+#endif // DOCUMENT_TEMPLATE_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define REGULATORY_COMPLIANCE_H
 
 #include "system_types.h"
+#include "document_template.h"
 #include <time.h>
 
 // Niveaux de protection CITES
@@ -12,6 +13,23 @@ typedef enum {
     CITES_APPENDIX_III
 } cites_level_t;
 
+// Annexes du règlement (CE) n° 338/97
+typedef enum {
+    EU_ANNEX_NONE,
+    EU_ANNEX_A,
+    EU_ANNEX_B,
+    EU_ANNEX_C,
+    EU_ANNEX_D
+} eu_annex_t;
+
+// Régime de détention en France (arrêté du 8 octobre 2018)
+typedef enum {
+    FRENCH_STATUS_FREE,
+    FRENCH_STATUS_DECLARATION,           // Marquage et déclaration de détention
+    FRENCH_STATUS_CAPACITY_CERTIFICATE,  // Certificat de capacité et autorisation de détention
+    FRENCH_STATUS_PROHIBITED
+} french_status_t;
+
 // Types de documents réglementaires
 typedef enum {
     DOC_TYPE_BREEDING_REGISTER,
@@ -25,7 +43,10 @@ typedef enum {
 // Structure pour les informations CITES d'une espèce
 typedef struct {
     char species_name[MAX_SPECIES_NAME_LEN];
+    char common_name[MAX_SPECIES_NAME_LEN];
     cites_level_t cites_level;
+    eu_annex_t eu_annex;
+    french_status_t french_status;
     bool requires_permit;
     bool breeding_allowed;
     bool commercial_trade_allowed;
@@ -33,6 +54,13 @@ typedef struct {
     time_t last_updated;
 } species_regulation_t;
 
+// Résultat de la reconnaissance d'un nom d'espèce
+typedef struct {
+    uint16_t species_id;                            // Identifiant canonique de l'espèce (ou du genre)
+    uint8_t confidence;                             // De 0 à 100 (100 : nom exact ou synonyme connu)
+    char scientific_name[MAX_SPECIES_NAME_LEN];     // Nom scientifique canonique
+} species_match_t;
+
 // Structure pour un document réglementaire
 typedef struct {
     uint32_t id;
@@ -61,6 +89,26 @@ typedef struct {
     time_t last_check;
 } compliance_check_t;
 
+// Éléments d'un animal transmis au suivi de conformité à chaque modification
+typedef struct {
+    uint32_t animal_id;
+    char species_name[MAX_SPECIES_NAME_LEN];
+    uint8_t status;         // animal_status_t
+    bool cites_declared;    // Marqué soumis à CITES par l'éleveur
+    bool has_cites_number;
+} compliance_animal_info_t;
+
+// Éléments d'une transaction transmis au suivi de conformité à chaque modification
+typedef struct {
+    uint32_t transaction_id;
+    uint32_t animal_id;
+    char species_name[MAX_SPECIES_NAME_LEN];
+    uint8_t type;           // transaction_type_t
+    uint8_t status;         // transaction_status_t
+    bool cites_required;
+    bool has_permit_number;
+} compliance_transaction_info_t;
+
 // Structure pour les statistiques de conformité
 typedef struct {
     uint32_t total_animals_checked;
@@ -100,12 +148,21 @@ system_error_t regulatory_check_transaction_compliance(uint32_t transaction_id,
 
 /**
  * @brief Récupère les informations réglementaires d'une espèce
- * @param species_name Nom de l'espèce
+ * @param species_name Nom de l'espèce (scientifique, commun ou synonyme ; fautes de frappe tolérées)
  * @param regulation Pointeur vers la structure réglementation à remplir
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si l'espèce n'est pas répertoriée
+ *         (regulation contient alors le régime libre par défaut)
  */
 system_error_t regulatory_get_species_info(const char* species_name, species_regulation_t* regulation);
 
+/**
+ * @brief Reconnaît un nom d'espèce saisi librement (casse, accents, nom commun, synonyme, faute de frappe)
+ * @param species_name Nom saisi
+ * @param match Espèce reconnue et confiance
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si aucune espèce n'est assez proche
+ */
+system_error_t regulatory_match_species(const char* species_name, species_match_t* match);
+
 /**
  * @brief Génère un document réglementaire
  * @param type Type de document
@@ -118,10 +175,18 @@ system_error_t regulatory_generate_document(document_type_t type, uint32_t anima
                                            uint32_t transaction_id, regulatory_document_t* document);
 
 /**
- * @brief Valide un document réglementaire
+ * @brief Produit le texte complet d'un document vers une destination (tampon, fichier, réponse HTTP)
+ * @param document Document à produire
+ * @param sink Destination du rendu
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t regulatory_render_document(const regulatory_document_t* document, const document_sink_t* sink);
+
+/**
+ * @brief Valide un document réglementaire (enregistré, non remplacé et non expiré)
  * @param document_id ID du document
  * @param is_valid Pointeur vers le résultat de validation
- * @return SYSTEM_OK en cas de succès
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si le document est inconnu
  */
 system_error_t regulatory_validate_document(uint32_t document_id, bool* is_valid);
 
@@ -137,7 +202,57 @@ system_error_t regulatory_get_animal_documents(uint32_t animal_id, regulatory_do
                                               uint32_t max_count, uint32_t* count);
 
 /**
- * @brief Vérifie tous les animaux pour la conformité
+ * @brief Récupère tous les documents d'une transaction
+ * @param transaction_id ID de la transaction
+ * @param documents Tableau de documents à remplir
+ * @param max_count Nombre maximum de documents
+ * @param count Pointeur vers le nombre de documents récupérés
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t regulatory_get_transaction_documents(uint32_t transaction_id, regulatory_document_t* documents,
+                                                   uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Signale les documents expirés ou à renouveler depuis la dernière vérification
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t regulatory_check_document_expiry(void);
+
+/**
+ * @brief Signale la création ou la modification d'un animal (réévalué au prochain traitement)
+ * @param info Éléments de conformité de l'animal
+ */
+void regulatory_animal_changed(const compliance_animal_info_t* info);
+
+/**
+ * @brief Signale la suppression d'un animal
+ * @param animal_id ID de l'animal
+ */
+void regulatory_animal_removed(uint32_t animal_id);
+
+/**
+ * @brief Signale la création ou la modification d'une transaction
+ * @param info Éléments de conformité de la transaction
+ */
+void regulatory_transaction_changed(const compliance_transaction_info_t* info);
+
+/**
+ * @brief Signale la suppression d'une transaction
+ * @param transaction_id ID de la transaction
+ */
+void regulatory_transaction_removed(uint32_t transaction_id);
+
+/**
+ * @brief Réévalue les seuls animaux modifiés depuis le dernier traitement
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t regulatory_process_changes(void);
+
+/**
+ * @brief Vérifie tous les animaux pour la conformité et recalcule les statistiques
+ *
+ * Le suivi est incrémental ; cette vérification complète ne sert que de filet de sécurité.
+ *
  * @return SYSTEM_OK en cas de succès
  */
 system_error_t regulatory_check_all_compliance(void);
@@ -150,13 +265,20 @@ system_error_t regulatory_check_all_compliance(void);
 system_error_t regulatory_get_compliance_stats(compliance_stats_t* stats);
 
 /**
- * @brief Met à jour la base de données des réglementations
- * @return SYSTEM_OK en cas de succès
+ * @brief Recompile les règles réglementaires (intégrées et fichier REGULATORY_RULES_PATH)
+ *
+ * Les règles en vigueur sont conservées si la compilation échoue.
+ *
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_INVALID_PARAM si une règle est invalide
  */
 system_error_t regulatory_update_database(void);
 
 /**
  * @brief Génère le registre d'élevage obligatoire
+ *
+ * Les entrées et sorties des sources déclarées par breeding_register_set_source (animaux,
+ * événements, transactions, archives comprises) sont écrites par date croissante.
+ *
  * @param file_path Chemin du fichier de sortie
  * @param format Format de sortie ("pdf", "csv")
  * @return SYSTEM_OK en cas de succès
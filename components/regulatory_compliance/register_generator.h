@@ -0,0 +1,19 @@
+#ifndef REGISTER_GENERATOR_H
+#define REGISTER_GENERATOR_H
+
+#include "breeding_register.h"
+
+/**
+ * @brief Produit le registre d'entrées et de sorties en fusionnant les sources par date
+ *
+ * Les lignes sont lues par petits lots et écrites par blocs de REGISTER_CHUNK_SIZE octets :
+ * la mémoire utilisée ne dépend pas de la longueur du registre.
+ *
+ * @param file_path Chemin du fichier produit
+ * @param pdf true pour un document PDF, false pour un fichier CSV
+ * @param row_count Pointeur vers le nombre de lignes écrites
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE en cas d'échec d'écriture
+ */
+system_error_t breeding_register_generate(const char* file_path, bool pdf, uint32_t* row_count);
+
+#endif // REGISTER_GENERATOR_H
\ No newline at end of file
@@ -1,12 +1,100 @@
 #include "regulatory_compliance.h"
+#include "document_generator.h"
+#include "cites_checker.h"
+#include "compliance_tracker.h"
+#include "rule_engine.h"
+#include "register_generator.h"
+#include "document_store.h"
+#include "app_main.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include <string.h>
+#include <strings.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 
 static const char* TAG = "REGULATORY_COMPLIANCE";
 
 // Variables globales
 static bool g_initialized = false;
+static uint32_t g_next_document_id = 1;
+static time_t g_last_expiry_check = 0;
+
+// Autorité et durée de validité par défaut de chaque type de document
+static const struct {
+    const char* authority;
+    uint16_t validity_days;  // 0 si sans expiration
+} k_document_defaults[] = {
+    [DOC_TYPE_BREEDING_REGISTER] = { "Direction départementale de la protection des populations", 0 },
+    [DOC_TYPE_ACQUISITION_CERTIFICATE] = { "Établissement d'élevage", 0 },
+    [DOC_TYPE_SALE_CERTIFICATE] = { "Établissement d'élevage", 0 },
+    [DOC_TYPE_CITES_PERMIT] = { "DREAL - Autorité CITES", 180 },
+    [DOC_TYPE_HEALTH_CERTIFICATE] = { "Vétérinaire sanitaire", 30 },
+    [DOC_TYPE_TRANSPORT_PERMIT] = { "Direction départementale de la protection des populations", 30 }
+};
+
+// Lit le fichier de règles complémentaires (NULL s'il est absent)
+static char* read_rules_file(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        return NULL;
+    }
+    
+    char* text = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long size = ftell(file);
+        if (size >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            text = malloc((size_t)size + 1);
+            if (text != NULL) {
+                size_t length = fread(text, 1, (size_t)size, file);
+                text[length] = '\0';
+            }
+        }
+    }
+    fclose(file);
+    
+    return text;
+}
+
+// Compile les règles européennes, françaises et complémentaires puis les active
+static system_error_t load_rules(void)
+{
+    // Jeu de travail : les règles actives restent en place jusqu'à la fin de la compilation
+    rule_set_t* rules = heap_caps_malloc(sizeof(rule_set_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (rules == NULL) {
+        rules = heap_caps_malloc(sizeof(rule_set_t), MALLOC_CAP_8BIT);
+        if (rules == NULL) {
+            return SYSTEM_ERROR_MEMORY;
+        }
+    }
+    rule_set_init(rules);
+    
+    system_error_t ret = rule_set_compile(rules, g_eu_regulation_rules, "eu_regulations");
+    if (ret == SYSTEM_OK) {
+        ret = rule_set_compile(rules, g_french_regulation_rules, "french_regulations");
+    }
+    if (ret == SYSTEM_OK) {
+        char* text = read_rules_file(REGULATORY_RULES_PATH);
+        if (text != NULL) {
+            ret = rule_set_compile(rules, text, REGULATORY_RULES_PATH);
+            free(text);
+        }
+    }
+    
+    if (ret == SYSTEM_OK) {
+        compliance_tracker_set_rules(rules);
+        ESP_LOGI(TAG, "Règles réglementaires chargées: %u animal, %u transaction, %u codes",
+                 rules->rule_count[RULE_SUBJECT_ANIMAL], rules->rule_count[RULE_SUBJECT_TRANSACTION],
+                 rules->code_count);
+    } else {
+        ESP_LOGE(TAG, "Règles réglementaires invalides, règles précédentes conservées");
+    }
+    
+    heap_caps_free(rules);
+    return ret;
+}
 
 system_error_t regulatory_compliance_init(void)
 {
@@ -16,7 +104,28 @@ system_error_t regulatory_compliance_init(void)
     
     ESP_LOGI(TAG, "Initialisation de la conformité réglementaire...");
     
-    // TODO: Charger la base de données des réglementations
+    cites_checker_init();
+    
+    system_error_t ret = compliance_tracker_init();
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = load_rules();
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = document_generator_init();
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    ret = document_store_init(REGULATORY_DOCUMENT_PATH);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    g_next_document_id = document_store_max_id() + 1;
     
     g_initialized = true;
     ESP_LOGI(TAG, "Conformité réglementaire initialisée");
@@ -30,15 +139,7 @@ system_error_t regulatory_check_animal_compliance(uint32_t animal_id, compliance
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la vérification de conformité
-    memset(check, 0, sizeof(compliance_check_t));
-    check->animal_id = animal_id;
-    check->is_compliant = true;
-    check->last_check = time(NULL);
-    
-    ESP_LOGI(TAG, "Vérification conformité animal ID=%" PRIu32, animal_id);
-    
-    return SYSTEM_OK;
+    return compliance_tracker_get_animal(animal_id, check);
 }
 
 system_error_t regulatory_check_transaction_compliance(uint32_t transaction_id, bool* is_compliant,
@@ -48,14 +149,7 @@ system_error_t regulatory_check_transaction_compliance(uint32_t transaction_id,
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la vérification de conformité des transactions
-    *is_compliant = true;
-    
-    if (violations && violations_size > 0) {
-        violations[0] = '\0';
-    }
-    
-    ESP_LOGI(TAG, "Vérification conformité transaction ID=%" PRIu32, transaction_id);
+    compliance_tracker_get_transaction(transaction_id, is_compliant, violations, violations_size);
     
     return SYSTEM_OK;
 }
@@ -66,14 +160,52 @@ system_error_t regulatory_get_species_info(const char* species_name, species_reg
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des informations d'espèce
     memset(regulation, 0, sizeof(species_regulation_t));
-    strncpy(regulation->species_name, species_name, sizeof(regulation->species_name) - 1);
-    regulation->cites_level = CITES_NONE;
-    regulation->requires_permit = false;
-    regulation->breeding_allowed = true;
-    regulation->commercial_trade_allowed = true;
-    regulation->last_updated = time(NULL);
+    
+    const species_rule_t* rule = cites_checker_find(species_name);
+    if (rule == NULL) {
+        strncpy(regulation->species_name, species_name, sizeof(regulation->species_name) - 1);
+        regulation->cites_level = CITES_NONE;
+        regulation->eu_annex = EU_ANNEX_NONE;
+        regulation->french_status = FRENCH_STATUS_FREE;
+        regulation->breeding_allowed = true;
+        regulation->commercial_trade_allowed = true;
+        regulation->last_updated = g_species_table_date;
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    // Une règle de genre s'applique sous le nom demandé
+    bool genus_rule = (strchr(rule->key, ' ') == NULL);
+    strncpy(regulation->species_name, genus_rule ? species_name : rule->scientific_name,
+            sizeof(regulation->species_name) - 1);
+    strncpy(regulation->common_name, rule->common_name, sizeof(regulation->common_name) - 1);
+    strncpy(regulation->restrictions, rule->restrictions, sizeof(regulation->restrictions) - 1);
+    regulation->cites_level = rule->cites_level;
+    regulation->eu_annex = rule->eu_annex;
+    regulation->french_status = rule->french_status;
+    regulation->requires_permit = (rule->flags & SPECIES_RULE_PERMIT) != 0;
+    regulation->breeding_allowed = (rule->flags & SPECIES_RULE_BREEDING) != 0;
+    regulation->commercial_trade_allowed = (rule->flags & SPECIES_RULE_TRADE) != 0;
+    regulation->last_updated = g_species_table_date;
+    
+    return SYSTEM_OK;
+}
+
+system_error_t regulatory_match_species(const char* species_name, species_match_t* match)
+{
+    if (!g_initialized || species_name == NULL || match == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    memset(match, 0, sizeof(species_match_t));
+    
+    const species_rule_t* rule = cites_checker_match(species_name, &match->confidence);
+    if (rule == NULL) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    match->species_id = (uint16_t)(rule - g_species_rules);
+    strncpy(match->scientific_name, rule->scientific_name, sizeof(match->scientific_name) - 1);
     
     return SYSTEM_OK;
 }
@@ -85,25 +217,70 @@ system_error_t regulatory_generate_document(document_type_t type, uint32_t anima
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la génération de documents
+    if ((uint32_t)type >= sizeof(k_document_defaults) / sizeof(k_document_defaults[0])) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
     memset(document, 0, sizeof(regulatory_document_t));
+    document->id = g_next_document_id++;
     document->type = type;
     document->issue_date = time(NULL);
+    document->animal_id = animal_id;
+    document->transaction_id = transaction_id;
     document->is_valid = true;
+    if (k_document_defaults[type].validity_days > 0) {
+        document->expiry_date = document->issue_date + (time_t)k_document_defaults[type].validity_days * 24 * 3600;
+    }
+    snprintf(document->document_number, sizeof(document->document_number), "DOC-%d-%06" PRIu32, type, document->id);
+    strncpy(document->issuing_authority, k_document_defaults[type].authority, sizeof(document->issuing_authority) - 1);
     
-    ESP_LOGI(TAG, "Document généré: type=%d", type);
+    // Contenu produit directement dans le document à partir du modèle compilé
+    document_sink_t sink;
+    document_buffer_sink_t buffer;
+    document_sink_buffer(&sink, &buffer, document->content, sizeof(document->content));
+    system_error_t ret = document_generator_render(document, &sink);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    if (buffer.truncated) {
+        ESP_LOGW(TAG, "Contenu du document %s tronqué, utiliser regulatory_render_document", document->document_number);
+    }
+    
+    if (document_store_add(document) != SYSTEM_OK) {
+        ESP_LOGW(TAG, "Document %s non conservé", document->document_number);
+    }
+    
+    if (type == DOC_TYPE_CITES_PERMIT && animal_id != 0) {
+        compliance_tracker_permit_issued(animal_id);
+    }
+    
+    ESP_LOGI(TAG, "Document généré: type=%d, N°=%s", type, document->document_number);
     
     return SYSTEM_OK;
 }
 
+system_error_t regulatory_render_document(const regulatory_document_t* document, const document_sink_t* sink)
+{
+    if (!g_initialized || document == NULL || sink == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    return document_generator_render(document, sink);
+}
+
 system_error_t regulatory_validate_document(uint32_t document_id, bool* is_valid)
 {
     if (!g_initialized || is_valid == NULL) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la validation de documents
-    *is_valid = true;
+    document_header_t header;
+    if (document_store_get_header(document_id, &header) != SYSTEM_OK) {
+        *is_valid = false;
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    *is_valid = header.is_valid && (header.expiry_date == 0 || header.expiry_date > time(NULL));
     
     return SYSTEM_OK;
 }
@@ -115,8 +292,96 @@ system_error_t regulatory_get_animal_documents(uint32_t animal_id, regulatory_do
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des documents
-    *count = 0;
+    *count = document_store_get_related(false, animal_id, documents, max_count);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t regulatory_get_transaction_documents(uint32_t transaction_id, regulatory_document_t* documents,
+                                                   uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || documents == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    *count = document_store_get_related(true, transaction_id, documents, max_count);
+    
+    return SYSTEM_OK;
+}
+
+static void log_expired_document(const document_header_t* header, void* context)
+{
+    (*(uint32_t*)context)++;
+    ESP_LOGW(TAG, "Document expiré: N°=%s, animal ID=%" PRIu32, header->document_number, header->animal_id);
+}
+
+static void log_renewal_document(const document_header_t* header, void* context)
+{
+    (*(uint32_t*)context)++;
+    ESP_LOGW(TAG, "Document à renouveler: N°=%s, animal ID=%" PRIu32, header->document_number, header->animal_id);
+}
+
+system_error_t regulatory_check_document_expiry(void)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    time_t now = time(NULL);
+    time_t renewal = (time_t)DOCUMENT_RENEWAL_DAYS * 24 * 3600;
+    uint32_t expired = 0;
+    uint32_t to_renew = 0;
+    
+    // Seuls les documents dont l'échéance a franchi un seuil depuis la dernière vérification sont visités
+    document_store_visit_expiring(g_last_expiry_check, now, log_expired_document, &expired);
+    time_t renewal_start = g_last_expiry_check + renewal;
+    document_store_visit_expiring((renewal_start > now) ? renewal_start : now, now + renewal,
+                                  log_renewal_document, &to_renew);
+    g_last_expiry_check = now;
+    
+    if (expired > 0 || to_renew > 0) {
+        system_event_t event = {
+            .type = EVENT_DOCUMENT_EXPIRING,
+            .timestamp = now,
+            .source_id = 0,
+            .data = NULL,
+            .data_size = 0
+        };
+        snprintf(event.description, sizeof(event.description),
+                 "Documents réglementaires: %" PRIu32 " expirés, %" PRIu32 " à renouveler", expired, to_renew);
+        app_emit_event(&event);
+    }
+    
+    return SYSTEM_OK;
+}
+
+void regulatory_animal_changed(const compliance_animal_info_t* info)
+{
+    compliance_tracker_animal_changed(info);
+}
+
+void regulatory_animal_removed(uint32_t animal_id)
+{
+    compliance_tracker_animal_removed(animal_id);
+}
+
+void regulatory_transaction_changed(const compliance_transaction_info_t* info)
+{
+    compliance_tracker_transaction_changed(info);
+}
+
+void regulatory_transaction_removed(uint32_t transaction_id)
+{
+    compliance_tracker_transaction_removed(transaction_id);
+}
+
+system_error_t regulatory_process_changes(void)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    compliance_tracker_process(time(NULL));
     
     return SYSTEM_OK;
 }
@@ -128,8 +393,7 @@ system_error_t regulatory_check_all_compliance(void)
     }
     
     ESP_LOGI(TAG, "Vérification de conformité globale");
-    
-    // TODO: Implémenter la vérification globale
+    compliance_tracker_full_sweep(time(NULL));
     
     return SYSTEM_OK;
 }
@@ -140,9 +404,7 @@ system_error_t regulatory_get_compliance_stats(compliance_stats_t* stats)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter les statistiques de conformité
-    memset(stats, 0, sizeof(compliance_stats_t));
-    stats->last_full_check = time(NULL);
+    compliance_tracker_get_stats(stats);
     
     return SYSTEM_OK;
 }
@@ -155,9 +417,7 @@ system_error_t regulatory_update_database(void)
     
     ESP_LOGI(TAG, "Mise à jour base de données réglementaire");
     
-    // TODO: Implémenter la mise à jour
-    
-    return SYSTEM_OK;
+    return load_rules();
 }
 
 system_error_t regulatory_generate_breeding_register(const char* file_path, const char* format)
@@ -166,9 +426,18 @@ system_error_t regulatory_generate_breeding_register(const char* file_path, cons
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    bool pdf = (strcasecmp(format, "pdf") == 0);
+    if (!pdf && strcasecmp(format, "csv") != 0) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
     ESP_LOGI(TAG, "Génération registre d'élevage: %s", file_path);
     
-    // TODO: Implémenter la génération du registre
+    uint32_t row_count = 0;
+    system_error_t ret = breeding_register_generate(file_path, pdf, &row_count);
+    if (ret == SYSTEM_OK) {
+        ESP_LOGI(TAG, "Registre d'élevage généré: %" PRIu32 " mouvements", row_count);
+    }
     
-    return SYSTEM_OK;
+    return ret;
 }
\ No newline at end of file
@@ -0,0 +1,425 @@
+#include "rule_engine.h"
+#include "esp_log.h"
+#include <string.h>
+#include <stdio.h>
+
+static const char* TAG = "RULE_ENGINE";
+
+#define SUBJECT_ANIMAL       (1 << RULE_SUBJECT_ANIMAL)
+#define SUBJECT_TRANSACTION  (1 << RULE_SUBJECT_TRANSACTION)
+#define SUBJECT_ALL          (SUBJECT_ANIMAL | SUBJECT_TRANSACTION)
+#define MAX_DOMAIN_VALUES    8
+#define MAX_TOKEN_LEN        64
+
+// Nom, sujets concernés et domaine de chaque attribut (dans l'ordre de rule_attribute_t)
+static const struct {
+    const char* name;
+    uint8_t subjects;
+    const char* values[MAX_DOMAIN_VALUES];
+} k_attributes[RULE_ATTR_COUNT] = {
+    [RULE_ATTR_CITES] = { "cites", SUBJECT_ALL, { "aucune", "I", "II", "III" } },
+    [RULE_ATTR_EU_ANNEX] = { "annexe_ue", SUBJECT_ALL, { "aucune", "A", "B", "C", "D" } },
+    [RULE_ATTR_FRENCH_STATUS] = { "statut_fr", SUBJECT_ALL, { "libre", "declaration", "certificat", "interdit" } },
+    [RULE_ATTR_LISTED] = { "repertoriee", SUBJECT_ALL, { "non", "oui" } },
+    [RULE_ATTR_SPECIES_PERMIT] = { "permis_espece", SUBJECT_ALL, { "non", "oui" } },
+    [RULE_ATTR_SPECIES_BREEDING] = { "elevage_espece", SUBJECT_ALL, { "non", "oui" } },
+    [RULE_ATTR_SPECIES_TRADE] = { "commerce_espece", SUBJECT_ALL, { "non", "oui" } },
+    [RULE_ATTR_CITES_SUBJECT] = { "soumis_cites", SUBJECT_ALL, { "non", "oui" } },
+    [RULE_ATTR_ANIMAL_STATUS] = { "statut_animal", SUBJECT_ANIMAL,
+                                  { "actif", "vendu", "decede", "quarantaine", "reproduction" } },
+    [RULE_ATTR_CITES_NUMBER] = { "numero_cites", SUBJECT_ANIMAL, { "non", "oui" } },
+    [RULE_ATTR_PERMIT] = { "permis", SUBJECT_ANIMAL, { "aucun", "valide", "expire" } },
+    [RULE_ATTR_FAILED_TRANSACTIONS] = { "transactions_non_conformes", SUBJECT_ANIMAL, { "non", "oui" } },
+    [RULE_ATTR_TRANSACTION_TYPE] = { "type", SUBJECT_TRANSACTION,
+                                     { "achat", "vente", "echange", "don", "elevage", "deces", "fuite" } },
+    [RULE_ATTR_TRANSACTION_STATUS] = { "statut_transaction", SUBJECT_TRANSACTION,
+                                       { "en_attente", "terminee", "annulee", "remboursee" } },
+    [RULE_ATTR_PERMIT_NUMBER] = { "numero_permis", SUBJECT_TRANSACTION, { "non", "oui" } }
+};
+
+static const char* const k_subjects[RULE_SUBJECT_COUNT] = { "animal", "transaction" };
+
+static const struct {
+    const char* name;
+    uint8_t category;
+} k_categories[] = {
+    { "permis_manquant", RULE_CATEGORY_PERMIT_MISSING },
+    { "permis_expire", RULE_CATEGORY_PERMIT_EXPIRED },
+    { "reproduction", RULE_CATEGORY_BREEDING },
+    { "commerce", RULE_CATEGORY_TRADE },
+    { "en_attente", RULE_CATEGORY_PENDING }
+};
+
+#define CATEGORY_COUNT (sizeof(k_categories) / sizeof(k_categories[0]))
+
+// Position du premier bit de chaque attribut dans rule_facts_t
+static uint8_t g_offsets[RULE_ATTR_COUNT];
+static uint8_t g_domain_sizes[RULE_ATTR_COUNT];
+static bool g_layout_ready = false;
+
+// Analyse d'une ligne de règle
+typedef struct {
+    const char* pos;
+    const char* end;
+    char token[MAX_TOKEN_LEN];
+} rule_parser_t;
+
+static void prepare_layout(void)
+{
+    uint32_t offset = 0;
+    
+    for (uint32_t a = 0; a < RULE_ATTR_COUNT; a++) {
+        uint8_t size = 0;
+        while (size < MAX_DOMAIN_VALUES && k_attributes[a].values[size] != NULL) {
+            size++;
+        }
+        g_offsets[a] = (uint8_t)offset;
+        g_domain_sizes[a] = size;
+        offset += size;
+    }
+    
+    // Le domaine complet des attributs doit tenir dans rule_facts_t
+    if (offset > 64) {
+        ESP_LOGE(TAG, "Domaines d'attributs trop grands (%u bits)", (unsigned)offset);
+    }
+    g_layout_ready = true;
+}
+
+static void skip_spaces(rule_parser_t* parser)
+{
+    while (parser->pos < parser->end && (*parser->pos == ' ' || *parser->pos == '\t' || *parser->pos == '\r')) {
+        parser->pos++;
+    }
+}
+
+static bool is_word_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+}
+
+// Lit un mot dans parser->token
+static bool read_word(rule_parser_t* parser)
+{
+    skip_spaces(parser);
+    size_t length = 0;
+    while (parser->pos < parser->end && is_word_char(*parser->pos)) {
+        if (length + 1 >= sizeof(parser->token)) {
+            return false;
+        }
+        parser->token[length++] = *parser->pos++;
+    }
+    parser->token[length] = '\0';
+    return length > 0;
+}
+
+static bool peek(rule_parser_t* parser, const char* symbol)
+{
+    skip_spaces(parser);
+    size_t length = strlen(symbol);
+    return (size_t)(parser->end - parser->pos) >= length && memcmp(parser->pos, symbol, length) == 0;
+}
+
+// Consomme un symbole s'il est présent
+static bool accept(rule_parser_t* parser, const char* symbol)
+{
+    if (!peek(parser, symbol)) {
+        return false;
+    }
+    parser->pos += strlen(symbol);
+    return true;
+}
+
+static int32_t find_attribute(const char* name)
+{
+    for (uint32_t a = 0; a < RULE_ATTR_COUNT; a++) {
+        if (strcmp(k_attributes[a].name, name) == 0) {
+            return (int32_t)a;
+        }
+    }
+    return -1;
+}
+
+static int32_t find_value(uint32_t attribute, const char* name)
+{
+    for (uint32_t v = 0; v < g_domain_sizes[attribute]; v++) {
+        if (strcmp(k_attributes[attribute].values[v], name) == 0) {
+            return (int32_t)v;
+        }
+    }
+    return -1;
+}
+
+// Lit une valeur ou une liste {valeur valeur...} et renvoie le masque des valeurs citées
+static const char* parse_values(rule_parser_t* parser, uint32_t attribute, uint8_t* mask)
+{
+    bool list = accept(parser, "{");
+    
+    *mask = 0;
+    do {
+        if (!read_word(parser)) {
+            return list ? "liste de valeurs non fermée" : "valeur attendue";
+        }
+        int32_t value = find_value(attribute, parser->token);
+        if (value < 0) {
+            return "valeur inconnue";
+        }
+        *mask |= (uint8_t)(1 << value);
+    } while (list && !accept(parser, "}"));
+    
+    return NULL;
+}
+
+// Lit une condition et restreint les valeurs admises de son attribut
+static const char* parse_condition(rule_parser_t* parser, rule_subject_t subject, uint8_t allowed[RULE_ATTR_COUNT])
+{
+    bool negated = accept(parser, "!");
+    if (!read_word(parser)) {
+        return "attribut attendu";
+    }
+    
+    int32_t attribute = find_attribute(parser->token);
+    if (attribute < 0) {
+        return "attribut inconnu";
+    }
+    if (!(k_attributes[attribute].subjects & (1 << subject))) {
+        return "attribut sans objet pour ce sujet";
+    }
+    
+    bool boolean = (g_domain_sizes[attribute] == 2);
+    uint8_t domain = (uint8_t)((1 << g_domain_sizes[attribute]) - 1);
+    uint8_t mask;
+    const char* error = NULL;
+    if (negated) {
+        mask = 0x01;  // !attribut : non
+        if (!boolean) {
+            error = "négation réservée aux attributs oui/non";
+        }
+    } else if (accept(parser, "!=")) {
+        error = parse_values(parser, (uint32_t)attribute, &mask);
+        mask = (uint8_t)(~mask & domain);
+    } else if (!peek(parser, "=>") && accept(parser, "=")) {
+        error = parse_values(parser, (uint32_t)attribute, &mask);
+    } else {
+        mask = 0x02;  // attribut seul : oui
+        if (!boolean) {
+            error = "valeur attendue";
+        }
+    }
+    
+    allowed[attribute] &= mask;
+    return error;
+}
+
+// Code existant ou nouveau code avec son texte
+static const char* add_code(rule_set_t* set, const char* code, uint8_t category, const char* message,
+                            size_t message_length, uint8_t* index)
+{
+    for (uint8_t c = 0; c < set->code_count; c++) {
+        if (strcmp(set->codes[c].code, code) == 0) {
+            set->codes[c].categories |= category;
+            *index = c;
+            return NULL;
+        }
+    }
+    
+    if (set->code_count >= RULE_MAX_CODES) {
+        return "trop de codes";
+    }
+    if (strlen(code) >= RULE_CODE_LEN) {
+        return "code trop long";
+    }
+    if (set->messages_length + message_length + 1 > sizeof(set->messages)) {
+        return "textes des règles trop longs";
+    }
+    
+    rule_code_t* entry = &set->codes[set->code_count];
+    strcpy(entry->code, code);
+    entry->categories = category;
+    entry->message = set->messages_length;
+    memcpy(&set->messages[set->messages_length], message, message_length);
+    set->messages[set->messages_length + message_length] = '\0';
+    set->messages_length += (uint16_t)(message_length + 1);
+    
+    *index = set->code_count++;
+    return NULL;
+}
+
+// Compile une ligne : CODE sujet [categorie] : conditions => "texte"
+static const char* compile_line(rule_set_t* set, rule_parser_t* parser)
+{
+    char code[MAX_TOKEN_LEN];
+    
+    if (!read_word(parser)) {
+        return "code attendu";
+    }
+    strcpy(code, parser->token);
+    
+    if (!read_word(parser)) {
+        return "sujet attendu";
+    }
+    int32_t subject = -1;
+    for (uint32_t s = 0; s < RULE_SUBJECT_COUNT; s++) {
+        if (strcmp(k_subjects[s], parser->token) == 0) {
+            subject = (int32_t)s;
+        }
+    }
+    if (subject < 0) {
+        return "sujet inconnu";
+    }
+    
+    uint8_t category = RULE_CATEGORY_OTHER;
+    if (read_word(parser)) {
+        category = 0;
+        for (uint32_t c = 0; c < CATEGORY_COUNT; c++) {
+            if (strcmp(k_categories[c].name, parser->token) == 0) {
+                category = k_categories[c].category;
+            }
+        }
+        if (category == 0) {
+            return "catégorie inconnue";
+        }
+    }
+    if (!accept(parser, ":")) {
+        return "':' attendu";
+    }
+    
+    uint8_t allowed[RULE_ATTR_COUNT];
+    memset(allowed, 0xFF, sizeof(allowed));
+    do {
+        const char* error = parse_condition(parser, (rule_subject_t)subject, allowed);
+        if (error != NULL) {
+            return error;
+        }
+    } while (accept(parser, ","));
+    
+    if (!accept(parser, "=>") || !accept(parser, "\"")) {
+        return "'=> \"texte\"' attendu";
+    }
+    const char* message = parser->pos;
+    while (parser->pos < parser->end && *parser->pos != '"') {
+        parser->pos++;
+    }
+    if (parser->pos >= parser->end) {
+        return "texte non fermé";
+    }
+    size_t message_length = (size_t)(parser->pos - message);
+    parser->pos++;
+    skip_spaces(parser);
+    if (parser->pos < parser->end) {
+        return "fin de ligne attendue";
+    }
+    
+    if (set->rule_count[subject] >= REGULATORY_MAX_RULES) {
+        return "trop de règles";
+    }
+    
+    // Valeurs exclues de chaque attribut, placées à la position de l'attribut dans les faits
+    compiled_rule_t* rule = &set->rules[subject][set->rule_count[subject]];
+    rule->excluded = 0;
+    for (uint32_t a = 0; a < RULE_ATTR_COUNT; a++) {
+        uint8_t domain = (uint8_t)((1 << g_domain_sizes[a]) - 1);
+        rule->excluded |= (uint64_t)(~allowed[a] & domain) << g_offsets[a];
+    }
+    
+    const char* error = add_code(set, code, category, message, message_length, &rule->code);
+    if (error != NULL) {
+        return error;
+    }
+    set->rule_count[subject]++;
+    
+    return NULL;
+}
+
+void rule_set_init(rule_set_t* set)
+{
+    if (!g_layout_ready) {
+        prepare_layout();
+    }
+    
+    memset(set, 0, sizeof(rule_set_t));
+}
+
+system_error_t rule_set_compile(rule_set_t* set, const char* source, const char* source_name)
+{
+    if (set == NULL || source == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t line = 0;
+    const char* pos = source;
+    while (*pos != '\0') {
+        const char* end = strchr(pos, '\n');
+        if (end == NULL) {
+            end = pos + strlen(pos);
+        }
+        line++;
+        
+        rule_parser_t parser = { .pos = pos, .end = end };
+        skip_spaces(&parser);
+        if (parser.pos < parser.end && *parser.pos != '#') {
+            const char* error = compile_line(set, &parser);
+            if (error != NULL) {
+                ESP_LOGE(TAG, "%s:%u: %s", source_name, (unsigned)line, error);
+                return SYSTEM_ERROR_INVALID_PARAM;
+            }
+        }
+        
+        pos = (*end == '\n') ? end + 1 : end;
+    }
+    
+    ESP_LOGI(TAG, "Règles %s compilées (%u règles animal, %u règles transaction, %u codes)", source_name,
+             set->rule_count[RULE_SUBJECT_ANIMAL], set->rule_count[RULE_SUBJECT_TRANSACTION], set->code_count);
+    return SYSTEM_OK;
+}
+
+void rule_facts_set(rule_facts_t* facts, rule_attribute_t attribute, uint32_t value)
+{
+    if (value < g_domain_sizes[attribute]) {
+        *facts |= (uint64_t)1 << (g_offsets[attribute] + value);
+    }
+}
+
+uint32_t rule_set_evaluate(const rule_set_t* set, rule_subject_t subject, rule_facts_t facts)
+{
+    const compiled_rule_t* rule = set->rules[subject];
+    uint32_t codes = 0;
+    
+    for (uint32_t r = 0; r < set->rule_count[subject]; r++, rule++) {
+        if ((facts & rule->excluded) == 0) {
+            codes |= 1u << rule->code;
+        }
+    }
+    
+    return codes;
+}
+
+uint8_t rule_set_categories(const rule_set_t* set, uint32_t codes)
+{
+    uint8_t categories = 0;
+    
+    for (uint32_t c = 0; c < set->code_count; c++) {
+        if (codes & (1u << c)) {
+            categories |= set->codes[c].categories;
+        }
+    }
+    
+    return categories;
+}
+
+void rule_set_describe(const rule_set_t* set, uint32_t codes, char* out, size_t out_size)
+{
+    size_t length = 0;
+    
+    out[0] = '\0';
+    for (uint32_t c = 0; c < set->code_count && length + 1 < out_size; c++) {
+        if (!(codes & (1u << c))) {
+            continue;
+        }
+        int written = snprintf(&out[length], out_size - length, "%s%s: %s", (length > 0) ? "; " : "",
+                               set->codes[c].code, &set->messages[set->codes[c].message]);
+        if (written < 0) {
+            break;
+        }
+        length += (size_t)written;
+    }
+}
\ No newline at end of file
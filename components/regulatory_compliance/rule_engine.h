@@ -0,0 +1,129 @@
+#ifndef RULE_ENGINE_H
+#define RULE_ENGINE_H
+
+#include "regulatory_compliance.h"
+
+// Attributs des faits soumis aux règles, chacun prenant une valeur d'un petit domaine
+typedef enum {
+    RULE_ATTR_CITES,                // aucune, I, II, III
+    RULE_ATTR_EU_ANNEX,             // aucune, A, B, C, D
+    RULE_ATTR_FRENCH_STATUS,        // libre, declaration, certificat, interdit
+    RULE_ATTR_LISTED,               // Espèce présente dans la table
+    RULE_ATTR_SPECIES_PERMIT,       // Permis exigé pour l'espèce
+    RULE_ATTR_SPECIES_BREEDING,     // Reproduction autorisée pour l'espèce
+    RULE_ATTR_SPECIES_TRADE,        // Commerce autorisé pour l'espèce
+    RULE_ATTR_CITES_SUBJECT,        // Espèce inscrite ou animal déclaré CITES
+    RULE_ATTR_ANIMAL_STATUS,        // actif, vendu, decede, quarantaine, reproduction
+    RULE_ATTR_CITES_NUMBER,         // Numéro CITES saisi sur l'animal
+    RULE_ATTR_PERMIT,               // aucun, valide, expire
+    RULE_ATTR_FAILED_TRANSACTIONS,  // Au moins une transaction non conforme
+    RULE_ATTR_TRANSACTION_TYPE,     // achat, vente, echange, don, elevage, deces, fuite
+    RULE_ATTR_TRANSACTION_STATUS,   // en_attente, terminee, annulee, remboursee
+    RULE_ATTR_PERMIT_NUMBER,        // Numéro de permis saisi sur la transaction
+    RULE_ATTR_COUNT
+} rule_attribute_t;
+
+// Sujet d'une règle
+typedef enum {
+    RULE_SUBJECT_ANIMAL,
+    RULE_SUBJECT_TRANSACTION,
+    RULE_SUBJECT_COUNT
+} rule_subject_t;
+
+// Catégories d'un manquement (alimentent les statistiques et les indicateurs de conformité)
+#define RULE_CATEGORY_PERMIT_MISSING  0x01
+#define RULE_CATEGORY_PERMIT_EXPIRED  0x02
+#define RULE_CATEGORY_BREEDING        0x04
+#define RULE_CATEGORY_TRADE           0x08
+#define RULE_CATEGORY_PENDING         0x10  // Démarche en cours, pas un manquement
+#define RULE_CATEGORY_OTHER           0x20
+
+#define RULE_MAX_CODES      32  // Un bit par code dans les résultats
+#define RULE_CODE_LEN       24
+
+// Faits d'un sujet : un bit par couple (attribut, valeur), une seule valeur par attribut
+typedef uint64_t rule_facts_t;
+
+// Règle compilée : elle s'applique si aucun fait ne prend une valeur exclue par ses conditions
+typedef struct {
+    uint64_t excluded;
+    uint8_t code;
+} compiled_rule_t;
+
+typedef struct {
+    char code[RULE_CODE_LEN];
+    uint16_t message;       // Position du texte dans messages
+    uint8_t categories;
+} rule_code_t;
+
+// Jeu de règles compilé en table de décision
+typedef struct {
+    compiled_rule_t rules[RULE_SUBJECT_COUNT][REGULATORY_MAX_RULES];
+    uint16_t rule_count[RULE_SUBJECT_COUNT];
+    rule_code_t codes[RULE_MAX_CODES];
+    uint8_t code_count;
+    char messages[REGULATORY_RULE_TEXT_SIZE];
+    uint16_t messages_length;
+} rule_set_t;
+
+/**
+ * @brief Vide un jeu de règles
+ * @param set Jeu de règles
+ */
+void rule_set_init(rule_set_t* set);
+
+/**
+ * @brief Compile un texte de règles et l'ajoute au jeu
+ *
+ * Une règle par ligne, les lignes vides et celles commençant par # sont ignorées :
+ *   CODE sujet [categorie] : condition, condition... => "texte"
+ * Conditions : attribut (vaut oui), !attribut (vaut non), attribut = valeur,
+ * attribut != valeur, attribut = {valeur valeur...}, attribut != {valeur...}.
+ * Plusieurs règles peuvent partager un code : le manquement est relevé si l'une s'applique.
+ *
+ * @param set Jeu de règles
+ * @param source Texte des règles
+ * @param source_name Nom de la source (messages d'erreur)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_INVALID_PARAM si le texte est invalide
+ */
+system_error_t rule_set_compile(rule_set_t* set, const char* source, const char* source_name);
+
+/**
+ * @brief Fixe la valeur d'un attribut dans des faits
+ * @param facts Faits à compléter (initialisés à 0, chaque attribut du sujet doit être fixé)
+ * @param attribute Attribut
+ * @param value Indice de la valeur dans le domaine de l'attribut
+ */
+void rule_facts_set(rule_facts_t* facts, rule_attribute_t attribute, uint32_t value);
+
+/**
+ * @brief Évalue les règles d'un sujet
+ * @param set Jeu de règles
+ * @param subject Sujet évalué
+ * @param facts Faits du sujet
+ * @return Masque des codes de manquement relevés
+ */
+uint32_t rule_set_evaluate(const rule_set_t* set, rule_subject_t subject, rule_facts_t facts);
+
+/**
+ * @brief Réunit les catégories de codes de manquement
+ * @param set Jeu de règles
+ * @param codes Masque des codes
+ * @return Catégories RULE_CATEGORY_*
+ */
+uint8_t rule_set_categories(const rule_set_t* set, uint32_t codes);
+
+/**
+ * @brief Décrit des manquements sous la forme "CODE: texte; CODE: texte"
+ * @param set Jeu de règles
+ * @param codes Masque des codes
+ * @param out Buffer de sortie
+ * @param out_size Taille du buffer
+ */
+void rule_set_describe(const rule_set_t* set, uint32_t codes, char* out, size_t out_size);
+
+// Règles intégrées, compilées au démarrage (eu_regulations.c, french_regulations.c)
+extern const char* const g_eu_regulation_rules;
+extern const char* const g_french_regulation_rules;
+
+#endif // RULE_ENGINE_H
\ No newline at end of file
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""Génère la table des réglementations d'espèces (species_table.c) à partir des CSV.
+
+La table est triée par nom scientifique normalisé ; un second tableau regroupe tous
+les noms recherchables (scientifiques, communs et synonymes) triés par nom normalisé
+pour la recherche exacte et la recherche approchée de cites_checker.c. Toutes les
+données sont constantes et restent en flash.
+
+Usage : gen_species_table.py <species_regulations.csv> <species_synonyms.csv> <species_table.c>
+"""
+
+import csv
+import io
+import os
+import sys
+
+CITES_LEVELS = {"": "CITES_NONE", "I": "CITES_APPENDIX_I", "II": "CITES_APPENDIX_II", "III": "CITES_APPENDIX_III"}
+EU_ANNEXES = {"": "EU_ANNEX_NONE", "A": "EU_ANNEX_A", "B": "EU_ANNEX_B", "C": "EU_ANNEX_C", "D": "EU_ANNEX_D"}
+FRENCH_STATUSES = {
+    "libre": "FRENCH_STATUS_FREE",
+    "declaration": "FRENCH_STATUS_DECLARATION",
+    "certificat": "FRENCH_STATUS_CAPACITY_CERTIFICATE",
+    "interdit": "FRENCH_STATUS_PROHIBITED",
+}
+FLAGS = (("permis", "SPECIES_RULE_PERMIT"), ("elevage", "SPECIES_RULE_BREEDING"), ("commerce", "SPECIES_RULE_TRADE"))
+GENUS_SUFFIXES = (" spp", " sp")  # Après normalisation : "Python spp." devient "python spp"
+MAX_NAME_LEN = 63  # MAX_SPECIES_NAME_LEN - 1
+MAX_RESTRICTIONS_LEN = 255
+# Repli des lettres latines accentuées U+00C0 à U+00FF, identique à k_latin1_fold de cites_checker.c
+LATIN1_FOLD = "aaaaaaaceeeeiiiidnooooo ouuuuy saaaaaaaceeeeiiiidnooooo ouuuuy y"
+
+
+def fail(line, message):
+    sys.exit("species_regulations.csv:%d: %s" % (line, message))
+
+
+def normalize(name):
+    """Même normalisation que cites_checker.c : minuscules sans accents, autres signes en espaces."""
+    out = ""
+    for c in name:
+        if "A" <= c <= "Z" or "a" <= c <= "z" or "0" <= c <= "9":
+            out += c.lower()
+        elif 0xC0 <= ord(c) <= 0xFF:
+            out += LATIN1_FOLD[ord(c) - 0xC0]
+        else:
+            out += " "
+    return " ".join(out.split()).encode()
+
+
+def species_key(scientific):
+    key = normalize(scientific)
+    for suffix in GENUS_SUFFIXES:
+        if key.endswith(suffix.encode()):
+            return key[:-len(suffix)]
+    return key
+
+
+def letters(name):
+    """Ensemble des lettres du nom, comme species_name_letters de cites_checker.c."""
+    mask = 0
+    for c in name:
+        if 97 <= c <= 122:
+            mask |= 1 << (c - 97)
+    return mask
+
+
+def c_string(data):
+    out = '"'
+    for c in data:
+        if c in (0x22, 0x5C):
+            out += "\\" + chr(c)
+        elif 0x20 <= c < 0x7F:
+            out += chr(c)
+        else:
+            out += '\\%03o' % c
+    return out + '"'
+
+
+def read_rows(path):
+    with open(path, encoding="utf-8") as f:
+        lines = [(i + 1, l) for i, l in enumerate(f) if l.strip() and not l.lstrip().startswith("#")]
+    reader = csv.DictReader(io.StringIO("".join(l for _, l in lines)))
+    for (line, _), row in zip(lines[1:], reader):
+        yield line, {k: (v or "").strip() for k, v in row.items()}
+
+
+def parse(path):
+    rules = {}
+    for line, row in read_rows(path):
+        scientific = row["nom_scientifique"]
+        key = species_key(scientific)
+        if not key or len(scientific.encode()) > MAX_NAME_LEN or len(row["nom_commun"].encode()) > MAX_NAME_LEN:
+            fail(line, "nom vide ou trop long")
+        if key in rules:
+            fail(line, "espèce en double : %s" % scientific)
+        if len(row["restrictions"].encode()) > MAX_RESTRICTIONS_LEN:
+            fail(line, "restrictions trop longues")
+        try:
+            flags = [name for column, name in FLAGS if int(row[column])]
+            rules[key] = (scientific, row["nom_commun"], CITES_LEVELS[row["cites"].upper()],
+                          EU_ANNEXES[row["annexe_ue"].upper()], FRENCH_STATUSES[row["statut_fr"].lower()],
+                          flags, row["restrictions"])
+        except (KeyError, ValueError) as error:
+            fail(line, "valeur invalide %s" % error)
+    return rules
+
+
+def add_name(names, name, species, origin):
+    """Ajoute un nom recherchable ; un même nom ne peut désigner deux espèces."""
+    if not name:
+        return
+    if len(name) > MAX_NAME_LEN:
+        sys.exit("%s : nom trop long" % origin)
+    if names.get(name, species) != species:
+        sys.exit("%s : nom déjà attribué à une autre espèce : %s" % (origin, name.decode()))
+    names[name] = species
+
+
+def collect_names(path, rules, keys):
+    index = {key: i for i, key in enumerate(keys)}
+    names = {}
+    for i, key in enumerate(keys):
+        add_name(names, key, i, "species_regulations.csv")
+        add_name(names, normalize(rules[key][1]), i, "species_regulations.csv")
+    for line, row in read_rows(path):
+        species = index.get(species_key(row["nom_scientifique"]))
+        if species is None:
+            sys.exit("species_synonyms.csv:%d: espèce inconnue : %s" % (line, row["nom_scientifique"]))
+        add_name(names, normalize(row["synonyme"]), species, "species_synonyms.csv:%d" % line)
+    return sorted(names.items())
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.exit(__doc__)
+    source, synonyms, output = sys.argv[1], sys.argv[2], sys.argv[3]
+    rules = parse(source)
+    keys = sorted(rules)
+    if len(keys) > 0xFFFF:
+        sys.exit("species_regulations.csv: trop d'espèces")
+    names = collect_names(synonyms, rules, keys)
+
+    out = ["// Fichier généré par tools/gen_species_table.py à partir des CSV de data/ : ne pas modifier",
+           '#include "cites_checker.h"', "",
+           "const species_rule_t g_species_rules[] = {"]
+    for key in keys:
+        scientific, common, cites, annex, status, flags, restrictions = rules[key]
+        out.append("    { %s, %s, %s, %s, %s, %s, %s, %s }," % (
+            c_string(key), c_string(scientific.encode()), c_string(common.encode()),
+            cites, annex, status, " | ".join(flags) or "0", c_string(restrictions.encode())))
+    out += ["};", "",
+            "const species_name_t g_species_names[] = {"]
+    for name, species in names:
+        out.append("    { %s, 0x%08X, %d, %d }," % (c_string(name), letters(name), species, len(name)))
+    out += ["};", "",
+            "const uint32_t g_species_rule_count = %d;" % len(keys),
+            "const uint32_t g_species_name_count = %d;" % len(names),
+            "const time_t g_species_table_date = %d;" % int(max(os.path.getmtime(source), os.path.getmtime(synonyms))),
+            ""]
+
+    with open(output, "w", encoding="utf-8", newline="\n") as f:
+        f.write("\n".join(out))
+
+
+if __name__ == "__main__":
+    main()
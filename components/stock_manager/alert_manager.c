@@ -1,9 +1,169 @@
-#include "stock_manager.h"
+#include "alert_manager.h"
 #include "esp_log.h"
+#include <string.h>
 
 static const char* TAG = "ALERT_MANAGER";
 
+// Index des expirations trié par (date, ID) : seuls les articles datés y figurent
+static expiry_entry_t g_expiry_index[MAX_STOCK_ITEMS];
+static uint32_t g_expiry_count = 0;
+
+// Ensemble trié des articles dont la quantité est sous le seuil minimum
+static uint32_t g_low_stock_ids[MAX_STOCK_ITEMS];
+static uint32_t g_low_stock_count = 0;
+
+static bool is_low_stock(const stock_item_t* item)
+{
+    return item->current_quantity <= item->min_quantity;
+}
+
+static int compare_expiry(time_t date_a, uint32_t id_a, time_t date_b, uint32_t id_b)
+{
+    if (date_a != date_b) {
+        return (date_a < date_b) ? -1 : 1;
+    }
+    if (id_a != id_b) {
+        return (id_a < id_b) ? -1 : 1;
+    }
+    return 0;
+}
+
+// Première position dont l'entrée n'est pas strictement inférieure à (date, id)
+static uint32_t expiry_lower_bound(time_t date, uint32_t item_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_expiry_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (compare_expiry(g_expiry_index[mid].expiry_date, g_expiry_index[mid].item_id, date, item_id) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+// Nombre d'entrées dont la date est inférieure ou égale à until
+static uint32_t expiry_count_until(time_t until)
+{
+    return expiry_lower_bound(until, UINT32_MAX);
+}
+
+static void expiry_insert(time_t date, uint32_t item_id)
+{
+    if (date == 0 || g_expiry_count >= MAX_STOCK_ITEMS) {
+        return;
+    }
+    
+    uint32_t pos = expiry_lower_bound(date, item_id);
+    memmove(&g_expiry_index[pos + 1], &g_expiry_index[pos],
+            (g_expiry_count - pos) * sizeof(expiry_entry_t));
+    g_expiry_index[pos].expiry_date = date;
+    g_expiry_index[pos].item_id = item_id;
+    g_expiry_count++;
+}
+
+static void expiry_remove(time_t date, uint32_t item_id)
+{
+    if (date == 0) {
+        return;
+    }
+    
+    uint32_t pos = expiry_lower_bound(date, item_id);
+    if (pos < g_expiry_count && g_expiry_index[pos].item_id == item_id &&
+        g_expiry_index[pos].expiry_date == date) {
+        memmove(&g_expiry_index[pos], &g_expiry_index[pos + 1],
+                (g_expiry_count - pos - 1) * sizeof(expiry_entry_t));
+        g_expiry_count--;
+    }
+}
+
+static uint32_t low_stock_lower_bound(uint32_t item_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_low_stock_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_low_stock_ids[mid] < item_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void low_stock_set(uint32_t item_id, bool is_low)
+{
+    uint32_t pos = low_stock_lower_bound(item_id);
+    bool present = (pos < g_low_stock_count && g_low_stock_ids[pos] == item_id);
+    
+    if (is_low && !present && g_low_stock_count < MAX_STOCK_ITEMS) {
+        memmove(&g_low_stock_ids[pos + 1], &g_low_stock_ids[pos],
+                (g_low_stock_count - pos) * sizeof(uint32_t));
+        g_low_stock_ids[pos] = item_id;
+        g_low_stock_count++;
+    } else if (!is_low && present) {
+        memmove(&g_low_stock_ids[pos], &g_low_stock_ids[pos + 1],
+                (g_low_stock_count - pos - 1) * sizeof(uint32_t));
+        g_low_stock_count--;
+    }
+}
+
 void alert_manager_init(void)
 {
+    g_expiry_count = 0;
+    g_low_stock_count = 0;
+    
     ESP_LOGI(TAG, "Gestionnaire d'alertes initialisé");
+}
+
+bool alert_manager_item_changed(const stock_item_t* old_item, const stock_item_t* new_item)
+{
+    bool was_low = (old_item != NULL) && is_low_stock(old_item);
+    bool now_low = (new_item != NULL) && is_low_stock(new_item);
+    
+    // Repositionner l'article dans l'index uniquement si sa date a changé
+    if (old_item == NULL || new_item == NULL || old_item->expiry_date != new_item->expiry_date) {
+        if (old_item != NULL) {
+            expiry_remove(old_item->expiry_date, old_item->id);
+        }
+        if (new_item != NULL) {
+            expiry_insert(new_item->expiry_date, new_item->id);
+        }
+    }
+    
+    if (was_low != now_low || new_item == NULL) {
+        uint32_t item_id = (new_item != NULL) ? new_item->id : old_item->id;
+        low_stock_set(item_id, now_low);
+    }
+    
+    return now_low && !was_low;
+}
+
+const expiry_entry_t* alert_manager_get_expiring(time_t until, uint32_t* count)
+{
+    *count = expiry_count_until(until);
+    return g_expiry_index;
+}
+
+const uint32_t* alert_manager_get_low_stock(uint32_t* count)
+{
+    *count = g_low_stock_count;
+    return g_low_stock_ids;
+}
+
+void alert_manager_get_counts(time_t now, uint32_t* low_stock, uint32_t* expired, uint32_t* near_expiry)
+{
+    uint32_t expired_count = expiry_count_until(now);
+    uint32_t horizon_count = expiry_count_until(now + (time_t)STOCK_NEAR_EXPIRY_DAYS * 24 * 3600);
+    
+    *low_stock = g_low_stock_count;
+    *expired = expired_count;
+    *near_expiry = horizon_count - expired_count;
 }
\ No newline at end of file
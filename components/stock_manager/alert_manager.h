@@ -0,0 +1,49 @@
+#ifndef ALERT_MANAGER_H
+#define ALERT_MANAGER_H
+
+#include "stock_manager.h"
+
+// Entrée de l'index des dates d'expiration (trié par date puis par ID)
+typedef struct {
+    time_t expiry_date;
+    uint32_t item_id;
+} expiry_entry_t;
+
+/**
+ * @brief Initialise les index d'alertes (expiration et stock bas)
+ */
+void alert_manager_init(void);
+
+/**
+ * @brief Met à jour les index après une modification d'article
+ * @param old_item État précédent de l'article (NULL pour un ajout)
+ * @param new_item Nouvel état de l'article (NULL pour une suppression)
+ * @return true si l'article vient de passer sous son seuil minimum
+ */
+bool alert_manager_item_changed(const stock_item_t* old_item, const stock_item_t* new_item);
+
+/**
+ * @brief Récupère les entrées dont l'expiration est antérieure ou égale à une date
+ * @param until Date limite (incluse)
+ * @param count Pointeur vers le nombre d'entrées concernées
+ * @return Début de l'index trié (valide jusqu'à la prochaine modification)
+ */
+const expiry_entry_t* alert_manager_get_expiring(time_t until, uint32_t* count);
+
+/**
+ * @brief Récupère l'ensemble des articles en stock bas
+ * @param count Pointeur vers le nombre d'articles
+ * @return Tableau trié d'IDs (valide jusqu'à la prochaine modification)
+ */
+const uint32_t* alert_manager_get_low_stock(uint32_t* count);
+
+/**
+ * @brief Compte les articles en alerte sans parcourir le catalogue
+ * @param now Date de référence
+ * @param low_stock Nombre d'articles en stock bas
+ * @param expired Nombre d'articles expirés
+ * @param near_expiry Nombre d'articles proches de l'expiration
+ */
+void alert_manager_get_counts(time_t now, uint32_t* low_stock, uint32_t* expired, uint32_t* near_expiry);
+
+#endif // ALERT_MANAGER_H
\ No newline at end of file
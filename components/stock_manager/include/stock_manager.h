@@ -24,6 +24,12 @@ typedef enum {
     UNIT_METERS
 } stock_unit_t;
 
+// Ordre de consommation des lots d'un article
+typedef enum {
+    STOCK_LOT_POLICY_FEFO,  // Premier expiré, premier sorti
+    STOCK_LOT_POLICY_FIFO   // Premier entré, premier sorti
+} stock_lot_policy_t;
+
 // Structure d'un article en stock
 typedef struct {
     uint32_t id;
@@ -36,17 +42,45 @@ typedef struct {
     float max_quantity;
     float unit_price;
     char supplier[128];
-    char batch_number[32];
-    time_t expiry_date;
+    uint32_t supplier_id;   // Fournisseur habituel (0 si aucun)
+    char batch_number[32];  // Lot consommé en premier
+    time_t expiry_date;     // Expiration la plus proche parmi les lots
+    stock_lot_policy_t lot_policy;
+    uint16_t lot_count;
     time_t last_restocked;
     bool alert_enabled;
     bool expired_alert;
     char storage_location[64];
     char notes[256];
+    float daily_consumption;       // Consommation journalière lissée (EWMA)
+    time_t predicted_stockout_date; // 0 si aucune consommation observée
+    float suggested_reorder_qty;
+    uint32_t consumption_day;      // Jour (depuis l'epoch) en cours d'accumulation
+    float consumption_today;       // Consommation cumulée du jour en cours
     time_t created_at;
     time_t updated_at;
+    uint32_t change_version;       // Version de la dernière modification (attribuée par le gestionnaire)
 } stock_item_t;
 
+/**
+ * @brief Fonction appelée pour chaque article d'un parcours
+ * @param item Article (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ * @return true pour continuer le parcours, false pour l'arrêter
+ */
+typedef bool (*stock_item_visit_fn_t)(const stock_item_t* item, void* context);
+
+// Structure d'un lot (quantité reçue avec un même numéro et une même date d'expiration)
+typedef struct {
+    uint32_t id;
+    uint32_t item_id;
+    char batch_number[32];
+    float quantity;
+    float unit_price;
+    time_t received_date;
+    time_t expiry_date;  // 0 si le lot n'expire pas
+} stock_lot_t;
+
 // Structure pour les mouvements de stock
 typedef struct {
     uint32_t id;
@@ -73,6 +107,63 @@ typedef struct {
     bool is_near_expiry;
 } stock_alert_t;
 
+// Déduction agrégée pour un article
+typedef struct {
+    uint32_t item_id;
+    float quantity;
+    uint32_t source_count;  // Nombre de demandes regroupées
+} stock_deduction_t;
+
+// Lot de déductions appliqué en une seule opération
+typedef struct {
+    stock_deduction_t lines[STOCK_BATCH_MAX_LINES];
+    uint32_t line_count;
+    char reason[128];
+} stock_deduction_batch_t;
+
+// Structure d'un fournisseur
+typedef struct {
+    uint32_t id;
+    char name[128];
+    char email[64];
+    char phone[32];
+    uint16_t default_lead_time_days;
+    bool is_active;
+    time_t created_at;
+    time_t updated_at;
+} stock_supplier_t;
+
+// Prix proposé par un fournisseur pour un article à une date donnée
+typedef struct {
+    uint32_t item_id;
+    uint32_t supplier_id;
+    float unit_price;
+    uint16_t lead_time_days;
+    time_t recorded_at;
+} stock_price_record_t;
+
+// Critère de choix du fournisseur
+typedef enum {
+    SUPPLIER_CRITERIA_CHEAPEST,
+    SUPPLIER_CRITERIA_FASTEST
+} supplier_criteria_t;
+
+// Ligne de bon de commande
+typedef struct {
+    uint32_t item_id;
+    float quantity;
+    float unit_price;
+} purchase_order_line_t;
+
+// Bon de commande regroupant les articles d'un même fournisseur
+typedef struct {
+    uint32_t supplier_id;
+    purchase_order_line_t lines[STOCK_PO_MAX_LINES];
+    uint32_t line_count;
+    float total_amount;
+    uint16_t lead_time_days;  // Délai le plus long parmi les lignes
+} purchase_order_t;
+
 // Structure pour les statistiques
 typedef struct {
     uint32_t total_items;
@@ -129,6 +220,46 @@ system_error_t stock_get_item_by_id(uint32_t item_id, stock_item_t* item);
  */
 system_error_t stock_get_all_items(stock_item_t* items, uint32_t max_count, uint32_t* count);
 
+/**
+ * @brief Parcourt les articles par ID croissant (prévisions de consommation à jour)
+ *
+ * Les articles sont copiés sous le verrou par petits lots et visit est appelée hors du verrou :
+ * elle peut lire ou modifier le stock, un parcours reflète alors chaque lot au moment de sa copie.
+ *
+ * @param visit Fonction appelée pour chaque article
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot n'a pas pu être alloué
+ */
+system_error_t stock_for_each_item(stock_item_visit_fn_t visit, void* context);
+
+/**
+ * @brief Restaure des articles sauvegardés avec leurs IDs (un article de même ID est remplacé)
+ *
+ * Le détail des lots n'est pas sauvegardé : la quantité de chaque article forme un lot unique.
+ *
+ * @param items Articles à restaurer
+ * @param count Nombre d'articles
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si la table est pleine
+ */
+system_error_t stock_restore_items(const stock_item_t* items, uint32_t count);
+
+/**
+ * @brief Version de changement courante, avancée à chaque modification d'un article (quantités comprises)
+ * @return Dernière version attribuée (0 au démarrage)
+ */
+uint32_t stock_get_change_version(void);
+
+/**
+ * @brief Copie les suppressions d'articles postérieures à une version de changement
+ * @param since_version Version de référence
+ * @param deletions Tableau à remplir (CHANGE_LOG_DELETIONS entrées suffisent)
+ * @param max_count Taille du tableau
+ * @param count Pointeur vers le nombre de suppressions copiées
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si des suppressions postérieures ont été oubliées
+ */
+system_error_t stock_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                   uint32_t* count);
+
 /**
  * @brief Ajoute du stock (entrée)
  * @param item_id ID de l'article
@@ -140,14 +271,60 @@ system_error_t stock_get_all_items(stock_item_t* items, uint32_t max_count, uint
 system_error_t stock_add_quantity(uint32_t item_id, float quantity, float unit_price, const char* reference);
 
 /**
- * @brief Retire du stock (sortie)
+ * @brief Ajoute un lot à un article (entrée)
  * @param item_id ID de l'article
- * @param quantity Quantité à retirer
- * @param reason Raison de la sortie
+ * @param lot Pointeur vers le lot (l'ID attribué y est écrit)
+ * @param reference Référence de la transaction
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_add_lot(uint32_t item_id, stock_lot_t* lot, const char* reference);
+
+/**
+ * @brief Récupère les lots d'un article dans l'ordre de consommation
+ * @param item_id ID de l'article
+ * @param lots Tableau de lots à remplir
+ * @param max_count Nombre maximum de lots
+ * @param count Pointeur vers le nombre de lots récupérés
  * @return SYSTEM_OK en cas de succès
  */
+system_error_t stock_get_lots(uint32_t item_id, stock_lot_t* lots, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Retire du stock (sortie) en consommant les lots selon la politique de l'article
+ * @param item_id ID de l'article
+ * @param quantity Quantité à retirer, strictement positive
+ * @param reason Raison de la sortie
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_INVALID_PARAM si la quantité est nulle ou négative
+ */
 system_error_t stock_remove_quantity(uint32_t item_id, float quantity, const char* reason);
 
+/**
+ * @brief Prépare un lot de déductions vide
+ * @param batch Lot à initialiser
+ * @param reason Raison commune des sorties (peut être NULL)
+ */
+void stock_batch_init(stock_deduction_batch_t* batch, const char* reason);
+
+/**
+ * @brief Ajoute une déduction au lot, cumulée avec celles du même article
+ * @param batch Lot de déductions
+ * @param item_id ID de l'article
+ * @param quantity Quantité à retirer
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot est plein
+ */
+system_error_t stock_batch_add(stock_deduction_batch_t* batch, uint32_t item_id, float quantity);
+
+/**
+ * @brief Applique toutes les déductions du lot, ou aucune si l'une est impossible
+ *
+ * Les lignes d'articles supprimés entre-temps sont retirées du lot avant la validation.
+ *
+ * @param batch Lot de déductions (vidé après application)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR si le stock d'un article est insuffisant
+ *         (le lot est alors conservé)
+ */
+system_error_t stock_batch_commit(stock_deduction_batch_t* batch);
+
 /**
  * @brief Ajuste le stock
  * @param item_id ID de l'article
@@ -183,6 +360,81 @@ system_error_t stock_get_alerts(stock_alert_t* alerts, uint32_t max_count, uint3
  */
 system_error_t stock_check_alerts(void);
 
+/**
+ * @brief Ajoute un fournisseur
+ * @param supplier Pointeur vers la structure fournisseur (l'ID attribué y est écrit)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_add(stock_supplier_t* supplier);
+
+/**
+ * @brief Met à jour un fournisseur
+ * @param supplier Pointeur vers la structure fournisseur
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_update(const stock_supplier_t* supplier);
+
+/**
+ * @brief Récupère un fournisseur par son ID
+ * @param supplier_id ID du fournisseur
+ * @param supplier Pointeur vers la structure fournisseur à remplir
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_get(uint32_t supplier_id, stock_supplier_t* supplier);
+
+/**
+ * @brief Récupère tous les fournisseurs
+ * @param suppliers Tableau de fournisseurs à remplir
+ * @param max_count Nombre maximum de fournisseurs
+ * @param count Pointeur vers le nombre de fournisseurs récupérés
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_get_all(stock_supplier_t* suppliers, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Enregistre un nouveau prix d'un fournisseur pour un article
+ * @param item_id ID de l'article
+ * @param supplier_id ID du fournisseur
+ * @param unit_price Prix unitaire
+ * @param lead_time_days Délai de livraison en jours (0 pour le délai par défaut du fournisseur)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_record_price(uint32_t item_id, uint32_t supplier_id,
+                                          float unit_price, uint16_t lead_time_days);
+
+/**
+ * @brief Récupère l'historique des prix d'un article, du plus récent au plus ancien
+ * @param item_id ID de l'article
+ * @param supplier_id ID du fournisseur (0 pour tous)
+ * @param records Tableau de prix à remplir
+ * @param max_count Nombre maximum d'entrées
+ * @param count Pointeur vers le nombre d'entrées récupérées
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_supplier_get_price_history(uint32_t item_id, uint32_t supplier_id,
+                                               stock_price_record_t* records, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Récupère la meilleure offre courante pour un article
+ * @param item_id ID de l'article
+ * @param criteria Critère de choix (moins cher ou plus rapide)
+ * @param offer Pointeur vers l'offre à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si aucune offre
+ */
+system_error_t stock_supplier_get_best_offer(uint32_t item_id, supplier_criteria_t criteria,
+                                            stock_price_record_t* offer);
+
+/**
+ * @brief Construit les bons de commande de réapprovisionnement, un par fournisseur
+ * @param criteria Critère de choix du fournisseur
+ * @param orders Tableau de bons de commande à remplir
+ * @param max_orders Nombre maximum de bons
+ * @param count Pointeur vers le nombre de bons générés
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t stock_build_reorder_plan(supplier_criteria_t criteria, purchase_order_t* orders,
+                                       uint32_t max_orders, uint32_t* count);
+
 /**
  * @brief Récupère les statistiques de stock
  * @param stats Pointeur vers la structure statistiques
@@ -1,9 +1,81 @@
-#include "stock_manager.h"
+#include "inventory_database.h"
 #include "esp_log.h"
+#include <string.h>
 
 static const char* TAG = "INVENTORY_DATABASE";
 
+// Journal circulaire : les mouvements les plus anciens sont écrasés une fois plein
+static stock_movement_t g_movements[MAX_STOCK_MOVEMENTS];
+static uint32_t g_movements_head = 0;   // Prochaine position d'écriture
+static uint32_t g_movements_count = 0;
+static uint32_t g_next_movement_id = 1;
+
+// Position du n-ième mouvement en partant du plus récent
+static uint32_t movement_slot(uint32_t age)
+{
+    return (g_movements_head + MAX_STOCK_MOVEMENTS - 1 - age) % MAX_STOCK_MOVEMENTS;
+}
+
 void inventory_database_init(void)
 {
+    memset(g_movements, 0, sizeof(g_movements));
+    g_movements_head = 0;
+    g_movements_count = 0;
+    g_next_movement_id = 1;
+    
     ESP_LOGI(TAG, "Base de données d'inventaire initialisée");
+}
+
+uint32_t inventory_record_movement(uint32_t item_id, const char* type, float quantity,
+                                   float unit_price, const char* reason, const char* reference)
+{
+    stock_movement_t* movement = &g_movements[g_movements_head];
+    
+    memset(movement, 0, sizeof(stock_movement_t));
+    movement->id = g_next_movement_id++;
+    movement->item_id = item_id;
+    movement->transaction_date = time(NULL);
+    strncpy(movement->transaction_type, type, sizeof(movement->transaction_type) - 1);
+    movement->quantity = quantity;
+    movement->unit_price = unit_price;
+    if (reason) {
+        strncpy(movement->reason, reason, sizeof(movement->reason) - 1);
+    }
+    if (reference) {
+        strncpy(movement->reference, reference, sizeof(movement->reference) - 1);
+    }
+    
+    g_movements_head = (g_movements_head + 1) % MAX_STOCK_MOVEMENTS;
+    if (g_movements_count < MAX_STOCK_MOVEMENTS) {
+        g_movements_count++;
+    }
+    
+    return movement->id;
+}
+
+uint32_t inventory_get_movements(uint32_t item_id, stock_movement_t* movements, uint32_t max_count)
+{
+    uint32_t found_count = 0;
+    
+    for (uint32_t age = 0; age < g_movements_count && found_count < max_count; age++) {
+        const stock_movement_t* movement = &g_movements[movement_slot(age)];
+        if (movement->item_id == item_id) {
+            memcpy(&movements[found_count++], movement, sizeof(stock_movement_t));
+        }
+    }
+    
+    return found_count;
+}
+
+uint32_t inventory_count_movements_since(time_t since)
+{
+    uint32_t count = 0;
+    
+    // Parcours du plus récent au plus ancien : arrêt dès la première date antérieure
+    while (count < g_movements_count &&
+           g_movements[movement_slot(count)].transaction_date >= since) {
+        count++;
+    }
+    
+    return count;
 }
\ No newline at end of file
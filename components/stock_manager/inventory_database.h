@@ -0,0 +1,40 @@
+#ifndef INVENTORY_DATABASE_H
+#define INVENTORY_DATABASE_H
+
+#include "stock_manager.h"
+
+/**
+ * @brief Initialise le journal des mouvements de stock
+ */
+void inventory_database_init(void);
+
+/**
+ * @brief Enregistre un mouvement dans le journal circulaire
+ * @param item_id ID de l'article
+ * @param type Type de mouvement ("IN", "OUT", "ADJUSTMENT")
+ * @param quantity Quantité déplacée
+ * @param unit_price Prix unitaire
+ * @param reason Raison du mouvement (peut être NULL)
+ * @param reference Référence associée (peut être NULL)
+ * @return ID du mouvement enregistré
+ */
+uint32_t inventory_record_movement(uint32_t item_id, const char* type, float quantity,
+                                   float unit_price, const char* reason, const char* reference);
+
+/**
+ * @brief Récupère les mouvements d'un article, du plus récent au plus ancien
+ * @param item_id ID de l'article
+ * @param movements Tableau de mouvements à remplir
+ * @param max_count Nombre maximum de mouvements
+ * @return Nombre de mouvements copiés
+ */
+uint32_t inventory_get_movements(uint32_t item_id, stock_movement_t* movements, uint32_t max_count);
+
+/**
+ * @brief Compte les mouvements enregistrés depuis une date
+ * @param since Date de début (incluse)
+ * @return Nombre de mouvements
+ */
+uint32_t inventory_count_movements_since(time_t since);
+
+#endif // INVENTORY_DATABASE_H
\ No newline at end of file
@@ -0,0 +1,333 @@
+#include "lot_manager.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char* TAG = "LOT_MANAGER";
+
+#define LOT_NONE            (-1)
+#define LOT_EPSILON         0.0001f  // Reliquat considéré comme un lot vide
+#define LOT_TABLE_SIZE      512      // Puissance de 2, au moins deux fois MAX_STOCK_ITEMS
+#define LOT_TABLE_EMPTY     0
+#define LOT_TABLE_DELETED   UINT32_MAX
+
+_Static_assert(LOT_TABLE_SIZE >= 2 * MAX_STOCK_ITEMS, "Table des lots trop petite");
+_Static_assert(MAX_STOCK_LOTS < INT16_MAX, "Index de lot sur 16 bits");
+
+// Nœud du réservoir : les lots d'un article forment une liste chaînée dans l'ordre de consommation
+typedef struct {
+    stock_lot_t lot;
+    int16_t next;
+} lot_node_t;
+
+// Entrée de la table de hachage article -> liste de lots
+typedef struct {
+    uint32_t item_id;
+    int16_t head;
+    int16_t tail;
+    uint16_t count;
+} lot_list_t;
+
+static lot_node_t g_lot_pool[MAX_STOCK_LOTS];
+static int16_t g_free_head = LOT_NONE;
+static uint32_t g_next_lot_id = 1;
+static lot_list_t g_lot_table[LOT_TABLE_SIZE];
+
+static uint32_t hash_item_id(uint32_t item_id)
+{
+    return (item_id * 2654435761u) & (LOT_TABLE_SIZE - 1);
+}
+
+static lot_list_t* find_list(uint32_t item_id, bool create)
+{
+    uint32_t slot = hash_item_id(item_id);
+    lot_list_t* reusable = NULL;
+    
+    for (uint32_t probe = 0; probe < LOT_TABLE_SIZE; probe++) {
+        lot_list_t* list = &g_lot_table[slot];
+        
+        if (list->item_id == item_id) {
+            return list;
+        }
+        if (list->item_id == LOT_TABLE_DELETED && reusable == NULL) {
+            reusable = list;
+        } else if (list->item_id == LOT_TABLE_EMPTY) {
+            if (reusable == NULL) {
+                reusable = list;
+            }
+            break;
+        }
+        
+        slot = (slot + 1) & (LOT_TABLE_SIZE - 1);
+    }
+    
+    if (!create || reusable == NULL) {
+        return NULL;
+    }
+    
+    reusable->item_id = item_id;
+    reusable->head = LOT_NONE;
+    reusable->tail = LOT_NONE;
+    reusable->count = 0;
+    return reusable;
+}
+
+static void release_list_if_empty(lot_list_t* list)
+{
+    if (list->count == 0) {
+        list->item_id = LOT_TABLE_DELETED;
+        list->head = LOT_NONE;
+        list->tail = LOT_NONE;
+    }
+}
+
+static int16_t alloc_node(void)
+{
+    int16_t node = g_free_head;
+    if (node != LOT_NONE) {
+        g_free_head = g_lot_pool[node].next;
+        g_lot_pool[node].next = LOT_NONE;
+    }
+    return node;
+}
+
+static void free_node(int16_t node)
+{
+    g_lot_pool[node].next = g_free_head;
+    g_free_head = node;
+}
+
+// Une date d'expiration nulle passe après toutes les autres
+static bool expires_before(time_t a, time_t b)
+{
+    if (a == 0) {
+        return false;
+    }
+    return (b == 0) || (a < b);
+}
+
+static bool same_lot(const stock_lot_t* a, const stock_lot_t* b)
+{
+    return a->expiry_date == b->expiry_date && strcmp(a->batch_number, b->batch_number) == 0;
+}
+
+void lot_manager_init(void)
+{
+    memset(g_lot_pool, 0, sizeof(g_lot_pool));
+    memset(g_lot_table, 0, sizeof(g_lot_table));
+    
+    for (int16_t i = 0; i < MAX_STOCK_LOTS; i++) {
+        g_lot_pool[i].next = (i + 1 < MAX_STOCK_LOTS) ? i + 1 : LOT_NONE;
+    }
+    g_free_head = 0;
+    g_next_lot_id = 1;
+    
+    ESP_LOGI(TAG, "Gestionnaire de lots initialisé (%d lots)", MAX_STOCK_LOTS);
+}
+
+system_error_t lot_manager_add(const stock_item_t* item, stock_lot_t* lot)
+{
+    lot_list_t* list = find_list(item->id, true);
+    if (list == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    lot->item_id = item->id;
+    
+    // Position d'insertion : en queue pour FIFO, triée par expiration pour FEFO
+    int16_t prev = LOT_NONE;
+    int16_t cursor = list->head;
+    if (item->lot_policy == STOCK_LOT_POLICY_FIFO) {
+        prev = list->tail;
+        cursor = LOT_NONE;
+        if (prev != LOT_NONE && same_lot(&g_lot_pool[prev].lot, lot)) {
+            g_lot_pool[prev].lot.quantity += lot->quantity;
+            lot->id = g_lot_pool[prev].lot.id;
+            return SYSTEM_OK;
+        }
+    } else {
+        while (cursor != LOT_NONE && !expires_before(lot->expiry_date, g_lot_pool[cursor].lot.expiry_date)) {
+            if (same_lot(&g_lot_pool[cursor].lot, lot)) {
+                g_lot_pool[cursor].lot.quantity += lot->quantity;
+                lot->id = g_lot_pool[cursor].lot.id;
+                return SYSTEM_OK;
+            }
+            prev = cursor;
+            cursor = g_lot_pool[cursor].next;
+        }
+    }
+    
+    int16_t node = alloc_node();
+    if (node == LOT_NONE) {
+        release_list_if_empty(list);
+        ESP_LOGE(TAG, "Nombre maximum de lots atteint");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    lot->id = g_next_lot_id++;
+    g_lot_pool[node].lot = *lot;
+    g_lot_pool[node].next = cursor;
+    
+    if (prev == LOT_NONE) {
+        list->head = node;
+    } else {
+        g_lot_pool[prev].next = node;
+    }
+    if (cursor == LOT_NONE) {
+        list->tail = node;
+    }
+    list->count++;
+    
+    return SYSTEM_OK;
+}
+
+float lot_manager_consume(uint32_t item_id, float quantity)
+{
+    lot_list_t* list = find_list(item_id, false);
+    if (list == NULL) {
+        return quantity;
+    }
+    
+    while (quantity > 0.0f && list->head != LOT_NONE) {
+        int16_t node = list->head;
+        stock_lot_t* lot = &g_lot_pool[node].lot;
+        
+        if (lot->quantity - quantity > LOT_EPSILON) {
+            lot->quantity -= quantity;
+            return 0.0f;
+        }
+        
+        // Lot épuisé : il quitte la tête de liste
+        quantity -= lot->quantity;
+        list->head = g_lot_pool[node].next;
+        if (list->head == LOT_NONE) {
+            list->tail = LOT_NONE;
+        }
+        list->count--;
+        free_node(node);
+    }
+    
+    release_list_if_empty(list);
+    return (quantity > LOT_EPSILON) ? quantity : 0.0f;
+}
+
+void lot_manager_remove_item(uint32_t item_id)
+{
+    lot_list_t* list = find_list(item_id, false);
+    if (list == NULL) {
+        return;
+    }
+    
+    int16_t node = list->head;
+    while (node != LOT_NONE) {
+        int16_t next = g_lot_pool[node].next;
+        free_node(node);
+        node = next;
+    }
+    
+    list->count = 0;
+    release_list_if_empty(list);
+}
+
+uint32_t lot_manager_get_lots(uint32_t item_id, stock_lot_t* lots, uint32_t max_count)
+{
+    lot_list_t* list = find_list(item_id, false);
+    uint32_t found_count = 0;
+    
+    if (list == NULL) {
+        return 0;
+    }
+    
+    for (int16_t node = list->head; node != LOT_NONE && found_count < max_count; node = g_lot_pool[node].next) {
+        lots[found_count++] = g_lot_pool[node].lot;
+    }
+    
+    return found_count;
+}
+
+bool lot_manager_update_single_lot(uint32_t item_id, const char* batch_number, time_t expiry_date)
+{
+    lot_list_t* list = find_list(item_id, false);
+    if (list == NULL || list->count != 1) {
+        return false;
+    }
+    
+    stock_lot_t* lot = &g_lot_pool[list->head].lot;
+    strncpy(lot->batch_number, batch_number, sizeof(lot->batch_number) - 1);
+    lot->batch_number[sizeof(lot->batch_number) - 1] = '\0';
+    lot->expiry_date = expiry_date;
+    return true;
+}
+
+// Ordre de consommation : arrivée (ID de lot croissant) en FIFO, expiration puis arrivée en FEFO
+static bool consumed_before(const stock_item_t* item, const stock_lot_t* a, const stock_lot_t* b)
+{
+    if (item->lot_policy != STOCK_LOT_POLICY_FIFO && a->expiry_date != b->expiry_date) {
+        return expires_before(a->expiry_date, b->expiry_date);
+    }
+    return a->id < b->id;
+}
+
+void lot_manager_reorder(const stock_item_t* item)
+{
+    lot_list_t* list = find_list(item->id, false);
+    if (list == NULL) {
+        return;
+    }
+    
+    // Tri par insertion stable de la liste chaînée, sans allocation
+    int16_t sorted = LOT_NONE;
+    int16_t node = list->head;
+    while (node != LOT_NONE) {
+        int16_t next = g_lot_pool[node].next;
+        int16_t prev = LOT_NONE;
+        int16_t cursor = sorted;
+        
+        while (cursor != LOT_NONE && !consumed_before(item, &g_lot_pool[node].lot, &g_lot_pool[cursor].lot)) {
+            prev = cursor;
+            cursor = g_lot_pool[cursor].next;
+        }
+        
+        g_lot_pool[node].next = cursor;
+        if (prev == LOT_NONE) {
+            sorted = node;
+        } else {
+            g_lot_pool[prev].next = node;
+        }
+        node = next;
+    }
+    
+    list->head = sorted;
+    list->tail = sorted;
+    while (list->tail != LOT_NONE && g_lot_pool[list->tail].next != LOT_NONE) {
+        list->tail = g_lot_pool[list->tail].next;
+    }
+}
+
+void lot_manager_sync_item(stock_item_t* item)
+{
+    lot_list_t* list = find_list(item->id, false);
+    
+    if (list == NULL) {
+        item->lot_count = 0;
+        item->expiry_date = 0;
+        item->batch_number[0] = '\0';
+        return;
+    }
+    
+    const stock_lot_t* head = &g_lot_pool[list->head].lot;
+    time_t earliest = head->expiry_date;
+    
+    // En FEFO la tête est déjà le lot qui expire le plus tôt
+    if (item->lot_policy == STOCK_LOT_POLICY_FIFO) {
+        for (int16_t node = g_lot_pool[list->head].next; node != LOT_NONE; node = g_lot_pool[node].next) {
+            if (expires_before(g_lot_pool[node].lot.expiry_date, earliest)) {
+                earliest = g_lot_pool[node].lot.expiry_date;
+            }
+        }
+    }
+    
+    item->lot_count = list->count;
+    item->expiry_date = earliest;
+    strncpy(item->batch_number, head->batch_number, sizeof(item->batch_number) - 1);
+    item->batch_number[sizeof(item->batch_number) - 1] = '\0';
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#ifndef LOT_MANAGER_H
+#define LOT_MANAGER_H
+
+#include "stock_manager.h"
+
+/**
+ * @brief Initialise le réservoir de lots
+ */
+void lot_manager_init(void);
+
+/**
+ * @brief Ajoute un lot à un article, fusionné avec un lot identique si possible
+ * @param item Article concerné (ID et politique de consommation)
+ * @param lot Lot à ajouter (ID et article attribués en sortie)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le réservoir est plein
+ */
+system_error_t lot_manager_add(const stock_item_t* item, stock_lot_t* lot);
+
+/**
+ * @brief Consomme une quantité en partant du lot de tête
+ * @param item_id ID de l'article
+ * @param quantity Quantité à consommer
+ * @return Quantité qui n'a pas pu être consommée (0 si tout a été servi)
+ */
+float lot_manager_consume(uint32_t item_id, float quantity);
+
+/**
+ * @brief Libère tous les lots d'un article
+ * @param item_id ID de l'article
+ */
+void lot_manager_remove_item(uint32_t item_id);
+
+/**
+ * @brief Copie les lots d'un article dans l'ordre de consommation
+ * @param item_id ID de l'article
+ * @param lots Tableau de lots à remplir
+ * @param max_count Nombre maximum de lots
+ * @return Nombre de lots copiés
+ */
+uint32_t lot_manager_get_lots(uint32_t item_id, stock_lot_t* lots, uint32_t max_count);
+
+/**
+ * @brief Modifie le numéro et l'expiration de l'unique lot d'un article
+ * @param item_id ID de l'article
+ * @param batch_number Nouveau numéro de lot
+ * @param expiry_date Nouvelle date d'expiration
+ * @return true si l'article possède exactement un lot
+ */
+bool lot_manager_update_single_lot(uint32_t item_id, const char* batch_number, time_t expiry_date);
+
+/**
+ * @brief Réordonne les lots existants d'un article après un changement de politique FIFO/FEFO
+ * @param item Article concerné (ID et nouvelle politique)
+ */
+void lot_manager_reorder(const stock_item_t* item);
+
+/**
+ * @brief Reporte sur l'article le résumé de ses lots (lot de tête, expiration la plus proche)
+ * @param item Article à mettre à jour
+ */
+void lot_manager_sync_item(stock_item_t* item);
+
+#endif // LOT_MANAGER_H
\ No newline at end of file
@@ -1,7 +1,17 @@
 #include "stock_manager.h"
+#include "alert_manager.h"
+#include "inventory_database.h"
+#include "lot_manager.h"
+#include "supplier_manager.h"
+#include "app_main.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string.h>
+#include <stdio.h>
 #include <inttypes.h>
+#include <math.h>
 
 static const char* TAG = "STOCK_MANAGER";
 
@@ -10,6 +20,181 @@ static bool g_initialized = false;
 static stock_item_t g_stock_items[MAX_STOCK_ITEMS];
 static uint32_t g_items_count = 0;
 static uint32_t g_next_id = 1;
+static time_t g_last_alert_check = 0;
+static uint32_t g_new_low_stock = 0;
+static uint32_t g_next_batch_id = 1;
+static SemaphoreHandle_t g_mutex = NULL;  // Protège les articles et, à travers eux, lots, mouvements et alertes
+
+// Versions de changement et dernières suppressions, pour les sauvegardes incrémentales
+static uint32_t g_change_version = 0;
+static record_deletion_t g_deletions[CHANGE_LOG_DELETIONS];
+static uint32_t g_deletions_count = 0;
+static uint32_t g_forgotten_version = 0;    // Suppressions oubliées jusqu'à cette version incluse
+
+// Les articles sont rangés par ID croissant (ajout en fin, suppression par décalage) :
+// position du premier ID supérieur ou égal
+static uint32_t item_lower_bound(uint32_t item_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_items_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_stock_items[mid].id < item_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static int32_t find_item_index(uint32_t item_id)
+{
+    uint32_t low = item_lower_bound(item_id);
+    if (low < g_items_count && g_stock_items[low].id == item_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+static time_t near_expiry_horizon(time_t now)
+{
+    return now + (time_t)STOCK_NEAR_EXPIRY_DAYS * 24 * 3600;
+}
+
+// Applique une modification à un article et répercute la transition dans les index d'alertes
+static void commit_item_change(const stock_item_t* old_item, stock_item_t* item)
+{
+    time_t now = time(NULL);
+    
+    item->expired_alert = (item->expiry_date != 0 && item->expiry_date <= now);
+    item->change_version = ++g_change_version;
+    
+    if (alert_manager_item_changed(old_item, item)) {
+        g_new_low_stock++;
+        ESP_LOGW(TAG, "Stock bas: ID=%" PRIu32 ", Quantité=%.2f (min %.2f)",
+                 item->id, item->current_quantity, item->min_quantity);
+    }
+}
+
+static void log_deletion(uint32_t item_id)
+{
+    // Journal plein : la suppression la plus ancienne est oubliée
+    if (g_deletions_count == CHANGE_LOG_DELETIONS) {
+        g_forgotten_version = g_deletions[0].version;
+        memmove(&g_deletions[0], &g_deletions[1], (CHANGE_LOG_DELETIONS - 1) * sizeof(record_deletion_t));
+        g_deletions_count--;
+    }
+    
+    g_deletions[g_deletions_count].id = item_id;
+    g_deletions[g_deletions_count].version = ++g_change_version;
+    g_deletions_count++;
+}
+
+// Clôture les jours écoulés depuis la dernière consommation : O(1) quel que soit l'écart
+static void forecast_roll_days(stock_item_t* item, time_t now)
+{
+    uint32_t day = (uint32_t)(now / (24 * 3600));
+    
+    if (item->consumption_day == 0 || day <= item->consumption_day) {
+        if (item->consumption_day == 0) {
+            item->consumption_day = day;
+        }
+        return;
+    }
+    
+    if (item->daily_consumption <= 0.0f) {
+        // Premier jour observé : il sert d'amorce à la moyenne
+        item->daily_consumption = item->consumption_today;
+    } else {
+        item->daily_consumption = STOCK_FORECAST_ALPHA * item->consumption_today +
+                                  (1.0f - STOCK_FORECAST_ALPHA) * item->daily_consumption;
+    }
+    
+    // Les jours sans aucune sortie tirent la moyenne vers zéro
+    uint32_t idle_days = day - item->consumption_day - 1;
+    if (idle_days > 0 && item->daily_consumption > 0.0f) {
+        item->daily_consumption *= powf(1.0f - STOCK_FORECAST_ALPHA, (float)idle_days);
+    }
+    
+    item->consumption_today = 0.0f;
+    item->consumption_day = day;
+}
+
+// Recalcule la date de rupture prévue et la quantité de réapprovisionnement conseillée
+static void forecast_refresh(stock_item_t* item, time_t now)
+{
+    forecast_roll_days(item, now);
+    
+    float rate = item->daily_consumption;
+    if (rate <= 0.0f) {
+        rate = item->consumption_today;
+    }
+    
+    if (rate <= 0.0f) {
+        item->predicted_stockout_date = 0;
+        item->suggested_reorder_qty = 0.0f;
+        return;
+    }
+    
+    float days_left = item->current_quantity / rate;
+    item->predicted_stockout_date = now + (time_t)(days_left * 24.0f * 3600.0f);
+    
+    float target = rate * STOCK_FORECAST_COVERAGE_DAYS + item->min_quantity;
+    if (item->max_quantity > 0.0f && target > item->max_quantity) {
+        target = item->max_quantity;
+    }
+    item->suggested_reorder_qty = (target > item->current_quantity) ? target - item->current_quantity : 0.0f;
+}
+
+static void forecast_record_consumption(stock_item_t* item, float quantity, time_t now)
+{
+    forecast_roll_days(item, now);
+    item->consumption_today += quantity;
+    forecast_refresh(item, now);
+}
+
+// Aligne la quantité sur une nouvelle valeur en ajoutant un lot ou en consommant les lots de tête
+static system_error_t apply_adjustment(stock_item_t* item, float new_quantity)
+{
+    float delta = new_quantity - item->current_quantity;
+    
+    if (delta > 0.0f) {
+        stock_lot_t lot = {0};
+        lot.quantity = delta;
+        lot.unit_price = item->unit_price;
+        lot.received_date = time(NULL);
+        
+        system_error_t ret = lot_manager_add(item, &lot);
+        if (ret != SYSTEM_OK) {
+            return ret;
+        }
+    } else if (delta < 0.0f) {
+        lot_manager_consume(item->id, -delta);
+    }
+    
+    item->current_quantity = new_quantity;
+    lot_manager_sync_item(item);
+    return SYSTEM_OK;
+}
+
+static void fill_alert(stock_alert_t* alert, const stock_item_t* item, time_t now)
+{
+    memset(alert, 0, sizeof(stock_alert_t));
+    alert->item_id = item->id;
+    snprintf(alert->item_name, sizeof(alert->item_name), "%s", item->name);
+    alert->type = item->type;
+    alert->current_quantity = item->current_quantity;
+    alert->min_quantity = item->min_quantity;
+    alert->expiry_date = item->expiry_date;
+    alert->is_low_stock = (item->current_quantity <= item->min_quantity);
+    alert->is_expired = (item->expiry_date != 0 && item->expiry_date <= now);
+    alert->is_near_expiry = !alert->is_expired && item->expiry_date != 0 &&
+                            item->expiry_date <= near_expiry_horizon(now);
+}
 
 system_error_t stock_manager_init(void)
 {
@@ -19,10 +204,22 @@ system_error_t stock_manager_init(void)
     
     ESP_LOGI(TAG, "Initialisation du gestionnaire de stocks...");
     
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_mutex == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
     // Initialisation des données
     memset(g_stock_items, 0, sizeof(g_stock_items));
     g_items_count = 0;
     g_next_id = 1;
+    g_last_alert_check = time(NULL);
+    g_new_low_stock = 0;
+    
+    alert_manager_init();
+    inventory_database_init();
+    lot_manager_init();
+    supplier_manager_init();
     
     g_initialized = true;
     ESP_LOGI(TAG, "Gestionnaire de stocks initialisé");
@@ -36,19 +233,54 @@ system_error_t stock_add_item(stock_item_t* item)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     if (g_items_count >= MAX_STOCK_ITEMS) {
+        xSemaphoreGive(g_mutex);
         ESP_LOGE(TAG, "Nombre maximum d'articles atteint");
         return SYSTEM_ERROR_MEMORY;
     }
     
-    // Assigner un ID unique
-    item->id = g_next_id++;
+    // ID unique, consommé seulement une fois l'article ajouté
+    item->id = g_next_id;
     item->created_at = time(NULL);
     item->updated_at = item->created_at;
     
+    // Les prévisions sont calculées à partir des mouvements uniquement
+    item->daily_consumption = 0.0f;
+    item->consumption_today = 0.0f;
+    item->consumption_day = 0;
+    forecast_refresh(item, item->created_at);
+    
+    // La quantité initiale constitue le premier lot
+    item->lot_count = 0;
+    if (item->current_quantity > 0.0f) {
+        stock_lot_t lot = {0};
+        snprintf(lot.batch_number, sizeof(lot.batch_number), "%s", item->batch_number);
+        lot.quantity = item->current_quantity;
+        lot.unit_price = item->unit_price;
+        lot.received_date = item->created_at;
+        lot.expiry_date = item->expiry_date;
+        
+        system_error_t ret = lot_manager_add(item, &lot);
+        if (ret != SYSTEM_OK) {
+            xSemaphoreGive(g_mutex);
+            return ret;
+        }
+        lot_manager_sync_item(item);
+    }
+    
     // Ajouter à la liste
-    memcpy(&g_stock_items[g_items_count], item, sizeof(stock_item_t));
+    stock_item_t* stored = &g_stock_items[g_items_count];
+    memcpy(stored, item, sizeof(stock_item_t));
     g_items_count++;
+    g_next_id++;
+    
+    commit_item_change(NULL, stored);
+    item->expired_alert = stored->expired_alert;
+    item->change_version = stored->change_version;
+    
+    xSemaphoreGive(g_mutex);
     
     ESP_LOGI(TAG, "Article ajouté: ID=%" PRIu32 ", Nom=%s", item->id, item->name);
     
@@ -61,18 +293,50 @@ system_error_t stock_update_item(const stock_item_t* item)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher l'article
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item->id) {
-            memcpy(&g_stock_items[i], item, sizeof(stock_item_t));
-            g_stock_items[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Article mis à jour: ID=%" PRIu32, item->id);
-            return SYSTEM_OK;
+    int32_t index = find_item_index(item->id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    stock_item_t old_item = g_stock_items[index];
+    stock_item_t* stored = &g_stock_items[index];
+    memcpy(stored, item, sizeof(stock_item_t));
+    stored->updated_at = time(NULL);
+    
+    // Les quantités et le résumé des lots restent tenus par les lots
+    stored->current_quantity = old_item.current_quantity;
+    stored->lot_count = old_item.lot_count;
+    if (strcmp(item->batch_number, old_item.batch_number) != 0 || item->expiry_date != old_item.expiry_date) {
+        lot_manager_update_single_lot(item->id, item->batch_number, item->expiry_date);
+    }
+    if (item->lot_policy != old_item.lot_policy) {
+        lot_manager_reorder(stored);
+    }
+    if (item->current_quantity != old_item.current_quantity) {
+        if (apply_adjustment(stored, item->current_quantity) == SYSTEM_OK) {
+            inventory_record_movement(item->id, "ADJUSTMENT", item->current_quantity - old_item.current_quantity,
+                                      stored->unit_price, "Mise à jour de l'article", NULL);
+        } else {
+            ESP_LOGW(TAG, "Quantité non modifiée: ID=%" PRIu32, item->id);
         }
     }
+    lot_manager_sync_item(stored);
+    
+    // Conserver l'état de prévision, dérivé de l'historique et non saisi
+    stored->daily_consumption = old_item.daily_consumption;
+    stored->consumption_today = old_item.consumption_today;
+    stored->consumption_day = old_item.consumption_day;
+    forecast_refresh(stored, stored->updated_at);
+    commit_item_change(&old_item, stored);
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Article mis à jour: ID=%" PRIu32, item->id);
+    return SYSTEM_OK;
 }
 
 system_error_t stock_delete_item(uint32_t item_id)
@@ -81,21 +345,132 @@ system_error_t stock_delete_item(uint32_t item_id)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher et supprimer l'article
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item_id) {
-            // Décaler les éléments suivants
-            for (uint32_t j = i; j < g_items_count - 1; j++) {
-                memcpy(&g_stock_items[j], &g_stock_items[j + 1], sizeof(stock_item_t));
+    int32_t index = find_item_index(item_id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    alert_manager_item_changed(&g_stock_items[index], NULL);
+    lot_manager_remove_item(item_id);
+    supplier_manager_remove_item(item_id);
+    
+    // Décaler les éléments suivants
+    memmove(&g_stock_items[index], &g_stock_items[index + 1],
+            (g_items_count - (uint32_t)index - 1) * sizeof(stock_item_t));
+    g_items_count--;
+    log_deletion(item_id);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Article supprimé: ID=%" PRIu32, item_id);
+    return SYSTEM_OK;
+}
+
+system_error_t stock_restore_items(const stock_item_t* items, uint32_t count)
+{
+    if (!g_initialized || items == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const stock_item_t* item = &items[i];
+        stock_item_t old_item;
+        bool replaced = false;
+        
+        int32_t index = find_item_index(item->id);
+        if (index >= 0) {
+            old_item = g_stock_items[index];
+            replaced = true;
+            lot_manager_remove_item(item->id);
+        } else {
+            if (g_items_count >= MAX_STOCK_ITEMS) {
+                xSemaphoreGive(g_mutex);
+                ESP_LOGE(TAG, "Nombre maximum d'articles atteint");
+                return SYSTEM_ERROR_MEMORY;
             }
-            g_items_count--;
             
-            ESP_LOGI(TAG, "Article supprimé: ID=%" PRIu32, item_id);
-            return SYSTEM_OK;
+            // Insertion à sa place dans l'ordre des IDs
+            uint32_t pos = g_items_count;
+            while (pos > 0 && g_stock_items[pos - 1].id > item->id) {
+                pos--;
+            }
+            memmove(&g_stock_items[pos + 1], &g_stock_items[pos], (g_items_count - pos) * sizeof(stock_item_t));
+            g_items_count++;
+            index = (int32_t)pos;
+        }
+        
+        stock_item_t* stored = &g_stock_items[index];
+        memcpy(stored, item, sizeof(stock_item_t));
+        stored->lot_count = 0;
+        if (stored->current_quantity > 0.0f) {
+            stock_lot_t lot = {0};
+            snprintf(lot.batch_number, sizeof(lot.batch_number), "%s", stored->batch_number);
+            lot.quantity = stored->current_quantity;
+            lot.unit_price = stored->unit_price;
+            lot.received_date = stored->updated_at;
+            lot.expiry_date = stored->expiry_date;
+            if (lot_manager_add(stored, &lot) != SYSTEM_OK) {
+                ESP_LOGW(TAG, "Lot non restauré: ID=%" PRIu32, stored->id);
+            }
+        }
+        lot_manager_sync_item(stored);
+        
+        if (item->id >= g_next_id) {
+            g_next_id = item->id + 1;
         }
+        commit_item_change(replaced ? &old_item : NULL, stored);
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    xSemaphoreGive(g_mutex);
+    return SYSTEM_OK;
+}
+
+uint32_t stock_get_change_version(void)
+{
+    if (!g_initialized) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    uint32_t version = g_change_version;
+    xSemaphoreGive(g_mutex);
+    return version;
+}
+
+system_error_t stock_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                   uint32_t* count)
+{
+    if (!g_initialized || deletions == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    *count = 0;
+    if (since_version < g_forgotten_version) {
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    }
+    for (uint32_t i = 0; ret == SYSTEM_OK && i < g_deletions_count; i++) {
+        if (g_deletions[i].version <= since_version) {
+            continue;
+        }
+        if (*count >= max_count) {
+            ret = SYSTEM_ERROR_MEMORY;
+            break;
+        }
+        deletions[(*count)++] = g_deletions[i];
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return ret;
 }
 
 system_error_t stock_get_item_by_id(uint32_t item_id, stock_item_t* item)
@@ -104,14 +479,18 @@ system_error_t stock_get_item_by_id(uint32_t item_id, stock_item_t* item)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item_id) {
-            memcpy(item, &g_stock_items[i], sizeof(stock_item_t));
-            return SYSTEM_OK;
-        }
+    system_error_t ret = SYSTEM_ERROR_NOT_FOUND;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    int32_t index = find_item_index(item_id);
+    if (index >= 0) {
+        forecast_refresh(&g_stock_items[index], time(NULL));
+        memcpy(item, &g_stock_items[index], sizeof(stock_item_t));
+        ret = SYSTEM_OK;
     }
+    xSemaphoreGive(g_mutex);
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    return ret;
 }
 
 system_error_t stock_get_all_items(stock_item_t* items, uint32_t max_count, uint32_t* count)
@@ -120,61 +499,295 @@ system_error_t stock_get_all_items(stock_item_t* items, uint32_t max_count, uint
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    uint32_t copy_count = (g_items_count < max_count) ? g_items_count : max_count;
+    time_t now = time(NULL);
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     
+    uint32_t copy_count = (g_items_count < max_count) ? g_items_count : max_count;
     for (uint32_t i = 0; i < copy_count; i++) {
+        forecast_refresh(&g_stock_items[i], now);
         memcpy(&items[i], &g_stock_items[i], sizeof(stock_item_t));
     }
     
+    xSemaphoreGive(g_mutex);
+    
     *count = copy_count;
     return SYSTEM_OK;
 }
 
+// Parcours par lots : les prévisions sont rafraîchies et les articles copiés sous g_mutex par ID
+// croissant, chaque lot reprenant après le dernier ID du précédent, puis remis à l'appelant hors du verrou
+#define VISIT_BATCH_ENTRIES     16
+
+system_error_t stock_for_each_item(stock_item_visit_fn_t visit, void* context)
+{
+    if (!g_initialized || visit == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    stock_item_t* batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(stock_item_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (batch == NULL) {
+        batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(stock_item_t), MALLOC_CAP_8BIT);
+    }
+    if (batch == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    time_t now = time(NULL);
+    uint32_t next_id = 0;
+    uint32_t count;
+    bool keep_going = true;
+    do {
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+        uint32_t pos = item_lower_bound(next_id);
+        count = (g_items_count - pos < VISIT_BATCH_ENTRIES) ? g_items_count - pos : VISIT_BATCH_ENTRIES;
+        for (uint32_t i = 0; i < count; i++) {
+            forecast_refresh(&g_stock_items[pos + i], now);
+            batch[i] = g_stock_items[pos + i];
+        }
+        xSemaphoreGive(g_mutex);
+        
+        for (uint32_t i = 0; keep_going && i < count; i++) {
+            keep_going = visit(&batch[i], context);
+        }
+        if (count > 0) {
+            next_id = batch[count - 1].id + 1;
+        }
+    } while (keep_going && count == VISIT_BATCH_ENTRIES);
+    
+    heap_caps_free(batch);
+    return SYSTEM_OK;
+}
+
+// Ajout d'un lot, appelé sous g_mutex
+static system_error_t add_lot_locked(uint32_t item_id, stock_lot_t* lot, const char* reference)
+{
+    int32_t index = find_item_index(item_id);
+    if (index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    stock_item_t* item = &g_stock_items[index];
+    if (lot->received_date == 0) {
+        lot->received_date = time(NULL);
+    }
+    
+    system_error_t ret = lot_manager_add(item, lot);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    stock_item_t old_item = *item;
+    item->current_quantity += lot->quantity;
+    item->unit_price = lot->unit_price;
+    item->last_restocked = lot->received_date;
+    item->updated_at = time(NULL);
+    lot_manager_sync_item(item);
+    forecast_refresh(item, item->updated_at);
+    commit_item_change(&old_item, item);
+    inventory_record_movement(item_id, "IN", lot->quantity, lot->unit_price, lot->batch_number, reference);
+    
+    return SYSTEM_OK;
+}
+
 system_error_t stock_add_quantity(uint32_t item_id, float quantity, float unit_price, const char* reference)
 {
     if (!g_initialized) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher l'article et mettre à jour la quantité
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item_id) {
-            g_stock_items[i].current_quantity += quantity;
-            g_stock_items[i].unit_price = unit_price;
-            g_stock_items[i].last_restocked = time(NULL);
-            g_stock_items[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Stock ajouté: ID=%" PRIu32 ", Quantité=%.2f", item_id, quantity);
-            return SYSTEM_OK;
-        }
+    int32_t index = find_item_index(item_id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    stock_lot_t lot = {0};
+    lot.quantity = quantity;
+    lot.unit_price = unit_price;
+    lot.received_date = time(NULL);
+    
+    system_error_t ret = (quantity > 0.0f) ? add_lot_locked(item_id, &lot, reference) : SYSTEM_ERROR_INVALID_PARAM;
+    xSemaphoreGive(g_mutex);
+    
+    if (ret == SYSTEM_OK) {
+        ESP_LOGI(TAG, "Stock ajouté: ID=%" PRIu32 ", Lot=%" PRIu32 ", Quantité=%.2f", item_id, lot.id, lot.quantity);
+    }
+    return ret;
+}
+
+system_error_t stock_add_lot(uint32_t item_id, stock_lot_t* lot, const char* reference)
+{
+    if (!g_initialized || lot == NULL || lot->quantity <= 0.0f) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    system_error_t ret = add_lot_locked(item_id, lot, reference);
+    xSemaphoreGive(g_mutex);
+    
+    if (ret == SYSTEM_OK) {
+        ESP_LOGI(TAG, "Stock ajouté: ID=%" PRIu32 ", Lot=%" PRIu32 ", Quantité=%.2f", item_id, lot->id, lot->quantity);
+    }
+    return ret;
+}
+
+system_error_t stock_get_lots(uint32_t item_id, stock_lot_t* lots, uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || lots == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    system_error_t ret = SYSTEM_ERROR_NOT_FOUND;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    if (find_item_index(item_id) >= 0) {
+        *count = lot_manager_get_lots(item_id, lots, max_count);
+        ret = SYSTEM_OK;
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return ret;
 }
 
 system_error_t stock_remove_quantity(uint32_t item_id, float quantity, const char* reason)
 {
-    if (!g_initialized) {
+    if (!g_initialized || quantity <= 0.0f) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher l'article et retirer la quantité
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item_id) {
-            if (g_stock_items[i].current_quantity >= quantity) {
-                g_stock_items[i].current_quantity -= quantity;
-                g_stock_items[i].updated_at = time(NULL);
-                
-                ESP_LOGI(TAG, "Stock retiré: ID=%" PRIu32 ", Quantité=%.2f", item_id, quantity);
-                return SYSTEM_OK;
-            } else {
-                ESP_LOGW(TAG, "Stock insuffisant: ID=%" PRIu32, item_id);
-                return SYSTEM_ERROR;
-            }
+    int32_t index = find_item_index(item_id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    stock_item_t* item = &g_stock_items[index];
+    if (item->current_quantity < quantity) {
+        xSemaphoreGive(g_mutex);
+        ESP_LOGW(TAG, "Stock insuffisant: ID=%" PRIu32, item_id);
+        return SYSTEM_ERROR;
+    }
+    
+    stock_item_t old_item = *item;
+    lot_manager_consume(item_id, quantity);
+    item->current_quantity -= quantity;
+    item->updated_at = time(NULL);
+    lot_manager_sync_item(item);
+    forecast_record_consumption(item, quantity, item->updated_at);
+    commit_item_change(&old_item, item);
+    inventory_record_movement(item_id, "OUT", quantity, item->unit_price, reason, NULL);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Stock retiré: ID=%" PRIu32 ", Quantité=%.2f", item_id, quantity);
+    return SYSTEM_OK;
+}
+
+void stock_batch_init(stock_deduction_batch_t* batch, const char* reason)
+{
+    if (batch == NULL) {
+        return;
+    }
+    
+    memset(batch, 0, sizeof(stock_deduction_batch_t));
+    if (reason) {
+        snprintf(batch->reason, sizeof(batch->reason), "%s", reason);
+    }
+}
+
+system_error_t stock_batch_add(stock_deduction_batch_t* batch, uint32_t item_id, float quantity)
+{
+    if (batch == NULL || quantity <= 0.0f) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    // Les sorties d'un même article sont cumulées sur une seule ligne
+    for (uint32_t i = 0; i < batch->line_count; i++) {
+        if (batch->lines[i].item_id == item_id) {
+            batch->lines[i].quantity += quantity;
+            batch->lines[i].source_count++;
+            return SYSTEM_OK;
         }
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    if (batch->line_count >= STOCK_BATCH_MAX_LINES) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    stock_deduction_t* line = &batch->lines[batch->line_count++];
+    line->item_id = item_id;
+    line->quantity = quantity;
+    line->source_count = 1;
+    
+    return SYSTEM_OK;
+}
+
+system_error_t stock_batch_commit(stock_deduction_batch_t* batch)
+{
+    if (!g_initialized || batch == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    // Un article supprimé depuis l'ajout de sa ligne n'a plus de stock à déduire : la ligne est retirée
+    int32_t indexes[STOCK_BATCH_MAX_LINES];
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < batch->line_count; i++) {
+        indexes[kept] = find_item_index(batch->lines[i].item_id);
+        if (indexes[kept] < 0) {
+            ESP_LOGW(TAG, "Lot de sorties: article ID=%" PRIu32 " supprimé, ligne retirée", batch->lines[i].item_id);
+            continue;
+        }
+        batch->lines[kept++] = batch->lines[i];
+    }
+    batch->line_count = kept;
+    
+    if (batch->line_count == 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_OK;
+    }
+    
+    // Validation complète avant toute écriture : le lot est appliqué en entier ou pas du tout
+    for (uint32_t i = 0; i < batch->line_count; i++) {
+        if (g_stock_items[indexes[i]].current_quantity < batch->lines[i].quantity) {
+            xSemaphoreGive(g_mutex);
+            ESP_LOGW(TAG, "Lot de sorties rejeté: stock insuffisant ID=%" PRIu32, batch->lines[i].item_id);
+            return SYSTEM_ERROR;
+        }
+    }
+    
+    char reference[32];
+    snprintf(reference, sizeof(reference), "BATCH-%" PRIu32, g_next_batch_id++);
+    time_t now = time(NULL);
+    
+    for (uint32_t i = 0; i < batch->line_count; i++) {
+        stock_item_t* item = &g_stock_items[indexes[i]];
+        stock_item_t old_item = *item;
+        float quantity = batch->lines[i].quantity;
+        
+        lot_manager_consume(item->id, quantity);
+        item->current_quantity -= quantity;
+        item->updated_at = now;
+        lot_manager_sync_item(item);
+        forecast_record_consumption(item, quantity, now);
+        commit_item_change(&old_item, item);
+        inventory_record_movement(item->id, "OUT", quantity, item->unit_price, batch->reason, reference);
+    }
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Lot de sorties %s appliqué: %" PRIu32 " articles", reference, batch->line_count);
+    
+    batch->line_count = 0;
+    return SYSTEM_OK;
 }
 
 system_error_t stock_adjust_quantity(uint32_t item_id, float new_quantity, const char* reason)
@@ -183,18 +796,37 @@ system_error_t stock_adjust_quantity(uint32_t item_id, float new_quantity, const
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher l'article et ajuster la quantité
-    for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].id == item_id) {
-            g_stock_items[i].current_quantity = new_quantity;
-            g_stock_items[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Stock ajusté: ID=%" PRIu32 ", Nouvelle quantité=%.2f", item_id, new_quantity);
-            return SYSTEM_OK;
-        }
+    int32_t index = find_item_index(item_id);
+    if (index < 0) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    if (new_quantity < 0.0f) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    stock_item_t* item = &g_stock_items[index];
+    stock_item_t old_item = *item;
+    system_error_t ret = apply_adjustment(item, new_quantity);
+    if (ret != SYSTEM_OK) {
+        xSemaphoreGive(g_mutex);
+        return ret;
+    }
+    item->updated_at = time(NULL);
+    forecast_refresh(item, item->updated_at);
+    commit_item_change(&old_item, item);
+    inventory_record_movement(item_id, "ADJUSTMENT", new_quantity - old_item.current_quantity,
+                              item->unit_price, reason, NULL);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Stock ajusté: ID=%" PRIu32 ", Nouvelle quantité=%.2f", item_id, new_quantity);
+    return SYSTEM_OK;
 }
 
 system_error_t stock_get_movements(uint32_t item_id, stock_movement_t* movements, 
@@ -204,8 +836,9 @@ system_error_t stock_get_movements(uint32_t item_id, stock_movement_t* movements
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des mouvements
-    *count = 0;
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    *count = inventory_get_movements(item_id, movements, max_count);
+    xSemaphoreGive(g_mutex);
     
     return SYSTEM_OK;
 }
@@ -216,9 +849,41 @@ system_error_t stock_get_alerts(stock_alert_t* alerts, uint32_t max_count, uint3
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la récupération des alertes
-    *count = 0;
+    time_t now = time(NULL);
+    time_t horizon = near_expiry_horizon(now);
+    uint32_t found_count = 0;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     
+    // Articles expirés ou proches de l'expiration, du plus urgent au moins urgent
+    uint32_t expiring_count = 0;
+    const expiry_entry_t* expiring = alert_manager_get_expiring(horizon, &expiring_count);
+    for (uint32_t i = 0; i < expiring_count && found_count < max_count; i++) {
+        int32_t index = find_item_index(expiring[i].item_id);
+        if (index >= 0 && g_stock_items[index].alert_enabled) {
+            fill_alert(&alerts[found_count++], &g_stock_items[index], now);
+        }
+    }
+    
+    // Articles en stock bas non déjà signalés par leur expiration
+    uint32_t low_count = 0;
+    const uint32_t* low_ids = alert_manager_get_low_stock(&low_count);
+    for (uint32_t i = 0; i < low_count && found_count < max_count; i++) {
+        int32_t index = find_item_index(low_ids[i]);
+        if (index < 0 || !g_stock_items[index].alert_enabled) {
+            continue;
+        }
+        
+        const stock_item_t* item = &g_stock_items[index];
+        if (item->expiry_date != 0 && item->expiry_date <= horizon) {
+            continue;
+        }
+        fill_alert(&alerts[found_count++], item, now);
+    }
+    
+    xSemaphoreGive(g_mutex);
+    
+    *count = found_count;
     return SYSTEM_OK;
 }
 
@@ -228,11 +893,139 @@ system_error_t stock_check_alerts(void)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la vérification des alertes
+    time_t now = time(NULL);
+    uint32_t new_expired = 0;
+    uint32_t new_near_expiry = 0;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    // Seuls les articles dont la date a franchi un seuil depuis la dernière vérification sont visités
+    uint32_t expiring_count = 0;
+    const expiry_entry_t* expiring = alert_manager_get_expiring(near_expiry_horizon(now), &expiring_count);
+    for (int32_t i = (int32_t)expiring_count - 1; i >= 0; i--) {
+        time_t expiry_date = expiring[i].expiry_date;
+        if (expiry_date <= g_last_alert_check) {
+            break;
+        }
+        
+        if (expiry_date <= now) {
+            int32_t index = find_item_index(expiring[i].item_id);
+            if (index >= 0) {
+                g_stock_items[index].expired_alert = true;
+                ESP_LOGW(TAG, "Article expiré: ID=%" PRIu32 ", Nom=%s",
+                         g_stock_items[index].id, g_stock_items[index].name);
+            }
+            new_expired++;
+        } else if (expiry_date > near_expiry_horizon(g_last_alert_check)) {
+            new_near_expiry++;
+        }
+    }
+    
+    g_last_alert_check = now;
+    uint32_t new_low_stock = g_new_low_stock;
+    g_new_low_stock = 0;
+    
+    xSemaphoreGive(g_mutex);
+    
+    // L'événement est émis hors du verrou : ses abonnés peuvent consulter le stock
+    if (new_expired > 0 || new_near_expiry > 0 || new_low_stock > 0) {
+        system_event_t event = {
+            .type = EVENT_STOCK_LOW,
+            .timestamp = now,
+            .source_id = 0,
+            .data = NULL,
+            .data_size = 0
+        };
+        snprintf(event.description, sizeof(event.description),
+                 "Alertes stock: %" PRIu32 " stock bas, %" PRIu32 " expirés, %" PRIu32 " proches expiration",
+                 new_low_stock, new_expired, new_near_expiry);
+        
+        app_emit_event(&event);
+    }
     
     return SYSTEM_OK;
 }
 
+system_error_t stock_build_reorder_plan(supplier_criteria_t criteria, purchase_order_t* orders,
+                                       uint32_t max_orders, uint32_t* count)
+{
+    if (!g_initialized || orders == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t order_count = 0;
+    time_t now = time(NULL);
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    for (uint32_t i = 0; i < g_items_count; i++) {
+        stock_item_t* item = &g_stock_items[i];
+        forecast_refresh(item, now);
+        
+        // Quantité à commander : prévision si disponible, sinon retour au maximum pour un stock bas
+        float quantity = item->suggested_reorder_qty;
+        if (quantity <= 0.0f && item->current_quantity <= item->min_quantity) {
+            float target = (item->max_quantity > 0.0f) ? item->max_quantity : 2.0f * item->min_quantity;
+            quantity = target - item->current_quantity;
+        }
+        if (quantity <= 0.0f) {
+            continue;
+        }
+        
+        stock_price_record_t offer;
+        if (!supplier_manager_best_offer(item->id, criteria, &offer)) {
+            if (item->supplier_id == 0 || !supplier_manager_is_active(item->supplier_id)) {
+                ESP_LOGW(TAG, "Aucun fournisseur actif pour l'article ID=%" PRIu32, item->id);
+                continue;
+            }
+            offer.supplier_id = item->supplier_id;
+            offer.unit_price = item->unit_price;
+            offer.lead_time_days = 0;
+        }
+        
+        // Couvrir aussi la consommation prévue pendant le délai de livraison
+        quantity += item->daily_consumption * offer.lead_time_days;
+        
+        purchase_order_t* order = NULL;
+        for (uint32_t o = 0; o < order_count; o++) {
+            if (orders[o].supplier_id == offer.supplier_id) {
+                order = &orders[o];
+                break;
+            }
+        }
+        
+        if (order == NULL) {
+            if (order_count >= max_orders) {
+                ESP_LOGW(TAG, "Nombre maximum de bons de commande atteint");
+                continue;
+            }
+            order = &orders[order_count++];
+            memset(order, 0, sizeof(purchase_order_t));
+            order->supplier_id = offer.supplier_id;
+        }
+        
+        if (order->line_count >= STOCK_PO_MAX_LINES) {
+            ESP_LOGW(TAG, "Bon de commande complet pour le fournisseur ID=%" PRIu32, offer.supplier_id);
+            continue;
+        }
+        
+        purchase_order_line_t* line = &order->lines[order->line_count++];
+        line->item_id = item->id;
+        line->quantity = quantity;
+        line->unit_price = offer.unit_price;
+        order->total_amount += quantity * offer.unit_price;
+        if (offer.lead_time_days > order->lead_time_days) {
+            order->lead_time_days = offer.lead_time_days;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    
+    *count = order_count;
+    ESP_LOGI(TAG, "Plan de réapprovisionnement: %" PRIu32 " bon(s) de commande", order_count);
+    return SYSTEM_OK;
+}
+
 system_error_t stock_get_stats(stock_stats_t* stats)
 {
     if (!g_initialized || stats == NULL) {
@@ -241,20 +1034,35 @@ system_error_t stock_get_stats(stock_stats_t* stats)
     
     memset(stats, 0, sizeof(stock_stats_t));
     
+    time_t now = time(NULL);
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     stats->total_items = g_items_count;
+    alert_manager_get_counts(now, &stats->low_stock_items,
+                             &stats->expired_items, &stats->near_expiry_items);
+    
+    struct tm midnight;
+    localtime_r(&now, &midnight);
+    midnight.tm_hour = 0;
+    midnight.tm_min = 0;
+    midnight.tm_sec = 0;
+    stats->movements_today = inventory_count_movements_since(mktime(&midnight));
     
     // Calculer les statistiques
     for (uint32_t i = 0; i < g_items_count; i++) {
-        if (g_stock_items[i].current_quantity <= g_stock_items[i].min_quantity) {
-            stats->low_stock_items++;
-        }
-        
         stats->total_stock_value += g_stock_items[i].current_quantity * g_stock_items[i].unit_price;
         
         if (g_stock_items[i].type < 6) {
             stats->items_by_type[g_stock_items[i].type]++;
         }
+        
+        if (g_stock_items[i].last_restocked > stats->last_restock_date) {
+            stats->last_restock_date = g_stock_items[i].last_restocked;
+        }
     }
     
+    xSemaphoreGive(g_mutex);
+    
     return SYSTEM_OK;
 }
\ No newline at end of file
@@ -1,9 +1,286 @@
-#include "stock_manager.h"
+#include "supplier_manager.h"
 #include "esp_log.h"
+#include <string.h>
+#include <inttypes.h>
 
 static const char* TAG = "SUPPLIER_MANAGER";
 
+// Variables globales
+static bool g_initialized = false;
+static stock_supplier_t g_suppliers[MAX_SUPPLIERS];
+static uint32_t g_suppliers_count = 0;
+static uint32_t g_next_supplier_id = 1;
+
+// Offres courantes triées par (article, fournisseur) : les offres d'un article sont contiguës
+static stock_price_record_t g_offers[MAX_SUPPLIER_OFFERS];
+static uint32_t g_offers_count = 0;
+
+// Historique circulaire des prix
+static stock_price_record_t g_price_history[MAX_PRICE_HISTORY];
+static uint32_t g_history_head = 0;
+static uint32_t g_history_count = 0;
+
+static int32_t find_supplier_index(uint32_t supplier_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_suppliers_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_suppliers[mid].id < supplier_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    if (low < g_suppliers_count && g_suppliers[low].id == supplier_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+// Première offre dont le couple (article, fournisseur) n'est pas inférieur à celui demandé
+static uint32_t offer_lower_bound(uint32_t item_id, uint32_t supplier_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_offers_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        const stock_price_record_t* offer = &g_offers[mid];
+        if (offer->item_id < item_id || (offer->item_id == item_id && offer->supplier_id < supplier_id)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static bool offer_is_better(const stock_price_record_t* candidate, const stock_price_record_t* best,
+                            supplier_criteria_t criteria)
+{
+    if (criteria == SUPPLIER_CRITERIA_FASTEST) {
+        if (candidate->lead_time_days != best->lead_time_days) {
+            return candidate->lead_time_days < best->lead_time_days;
+        }
+        return candidate->unit_price < best->unit_price;
+    }
+    
+    if (candidate->unit_price != best->unit_price) {
+        return candidate->unit_price < best->unit_price;
+    }
+    return candidate->lead_time_days < best->lead_time_days;
+}
+
 void supplier_manager_init(void)
 {
+    memset(g_suppliers, 0, sizeof(g_suppliers));
+    g_suppliers_count = 0;
+    g_next_supplier_id = 1;
+    g_offers_count = 0;
+    g_history_head = 0;
+    g_history_count = 0;
+    
+    g_initialized = true;
     ESP_LOGI(TAG, "Gestionnaire de fournisseurs initialisé");
+}
+
+system_error_t stock_supplier_add(stock_supplier_t* supplier)
+{
+    if (!g_initialized || supplier == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    if (g_suppliers_count >= MAX_SUPPLIERS) {
+        ESP_LOGE(TAG, "Nombre maximum de fournisseurs atteint");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    supplier->id = g_next_supplier_id++;
+    supplier->created_at = time(NULL);
+    supplier->updated_at = supplier->created_at;
+    
+    memcpy(&g_suppliers[g_suppliers_count], supplier, sizeof(stock_supplier_t));
+    g_suppliers_count++;
+    
+    ESP_LOGI(TAG, "Fournisseur ajouté: ID=%" PRIu32 ", Nom=%s", supplier->id, supplier->name);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t stock_supplier_update(const stock_supplier_t* supplier)
+{
+    if (!g_initialized || supplier == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    int32_t index = find_supplier_index(supplier->id);
+    if (index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    memcpy(&g_suppliers[index], supplier, sizeof(stock_supplier_t));
+    g_suppliers[index].updated_at = time(NULL);
+    
+    ESP_LOGI(TAG, "Fournisseur mis à jour: ID=%" PRIu32, supplier->id);
+    return SYSTEM_OK;
+}
+
+system_error_t stock_supplier_get(uint32_t supplier_id, stock_supplier_t* supplier)
+{
+    if (!g_initialized || supplier == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    int32_t index = find_supplier_index(supplier_id);
+    if (index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    memcpy(supplier, &g_suppliers[index], sizeof(stock_supplier_t));
+    return SYSTEM_OK;
+}
+
+system_error_t stock_supplier_get_all(stock_supplier_t* suppliers, uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || suppliers == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t copy_count = (g_suppliers_count < max_count) ? g_suppliers_count : max_count;
+    memcpy(suppliers, g_suppliers, copy_count * sizeof(stock_supplier_t));
+    
+    *count = copy_count;
+    return SYSTEM_OK;
+}
+
+system_error_t stock_supplier_record_price(uint32_t item_id, uint32_t supplier_id,
+                                          float unit_price, uint16_t lead_time_days)
+{
+    if (!g_initialized || item_id == 0 || unit_price < 0.0f) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    int32_t supplier_index = find_supplier_index(supplier_id);
+    if (supplier_index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    // Une offre ne peut porter que sur un article existant
+    stock_item_t item;
+    if (stock_get_item_by_id(item_id, &item) != SYSTEM_OK) {
+        ESP_LOGW(TAG, "Prix rejeté: article ID=%" PRIu32 " introuvable", item_id);
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    stock_price_record_t record = {
+        .item_id = item_id,
+        .supplier_id = supplier_id,
+        .unit_price = unit_price,
+        .lead_time_days = lead_time_days ? lead_time_days : g_suppliers[supplier_index].default_lead_time_days,
+        .recorded_at = time(NULL)
+    };
+    
+    // Mise à jour de l'offre courante, ou insertion à sa place dans l'ordre trié
+    uint32_t pos = offer_lower_bound(item_id, supplier_id);
+    if (pos < g_offers_count && g_offers[pos].item_id == item_id && g_offers[pos].supplier_id == supplier_id) {
+        g_offers[pos] = record;
+    } else {
+        if (g_offers_count >= MAX_SUPPLIER_OFFERS) {
+            ESP_LOGE(TAG, "Nombre maximum d'offres atteint");
+            return SYSTEM_ERROR_MEMORY;
+        }
+        memmove(&g_offers[pos + 1], &g_offers[pos], (g_offers_count - pos) * sizeof(stock_price_record_t));
+        g_offers[pos] = record;
+        g_offers_count++;
+    }
+    
+    g_price_history[g_history_head] = record;
+    g_history_head = (g_history_head + 1) % MAX_PRICE_HISTORY;
+    if (g_history_count < MAX_PRICE_HISTORY) {
+        g_history_count++;
+    }
+    
+    ESP_LOGI(TAG, "Prix enregistré: article ID=%" PRIu32 ", fournisseur ID=%" PRIu32 ", %.2f",
+             item_id, supplier_id, unit_price);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t stock_supplier_get_price_history(uint32_t item_id, uint32_t supplier_id,
+                                               stock_price_record_t* records, uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || records == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t found_count = 0;
+    
+    for (uint32_t age = 0; age < g_history_count && found_count < max_count; age++) {
+        const stock_price_record_t* record =
+            &g_price_history[(g_history_head + MAX_PRICE_HISTORY - 1 - age) % MAX_PRICE_HISTORY];
+        if (record->item_id == item_id && (supplier_id == 0 || record->supplier_id == supplier_id)) {
+            records[found_count++] = *record;
+        }
+    }
+    
+    *count = found_count;
+    return SYSTEM_OK;
+}
+
+bool supplier_manager_is_active(uint32_t supplier_id)
+{
+    int32_t index = find_supplier_index(supplier_id);
+    return index >= 0 && g_suppliers[index].is_active;
+}
+
+bool supplier_manager_best_offer(uint32_t item_id, supplier_criteria_t criteria, stock_price_record_t* offer)
+{
+    const stock_price_record_t* best = NULL;
+    
+    for (uint32_t i = offer_lower_bound(item_id, 0); i < g_offers_count && g_offers[i].item_id == item_id; i++) {
+        int32_t supplier_index = find_supplier_index(g_offers[i].supplier_id);
+        if (supplier_index < 0 || !g_suppliers[supplier_index].is_active) {
+            continue;
+        }
+        if (best == NULL || offer_is_better(&g_offers[i], best, criteria)) {
+            best = &g_offers[i];
+        }
+    }
+    
+    if (best == NULL) {
+        return false;
+    }
+    
+    *offer = *best;
+    return true;
+}
+
+system_error_t stock_supplier_get_best_offer(uint32_t item_id, supplier_criteria_t criteria,
+                                            stock_price_record_t* offer)
+{
+    if (!g_initialized || offer == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    return supplier_manager_best_offer(item_id, criteria, offer) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+}
+
+void supplier_manager_remove_item(uint32_t item_id)
+{
+    uint32_t first = offer_lower_bound(item_id, 0);
+    uint32_t last = first;
+    
+    while (last < g_offers_count && g_offers[last].item_id == item_id) {
+        last++;
+    }
+    
+    if (last > first) {
+        memmove(&g_offers[first], &g_offers[last], (g_offers_count - last) * sizeof(stock_price_record_t));
+        g_offers_count -= last - first;
+    }
 }
\ No newline at end of file
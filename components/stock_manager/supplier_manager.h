@@ -0,0 +1,33 @@
+#ifndef SUPPLIER_MANAGER_H
+#define SUPPLIER_MANAGER_H
+
+#include "stock_manager.h"
+
+/**
+ * @brief Initialise le catalogue des fournisseurs
+ */
+void supplier_manager_init(void);
+
+/**
+ * @brief Indique si un fournisseur existe et est actif
+ * @param supplier_id ID du fournisseur
+ * @return true si le fournisseur est actif
+ */
+bool supplier_manager_is_active(uint32_t supplier_id);
+
+/**
+ * @brief Recherche la meilleure offre courante d'un article (fournisseurs actifs uniquement)
+ * @param item_id ID de l'article
+ * @param criteria Critère de choix
+ * @param offer Pointeur vers l'offre à remplir
+ * @return true si une offre existe
+ */
+bool supplier_manager_best_offer(uint32_t item_id, supplier_criteria_t criteria, stock_price_record_t* offer);
+
+/**
+ * @brief Retire les offres courantes d'un article supprimé
+ * @param item_id ID de l'article
+ */
+void supplier_manager_remove_item(uint32_t item_id);
+
+#endif // SUPPLIER_MANAGER_H
\ No newline at end of file
@@ -42,8 +42,17 @@ typedef struct {
     bool humidifier_enabled;
     time_t created_at;
     time_t updated_at;
+    uint32_t change_version;    // Version de la dernière modification (attribuée par le moniteur)
 } terrarium_t;
 
+/**
+ * @brief Fonction appelée pour chaque terrarium d'un parcours
+ * @param terrarium Terrarium (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ * @return true pour continuer le parcours, false pour l'arrêter
+ */
+typedef bool (*terrarium_visit_fn_t)(const terrarium_t* terrarium, void* context);
+
 // Structure d'une alarme
 typedef struct {
     uint32_t id;
@@ -131,6 +140,43 @@ system_error_t terrarium_get_by_id(uint32_t terrarium_id, terrarium_t* terrarium
  */
 system_error_t terrarium_get_all(terrarium_t* terrariums, uint32_t max_count, uint32_t* count);
 
+/**
+ * @brief Parcourt les terrariums par ID croissant
+ *
+ * Les terrariums sont copiés sous le verrou par petits lots et visit est appelée hors du verrou :
+ * elle peut lire ou modifier les terrariums, un parcours reflète alors chaque lot au moment de sa copie.
+ *
+ * @param visit Fonction appelée pour chaque terrarium
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot n'a pas pu être alloué
+ */
+system_error_t terrarium_for_each(terrarium_visit_fn_t visit, void* context);
+
+/**
+ * @brief Restaure des terrariums sauvegardés avec leurs IDs (un terrarium de même ID est remplacé)
+ * @param terrariums Terrariums à restaurer
+ * @param count Nombre de terrariums
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si la table est pleine
+ */
+system_error_t terrarium_restore(const terrarium_t* terrariums, uint32_t count);
+
+/**
+ * @brief Version de changement courante, avancée à chaque ajout, modification ou suppression de terrarium
+ * @return Dernière version attribuée (0 au démarrage)
+ */
+uint32_t terrarium_get_change_version(void);
+
+/**
+ * @brief Copie les suppressions de terrariums postérieures à une version de changement
+ * @param since_version Version de référence
+ * @param deletions Tableau à remplir (CHANGE_LOG_DELETIONS entrées suffisent)
+ * @param max_count Taille du tableau
+ * @param count Pointeur vers le nombre de suppressions copiées
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si des suppressions postérieures ont été oubliées
+ */
+system_error_t terrarium_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                       uint32_t* count);
+
 /**
  * @brief Ajoute un capteur à un terrarium
  * @param terrarium_id ID du terrarium
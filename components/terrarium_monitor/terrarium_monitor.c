@@ -1,6 +1,8 @@
 #include "terrarium_monitor.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include <string.h>
 #include <inttypes.h>
@@ -14,6 +16,45 @@ static terrarium_t g_terrariums[MAX_TERRARIUMS];
 static uint32_t g_terrariums_count = 0;
 static uint32_t g_next_id = 1;
 static TaskHandle_t g_monitor_task = NULL;
+static SemaphoreHandle_t g_mutex = NULL;  // Protège la table des terrariums et le journal des suppressions
+
+// Versions de changement et dernières suppressions, pour les sauvegardes incrémentales
+static uint32_t g_change_version = 0;
+static record_deletion_t g_deletions[CHANGE_LOG_DELETIONS];
+static uint32_t g_deletions_count = 0;
+static uint32_t g_forgotten_version = 0;    // Suppressions oubliées jusqu'à cette version incluse
+
+// Les terrariums sont rangés par ID croissant : position du premier ID supérieur ou égal
+static uint32_t terrarium_lower_bound(uint32_t terrarium_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_terrariums_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_terrariums[mid].id < terrarium_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void log_deletion(uint32_t terrarium_id)
+{
+    // Journal plein : la suppression la plus ancienne est oubliée
+    if (g_deletions_count == CHANGE_LOG_DELETIONS) {
+        g_forgotten_version = g_deletions[0].version;
+        memmove(&g_deletions[0], &g_deletions[1], (CHANGE_LOG_DELETIONS - 1) * sizeof(record_deletion_t));
+        g_deletions_count--;
+    }
+    
+    g_deletions[g_deletions_count].id = terrarium_id;
+    g_deletions[g_deletions_count].version = ++g_change_version;
+    g_deletions_count++;
+}
 
 static void monitor_task(void* pvParameters)
 {
@@ -37,6 +78,11 @@ system_error_t terrarium_monitor_init(void)
     
     ESP_LOGI(TAG, "Initialisation du moniteur de terrariums...");
     
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_mutex == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
     // Initialisation des données
     memset(g_terrariums, 0, sizeof(g_terrariums));
     g_terrariums_count = 0;
@@ -104,7 +150,10 @@ system_error_t terrarium_add(terrarium_t* terrarium)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     if (g_terrariums_count >= MAX_TERRARIUMS) {
+        xSemaphoreGive(g_mutex);
         ESP_LOGE(TAG, "Nombre maximum de terrariums atteint");
         return SYSTEM_ERROR_MEMORY;
     }
@@ -113,11 +162,14 @@ system_error_t terrarium_add(terrarium_t* terrarium)
     terrarium->id = g_next_id++;
     terrarium->created_at = time(NULL);
     terrarium->updated_at = terrarium->created_at;
+    terrarium->change_version = ++g_change_version;
     
     // Ajouter à la liste
     memcpy(&g_terrariums[g_terrariums_count], terrarium, sizeof(terrarium_t));
     g_terrariums_count++;
     
+    xSemaphoreGive(g_mutex);
+    
     ESP_LOGI(TAG, "Terrarium ajouté: ID=%" PRIu32 ", Nom=%s", terrarium->id, terrarium->name);
     
     return SYSTEM_OK;
@@ -129,18 +181,23 @@ system_error_t terrarium_update(const terrarium_t* terrarium)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher le terrarium
-    for (uint32_t i = 0; i < g_terrariums_count; i++) {
-        if (g_terrariums[i].id == terrarium->id) {
-            memcpy(&g_terrariums[i], terrarium, sizeof(terrarium_t));
-            g_terrariums[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Terrarium mis à jour: ID=%" PRIu32, terrarium->id);
-            return SYSTEM_OK;
-        }
+    uint32_t pos = terrarium_lower_bound(terrarium->id);
+    if (pos >= g_terrariums_count || g_terrariums[pos].id != terrarium->id) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    memcpy(&g_terrariums[pos], terrarium, sizeof(terrarium_t));
+    g_terrariums[pos].updated_at = time(NULL);
+    g_terrariums[pos].change_version = ++g_change_version;
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Terrarium mis à jour: ID=%" PRIu32, terrarium->id);
+    return SYSTEM_OK;
 }
 
 system_error_t terrarium_delete(uint32_t terrarium_id)
@@ -149,21 +206,24 @@ system_error_t terrarium_delete(uint32_t terrarium_id)
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     // Rechercher et supprimer le terrarium
-    for (uint32_t i = 0; i < g_terrariums_count; i++) {
-        if (g_terrariums[i].id == terrarium_id) {
-            // Décaler les éléments suivants
-            for (uint32_t j = i; j < g_terrariums_count - 1; j++) {
-                memcpy(&g_terrariums[j], &g_terrariums[j + 1], sizeof(terrarium_t));
-            }
-            g_terrariums_count--;
-            
-            ESP_LOGI(TAG, "Terrarium supprimé: ID=%" PRIu32, terrarium_id);
-            return SYSTEM_OK;
-        }
+    uint32_t pos = terrarium_lower_bound(terrarium_id);
+    if (pos >= g_terrariums_count || g_terrariums[pos].id != terrarium_id) {
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_NOT_FOUND;
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    // Décaler les éléments suivants
+    memmove(&g_terrariums[pos], &g_terrariums[pos + 1], (g_terrariums_count - pos - 1) * sizeof(terrarium_t));
+    g_terrariums_count--;
+    log_deletion(terrarium_id);
+    
+    xSemaphoreGive(g_mutex);
+    
+    ESP_LOGI(TAG, "Terrarium supprimé: ID=%" PRIu32, terrarium_id);
+    return SYSTEM_OK;
 }
 
 system_error_t terrarium_get_by_id(uint32_t terrarium_id, terrarium_t* terrarium)
@@ -172,14 +232,17 @@ system_error_t terrarium_get_by_id(uint32_t terrarium_id, terrarium_t* terrarium
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    for (uint32_t i = 0; i < g_terrariums_count; i++) {
-        if (g_terrariums[i].id == terrarium_id) {
-            memcpy(terrarium, &g_terrariums[i], sizeof(terrarium_t));
-            return SYSTEM_OK;
-        }
+    system_error_t ret = SYSTEM_ERROR_NOT_FOUND;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    uint32_t pos = terrarium_lower_bound(terrarium_id);
+    if (pos < g_terrariums_count && g_terrariums[pos].id == terrarium_id) {
+        memcpy(terrarium, &g_terrariums[pos], sizeof(terrarium_t));
+        ret = SYSTEM_OK;
     }
+    xSemaphoreGive(g_mutex);
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    return ret;
 }
 
 system_error_t terrarium_get_all(terrarium_t* terrariums, uint32_t max_count, uint32_t* count)
@@ -188,16 +251,140 @@ system_error_t terrarium_get_all(terrarium_t* terrariums, uint32_t max_count, ui
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
     uint32_t copy_count = (g_terrariums_count < max_count) ? g_terrariums_count : max_count;
     
     for (uint32_t i = 0; i < copy_count; i++) {
         memcpy(&terrariums[i], &g_terrariums[i], sizeof(terrarium_t));
     }
     
+    xSemaphoreGive(g_mutex);
+    
     *count = copy_count;
     return SYSTEM_OK;
 }
 
+// Parcours par lots : les terrariums sont copiés sous g_mutex par ID croissant, chaque lot reprenant
+// après le dernier ID du précédent, puis remis à l'appelant hors du verrou
+#define VISIT_BATCH_ENTRIES     8
+
+system_error_t terrarium_for_each(terrarium_visit_fn_t visit, void* context)
+{
+    if (!g_initialized || visit == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    terrarium_t* batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(terrarium_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (batch == NULL) {
+        batch = heap_caps_malloc(VISIT_BATCH_ENTRIES * sizeof(terrarium_t), MALLOC_CAP_8BIT);
+    }
+    if (batch == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    uint32_t next_id = 0;
+    uint32_t count;
+    bool keep_going = true;
+    do {
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+        uint32_t pos = terrarium_lower_bound(next_id);
+        count = (g_terrariums_count - pos < VISIT_BATCH_ENTRIES) ? g_terrariums_count - pos : VISIT_BATCH_ENTRIES;
+        memcpy(batch, &g_terrariums[pos], count * sizeof(terrarium_t));
+        xSemaphoreGive(g_mutex);
+        
+        for (uint32_t i = 0; keep_going && i < count; i++) {
+            keep_going = visit(&batch[i], context);
+        }
+        if (count > 0) {
+            next_id = batch[count - 1].id + 1;
+        }
+    } while (keep_going && count == VISIT_BATCH_ENTRIES);
+    
+    heap_caps_free(batch);
+    return SYSTEM_OK;
+}
+
+system_error_t terrarium_restore(const terrarium_t* terrariums, uint32_t count)
+{
+    if (!g_initialized || terrariums == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    for (uint32_t i = 0; i < count; i++) {
+        const terrarium_t* terrarium = &terrariums[i];
+        
+        // Les terrariums sont rangés par ID croissant (ajout en fin)
+        uint32_t pos = g_terrariums_count;
+        while (pos > 0 && g_terrariums[pos - 1].id > terrarium->id) {
+            pos--;
+        }
+        if (pos == 0 || g_terrariums[pos - 1].id != terrarium->id) {
+            if (g_terrariums_count >= MAX_TERRARIUMS) {
+                xSemaphoreGive(g_mutex);
+                ESP_LOGE(TAG, "Nombre maximum de terrariums atteint");
+                return SYSTEM_ERROR_MEMORY;
+            }
+            memmove(&g_terrariums[pos + 1], &g_terrariums[pos], (g_terrariums_count - pos) * sizeof(terrarium_t));
+            g_terrariums_count++;
+            pos++;
+        }
+        
+        memcpy(&g_terrariums[pos - 1], terrarium, sizeof(terrarium_t));
+        g_terrariums[pos - 1].change_version = ++g_change_version;
+        if (terrarium->id >= g_next_id) {
+            g_next_id = terrarium->id + 1;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return SYSTEM_OK;
+}
+
+uint32_t terrarium_get_change_version(void)
+{
+    if (!g_initialized) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    uint32_t version = g_change_version;
+    xSemaphoreGive(g_mutex);
+    return version;
+}
+
+system_error_t terrarium_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                       uint32_t* count)
+{
+    if (!g_initialized || deletions == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    *count = 0;
+    if (since_version < g_forgotten_version) {
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    }
+    for (uint32_t i = 0; ret == SYSTEM_OK && i < g_deletions_count; i++) {
+        if (g_deletions[i].version <= since_version) {
+            continue;
+        }
+        if (*count >= max_count) {
+            ret = SYSTEM_ERROR_MEMORY;
+            break;
+        }
+        deletions[(*count)++] = g_deletions[i];
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return ret;
+}
+
 system_error_t terrarium_add_sensor(uint32_t terrarium_id, const sensor_t* sensor)
 {
     if (!g_initialized || sensor == NULL) {
@@ -253,7 +440,9 @@ system_error_t terrarium_get_stats(terrarium_stats_t* stats)
     
     memset(stats, 0, sizeof(terrarium_stats_t));
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     stats->total_terrariums = g_terrariums_count;
+    xSemaphoreGive(g_mutex);
     // TODO: Calculer les autres statistiques
     
     return SYSTEM_OK;
@@ -1,9 +1,118 @@
-#include "transaction_manager.h"
+#include "certificate_generator.h"
 #include "esp_log.h"
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
 
 static const char* TAG = "CERTIFICATE_GENERATOR";
 
-void certificate_generator_init(void)
+// Champs disponibles dans le modèle de certificat
+typedef enum {
+    CERT_FIELD_TYPE,
+    CERT_FIELD_NUMBER,
+    CERT_FIELD_ISSUE_DATE,
+    CERT_FIELD_AUTHORITY,
+    CERT_FIELD_TRANSACTION_ID,
+    CERT_FIELD_TRANSACTION_DATE,
+    CERT_FIELD_ANIMAL_NAME,
+    CERT_FIELD_SPECIES,
+    CERT_FIELD_AMOUNT,
+    CERT_FIELD_CURRENCY,
+    CERT_FIELD_COUNTERPART_NAME,
+    CERT_FIELD_COUNTERPART_ADDRESS,
+    CERT_FIELD_CITES_PERMIT,
+    CERT_FIELD_COUNT
+} certificate_field_t;
+
+static const char* const k_field_names[CERT_FIELD_COUNT] = {
+    "type",
+    "numero",
+    "date_emission",
+    "autorite",
+    "transaction_id",
+    "date_transaction",
+    "animal",
+    "espece",
+    "montant",
+    "devise",
+    "contrepartie",
+    "adresse",
+    "permis_cites"
+};
+
+static const char* const k_certificate_source =
+    "CERTIFICAT {{type}}\n"
+    "N° {{numero}} - établi le {{date_emission}} par {{autorite}}\n"
+    "\n"
+    "Transaction n° {{transaction_id}} du {{date_transaction}}\n"
+    "Animal: {{animal}} ({{espece}})\n"
+    "Montant: {{montant}} {{devise}}\n"
+    "Contrepartie: {{contrepartie}}\n"
+    "Adresse: {{adresse}}\n"
+    "Permis CITES: {{permis_cites}}\n";
+
+// Modèle compilé une seule fois à l'initialisation
+static document_template_t g_template;
+static bool g_template_ready = false;
+
+static void format_date(char* buffer, size_t size, time_t date)
 {
+    if (date == 0) {
+        buffer[0] = '\0';
+        return;
+    }
+    
+    struct tm date_tm;
+    localtime_r(&date, &date_tm);
+    strftime(buffer, size, "%d/%m/%Y", &date_tm);
+}
+
+system_error_t certificate_generator_init(void)
+{
+    system_error_t ret = document_template_compile(&g_template, k_certificate_source, k_field_names, CERT_FIELD_COUNT);
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Modèle de certificat invalide");
+        return ret;
+    }
+    
+    g_template_ready = true;
     ESP_LOGI(TAG, "Générateur de certificats initialisé");
+    
+    return SYSTEM_OK;
+}
+
+system_error_t certificate_generator_render(const transaction_t* transaction, const certificate_t* certificate,
+                                           const document_sink_t* sink)
+{
+    if (!g_template_ready || transaction == NULL || certificate == NULL || sink == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    char issue_date[16];
+    char transaction_date[16];
+    char transaction_id[12];
+    char amount[24];
+    
+    format_date(issue_date, sizeof(issue_date), certificate->issue_date);
+    format_date(transaction_date, sizeof(transaction_date), transaction->transaction_date);
+    snprintf(transaction_id, sizeof(transaction_id), "%" PRIu32, transaction->id);
+    snprintf(amount, sizeof(amount), "%.2f", transaction->amount);
+    
+    const char* values[CERT_FIELD_COUNT] = {
+        [CERT_FIELD_TYPE] = certificate->certificate_type,
+        [CERT_FIELD_NUMBER] = certificate->certificate_number,
+        [CERT_FIELD_ISSUE_DATE] = issue_date,
+        [CERT_FIELD_AUTHORITY] = certificate->issuing_authority,
+        [CERT_FIELD_TRANSACTION_ID] = transaction_id,
+        [CERT_FIELD_TRANSACTION_DATE] = transaction_date,
+        [CERT_FIELD_ANIMAL_NAME] = transaction->animal_name,
+        [CERT_FIELD_SPECIES] = transaction->animal_species,
+        [CERT_FIELD_AMOUNT] = amount,
+        [CERT_FIELD_CURRENCY] = transaction->currency,
+        [CERT_FIELD_COUNTERPART_NAME] = transaction->counterpart_name,
+        [CERT_FIELD_COUNTERPART_ADDRESS] = transaction->counterpart_address,
+        [CERT_FIELD_CITES_PERMIT] = transaction->cites_required ? transaction->cites_permit_number : "non requis"
+    };
+    
+    return document_template_render(&g_template, values, sink);
 }
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef CERTIFICATE_GENERATOR_H
+#define CERTIFICATE_GENERATOR_H
+
+#include "transaction_manager.h"
+
+/**
+ * @brief Compile le modèle de certificat
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t certificate_generator_init(void);
+
+/**
+ * @brief Produit le texte d'un certificat vers une destination
+ * @param transaction Transaction certifiée
+ * @param certificate Certificat (type, numéro, dates, autorité)
+ * @param sink Destination du rendu
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t certificate_generator_render(const transaction_t* transaction, const certificate_t* certificate,
+                                           const document_sink_t* sink);
+
+#endif // CERTIFICATE_GENERATOR_H
\ No newline at end of file
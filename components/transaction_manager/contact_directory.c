@@ -0,0 +1,423 @@
+#include "contact_directory.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+static const char* TAG = "CONTACT_DIRECTORY";
+
+// Contact, ses clés de recherche normalisées et ses références
+typedef struct {
+    transaction_contact_t contact;
+    char name_key[128];
+    char email_key[64];
+    uint32_t references;    // Transactions en mémoire désignant le contact
+    bool archived;          // Désigné par des transactions archivées : jamais retiré
+} contact_entry_t;
+
+// Contacts rangés par ID croissant (en PSRAM), index par nom et par email triés sur les clés
+static contact_entry_t* g_contacts = NULL;
+static uint32_t g_contacts_count = 0;
+static uint32_t g_next_contact_id = 1;
+static uint16_t g_by_name[MAX_CONTACTS];
+static uint32_t g_by_name_count = 0;
+static uint16_t g_by_email[MAX_CONTACTS];
+static uint32_t g_by_email_count = 0;
+static bool g_reclaim_enabled = false;  // Contacts sans référence retirés (après l'élagage qui suit la relecture)
+
+// Minuscules ASCII, espaces de début et de fin supprimés, espaces internes réduits à un seul
+static void normalize_key(char* key, size_t size, const char* value)
+{
+    size_t length = 0;
+    bool pending_space = false;
+    
+    for (const char* c = value; *c != '\0' && length + 1 < size; c++) {
+        if (isspace((unsigned char)*c)) {
+            pending_space = (length > 0);
+            continue;
+        }
+        if (pending_space && length + 2 < size) {
+            key[length++] = ' ';
+        }
+        pending_space = false;
+        key[length++] = (char)tolower((unsigned char)*c);
+    }
+    
+    key[length] = '\0';
+}
+
+static const char* entry_key(uint16_t entry, bool by_email)
+{
+    return by_email ? g_contacts[entry].email_key : g_contacts[entry].name_key;
+}
+
+// Première position de l'index dont la clé n'est pas inférieure à key
+static uint32_t key_lower_bound(const uint16_t* index, uint32_t count, bool by_email, const char* key)
+{
+    uint32_t low = 0;
+    uint32_t high = count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (strcmp(entry_key(index[mid], by_email), key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static int32_t key_find(const uint16_t* index, uint32_t count, bool by_email, const char* key)
+{
+    if (key[0] == '\0') {
+        return -1;
+    }
+    
+    uint32_t pos = key_lower_bound(index, count, by_email, key);
+    if (pos < count && strcmp(entry_key(index[pos], by_email), key) == 0) {
+        return index[pos];
+    }
+    
+    return -1;
+}
+
+static void key_insert(uint16_t* index, uint32_t* count, bool by_email, uint16_t entry)
+{
+    const char* key = entry_key(entry, by_email);
+    if (key[0] == '\0') {
+        return;
+    }
+    
+    uint32_t pos = key_lower_bound(index, *count, by_email, key);
+    memmove(&index[pos + 1], &index[pos], (*count - pos) * sizeof(uint16_t));
+    index[pos] = entry;
+    (*count)++;
+}
+
+static void key_remove(uint16_t* index, uint32_t* count, bool by_email, uint16_t entry)
+{
+    const char* key = entry_key(entry, by_email);
+    
+    for (uint32_t pos = key_lower_bound(index, *count, by_email, key);
+         pos < *count && strcmp(entry_key(index[pos], by_email), key) == 0; pos++) {
+        if (index[pos] == entry) {
+            memmove(&index[pos], &index[pos + 1], (*count - pos - 1) * sizeof(uint16_t));
+            (*count)--;
+            return;
+        }
+    }
+}
+
+static int32_t find_contact_index(uint32_t contact_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_contacts_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_contacts[mid].contact.id < contact_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    if (low < g_contacts_count && g_contacts[low].contact.id == contact_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+// Vrai si les deux valeurs sont renseignées et diffèrent (casse et espaces ignorés)
+static bool detail_conflicts(const char* stored, const char* incoming)
+{
+    char stored_key[256];
+    char incoming_key[256];
+    normalize_key(stored_key, sizeof(stored_key), stored);
+    normalize_key(incoming_key, sizeof(incoming_key), incoming);
+    
+    return stored_key[0] != '\0' && incoming_key[0] != '\0' && strcmp(stored_key, incoming_key) != 0;
+}
+
+static bool contact_conflicts(uint16_t entry, const transaction_t* transaction)
+{
+    const transaction_contact_t* contact = &g_contacts[entry].contact;
+    
+    return detail_conflicts(contact->name, transaction->counterpart_name) ||
+           detail_conflicts(contact->address, transaction->counterpart_address) ||
+           detail_conflicts(contact->phone, transaction->counterpart_phone) ||
+           detail_conflicts(contact->email, transaction->counterpart_email);
+}
+
+// Premier contact de même clé dont les coordonnées sont compatibles avec celles de la transaction
+static int32_t key_find_compatible(const uint16_t* index, uint32_t count, bool by_email, const char* key,
+                                   const transaction_t* transaction)
+{
+    if (key[0] == '\0') {
+        return -1;
+    }
+    
+    for (uint32_t pos = key_lower_bound(index, count, by_email, key);
+         pos < count && strcmp(entry_key(index[pos], by_email), key) == 0; pos++) {
+        if (!contact_conflicts(index[pos], transaction)) {
+            return index[pos];
+        }
+    }
+    
+    return -1;
+}
+
+static bool fill_if_empty(char* dst, size_t size, const char* src)
+{
+    if (dst[0] != '\0' || src[0] == '\0') {
+        return false;
+    }
+    
+    snprintf(dst, size, "%s", src);
+    return true;
+}
+
+// Complète les coordonnées manquantes d'un contact : celles déjà enregistrées, partagées par
+// d'autres transactions, ne sont jamais remplacées
+static void complete_contact(uint16_t entry, const transaction_t* transaction)
+{
+    contact_entry_t* contact = &g_contacts[entry];
+    bool changed = false;
+    
+    changed |= fill_if_empty(contact->contact.name, sizeof(contact->contact.name), transaction->counterpart_name);
+    changed |= fill_if_empty(contact->contact.address, sizeof(contact->contact.address),
+                             transaction->counterpart_address);
+    changed |= fill_if_empty(contact->contact.phone, sizeof(contact->contact.phone), transaction->counterpart_phone);
+    changed |= fill_if_empty(contact->contact.email, sizeof(contact->contact.email), transaction->counterpart_email);
+    
+    if (!changed) {
+        return;
+    }
+    
+    // Les clés enregistrées désignent encore les anciennes entrées d'index
+    key_remove(g_by_name, &g_by_name_count, false, entry);
+    key_remove(g_by_email, &g_by_email_count, true, entry);
+    normalize_key(contact->name_key, sizeof(contact->name_key), contact->contact.name);
+    normalize_key(contact->email_key, sizeof(contact->email_key), contact->contact.email);
+    key_insert(g_by_name, &g_by_name_count, false, entry);
+    key_insert(g_by_email, &g_by_email_count, true, entry);
+    
+    contact->contact.updated_at = time(NULL);
+}
+
+// Retire un contact du tableau ; les index désignent les rangs, ceux des contacts suivants reculent d'un rang
+static void remove_entry(uint16_t entry)
+{
+    ESP_LOGI(TAG, "Contact retiré: ID=%" PRIu32, g_contacts[entry].contact.id);
+    
+    key_remove(g_by_name, &g_by_name_count, false, entry);
+    key_remove(g_by_email, &g_by_email_count, true, entry);
+    memmove(&g_contacts[entry], &g_contacts[entry + 1], (g_contacts_count - entry - 1) * sizeof(contact_entry_t));
+    g_contacts_count--;
+    
+    for (uint32_t i = 0; i < g_by_name_count; i++) {
+        g_by_name[i] -= (g_by_name[i] > entry);
+    }
+    for (uint32_t i = 0; i < g_by_email_count; i++) {
+        g_by_email[i] -= (g_by_email[i] > entry);
+    }
+}
+
+system_error_t contact_directory_init(void)
+{
+    g_contacts = heap_caps_calloc(MAX_CONTACTS, sizeof(contact_entry_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_contacts == NULL) {
+        g_contacts = heap_caps_calloc(MAX_CONTACTS, sizeof(contact_entry_t), MALLOC_CAP_8BIT);
+    }
+    if (g_contacts == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer l'annuaire des contacts");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    g_contacts_count = 0;
+    g_next_contact_id = 1;
+    g_by_name_count = 0;
+    g_by_email_count = 0;
+    g_reclaim_enabled = false;
+    
+    ESP_LOGI(TAG, "Annuaire des contacts initialisé");
+    return SYSTEM_OK;
+}
+
+system_error_t contact_directory_resolve(const transaction_t* transaction, uint32_t* contact_id)
+{
+    int32_t entry = -1;
+    
+    // Un ID inconnu (contact retiré depuis, faute de référence) est résolu par les coordonnées
+    if (transaction->counterpart_id != 0) {
+        entry = find_contact_index(transaction->counterpart_id);
+        // Coordonnées divergentes : les autres transactions du contact conservent les leurs
+        if (entry >= 0 && contact_conflicts((uint16_t)entry, transaction)) {
+            entry = -1;
+        }
+    }
+    
+    if (entry < 0) {
+        char name_key[128];
+        char email_key[64];
+        normalize_key(name_key, sizeof(name_key), transaction->counterpart_name);
+        normalize_key(email_key, sizeof(email_key), transaction->counterpart_email);
+        
+        if (transaction->counterpart_id == 0 && name_key[0] == '\0' && email_key[0] == '\0') {
+            *contact_id = 0;
+            return SYSTEM_OK;
+        }
+        
+        // Homonyme ou email partagé avec d'autres coordonnées : contact distinct
+        entry = key_find_compatible(g_by_email, g_by_email_count, true, email_key, transaction);
+        if (entry < 0) {
+            entry = key_find_compatible(g_by_name, g_by_name_count, false, name_key, transaction);
+        }
+        
+        if (entry < 0) {
+            if (g_contacts_count >= MAX_CONTACTS) {
+                ESP_LOGE(TAG, "Nombre maximum de contacts atteint");
+                return SYSTEM_ERROR_MEMORY;
+            }
+            
+            // Ajout en fin : les IDs croissants gardent le tableau trié
+            entry = (int32_t)g_contacts_count++;
+            memset(&g_contacts[entry], 0, sizeof(contact_entry_t));
+            g_contacts[entry].contact.id = g_next_contact_id++;
+            g_contacts[entry].contact.created_at = time(NULL);
+            ESP_LOGI(TAG, "Contact ajouté: ID=%" PRIu32, g_contacts[entry].contact.id);
+        }
+    }
+    
+    complete_contact((uint16_t)entry, transaction);
+    g_contacts[entry].references++;
+    *contact_id = g_contacts[entry].contact.id;
+    
+    return SYSTEM_OK;
+}
+
+void contact_directory_retain(uint32_t contact_id)
+{
+    int32_t entry = find_contact_index(contact_id);
+    if (entry >= 0) {
+        g_contacts[entry].references++;
+    }
+}
+
+void contact_directory_release(uint32_t contact_id)
+{
+    int32_t entry = find_contact_index(contact_id);
+    if (entry < 0 || g_contacts[entry].references == 0) {
+        return;
+    }
+    
+    g_contacts[entry].references--;
+    if (g_reclaim_enabled && g_contacts[entry].references == 0 && !g_contacts[entry].archived) {
+        remove_entry((uint16_t)entry);
+    }
+}
+
+void contact_directory_set_archived(uint32_t contact_id)
+{
+    int32_t entry = find_contact_index(contact_id);
+    if (entry >= 0) {
+        g_contacts[entry].archived = true;
+    }
+}
+
+uint32_t contact_directory_prune(contact_archived_fn_t is_archived)
+{
+    uint32_t removed = 0;
+    
+    // Parcours depuis la fin : un retrait ne décale que les contacts déjà examinés
+    for (uint32_t entry = g_contacts_count; entry-- > 0; ) {
+        contact_entry_t* contact = &g_contacts[entry];
+        if (contact->references > 0 || contact->archived) {
+            continue;
+        }
+        if (is_archived == NULL || is_archived(contact->contact.id)) {
+            contact->archived = true;
+        } else {
+            remove_entry((uint16_t)entry);
+            removed++;
+        }
+    }
+    
+    g_reclaim_enabled = true;
+    return removed;
+}
+
+system_error_t contact_directory_restore(const transaction_contact_t* contact)
+{
+    int32_t entry = find_contact_index(contact->id);
+    
+    if (entry < 0) {
+        // Ajout en fin uniquement : les index par nom et par email désignent les rangs du tableau
+        if (contact->id == 0 || (g_contacts_count > 0 && contact->id < g_contacts[g_contacts_count - 1].contact.id)) {
+            return SYSTEM_ERROR_INVALID_PARAM;
+        }
+        if (g_contacts_count >= MAX_CONTACTS) {
+            return SYSTEM_ERROR_MEMORY;
+        }
+        entry = (int32_t)g_contacts_count++;
+        memset(&g_contacts[entry], 0, sizeof(contact_entry_t));
+    } else {
+        // Un contact existant garde ses références
+        key_remove(g_by_name, &g_by_name_count, false, (uint16_t)entry);
+        key_remove(g_by_email, &g_by_email_count, true, (uint16_t)entry);
+    }
+    
+    contact_entry_t* restored = &g_contacts[entry];
+    restored->contact = *contact;
+    restored->contact.transaction_count = 0;
+    normalize_key(restored->name_key, sizeof(restored->name_key), restored->contact.name);
+    normalize_key(restored->email_key, sizeof(restored->email_key), restored->contact.email);
+    key_insert(g_by_name, &g_by_name_count, false, (uint16_t)entry);
+    key_insert(g_by_email, &g_by_email_count, true, (uint16_t)entry);
+    
+    if (contact->id >= g_next_contact_id) {
+        g_next_contact_id = contact->id + 1;
+    }
+    
+    return SYSTEM_OK;
+}
+
+const transaction_contact_t* contact_directory_get(uint32_t contact_id)
+{
+    int32_t entry = find_contact_index(contact_id);
+    return (entry >= 0) ? &g_contacts[entry].contact : NULL;
+}
+
+const transaction_contact_t* contact_directory_find(const char* name_or_email)
+{
+    char key[128];
+    normalize_key(key, sizeof(key), name_or_email);
+    
+    int32_t entry = key_find(g_by_email, g_by_email_count, true, key);
+    if (entry < 0) {
+        entry = key_find(g_by_name, g_by_name_count, false, key);
+    }
+    
+    return (entry >= 0) ? &g_contacts[entry].contact : NULL;
+}
+
+const transaction_contact_t* contact_directory_get_at(uint32_t index)
+{
+    return (index < g_contacts_count) ? &g_contacts[index].contact : NULL;
+}
+
+uint32_t contact_directory_get_all(transaction_contact_t* contacts, uint32_t max_count)
+{
+    uint32_t copy_count = (g_contacts_count < max_count) ? g_contacts_count : max_count;
+    
+    for (uint32_t i = 0; i < copy_count; i++) {
+        contacts[i] = g_contacts[i].contact;
+    }
+    
+    return copy_count;
+}
\ No newline at end of file
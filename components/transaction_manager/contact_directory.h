@@ -0,0 +1,105 @@
+#ifndef CONTACT_DIRECTORY_H
+#define CONTACT_DIRECTORY_H
+
+#include "transaction_manager.h"
+
+/**
+ * @brief Indique si des transactions archivées peuvent désigner un contact
+ * @param contact_id ID du contact
+ * @return true si le contact doit être conservé pour l'archive
+ */
+typedef bool (*contact_archived_fn_t)(uint32_t contact_id);
+
+/**
+ * @brief Alloue l'annuaire des contacts
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t contact_directory_init(void);
+
+/**
+ * @brief Retrouve ou crée le contact correspondant aux coordonnées d'une transaction
+ *
+ * Le contact est retrouvé par son ID s'il est fourni et connu, sinon par email puis par nom normalisés.
+ * Les coordonnées ne font que compléter les champs vides du contact retrouvé ; si elles
+ * diffèrent de celles déjà enregistrées, un autre contact est retrouvé ou créé. Le contact
+ * renvoyé gagne une référence, rendue par contact_directory_release.
+ *
+ * @param transaction Transaction portant l'ID et les coordonnées de la contrepartie
+ * @param contact_id Pointeur vers l'ID du contact (0 si aucune contrepartie)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si l'annuaire est plein
+ */
+system_error_t contact_directory_resolve(const transaction_t* transaction, uint32_t* contact_id);
+
+/**
+ * @brief Ajoute une référence à un contact existant (image conservée pour une annulation)
+ * @param contact_id ID du contact (0 : aucun)
+ */
+void contact_directory_retain(uint32_t contact_id);
+
+/**
+ * @brief Rend une référence : transaction retirée ou remplacée, image d'annulation libérée
+ *
+ * Une fois l'annuaire élagué, un contact sans référence qu'aucune transaction archivée
+ * ne désigne est retiré ; son ID n'est plus attribué pendant la session.
+ *
+ * @param contact_id ID du contact (0 : aucun)
+ */
+void contact_directory_release(uint32_t contact_id);
+
+/**
+ * @brief Marque un contact comme désigné par une transaction archivée : il n'est plus jamais retiré
+ * @param contact_id ID du contact
+ */
+void contact_directory_set_archived(uint32_t contact_id);
+
+/**
+ * @brief Retire les contacts sans référence après la relecture du journal
+ *
+ * Les contacts que l'archive peut désigner sont conservés et marqués archivés ; ensuite les
+ * contacts sont retirés dès leur dernière référence rendue.
+ *
+ * @param is_archived Test de l'archive (NULL : archive indisponible, tous les contacts sont conservés)
+ * @return Nombre de contacts retirés
+ */
+uint32_t contact_directory_prune(contact_archived_fn_t is_archived);
+
+/**
+ * @brief Restaure un contact avec son ID d'origine (relecture du journal)
+ *
+ * Les contacts doivent être restaurés par ID croissant ; un contact existant est mis à jour.
+ *
+ * @param contact Contact à restaurer
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si l'annuaire est plein
+ */
+system_error_t contact_directory_restore(const transaction_contact_t* contact);
+
+/**
+ * @brief Accède au contact de rang donné (ordre des IDs croissants)
+ * @param index Rang du contact
+ * @return Contact (valide jusqu'à la prochaine modification), NULL au-delà du dernier
+ */
+const transaction_contact_t* contact_directory_get_at(uint32_t index);
+
+/**
+ * @brief Accède à un contact
+ * @param contact_id ID du contact
+ * @return Contact (valide jusqu'à la prochaine modification), NULL si inconnu
+ */
+const transaction_contact_t* contact_directory_get(uint32_t contact_id);
+
+/**
+ * @brief Recherche un contact par email ou par nom (sans tenir compte de la casse ni des espaces)
+ * @param name_or_email Email ou nom recherché
+ * @return Contact (valide jusqu'à la prochaine modification), NULL si inconnu
+ */
+const transaction_contact_t* contact_directory_find(const char* name_or_email);
+
+/**
+ * @brief Copie les contacts par ID croissant
+ * @param contacts Tableau à remplir
+ * @param max_count Nombre maximum de contacts
+ * @return Nombre de contacts copiés
+ */
+uint32_t contact_directory_get_all(transaction_contact_t* contacts, uint32_t max_count);
+
+#endif // CONTACT_DIRECTORY_H
\ No newline at end of file
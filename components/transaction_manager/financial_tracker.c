@@ -1,9 +1,156 @@
-#include "transaction_manager.h"
+#include "financial_tracker.h"
 #include "esp_log.h"
+#include <string.h>
+#include <math.h>
 
 static const char* TAG = "FINANCIAL_TRACKER";
 
+// Cumuls d'un mois, montants en centimes pour rester exacts après ajouts et retraits
+typedef struct {
+    int32_t month_key;  // année * 12 + mois (0-11)
+    uint32_t counts[TRANSACTION_TYPE_COUNT];
+    int64_t amounts_cents[TRANSACTION_TYPE_COUNT];
+} month_bucket_t;
+
+// Mois triés par clé croissante, plus un cumul global
+static month_bucket_t g_months[FINANCE_MAX_MONTHS];
+static uint32_t g_months_count = 0;
+static month_bucket_t g_totals;
+
+static int32_t month_key(time_t date)
+{
+    struct tm date_tm;
+    localtime_r(&date, &date_tm);
+    return (date_tm.tm_year + 1900) * 12 + date_tm.tm_mon;
+}
+
+static uint32_t month_lower_bound(int32_t key)
+{
+    uint32_t low = 0;
+    uint32_t high = g_months_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_months[mid].month_key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static month_bucket_t* get_month(int32_t key)
+{
+    uint32_t pos = month_lower_bound(key);
+    if (pos < g_months_count && g_months[pos].month_key == key) {
+        return &g_months[pos];
+    }
+    
+    if (g_months_count >= FINANCE_MAX_MONTHS) {
+        ESP_LOGW(TAG, "Nombre maximum de mois atteint");
+        return NULL;
+    }
+    
+    memmove(&g_months[pos + 1], &g_months[pos], (g_months_count - pos) * sizeof(month_bucket_t));
+    memset(&g_months[pos], 0, sizeof(month_bucket_t));
+    g_months[pos].month_key = key;
+    g_months_count++;
+    
+    return &g_months[pos];
+}
+
+static void bucket_apply(month_bucket_t* bucket, transaction_type_t type, int64_t cents, int32_t sign)
+{
+    if (sign > 0) {
+        bucket->counts[type]++;
+    } else if (bucket->counts[type] > 0) {
+        bucket->counts[type]--;
+    }
+    bucket->amounts_cents[type] += sign * cents;
+}
+
 void financial_tracker_init(void)
 {
+    memset(g_months, 0, sizeof(g_months));
+    g_months_count = 0;
+    memset(&g_totals, 0, sizeof(g_totals));
+    
     ESP_LOGI(TAG, "Suivi financier initialisé");
+}
+
+void financial_tracker_apply(transaction_type_t type, transaction_status_t status,
+                             time_t transaction_date, float amount, int32_t sign)
+{
+    if (status != TRANSACTION_STATUS_COMPLETED || (uint32_t)type >= TRANSACTION_TYPE_COUNT) {
+        return;
+    }
+    
+    int64_t cents = llroundf(amount * 100.0f);
+    bucket_apply(&g_totals, type, cents, sign);
+    
+    month_bucket_t* bucket = get_month(month_key(transaction_date));
+    if (bucket != NULL) {
+        bucket_apply(bucket, type, cents, sign);
+    }
+}
+
+void financial_tracker_accumulate(financial_totals_t* totals, transaction_type_t type,
+                                  transaction_status_t status, float amount)
+{
+    if (status != TRANSACTION_STATUS_COMPLETED || (uint32_t)type >= TRANSACTION_TYPE_COUNT) {
+        return;
+    }
+    
+    totals->counts[type]++;
+    totals->amounts_cents[type] += llroundf(amount * 100.0f);
+}
+
+void financial_tracker_add_month(int32_t key, const financial_totals_t* totals)
+{
+    month_bucket_t* bucket = get_month(key);
+    
+    for (uint32_t t = 0; t < TRANSACTION_TYPE_COUNT; t++) {
+        g_totals.counts[t] += totals->counts[t];
+        g_totals.amounts_cents[t] += totals->amounts_cents[t];
+        if (bucket != NULL) {
+            bucket->counts[t] += totals->counts[t];
+            bucket->amounts_cents[t] += totals->amounts_cents[t];
+        }
+    }
+}
+
+void financial_tracker_get_summary(uint16_t year, uint8_t month, financial_summary_t* summary)
+{
+    memset(summary, 0, sizeof(financial_summary_t));
+    summary->year = year;
+    summary->month = month;
+    
+    int64_t cents[TRANSACTION_TYPE_COUNT] = {0};
+    
+    if (year == 0) {
+        memcpy(summary->count_by_type, g_totals.counts, sizeof(summary->count_by_type));
+        memcpy(cents, g_totals.amounts_cents, sizeof(cents));
+    } else {
+        // Mois demandé, ou les douze mois de l'année
+        int32_t first_key = (int32_t)year * 12 + ((month != 0) ? month - 1 : 0);
+        int32_t end_key = (month != 0) ? first_key + 1 : first_key + 12;
+        
+        for (uint32_t i = month_lower_bound(first_key); i < g_months_count && g_months[i].month_key < end_key; i++) {
+            for (uint32_t t = 0; t < TRANSACTION_TYPE_COUNT; t++) {
+                summary->count_by_type[t] += g_months[i].counts[t];
+                cents[t] += g_months[i].amounts_cents[t];
+            }
+        }
+    }
+    
+    for (uint32_t t = 0; t < TRANSACTION_TYPE_COUNT; t++) {
+        summary->amount_by_type[t] = (float)cents[t] / 100.0f;
+        if (summary->count_by_type[t] > 0) {
+            summary->average_by_type[t] = summary->amount_by_type[t] / summary->count_by_type[t];
+        }
+    }
+    
+    summary->net_profit = (float)(cents[TRANSACTION_TYPE_SALE] - cents[TRANSACTION_TYPE_PURCHASE]) / 100.0f;
 }
\ No newline at end of file
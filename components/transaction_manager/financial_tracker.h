@@ -0,0 +1,53 @@
+#ifndef FINANCIAL_TRACKER_H
+#define FINANCIAL_TRACKER_H
+
+#include "transaction_manager.h"
+
+// Cumuls par type de transaction, montants en centimes
+typedef struct {
+    uint32_t counts[TRANSACTION_TYPE_COUNT];
+    int64_t amounts_cents[TRANSACTION_TYPE_COUNT];
+} financial_totals_t;
+
+/**
+ * @brief Initialise les cumuls financiers mensuels
+ */
+void financial_tracker_init(void);
+
+/**
+ * @brief Ajoute ou retire une transaction des cumuls (seules les transactions terminées comptent)
+ * @param type Type de transaction
+ * @param status Statut de la transaction
+ * @param transaction_date Date de la transaction
+ * @param amount Montant
+ * @param sign +1 pour ajouter, -1 pour retirer
+ */
+void financial_tracker_apply(transaction_type_t type, transaction_status_t status,
+                             time_t transaction_date, float amount, int32_t sign);
+
+/**
+ * @brief Cumule une transaction dans des totaux indépendants (mêmes règles que financial_tracker_apply)
+ * @param totals Totaux à compléter
+ * @param type Type de transaction
+ * @param status Statut de la transaction
+ * @param amount Montant
+ */
+void financial_tracker_accumulate(financial_totals_t* totals, transaction_type_t type,
+                                  transaction_status_t status, float amount);
+
+/**
+ * @brief Ajoute aux cumuls les totaux d'un mois dont les transactions ne sont plus en mémoire
+ * @param key Année * 12 + mois (0-11)
+ * @param totals Totaux du mois
+ */
+void financial_tracker_add_month(int32_t key, const financial_totals_t* totals);
+
+/**
+ * @brief Calcule le résumé d'une période à partir des cumuls
+ * @param year Année (0 pour toutes les années)
+ * @param month Mois de 1 à 12 (0 pour l'année entière)
+ * @param summary Pointeur vers le résumé à remplir
+ */
+void financial_tracker_get_summary(uint16_t year, uint8_t month, financial_summary_t* summary);
+
+#endif // FINANCIAL_TRACKER_H
\ No newline at end of file
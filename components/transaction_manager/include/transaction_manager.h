@@ -2,6 +2,7 @@
 #define TRANSACTION_MANAGER_H
 
 #include "system_types.h"
+#include "document_template.h"
 #include <time.h>
 
 // Types de transactions
@@ -15,6 +16,8 @@ typedef enum {
     TRANSACTION_TYPE_ESCAPE
 } transaction_type_t;
 
+#define TRANSACTION_TYPE_COUNT 7
+
 // Statut de transaction
 typedef enum {
     TRANSACTION_STATUS_PENDING,
@@ -34,6 +37,7 @@ typedef struct {
     time_t transaction_date;
     float amount;
     char currency[4];
+    uint32_t counterpart_id;  // Contact de l'annuaire (0 pour le retrouver à partir des coordonnées)
     char counterpart_name[128];
     char counterpart_address[256];
     char counterpart_phone[32];
@@ -45,8 +49,29 @@ typedef struct {
     char documents[512]; // Liste des documents associés
     time_t created_at;
     time_t updated_at;
+    uint32_t change_version;    // Version de la dernière modification (0 pour une transaction archivée)
 } transaction_t;
 
+/**
+ * @brief Fonction appelée pour chaque transaction d'un parcours
+ * @param transaction Transaction (valide pendant l'appel uniquement)
+ * @param context Contexte de l'appelant
+ * @return true pour continuer le parcours, false pour l'arrêter
+ */
+typedef bool (*transaction_visit_fn_t)(const transaction_t* transaction, void* context);
+
+// Contact de l'annuaire des contreparties (clients, éleveurs)
+typedef struct {
+    uint32_t id;
+    char name[128];
+    char address[256];
+    char phone[32];
+    char email[64];
+    uint32_t transaction_count;
+    time_t created_at;
+    time_t updated_at;
+} transaction_contact_t;
+
 // Structure pour les certificats
 typedef struct {
     uint32_t id;
@@ -75,6 +100,16 @@ typedef struct {
     time_t last_transaction_date;
 } financial_stats_t;
 
+// Résumé financier d'une période (transactions terminées uniquement)
+typedef struct {
+    uint16_t year;
+    uint8_t month;  // 1 à 12, 0 pour une année entière
+    uint32_t count_by_type[TRANSACTION_TYPE_COUNT];
+    float amount_by_type[TRANSACTION_TYPE_COUNT];
+    float average_by_type[TRANSACTION_TYPE_COUNT];
+    float net_profit;  // Ventes moins achats
+} financial_summary_t;
+
 /**
  * @brief Initialise le gestionnaire de transactions
  * @return SYSTEM_OK en cas de succès
@@ -111,7 +146,7 @@ system_error_t transaction_delete(uint32_t transaction_id);
 system_error_t transaction_get_by_id(uint32_t transaction_id, transaction_t* transaction);
 
 /**
- * @brief Récupère toutes les transactions
+ * @brief Récupère toutes les transactions en mémoire (hors archive), par ID croissant
  * @param transactions Tableau de transactions à remplir
  * @param max_count Nombre maximum de transactions
  * @param count Pointeur vers le nombre de transactions récupérées
@@ -120,7 +155,7 @@ system_error_t transaction_get_by_id(uint32_t transaction_id, transaction_t* tra
 system_error_t transaction_get_all(transaction_t* transactions, uint32_t max_count, uint32_t* count);
 
 /**
- * @brief Récupère les transactions d'un animal
+ * @brief Récupère les transactions d'un animal, triées par date
  * @param animal_id ID de l'animal
  * @param transactions Tableau de transactions à remplir
  * @param max_count Nombre maximum de transactions
@@ -130,6 +165,125 @@ system_error_t transaction_get_all(transaction_t* transactions, uint32_t max_cou
 system_error_t transaction_get_by_animal(uint32_t animal_id, transaction_t* transactions, 
                                         uint32_t max_count, uint32_t* count);
 
+/**
+ * @brief Récupère les transactions d'un contact, triées par date
+ * @param contact_id ID du contact
+ * @param transactions Tableau de transactions à remplir
+ * @param max_count Nombre maximum de transactions
+ * @param count Pointeur vers le nombre de transactions récupérées
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_get_by_contact(uint32_t contact_id, transaction_t* transactions,
+                                         uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Récupère un contact par son ID
+ * @param contact_id ID du contact
+ * @param contact Pointeur vers la structure contact à remplir
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_contact_get(uint32_t contact_id, transaction_contact_t* contact);
+
+/**
+ * @brief Recherche un contact par email ou par nom (sans tenir compte de la casse ni des espaces)
+ * @param name_or_email Email ou nom recherché
+ * @param contact Pointeur vers la structure contact à remplir
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si inconnu
+ */
+system_error_t transaction_contact_find(const char* name_or_email, transaction_contact_t* contact);
+
+/**
+ * @brief Récupère tous les contacts
+ * @param contacts Tableau de contacts à remplir
+ * @param max_count Nombre maximum de contacts
+ * @param count Pointeur vers le nombre de contacts récupérés
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_contact_get_all(transaction_contact_t* contacts, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Récupère les transactions d'un intervalle de dates, triées par date
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param offset Nombre de transactions de l'intervalle à ignorer (pagination)
+ * @param transactions Tableau de transactions à remplir
+ * @param max_count Nombre maximum de transactions
+ * @param count Pointeur vers le nombre de transactions récupérées
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_get_by_date_range(time_t start_date, time_t end_date, uint32_t offset,
+                                            transaction_t* transactions, uint32_t max_count, uint32_t* count);
+
+/**
+ * @brief Parcourt par date croissante les transactions d'un intervalle, archive comprise
+ *
+ * Les transactions sont copiées sous le verrou par lots de TRANSACTION_READ_BUFFER octets : la mémoire du
+ * parcours ne dépend pas du nombre de transactions, et visit est appelée hors du verrou (elle peut
+ * lire ou modifier les transactions, un parcours reflète alors chaque lot au moment de sa copie).
+ *
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param visit Fonction appelée pour chaque transaction
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si le lot n'a pas pu être alloué
+ */
+system_error_t transaction_for_each(time_t start_date, time_t end_date, transaction_visit_fn_t visit, void* context);
+
+/**
+ * @brief Restaure des transactions sauvegardées avec leurs IDs, journalisées par lots avec une attente de durabilité par lot
+ *
+ * Une transaction de même ID en mémoire est remplacée ; une transaction déjà archivée est conservée telle quelle.
+ * Comme une modification, chaque transaction attend la durabilité d'une modification en cours du même ID ;
+ * celles dont l'écriture au journal échoue reprennent leur état précédent.
+ *
+ * @param transactions Transactions à restaurer
+ * @param count Nombre de transactions
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY si la table est pleine (à archiver avant de reprendre)
+ */
+system_error_t transaction_restore(const transaction_t* transactions, uint32_t count);
+
+/**
+ * @brief Version de changement courante, avancée à chaque création, modification ou suppression
+ * @return Dernière version attribuée (0 au démarrage)
+ */
+uint32_t transaction_get_change_version(void);
+
+/**
+ * @brief Parcourt par ID croissant les transactions en mémoire modifiées après une version de changement
+ *
+ * Les modifications sont bloquées pendant le parcours : visit ne doit pas modifier de transaction.
+ *
+ * @param since_version Version de référence
+ * @param visit Fonction appelée pour chaque transaction
+ * @param context Contexte transmis à visit
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si des transactions modifiées depuis ont été archivées
+ */
+system_error_t transaction_for_each_changed(uint32_t since_version, transaction_visit_fn_t visit, void* context);
+
+/**
+ * @brief Copie les suppressions de transactions postérieures à une version de changement
+ * @param since_version Version de référence
+ * @param deletions Tableau à remplir (CHANGE_LOG_DELETIONS entrées suffisent)
+ * @param max_count Taille du tableau
+ * @param count Pointeur vers le nombre de suppressions copiées
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_NOT_FOUND si des suppressions postérieures ont été oubliées
+ *         ou si des transactions modifiées depuis ont été archivées
+ */
+system_error_t transaction_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                         uint32_t* count);
+
+/**
+ * @brief Déplace vers l'archive les transactions anciennes ou terminées depuis longtemps
+ *
+ * Les transactions archivées restent accessibles par ID, par animal, par contact et par date,
+ * et comptent toujours dans les résumés financiers.
+ *
+ * @param now Date de référence
+ * @param archived_count Pointeur vers le nombre de transactions archivées (peut être NULL)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_archive_old(time_t now, uint32_t* archived_count);
+
 /**
  * @brief Génère un certificat pour une transaction
  * @param transaction_id ID de la transaction
@@ -140,6 +294,14 @@ system_error_t transaction_get_by_animal(uint32_t animal_id, transaction_t* tran
 system_error_t transaction_generate_certificate(uint32_t transaction_id, const char* certificate_type, 
                                                certificate_t* certificate);
 
+/**
+ * @brief Produit le texte complet d'un certificat vers une destination (tampon, fichier, réponse HTTP)
+ * @param certificate Certificat généré par transaction_generate_certificate
+ * @param sink Destination du rendu
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_render_certificate(const certificate_t* certificate, const document_sink_t* sink);
+
 /**
  * @brief Valide une transaction selon les règles réglementaires
  * @param transaction Pointeur vers la structure transaction
@@ -158,6 +320,23 @@ system_error_t transaction_validate(const transaction_t* transaction, bool* is_v
  */
 system_error_t transaction_get_financial_stats(financial_stats_t* stats);
 
+/**
+ * @brief Récupère le résumé financier d'un mois
+ * @param year Année (ex: 2024)
+ * @param month Mois de 1 à 12
+ * @param summary Pointeur vers le résumé à remplir
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_get_monthly_summary(uint16_t year, uint8_t month, financial_summary_t* summary);
+
+/**
+ * @brief Récupère le résumé financier d'une année
+ * @param year Année (ex: 2024)
+ * @param summary Pointeur vers le résumé à remplir
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_get_yearly_summary(uint16_t year, financial_summary_t* summary);
+
 /**
  * @brief Exporte les transactions vers un fichier
  * @param filename Nom du fichier de destination
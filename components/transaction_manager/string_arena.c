@@ -0,0 +1,170 @@
+#include "string_arena.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+
+static const char* TAG = "STRING_ARENA";
+
+// En-tête d'une chaîne : longueur puis compteur de références, suivis des octets et du zéro final
+#define ENTRY_HEADER_SIZE 4
+#define ENTRY_MAX_REFS    UINT16_MAX
+
+static void* arena_alloc(size_t size)
+{
+    void* ptr = heap_caps_calloc(1, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL) {
+        ESP_LOGW(TAG, "PSRAM indisponible, allocation en RAM interne (%u octets)", (unsigned)size);
+        ptr = heap_caps_calloc(1, size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static uint16_t entry_length(const string_arena_t* arena, uint32_t offset)
+{
+    uint16_t length;
+    memcpy(&length, &arena->data[offset], sizeof(length));
+    return length;
+}
+
+static uint16_t entry_refs(const string_arena_t* arena, uint32_t offset)
+{
+    uint16_t refs;
+    memcpy(&refs, &arena->data[offset + 2], sizeof(refs));
+    return refs;
+}
+
+static void entry_set_refs(string_arena_t* arena, uint32_t offset, uint16_t refs)
+{
+    memcpy(&arena->data[offset + 2], &refs, sizeof(refs));
+}
+
+static uint32_t entry_size(uint16_t length)
+{
+    // Alignement sur 2 octets pour garder les en-têtes alignés
+    return (ENTRY_HEADER_SIZE + length + 1 + 1) & ~1u;
+}
+
+// FNV-1a
+static uint32_t hash_string(const char* str, size_t length)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+system_error_t string_arena_init(string_arena_t* arena, uint32_t capacity, uint32_t slot_count)
+{
+    if (arena == NULL || capacity <= ENTRY_HEADER_SIZE || slot_count == 0 || (slot_count & (slot_count - 1)) != 0) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    memset(arena, 0, sizeof(string_arena_t));
+    arena->data = arena_alloc(capacity);
+    arena->slots = arena_alloc(slot_count * sizeof(uint32_t));
+    if (arena->data == NULL || arena->slots == NULL) {
+        string_arena_deinit(arena);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    arena->capacity = capacity;
+    arena->slot_count = slot_count;
+    // L'offset 0 est réservé à la chaîne vide
+    arena->used = ENTRY_HEADER_SIZE;
+    
+    return SYSTEM_OK;
+}
+
+void string_arena_deinit(string_arena_t* arena)
+{
+    if (arena == NULL) {
+        return;
+    }
+    
+    heap_caps_free(arena->data);
+    heap_caps_free(arena->slots);
+    memset(arena, 0, sizeof(string_arena_t));
+}
+
+uint32_t string_arena_intern(string_arena_t* arena, const char* str, size_t max_len)
+{
+    if (str == NULL) {
+        return 0;
+    }
+    
+    size_t length = strnlen(str, max_len);
+    if (length == 0) {
+        return 0;
+    }
+    if (length > UINT16_MAX - 2) {
+        length = UINT16_MAX - 2;
+    }
+    
+    uint32_t mask = arena->slot_count - 1;
+    uint32_t slot = hash_string(str, length) & mask;
+    
+    // Recherche d'une copie existante, y compris sans référence
+    while (arena->slots[slot] != 0) {
+        uint32_t offset = arena->slots[slot];
+        if (entry_length(arena, offset) == length &&
+            memcmp(&arena->data[offset + ENTRY_HEADER_SIZE], str, length) == 0) {
+            uint16_t refs = entry_refs(arena, offset);
+            if (refs == ENTRY_MAX_REFS) {
+                return STRING_ARENA_FULL;
+            }
+            if (refs == 0) {
+                arena->dead_bytes -= entry_size((uint16_t)length);
+            }
+            entry_set_refs(arena, offset, refs + 1);
+            return offset;
+        }
+        slot = (slot + 1) & mask;
+    }
+    
+    uint32_t size = entry_size((uint16_t)length);
+    if (arena->used + size > arena->capacity || (arena->slots_used + 1) * 4 > arena->slot_count * 3) {
+        return STRING_ARENA_FULL;
+    }
+    
+    uint32_t offset = arena->used;
+    uint16_t length16 = (uint16_t)length;
+    memcpy(&arena->data[offset], &length16, sizeof(length16));
+    entry_set_refs(arena, offset, 1);
+    memcpy(&arena->data[offset + ENTRY_HEADER_SIZE], str, length);
+    arena->data[offset + ENTRY_HEADER_SIZE + length] = '\0';
+    
+    arena->used += size;
+    arena->slots[slot] = offset;
+    arena->slots_used++;
+    
+    return offset;
+}
+
+void string_arena_release(string_arena_t* arena, uint32_t offset)
+{
+    if (offset == 0 || offset >= arena->used) {
+        return;
+    }
+    
+    uint16_t refs = entry_refs(arena, offset);
+    if (refs == 0) {
+        return;
+    }
+    
+    // Une chaîne sans référence reste indexée : elle est réutilisée ou éliminée au compactage
+    entry_set_refs(arena, offset, refs - 1);
+    if (refs == 1) {
+        arena->dead_bytes += entry_size(entry_length(arena, offset));
+    }
+}
+
+const char* string_arena_get(const string_arena_t* arena, uint32_t offset)
+{
+    if (offset == 0 || offset >= arena->used) {
+        return "";
+    }
+    
+    return (const char*)&arena->data[offset + ENTRY_HEADER_SIZE];
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef STRING_ARENA_H
+#define STRING_ARENA_H
+
+#include "system_types.h"
+#include <stddef.h>
+
+// Offset renvoyé lorsque l'arène ou sa table de hachage est pleine
+#define STRING_ARENA_FULL UINT32_MAX
+
+// Arène de chaînes préfixées par leur longueur, dédupliquées et comptées par référence.
+// L'offset 0 désigne la chaîne vide et n'occupe aucune place.
+typedef struct {
+    uint8_t* data;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t dead_bytes;    // Octets occupés par des chaînes sans référence
+    uint32_t* slots;        // Table de hachage (adressage ouvert) des offsets
+    uint32_t slot_count;    // Puissance de 2
+    uint32_t slots_used;
+} string_arena_t;
+
+/**
+ * @brief Alloue une arène, en PSRAM si disponible
+ * @param arena Arène à initialiser
+ * @param capacity Taille des données en octets
+ * @param slot_count Taille de la table de déduplication (puissance de 2)
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_MEMORY sinon
+ */
+system_error_t string_arena_init(string_arena_t* arena, uint32_t capacity, uint32_t slot_count);
+
+/**
+ * @brief Libère la mémoire d'une arène
+ * @param arena Arène à libérer
+ */
+void string_arena_deinit(string_arena_t* arena);
+
+/**
+ * @brief Ajoute une référence vers une chaîne, en réutilisant une copie existante
+ * @param arena Arène cible
+ * @param str Chaîne à stocker (NULL ou vide pour l'offset 0)
+ * @param max_len Longueur maximale lue dans str
+ * @return Offset de la chaîne, STRING_ARENA_FULL si l'arène est pleine
+ */
+uint32_t string_arena_intern(string_arena_t* arena, const char* str, size_t max_len);
+
+/**
+ * @brief Retire une référence vers une chaîne
+ * @param arena Arène cible
+ * @param offset Offset renvoyé par string_arena_intern
+ */
+void string_arena_release(string_arena_t* arena, uint32_t offset);
+
+/**
+ * @brief Accède à une chaîne stockée
+ * @param arena Arène source
+ * @param offset Offset renvoyé par string_arena_intern
+ * @return Chaîne terminée par un zéro (valide jusqu'au prochain compactage)
+ */
+const char* string_arena_get(const string_arena_t* arena, uint32_t offset);
+
+#endif // STRING_ARENA_H
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include "transaction_index.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <string.h>
+#include <stdlib.h>
+
+static const char* TAG = "TRANSACTION_INDEX";
+
+// Index secondaire trié par (clé, date, ID)
+typedef struct {
+    transaction_key_entry_t* entries;
+    uint32_t count;
+} key_index_t;
+
+// Index alloués en PSRAM comme les en-têtes de transactions
+static transaction_date_entry_t* g_date_index = NULL;
+static uint32_t g_date_count = 0;
+static key_index_t g_animal_index;
+static key_index_t g_contact_index;
+
+static void* index_alloc(size_t entry_size)
+{
+    void* ptr = heap_caps_calloc(MAX_TRANSACTIONS, entry_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (ptr == NULL) {
+        ptr = heap_caps_calloc(MAX_TRANSACTIONS, entry_size, MALLOC_CAP_8BIT);
+    }
+    return ptr;
+}
+
+static int compare_entry(time_t date_a, uint32_t id_a, time_t date_b, uint32_t id_b)
+{
+    if (date_a != date_b) {
+        return (date_a < date_b) ? -1 : 1;
+    }
+    if (id_a != id_b) {
+        return (id_a < id_b) ? -1 : 1;
+    }
+    return 0;
+}
+
+static int compare_key_entry(const transaction_key_entry_t* a, const transaction_key_entry_t* b)
+{
+    if (a->key != b->key) {
+        return (a->key < b->key) ? -1 : 1;
+    }
+    return compare_entry(a->transaction_date, a->transaction_id, b->transaction_date, b->transaction_id);
+}
+
+static int qsort_date_entry(const void* a, const void* b)
+{
+    const transaction_date_entry_t* entry_a = a;
+    const transaction_date_entry_t* entry_b = b;
+    return compare_entry(entry_a->transaction_date, entry_a->transaction_id,
+                         entry_b->transaction_date, entry_b->transaction_id);
+}
+
+static int qsort_key_entry(const void* a, const void* b)
+{
+    return compare_key_entry(a, b);
+}
+
+// Première position dont l'entrée n'est pas strictement inférieure à (date, id)
+static uint32_t date_lower_bound(time_t date, uint32_t transaction_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_date_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (compare_entry(g_date_index[mid].transaction_date, g_date_index[mid].transaction_id,
+                          date, transaction_id) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+// Première position dont l'entrée n'est pas strictement inférieure à key
+static uint32_t key_lower_bound(const key_index_t* index, const transaction_key_entry_t* key)
+{
+    uint32_t low = 0;
+    uint32_t high = index->count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (compare_key_entry(&index->entries[mid], key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    return low;
+}
+
+static void key_insert(key_index_t* index, uint32_t key, time_t transaction_date, uint32_t transaction_id)
+{
+    transaction_key_entry_t entry = { key, transaction_date, transaction_id };
+    uint32_t pos = key_lower_bound(index, &entry);
+    
+    memmove(&index->entries[pos + 1], &index->entries[pos],
+            (index->count - pos) * sizeof(transaction_key_entry_t));
+    index->entries[pos] = entry;
+    index->count++;
+}
+
+static void key_remove(key_index_t* index, uint32_t key, time_t transaction_date, uint32_t transaction_id)
+{
+    transaction_key_entry_t entry = { key, transaction_date, transaction_id };
+    uint32_t pos = key_lower_bound(index, &entry);
+    
+    if (pos < index->count && compare_key_entry(&index->entries[pos], &entry) == 0) {
+        memmove(&index->entries[pos], &index->entries[pos + 1],
+                (index->count - pos - 1) * sizeof(transaction_key_entry_t));
+        index->count--;
+    }
+}
+
+static const transaction_key_entry_t* key_range(const key_index_t* index, uint32_t key, uint32_t* count)
+{
+    // Première entrée de la clé, quelle que soit sa date
+    uint32_t low = 0;
+    uint32_t high = index->count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (index->entries[mid].key < key) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    uint32_t first = low;
+    uint32_t last = first;
+    while (last < index->count && index->entries[last].key == key) {
+        last++;
+    }
+    
+    *count = last - first;
+    return &index->entries[first];
+}
+
+system_error_t transaction_index_init(void)
+{
+    g_date_index = index_alloc(sizeof(transaction_date_entry_t));
+    g_animal_index.entries = index_alloc(sizeof(transaction_key_entry_t));
+    g_contact_index.entries = index_alloc(sizeof(transaction_key_entry_t));
+    if (g_date_index == NULL || g_animal_index.entries == NULL || g_contact_index.entries == NULL) {
+        ESP_LOGE(TAG, "Impossible d'allouer les index de transactions");
+        heap_caps_free(g_date_index);
+        heap_caps_free(g_animal_index.entries);
+        heap_caps_free(g_contact_index.entries);
+        g_date_index = NULL;
+        g_animal_index.entries = NULL;
+        g_contact_index.entries = NULL;
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    transaction_index_reset();
+    ESP_LOGI(TAG, "Index des transactions initialisés");
+    
+    return SYSTEM_OK;
+}
+
+void transaction_index_insert(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id)
+{
+    if (g_date_count >= MAX_TRANSACTIONS) {
+        return;
+    }
+    
+    uint32_t pos = date_lower_bound(transaction_date, transaction_id);
+    memmove(&g_date_index[pos + 1], &g_date_index[pos],
+            (g_date_count - pos) * sizeof(transaction_date_entry_t));
+    g_date_index[pos].transaction_date = transaction_date;
+    g_date_index[pos].transaction_id = transaction_id;
+    g_date_count++;
+    
+    key_insert(&g_animal_index, animal_id, transaction_date, transaction_id);
+    key_insert(&g_contact_index, contact_id, transaction_date, transaction_id);
+}
+
+void transaction_index_remove(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id)
+{
+    uint32_t pos = date_lower_bound(transaction_date, transaction_id);
+    if (pos < g_date_count && g_date_index[pos].transaction_id == transaction_id &&
+        g_date_index[pos].transaction_date == transaction_date) {
+        memmove(&g_date_index[pos], &g_date_index[pos + 1],
+                (g_date_count - pos - 1) * sizeof(transaction_date_entry_t));
+        g_date_count--;
+    }
+    
+    key_remove(&g_animal_index, animal_id, transaction_date, transaction_id);
+    key_remove(&g_contact_index, contact_id, transaction_date, transaction_id);
+}
+
+void transaction_index_reset(void)
+{
+    g_date_count = 0;
+    g_animal_index.count = 0;
+    g_contact_index.count = 0;
+}
+
+void transaction_index_append(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id)
+{
+    if (g_date_count >= MAX_TRANSACTIONS) {
+        return;
+    }
+    
+    g_date_index[g_date_count].transaction_date = transaction_date;
+    g_date_index[g_date_count].transaction_id = transaction_id;
+    g_date_count++;
+    
+    transaction_key_entry_t animal_entry = { animal_id, transaction_date, transaction_id };
+    g_animal_index.entries[g_animal_index.count++] = animal_entry;
+    
+    transaction_key_entry_t contact_entry = { contact_id, transaction_date, transaction_id };
+    g_contact_index.entries[g_contact_index.count++] = contact_entry;
+}
+
+void transaction_index_finalize(void)
+{
+    qsort(g_date_index, g_date_count, sizeof(transaction_date_entry_t), qsort_date_entry);
+    qsort(g_animal_index.entries, g_animal_index.count, sizeof(transaction_key_entry_t), qsort_key_entry);
+    qsort(g_contact_index.entries, g_contact_index.count, sizeof(transaction_key_entry_t), qsort_key_entry);
+    
+    ESP_LOGI(TAG, "Index des transactions reconstruits: %u entrées", (unsigned)g_date_count);
+}
+
+const transaction_date_entry_t* transaction_index_range(time_t start_date, time_t end_date, uint32_t* count)
+{
+    uint32_t first = (start_date != 0) ? date_lower_bound(start_date, 0) : 0;
+    uint32_t last = (end_date != 0) ? date_lower_bound(end_date, UINT32_MAX) : g_date_count;
+    
+    // Inclure une éventuelle entrée (end_date, UINT32_MAX)
+    if (end_date != 0 && last < g_date_count && g_date_index[last].transaction_date == end_date) {
+        last++;
+    }
+    
+    *count = (last > first) ? last - first : 0;
+    return &g_date_index[first];
+}
+
+const transaction_key_entry_t* transaction_index_animal_range(uint32_t animal_id, uint32_t* count)
+{
+    return key_range(&g_animal_index, animal_id, count);
+}
+
+const transaction_key_entry_t* transaction_index_contact_range(uint32_t contact_id, uint32_t* count)
+{
+    return key_range(&g_contact_index, contact_id, count);
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef TRANSACTION_INDEX_H
+#define TRANSACTION_INDEX_H
+
+#include "transaction_manager.h"
+
+// Entrée de l'index des dates de transaction (trié par date puis par ID)
+typedef struct {
+    time_t transaction_date;
+    uint32_t transaction_id;
+} transaction_date_entry_t;
+
+// Entrée des index par animal et par contact (triés par clé, date puis ID)
+typedef struct {
+    uint32_t key;
+    time_t transaction_date;
+    uint32_t transaction_id;
+} transaction_key_entry_t;
+
+/**
+ * @brief Alloue les index des transactions (par date, par animal et par contact)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_index_init(void);
+
+/**
+ * @brief Ajoute une transaction aux index
+ * @param transaction_date Date de la transaction
+ * @param animal_id ID de l'animal concerné
+ * @param contact_id ID du contact (0 si aucun)
+ * @param transaction_id ID de la transaction
+ */
+void transaction_index_insert(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id);
+
+/**
+ * @brief Retire une transaction des index
+ * @param transaction_date Date de la transaction
+ * @param animal_id ID de l'animal concerné
+ * @param contact_id ID du contact (0 si aucun)
+ * @param transaction_id ID de la transaction
+ */
+void transaction_index_remove(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id);
+
+/**
+ * @brief Vide les index avant une reconstruction
+ */
+void transaction_index_reset(void);
+
+/**
+ * @brief Ajoute une transaction sans maintenir l'ordre (reconstruction au chargement)
+ * @param transaction_date Date de la transaction
+ * @param animal_id ID de l'animal concerné
+ * @param contact_id ID du contact (0 si aucun)
+ * @param transaction_id ID de la transaction
+ */
+void transaction_index_append(time_t transaction_date, uint32_t animal_id, uint32_t contact_id,
+                              uint32_t transaction_id);
+
+/**
+ * @brief Trie les index après une série de transaction_index_append
+ */
+void transaction_index_finalize(void);
+
+/**
+ * @brief Récupère les entrées comprises dans un intervalle de dates
+ * @param start_date Date de début incluse (0 pour aucune borne)
+ * @param end_date Date de fin incluse (0 pour aucune borne)
+ * @param count Pointeur vers le nombre d'entrées concernées
+ * @return Première entrée de l'intervalle (valide jusqu'à la prochaine modification)
+ */
+const transaction_date_entry_t* transaction_index_range(time_t start_date, time_t end_date, uint32_t* count);
+
+/**
+ * @brief Récupère l'historique d'un animal, trié par date
+ * @param animal_id ID de l'animal
+ * @param count Pointeur vers le nombre d'entrées concernées
+ * @return Première entrée de l'animal (valide jusqu'à la prochaine modification)
+ */
+const transaction_key_entry_t* transaction_index_animal_range(uint32_t animal_id, uint32_t* count);
+
+/**
+ * @brief Récupère l'historique d'un contact, trié par date
+ * @param contact_id ID du contact
+ * @param count Pointeur vers le nombre d'entrées concernées
+ * @return Première entrée du contact (valide jusqu'à la prochaine modification)
+ */
+const transaction_key_entry_t* transaction_index_contact_range(uint32_t contact_id, uint32_t* count);
+
+#endif // TRANSACTION_INDEX_H
\ No newline at end of file
@@ -0,0 +1,482 @@
+#include "transaction_journal.h"
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+static const char* TAG = "TRANSACTION_JOURNAL";
+
+#define JOURNAL_MAGIC 0x4C4E524Au  // "JRNL"
+
+// En-tête d'un enregistrement, suivi de la charge utile puis du CRC32 de l'ensemble
+typedef struct {
+    uint32_t magic;
+    uint8_t op;
+    uint8_t reserved;
+    uint16_t length;
+    uint32_t sequence;
+} journal_frame_header_t;
+
+// Tâche en attente de la durabilité d'un enregistrement
+typedef struct {
+    TaskHandle_t task;
+    uint32_t sequence;
+} journal_waiter_t;
+
+// Variables globales
+static char g_path[64];
+static FILE* g_file = NULL;
+static FILE* g_checkpoint_file = NULL;
+static long g_file_size = 0;
+static long g_checkpoint_size = 0;  // Taille du journal après le dernier point de reprise
+static bool g_tmp_active = false;   // Point de reprise non renommé : le .tmp reste le journal courant
+static SemaphoreHandle_t g_mutex = NULL;
+static SemaphoreHandle_t g_commit_signal = NULL;
+static TaskHandle_t g_commit_task = NULL;
+
+// Enregistrements en attente d'écriture groupée
+static uint8_t g_buffer[JOURNAL_BUFFER_SIZE];
+static size_t g_buffer_length = 0;
+static uint32_t g_buffer_first_sequence = 0;
+static uint32_t g_next_sequence = 1;
+static uint32_t g_durable_sequence = 0;  // Dernier enregistrement synchronisé
+static uint32_t g_failed_first = 0;      // Premier et dernier enregistrements du dernier lot perdu
+static uint32_t g_failed_sequence = 0;
+
+static journal_waiter_t g_waiters[JOURNAL_MAX_WAITERS];
+static uint32_t g_waiters_count = 0;
+
+static size_t frame_size(size_t length)
+{
+    return sizeof(journal_frame_header_t) + length + sizeof(uint32_t);
+}
+
+static size_t encode_frame(uint8_t* dst, journal_op_t op, const uint8_t* payload, size_t length, uint32_t sequence)
+{
+    journal_frame_header_t header = {
+        .magic = JOURNAL_MAGIC,
+        .op = (uint8_t)op,
+        .reserved = 0,
+        .length = (uint16_t)length,
+        .sequence = sequence
+    };
+    
+    memcpy(dst, &header, sizeof(header));
+    memcpy(dst + sizeof(header), payload, length);
+    uint32_t crc = esp_rom_crc32_le(0, dst, sizeof(header) + length);
+    memcpy(dst + sizeof(header) + length, &crc, sizeof(crc));
+    
+    return frame_size(length);
+}
+
+static system_error_t sync_file(FILE* file)
+{
+    if (fflush(file) != 0 || fsync(fileno(file)) != 0) {
+        return SYSTEM_ERROR_STORAGE;
+    }
+    return SYSTEM_OK;
+}
+
+static void get_tmp_path(char* path, size_t size)
+{
+    snprintf(path, size, "%s.tmp", g_path);
+}
+
+// Ouvre le journal courant en ajout, sans tampon stdio : après un échec, rien ne reste en attente
+// au-delà de la fin tronquée
+static bool open_current(void)
+{
+    char tmp_path[sizeof(g_path) + 4];
+    get_tmp_path(tmp_path, sizeof(tmp_path));
+    
+    g_file = fopen(g_tmp_active ? tmp_path : g_path, "ab");
+    if (g_file == NULL) {
+        return false;
+    }
+    setvbuf(g_file, NULL, _IONBF, 0);
+    return true;
+}
+
+// Installe le .tmp synchronisé à la place du journal. Le renommage remplace l'ancien journal d'un
+// seul coup quand le système de fichiers le permet ; sinon (FAT) l'ancien n'est supprimé qu'ici.
+// Le journal n'est jamais recréé vide : tant que le renommage échoue, le .tmp reste le journal
+// courant (g_tmp_active), retenu à la relecture puisque l'ancien a disparu.
+static bool promote_tmp(void)
+{
+    char tmp_path[sizeof(g_path) + 4];
+    get_tmp_path(tmp_path, sizeof(tmp_path));
+    
+    if (rename(tmp_path, g_path) != 0 && (remove(g_path) != 0 || rename(tmp_path, g_path) != 0)) {
+        g_tmp_active = (access(g_path, F_OK) != 0);
+        if (!g_tmp_active) {
+            // Ancien journal intact : il reste le journal courant
+            remove(tmp_path);
+        }
+        ESP_LOGE(TAG, "Impossible de renommer %s", tmp_path);
+        return false;
+    }
+    
+    g_tmp_active = false;
+    return true;
+}
+
+// Écrit le tampon en une seule fois puis synchronise : à appeler avec le mutex pris
+static void flush_locked(void)
+{
+    if (g_buffer_length == 0) {
+        return;
+    }
+    
+    uint32_t last_sequence = g_next_sequence - 1;
+    bool ok = (g_file != NULL) && fwrite(g_buffer, 1, g_buffer_length, g_file) == g_buffer_length &&
+              sync_file(g_file) == SYSTEM_OK;
+    
+    if (ok) {
+        g_file_size += (long)g_buffer_length;
+        g_durable_sequence = last_sequence;
+    } else {
+        ESP_LOGE(TAG, "Échec d'écriture du journal (séquences %" PRIu32 " à %" PRIu32 ")",
+                 g_buffer_first_sequence, last_sequence);
+        g_failed_first = g_buffer_first_sequence;
+        g_failed_sequence = last_sequence;
+        // Retirer l'écriture partielle : un enregistrement ajouté après elle serait perdu à la relecture
+        if (g_file != NULL) {
+            clearerr(g_file);
+            if (ftruncate(fileno(g_file), g_file_size) != 0 || fseek(g_file, 0, SEEK_END) != 0) {
+                ESP_LOGE(TAG, "Impossible de tronquer le journal, écritures suspendues");
+                fclose(g_file);
+                g_file = NULL;
+            }
+        }
+    }
+    
+    g_buffer_length = 0;
+}
+
+static void notify_waiters_locked(void)
+{
+    uint32_t kept = 0;
+    
+    for (uint32_t i = 0; i < g_waiters_count; i++) {
+        if (g_waiters[i].sequence <= g_durable_sequence || g_waiters[i].sequence <= g_failed_sequence) {
+            xTaskNotifyGive(g_waiters[i].task);
+        } else {
+            g_waiters[kept++] = g_waiters[i];
+        }
+    }
+    
+    g_waiters_count = kept;
+}
+
+static void commit_task(void* pvParameters)
+{
+    while (1) {
+        xSemaphoreTake(g_commit_signal, portMAX_DELAY);
+        
+        // Laisser les écritures concurrentes rejoindre le même lot
+        vTaskDelay(pdMS_TO_TICKS(JOURNAL_GROUP_COMMIT_MS));
+        
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+        flush_locked();
+        notify_waiters_locked();
+        xSemaphoreGive(g_mutex);
+    }
+}
+
+// Relit les enregistrements valides et renvoie la position de la fin cohérente
+static long replay_file(FILE* file, journal_replay_fn_t replay, uint32_t* records)
+{
+    static uint8_t frame[sizeof(journal_frame_header_t) + JOURNAL_MAX_PAYLOAD + sizeof(uint32_t)];
+    long valid_end = 0;
+    
+    while (1) {
+        journal_frame_header_t header;
+        if (fread(&header, 1, sizeof(header), file) != sizeof(header)) {
+            break;
+        }
+        if (header.magic != JOURNAL_MAGIC || header.length > JOURNAL_MAX_PAYLOAD) {
+            break;
+        }
+        
+        size_t rest = header.length + sizeof(uint32_t);
+        memcpy(frame, &header, sizeof(header));
+        if (fread(frame + sizeof(header), 1, rest, file) != rest) {
+            break;
+        }
+        
+        uint32_t crc;
+        memcpy(&crc, frame + sizeof(header) + header.length, sizeof(crc));
+        if (crc != esp_rom_crc32_le(0, frame, sizeof(header) + header.length)) {
+            break;
+        }
+        
+        if (replay != NULL) {
+            replay((journal_op_t)header.op, frame + sizeof(header), header.length);
+        }
+        if (header.sequence >= g_next_sequence) {
+            g_next_sequence = header.sequence + 1;
+        }
+        (*records)++;
+        valid_end = ftell(file);
+    }
+    
+    return valid_end;
+}
+
+system_error_t transaction_journal_init(const char* path, journal_replay_fn_t replay)
+{
+    if (path == NULL || strlen(path) >= sizeof(g_path)) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    // Réouverture : le journal courant est fermé avant la relecture
+    if (g_file != NULL) {
+        fclose(g_file);
+        g_file = NULL;
+    }
+    
+    strncpy(g_path, path, sizeof(g_path) - 1);
+    g_buffer_length = 0;
+    g_next_sequence = 1;
+    g_waiters_count = 0;
+    
+    if (g_mutex == NULL) {
+        g_mutex = xSemaphoreCreateMutex();
+        g_commit_signal = xSemaphoreCreateBinary();
+        if (g_mutex == NULL || g_commit_signal == NULL) {
+            return SYSTEM_ERROR_MEMORY;
+        }
+    }
+    
+    // Coupure ou échec de renommage pendant un compactage : le nouveau journal, synchronisé avant
+    // la suppression de l'ancien, n'est retenu que si l'ancien a déjà disparu ; sinon il peut être
+    // incomplet et l'ancien fait foi
+    char tmp_path[sizeof(g_path) + 4];
+    get_tmp_path(tmp_path, sizeof(tmp_path));
+    g_tmp_active = false;
+    if (access(tmp_path, F_OK) == 0) {
+        if (access(g_path, F_OK) != 0) {
+            promote_tmp();
+        } else {
+            remove(tmp_path);
+        }
+    }
+    const char* current_path = g_tmp_active ? tmp_path : g_path;
+    
+    uint32_t records = 0;
+    long valid_end = 0;
+    
+    FILE* file = fopen(current_path, "rb");
+    if (file != NULL) {
+        valid_end = replay_file(file, replay, &records);
+        fseek(file, 0, SEEK_END);
+        long file_end = ftell(file);
+        fclose(file);
+        
+        // Coupure pendant une écriture : supprimer la fin incomplète
+        if (file_end > valid_end) {
+            ESP_LOGW(TAG, "Fin de journal incomplète ignorée (%ld octets)", file_end - valid_end);
+            if (truncate(current_path, valid_end) != 0) {
+                ESP_LOGE(TAG, "Impossible de tronquer le journal");
+                return SYSTEM_ERROR_STORAGE;
+            }
+        }
+    }
+    
+    if (!open_current()) {
+        ESP_LOGE(TAG, "Impossible d'ouvrir le journal %s", current_path);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    g_file_size = valid_end;
+    g_durable_sequence = g_next_sequence - 1;
+    g_failed_first = 0;
+    g_failed_sequence = 0;
+    
+    ESP_LOGI(TAG, "Journal relu: %" PRIu32 " enregistrements, %ld octets", records, valid_end);
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_journal_start(void)
+{
+    if (g_file == NULL) {
+        return SYSTEM_ERROR;
+    }
+    
+    if (g_commit_task != NULL) {
+        return SYSTEM_OK;
+    }
+    
+    BaseType_t ret = xTaskCreate(
+        commit_task,
+        "txn_journal",
+        3072,
+        NULL,
+        6,
+        &g_commit_task
+    );
+    
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Échec création tâche journal");
+        g_commit_task = NULL;
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    ESP_LOGI(TAG, "Validation groupée du journal démarrée");
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_journal_append(journal_op_t op, const uint8_t* payload, size_t length,
+                                          uint32_t* sequence)
+{
+    if (g_file == NULL || payload == NULL || length > JOURNAL_MAX_PAYLOAD || sequence == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    // Tampon plein : écrire le lot courant immédiatement
+    if (g_buffer_length + frame_size(length) > sizeof(g_buffer)) {
+        flush_locked();
+        notify_waiters_locked();
+    }
+    
+    *sequence = g_next_sequence++;
+    if (g_buffer_length == 0) {
+        g_buffer_first_sequence = *sequence;
+    }
+    g_buffer_length += encode_frame(&g_buffer[g_buffer_length], op, payload, length, *sequence);
+    
+    if (g_commit_task == NULL) {
+        // Sans tâche de validation : écriture synchrone
+        flush_locked();
+    } else {
+        xSemaphoreGive(g_commit_signal);
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_journal_wait(uint32_t sequence)
+{
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    while (sequence > g_durable_sequence && sequence > g_failed_sequence) {
+        if (g_waiters_count >= JOURNAL_MAX_WAITERS) {
+            // Trop d'attentes simultanées : écrire le lot sans attendre la tâche
+            flush_locked();
+            notify_waiters_locked();
+            continue;
+        }
+        
+        g_waiters[g_waiters_count].task = xTaskGetCurrentTaskHandle();
+        g_waiters[g_waiters_count].sequence = sequence;
+        g_waiters_count++;
+        
+        xSemaphoreGive(g_mutex);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+    }
+    
+    bool failed = (sequence >= g_failed_first && sequence <= g_failed_sequence);
+    bool durable = (sequence <= g_durable_sequence) && !failed;
+    xSemaphoreGive(g_mutex);
+    
+    return durable ? SYSTEM_OK : SYSTEM_ERROR_STORAGE;
+}
+
+bool transaction_journal_needs_checkpoint(void)
+{
+    // Le seuil suit la taille des données vivantes pour ne pas recompacter à chaque écriture
+    return g_file != NULL && g_file_size > JOURNAL_CHECKPOINT_SIZE && g_file_size > 2 * g_checkpoint_size;
+}
+
+system_error_t transaction_journal_checkpoint_begin(void)
+{
+    if (g_file == NULL) {
+        return SYSTEM_ERROR;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    flush_locked();
+    notify_waiters_locked();
+    
+    // Le .tmp est encore le journal courant : nouvel essai de renommage avant de le réécrire
+    if (g_tmp_active) {
+        fclose(g_file);
+        bool promoted = promote_tmp();
+        if (!open_current() || !promoted) {
+            xSemaphoreGive(g_mutex);
+            return SYSTEM_ERROR_STORAGE;
+        }
+    }
+    
+    char tmp_path[sizeof(g_path) + 4];
+    get_tmp_path(tmp_path, sizeof(tmp_path));
+    g_checkpoint_file = fopen(tmp_path, "wb");
+    if (g_checkpoint_file == NULL) {
+        ESP_LOGE(TAG, "Impossible de créer %s", tmp_path);
+        xSemaphoreGive(g_mutex);
+        return SYSTEM_ERROR_STORAGE;
+    }
+    
+    // Le mutex reste pris jusqu'à transaction_journal_checkpoint_end
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_journal_checkpoint_write(journal_op_t op, const uint8_t* payload, size_t length)
+{
+    static uint8_t frame[sizeof(journal_frame_header_t) + JOURNAL_MAX_PAYLOAD + sizeof(uint32_t)];
+    
+    if (g_checkpoint_file == NULL || length > JOURNAL_MAX_PAYLOAD) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    size_t size = encode_frame(frame, op, payload, length, g_next_sequence++);
+    return (fwrite(frame, 1, size, g_checkpoint_file) == size) ? SYSTEM_OK : SYSTEM_ERROR_STORAGE;
+}
+
+system_error_t transaction_journal_checkpoint_end(bool commit)
+{
+    if (g_checkpoint_file == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    char tmp_path[sizeof(g_path) + 4];
+    get_tmp_path(tmp_path, sizeof(tmp_path));
+    
+    system_error_t ret = commit ? sync_file(g_checkpoint_file) : SYSTEM_ERROR;
+    long new_size = ftell(g_checkpoint_file);
+    fclose(g_checkpoint_file);
+    g_checkpoint_file = NULL;
+    
+    if (ret == SYSTEM_OK) {
+        fclose(g_file);
+        if (!promote_tmp()) {
+            ret = SYSTEM_ERROR_STORAGE;
+        }
+        // Journal courant : le nouveau, même resté en .tmp, sauf si l'ancien est intact
+        bool compacted = (ret == SYSTEM_OK || g_tmp_active);
+        if (!open_current()) {
+            ESP_LOGE(TAG, "Impossible de rouvrir le journal, écritures suspendues");
+            ret = SYSTEM_ERROR_STORAGE;
+        } else if (compacted) {
+            ESP_LOGI(TAG, "Journal compacté: %ld -> %ld octets", g_file_size, new_size);
+            g_file_size = new_size;
+            g_checkpoint_size = new_size;
+        }
+    } else {
+        remove(tmp_path);
+    }
+    
+    g_durable_sequence = g_next_sequence - 1;
+    xSemaphoreGive(g_mutex);
+    
+    return ret;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#ifndef TRANSACTION_JOURNAL_H
+#define TRANSACTION_JOURNAL_H
+
+#include "system_types.h"
+#include <stddef.h>
+
+// Opérations enregistrées dans le journal
+typedef enum {
+    JOURNAL_OP_PUT = 1,     // Image complète d'une transaction (création ou mise à jour)
+    JOURNAL_OP_DELETE = 2,  // Suppression d'une transaction
+    JOURNAL_OP_CONTACT = 3  // Image d'un contact (points de reprise)
+} journal_op_t;
+
+// Taille maximale de la charge utile d'un enregistrement
+#define JOURNAL_MAX_PAYLOAD 4096
+
+/**
+ * @brief Fonction appelée pour chaque enregistrement valide lors de la relecture
+ * @param op Opération
+ * @param payload Charge utile
+ * @param length Taille de la charge utile
+ */
+typedef void (*journal_replay_fn_t)(journal_op_t op, const uint8_t* payload, size_t length);
+
+/**
+ * @brief Relit le journal, tronque une éventuelle fin incomplète puis l'ouvre en ajout
+ * @param path Chemin du fichier journal
+ * @param replay Fonction appliquant chaque enregistrement valide
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE si le journal est inaccessible
+ */
+system_error_t transaction_journal_init(const char* path, journal_replay_fn_t replay);
+
+/**
+ * @brief Démarre la tâche de validation groupée (sans elle, chaque ajout est écrit immédiatement)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_journal_start(void);
+
+/**
+ * @brief Ajoute un enregistrement au tampon du journal
+ * @param op Opération
+ * @param payload Charge utile
+ * @param length Taille de la charge utile
+ * @param sequence Pointeur vers le numéro de séquence attribué
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_journal_append(journal_op_t op, const uint8_t* payload, size_t length,
+                                          uint32_t* sequence);
+
+/**
+ * @brief Attend que l'enregistrement soit écrit et synchronisé sur la flash
+ * @param sequence Numéro de séquence renvoyé par transaction_journal_append
+ * @return SYSTEM_OK une fois durable, SYSTEM_ERROR_STORAGE si l'écriture a échoué
+ */
+system_error_t transaction_journal_wait(uint32_t sequence);
+
+/**
+ * @brief Indique si le journal a dépassé la taille de compactage
+ * @return true si un point de reprise est conseillé
+ */
+bool transaction_journal_needs_checkpoint(void);
+
+/**
+ * @brief Commence la réécriture du journal (les ajouts sont bloqués jusqu'à la fin)
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_journal_checkpoint_begin(void);
+
+/**
+ * @brief Écrit un enregistrement dans le nouveau journal
+ * @param op Opération (image de transaction ou de contact)
+ * @param payload Charge utile
+ * @param length Taille de la charge utile
+ * @return SYSTEM_OK en cas de succès
+ */
+system_error_t transaction_journal_checkpoint_write(journal_op_t op, const uint8_t* payload, size_t length);
+
+/**
+ * @brief Termine la réécriture et remplace l'ancien journal par le nouveau
+ *
+ * L'ancien journal n'est supprimé qu'une fois le nouveau synchronisé. Si le renommage échoue
+ * ensuite, le nouveau journal reste le journal courant sous son nom temporaire : il est renommé
+ * au prochain point de reprise ou à la prochaine relecture.
+ *
+ * @param commit false pour abandonner le nouveau journal
+ * @return SYSTEM_OK en cas de succès, SYSTEM_ERROR_STORAGE si le renommage a échoué
+ */
+system_error_t transaction_journal_checkpoint_end(bool commit);
+
+#endif // TRANSACTION_JOURNAL_H
\ No newline at end of file
@@ -1,117 +1,1627 @@
 #include "transaction_manager.h"
+#include "string_arena.h"
+#include "transaction_index.h"
+#include "financial_tracker.h"
+#include "certificate_generator.h"
+#include "contact_directory.h"
+#include "transaction_journal.h"
+#include "archive_store.h"
+#include "regulatory_compliance.h"
+#include "breeding_register.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include <string.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <inttypes.h>
 
 static const char* TAG = "TRANSACTION_MANAGER";
 
+// Champs texte de transaction_t stockés dans l'arène (les coordonnées de la contrepartie sont dans l'annuaire)
+#define STRING_FIELD(field) { offsetof(transaction_t, field), sizeof(((transaction_t*)0)->field) }
+
+static const struct {
+    size_t offset;
+    size_t size;
+} k_string_fields[] = {
+    STRING_FIELD(animal_name),
+    STRING_FIELD(animal_species),
+    STRING_FIELD(cites_permit_number),
+    STRING_FIELD(certificate_number),
+    STRING_FIELD(notes),
+    STRING_FIELD(documents)
+};
+
+#define STRING_FIELD_COUNT (sizeof(k_string_fields) / sizeof(k_string_fields[0]))
+#define STRING_FIELD_ANIMAL_NAME  0  // Indices dans k_string_fields
+#define STRING_FIELD_SPECIES      1
+#define STRING_FIELD_CITES_PERMIT 2
+
+// En-tête compact d'une transaction : les textes sont des offsets dans l'arène
+typedef struct {
+    uint32_t id;
+    uint32_t animal_id;
+    uint32_t contact_id;
+    time_t transaction_date;
+    time_t created_at;
+    time_t updated_at;
+    float amount;
+    uint8_t type;
+    uint8_t status;
+    bool cites_required;
+    char currency[4];
+    uint32_t strings[STRING_FIELD_COUNT];
+    uint32_t change_version;
+} transaction_record_t;
+
+// Modification appliquée en mémoire en attente de sa durabilité, annulée si le journal échoue
+typedef struct {
+    uint32_t transaction_id;
+    uint8_t* payload;   // Image précédente dans le format du journal (NULL : la transaction n'existait pas)
+    size_t length;
+    uint32_t contact_id;    // Contact de l'image précédente, retenu jusqu'à la fin de la modification
+    bool registered;    // Inscrite parmi les modifications en attente
+    bool applied;       // Appliquée en mémoire
+} transaction_undo_t;
+
 // Variables globales
 static bool g_initialized = false;
-static transaction_t g_transactions[MAX_TRANSACTIONS];
+static transaction_record_t* g_transactions = NULL;  // En PSRAM, trié par ID croissant
 static uint32_t g_transactions_count = 0;
 static uint32_t g_next_id = 1;
+static uint32_t g_next_certificate_id = 1;
+static string_arena_t g_strings;
+static SemaphoreHandle_t g_mutex = NULL;  // Sérialise les modifications et leur ordre dans le journal
+static bool g_journal_enabled = false;
+static uint8_t g_journal_payload[JOURNAL_MAX_PAYLOAD];
+static transaction_t g_replay_transaction;
+static transaction_contact_t g_replay_contact;
+static archive_store_t g_archive;  // Transactions anciennes ou terminées, hors de la table en mémoire
+static bool g_archive_enabled = false;
+static transaction_t g_archive_transaction;
+static transaction_t g_restore_transaction;  // Sous g_mutex
+
+// Versions de changement et dernières suppressions (sous g_mutex), pour les sauvegardes incrémentales
+static uint32_t g_change_version = 0;
+static record_deletion_t g_deletions[CHANGE_LOG_DELETIONS];
+static uint32_t g_deletions_count = 0;
+static uint32_t g_forgotten_version = 0;    // Suppressions oubliées jusqu'à cette version incluse
+static uint32_t g_archived_version = 0;     // Plus haute version des transactions archivées
+
+// Transactions dont une modification attend le journal (sous g_mutex) : une seule à la fois par
+// transaction, pour que l'image conservée pour l'annulation soit toujours l'état durable
+static uint32_t g_pending_ids[JOURNAL_MAX_WAITERS];
+static uint32_t g_pending_count = 0;
+
+// Les transactions sont rangées par ID croissant (ajout en fin, suppression par décalage)
+static int32_t find_transaction_index(uint32_t transaction_id)
+{
+    uint32_t low = 0;
+    uint32_t high = g_transactions_count;
+    
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (g_transactions[mid].id < transaction_id) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    
+    if (low < g_transactions_count && g_transactions[low].id == transaction_id) {
+        return (int32_t)low;
+    }
+    
+    return -1;
+}
+
+static void track_record(const transaction_record_t* record, int32_t sign)
+{
+    financial_tracker_apply((transaction_type_t)record->type, (transaction_status_t)record->status,
+                            record->transaction_date, record->amount, sign);
+}
+
+// Transmet au suivi de conformité les éléments réglementaires d'une transaction
+static void report_compliance(const transaction_record_t* record)
+{
+    compliance_transaction_info_t info = {
+        .transaction_id = record->id,
+        .animal_id = record->animal_id,
+        .type = (uint8_t)record->type,
+        .status = (uint8_t)record->status,
+        .cites_required = record->cites_required,
+        .has_permit_number = (string_arena_get(&g_strings, record->strings[STRING_FIELD_CITES_PERMIT])[0] != '\0')
+    };
+    snprintf(info.species_name, sizeof(info.species_name), "%s",
+             string_arena_get(&g_strings, record->strings[STRING_FIELD_SPECIES]));
+    regulatory_transaction_changed(&info);
+}
+
+// Contact que des transactions archivées peuvent désigner (faux positifs possibles : contact conservé)
+static bool contact_archived(uint32_t contact_id)
+{
+    return archive_store_may_contain(&g_archive, 2, contact_id);
+}
+
+// Reconstruit les index secondaires et les cumuls à partir des en-têtes (après un chargement)
+static void rebuild_indexes(void)
+{
+    transaction_index_reset();
+    financial_tracker_init();
+    for (uint32_t i = 0; i < g_transactions_count; i++) {
+        transaction_index_append(g_transactions[i].transaction_date, g_transactions[i].animal_id,
+                                 g_transactions[i].contact_id, g_transactions[i].id);
+        track_record(&g_transactions[i], 1);
+        report_compliance(&g_transactions[i]);
+    }
+    transaction_index_finalize();
+    
+    // Les transactions archivées ne comptent que par le résumé de leur segment
+    for (uint32_t s = 0; g_archive_enabled && s < g_archive.segment_count; s++) {
+        financial_totals_t totals;
+        memcpy(&totals, g_archive.segments[s].summary, sizeof(totals));
+        financial_tracker_add_month(g_archive.segments[s].month_key, &totals);
+    }
+}
+
+// Rend les chaînes et la référence de contact d'un en-tête retiré ou remplacé
+static void release_record(const transaction_record_t* record)
+{
+    for (uint32_t f = 0; f < STRING_FIELD_COUNT; f++) {
+        string_arena_release(&g_strings, record->strings[f]);
+    }
+    contact_directory_release(record->contact_id);
+}
+
+// Reconstruit l'arène en ne gardant que les chaînes référencées
+static system_error_t compact_strings(void)
+{
+    string_arena_t compacted;
+    system_error_t ret = string_arena_init(&compacted, g_strings.capacity, g_strings.slot_count);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    for (uint32_t i = 0; i < g_transactions_count; i++) {
+        for (uint32_t f = 0; f < STRING_FIELD_COUNT; f++) {
+            const char* str = string_arena_get(&g_strings, g_transactions[i].strings[f]);
+            g_transactions[i].strings[f] = string_arena_intern(&compacted, str, k_string_fields[f].size - 1);
+        }
+    }
+    
+    ESP_LOGI(TAG, "Arène compactée: %" PRIu32 " -> %" PRIu32 " octets", g_strings.used, compacted.used);
+    
+    string_arena_deinit(&g_strings);
+    g_strings = compacted;
+    return SYSTEM_OK;
+}
+
+static bool intern_strings(const transaction_t* transaction, transaction_record_t* record)
+{
+    for (uint32_t f = 0; f < STRING_FIELD_COUNT; f++) {
+        const char* str = (const char*)transaction + k_string_fields[f].offset;
+        record->strings[f] = string_arena_intern(&g_strings, str, k_string_fields[f].size - 1);
+        if (record->strings[f] == STRING_ARENA_FULL) {
+            for (uint32_t r = 0; r < f; r++) {
+                string_arena_release(&g_strings, record->strings[r]);
+            }
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+static system_error_t pack_transaction(const transaction_t* transaction, transaction_record_t* record)
+{
+    memset(record, 0, sizeof(transaction_record_t));
+    record->id = transaction->id;
+    record->animal_id = transaction->animal_id;
+    record->transaction_date = transaction->transaction_date;
+    record->created_at = transaction->created_at;
+    record->updated_at = transaction->updated_at;
+    record->amount = transaction->amount;
+    record->type = (uint8_t)transaction->type;
+    record->status = (uint8_t)transaction->status;
+    record->cites_required = transaction->cites_required;
+    memcpy(record->currency, transaction->currency, sizeof(record->currency));
+    
+    system_error_t ret = contact_directory_resolve(transaction, &record->contact_id);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    if (intern_strings(transaction, record)) {
+        return SYSTEM_OK;
+    }
+    
+    // Arène pleine : récupérer la place des chaînes orphelines puis réessayer
+    if (g_strings.dead_bytes == 0 || compact_strings() != SYSTEM_OK || !intern_strings(transaction, record)) {
+        ESP_LOGE(TAG, "Arène de chaînes pleine");
+        contact_directory_release(record->contact_id);
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    return SYSTEM_OK;
+}
+
+static void log_deletion(uint32_t transaction_id)
+{
+    // Journal plein : la suppression la plus ancienne est oubliée
+    if (g_deletions_count == CHANGE_LOG_DELETIONS) {
+        g_forgotten_version = g_deletions[0].version;
+        memmove(&g_deletions[0], &g_deletions[1], (CHANGE_LOG_DELETIONS - 1) * sizeof(record_deletion_t));
+        g_deletions_count--;
+    }
+    
+    g_deletions[g_deletions_count].id = transaction_id;
+    g_deletions[g_deletions_count].version = ++g_change_version;
+    g_deletions_count++;
+}
+
+static void unpack_transaction(const transaction_record_t* record, transaction_t* transaction)
+{
+    memset(transaction, 0, sizeof(transaction_t));
+    transaction->id = record->id;
+    transaction->type = (transaction_type_t)record->type;
+    transaction->status = (transaction_status_t)record->status;
+    transaction->animal_id = record->animal_id;
+    transaction->transaction_date = record->transaction_date;
+    transaction->amount = record->amount;
+    memcpy(transaction->currency, record->currency, sizeof(transaction->currency));
+    transaction->cites_required = record->cites_required;
+    transaction->created_at = record->created_at;
+    transaction->updated_at = record->updated_at;
+    transaction->change_version = record->change_version;
+    transaction->counterpart_id = record->contact_id;
+    
+    const transaction_contact_t* contact = contact_directory_get(record->contact_id);
+    if (contact != NULL) {
+        snprintf(transaction->counterpart_name, sizeof(transaction->counterpart_name), "%s", contact->name);
+        snprintf(transaction->counterpart_address, sizeof(transaction->counterpart_address), "%s", contact->address);
+        snprintf(transaction->counterpart_phone, sizeof(transaction->counterpart_phone), "%s", contact->phone);
+        snprintf(transaction->counterpart_email, sizeof(transaction->counterpart_email), "%s", contact->email);
+    }
+    
+    for (uint32_t f = 0; f < STRING_FIELD_COUNT; f++) {
+        char* dst = (char*)transaction + k_string_fields[f].offset;
+        snprintf(dst, k_string_fields[f].size, "%s", string_arena_get(&g_strings, record->strings[f]));
+    }
+}
+
+// Retire un en-tête du tableau (les index sont mis à jour par l'appelant)
+static void remove_record(uint32_t index)
+{
+    release_record(&g_transactions[index]);
+    memmove(&g_transactions[index], &g_transactions[index + 1],
+            (g_transactions_count - index - 1) * sizeof(transaction_record_t));
+    g_transactions_count--;
+}
+
+static size_t put_bytes(size_t pos, const void* data, size_t length)
+{
+    memcpy(&g_journal_payload[pos], data, length);
+    return pos + length;
+}
+
+static size_t put_string(size_t pos, const char* str, size_t max_len)
+{
+    uint16_t length = (uint16_t)strnlen(str, max_len);
+    pos = put_bytes(pos, &length, sizeof(length));
+    return put_bytes(pos, str, length);
+}
+
+// Image d'une transaction dans le journal : champs fixes puis textes préfixés par leur longueur
+static size_t encode_record(const transaction_record_t* record)
+{
+    size_t pos = 0;
+    int64_t dates[3] = { record->transaction_date, record->created_at, record->updated_at };
+    
+    pos = put_bytes(pos, &record->id, sizeof(record->id));
+    pos = put_bytes(pos, &record->animal_id, sizeof(record->animal_id));
+    pos = put_bytes(pos, dates, sizeof(dates));
+    pos = put_bytes(pos, &record->amount, sizeof(record->amount));
+    pos = put_bytes(pos, &record->type, sizeof(record->type));
+    pos = put_bytes(pos, &record->status, sizeof(record->status));
+    pos = put_bytes(pos, &record->cites_required, sizeof(record->cites_required));
+    pos = put_bytes(pos, record->currency, sizeof(record->currency));
+    
+    for (uint32_t f = 0; f < STRING_FIELD_COUNT; f++) {
+        pos = put_string(pos, string_arena_get(&g_strings, record->strings[f]), k_string_fields[f].size - 1);
+    }
+    
+    const transaction_contact_t* contact = contact_directory_get(record->contact_id);
+    static const transaction_contact_t no_contact;
+    if (contact == NULL) {
+        contact = &no_contact;
+    }
+    pos = put_string(pos, contact->name, sizeof(contact->name) - 1);
+    pos = put_string(pos, contact->address, sizeof(contact->address) - 1);
+    pos = put_string(pos, contact->phone, sizeof(contact->phone) - 1);
+    pos = put_string(pos, contact->email, sizeof(contact->email) - 1);
+    pos = put_bytes(pos, &record->contact_id, sizeof(record->contact_id));
+    
+    return pos;
+}
+
+// Image d'un contact : écrite à chaque point de reprise pour conserver les IDs
+static size_t encode_contact(const transaction_contact_t* contact)
+{
+    size_t pos = 0;
+    int64_t dates[2] = { contact->created_at, contact->updated_at };
+    
+    pos = put_bytes(pos, &contact->id, sizeof(contact->id));
+    pos = put_bytes(pos, dates, sizeof(dates));
+    pos = put_string(pos, contact->name, sizeof(contact->name) - 1);
+    pos = put_string(pos, contact->address, sizeof(contact->address) - 1);
+    pos = put_string(pos, contact->phone, sizeof(contact->phone) - 1);
+    pos = put_string(pos, contact->email, sizeof(contact->email) - 1);
+    
+    return pos;
+}
+
+static bool get_bytes(const uint8_t* payload, size_t length, size_t* pos, void* data, size_t size)
+{
+    if (*pos + size > length) {
+        return false;
+    }
+    memcpy(data, &payload[*pos], size);
+    *pos += size;
+    return true;
+}
+
+static bool get_string(const uint8_t* payload, size_t length, size_t* pos, char* dst, size_t size)
+{
+    uint16_t str_length;
+    if (!get_bytes(payload, length, pos, &str_length, sizeof(str_length)) || str_length >= size) {
+        return false;
+    }
+    if (!get_bytes(payload, length, pos, dst, str_length)) {
+        return false;
+    }
+    dst[str_length] = '\0';
+    return true;
+}
+
+static bool decode_record(const uint8_t* payload, size_t length, transaction_t* transaction)
+{
+    size_t pos = 0;
+    int64_t dates[3];
+    uint8_t type;
+    uint8_t status;
+    bool ok = true;
+    
+    memset(transaction, 0, sizeof(transaction_t));
+    ok = ok && get_bytes(payload, length, &pos, &transaction->id, sizeof(transaction->id));
+    ok = ok && get_bytes(payload, length, &pos, &transaction->animal_id, sizeof(transaction->animal_id));
+    ok = ok && get_bytes(payload, length, &pos, dates, sizeof(dates));
+    ok = ok && get_bytes(payload, length, &pos, &transaction->amount, sizeof(transaction->amount));
+    ok = ok && get_bytes(payload, length, &pos, &type, sizeof(type));
+    ok = ok && get_bytes(payload, length, &pos, &status, sizeof(status));
+    ok = ok && get_bytes(payload, length, &pos, &transaction->cites_required, sizeof(transaction->cites_required));
+    ok = ok && get_bytes(payload, length, &pos, transaction->currency, sizeof(transaction->currency));
+    
+    for (uint32_t f = 0; ok && f < STRING_FIELD_COUNT; f++) {
+        ok = ok && get_string(payload, length, &pos, (char*)transaction + k_string_fields[f].offset, k_string_fields[f].size);
+    }
+    
+    ok = ok && get_string(payload, length, &pos, transaction->counterpart_name, sizeof(transaction->counterpart_name));
+    ok = ok && get_string(payload, length, &pos, transaction->counterpart_address, sizeof(transaction->counterpart_address));
+    ok = ok && get_string(payload, length, &pos, transaction->counterpart_phone, sizeof(transaction->counterpart_phone));
+    ok = ok && get_string(payload, length, &pos, transaction->counterpart_email, sizeof(transaction->counterpart_email));
+    ok = ok && get_bytes(payload, length, &pos, &transaction->counterpart_id, sizeof(transaction->counterpart_id));
+    if (!ok) {
+        return false;
+    }
+    
+    transaction->type = (transaction_type_t)type;
+    transaction->status = (transaction_status_t)status;
+    transaction->transaction_date = (time_t)dates[0];
+    transaction->created_at = (time_t)dates[1];
+    transaction->updated_at = (time_t)dates[2];
+    
+    return true;
+}
+
+static bool decode_contact(const uint8_t* payload, size_t length, transaction_contact_t* contact)
+{
+    size_t pos = 0;
+    int64_t dates[2];
+    bool ok = true;
+    
+    memset(contact, 0, sizeof(transaction_contact_t));
+    ok = ok && get_bytes(payload, length, &pos, &contact->id, sizeof(contact->id));
+    ok = ok && get_bytes(payload, length, &pos, dates, sizeof(dates));
+    ok = ok && get_string(payload, length, &pos, contact->name, sizeof(contact->name));
+    ok = ok && get_string(payload, length, &pos, contact->address, sizeof(contact->address));
+    ok = ok && get_string(payload, length, &pos, contact->phone, sizeof(contact->phone));
+    ok = ok && get_string(payload, length, &pos, contact->email, sizeof(contact->email));
+    if (!ok) {
+        return false;
+    }
+    
+    contact->created_at = (time_t)dates[0];
+    contact->updated_at = (time_t)dates[1];
+    return true;
+}
+
+// Rejoue un enregistrement du journal (les index sont reconstruits après la relecture)
+static void replay_record(journal_op_t op, const uint8_t* payload, size_t length)
+{
+    if (op == JOURNAL_OP_DELETE) {
+        uint32_t transaction_id;
+        size_t pos = 0;
+        if (get_bytes(payload, length, &pos, &transaction_id, sizeof(transaction_id))) {
+            int32_t index = find_transaction_index(transaction_id);
+            if (index >= 0) {
+                remove_record((uint32_t)index);
+            }
+        }
+        return;
+    }
+    
+    if (op == JOURNAL_OP_CONTACT) {
+        if (!decode_contact(payload, length, &g_replay_contact) ||
+            contact_directory_restore(&g_replay_contact) != SYSTEM_OK) {
+            ESP_LOGW(TAG, "Contact du journal ignoré");
+        }
+        return;
+    }
+    
+    if (op != JOURNAL_OP_PUT || !decode_record(payload, length, &g_replay_transaction)) {
+        ESP_LOGW(TAG, "Enregistrement de journal ignoré");
+        return;
+    }
+    
+    // Un contact créé par cette transaction est recréé à partir de ses coordonnées, avec le même ID
+    if (contact_directory_get(g_replay_transaction.counterpart_id) == NULL) {
+        g_replay_transaction.counterpart_id = 0;
+    }
+    
+    transaction_record_t record;
+    if (pack_transaction(&g_replay_transaction, &record) != SYSTEM_OK) {
+        return;
+    }
+    
+    int32_t index = find_transaction_index(record.id);
+    if (index >= 0) {
+        release_record(&g_transactions[index]);
+        g_transactions[index] = record;
+        return;
+    }
+    
+    if (g_transactions_count >= MAX_TRANSACTIONS) {
+        release_record(&record);
+        return;
+    }
+    
+    // Insertion à sa place dans l'ordre des IDs
+    uint32_t pos = g_transactions_count;
+    while (pos > 0 && g_transactions[pos - 1].id > record.id) {
+        pos--;
+    }
+    memmove(&g_transactions[pos + 1], &g_transactions[pos],
+            (g_transactions_count - pos) * sizeof(transaction_record_t));
+    g_transactions[pos] = record;
+    g_transactions_count++;
+}
+
+static system_error_t journal_put(const transaction_record_t* record, uint32_t* sequence)
+{
+    *sequence = 0;
+    if (!g_journal_enabled) {
+        return SYSTEM_OK;
+    }
+    
+    return transaction_journal_append(JOURNAL_OP_PUT, g_journal_payload, encode_record(record), sequence);
+}
+
+static system_error_t journal_delete(uint32_t transaction_id, uint32_t* sequence)
+{
+    *sequence = 0;
+    if (!g_journal_enabled) {
+        return SYSTEM_OK;
+    }
+    
+    memcpy(g_journal_payload, &transaction_id, sizeof(transaction_id));
+    return transaction_journal_append(JOURNAL_OP_DELETE, g_journal_payload, sizeof(transaction_id), sequence);
+}
+
+// Réécrit le journal avec l'image courante de chaque transaction. Différé tant qu'une modification
+// attend sa durabilité : le point de reprise rendrait durable une image que son annulation retirerait
+// ensuite de la mémoire ; le compactage est repris à la fin d'une modification suivante
+static void journal_checkpoint(void)
+{
+    if (!g_journal_enabled || !transaction_journal_needs_checkpoint()) {
+        return;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_pending_count == 0 && transaction_journal_checkpoint_begin() == SYSTEM_OK) {
+        bool ok = true;
+        // Tous les contacts sont conservés, y compris ceux des seules transactions archivées
+        const transaction_contact_t* contact;
+        for (uint32_t i = 0; ok && (contact = contact_directory_get_at(i)) != NULL; i++) {
+            ok = transaction_journal_checkpoint_write(JOURNAL_OP_CONTACT, g_journal_payload,
+                                                      encode_contact(contact)) == SYSTEM_OK;
+        }
+        for (uint32_t i = 0; ok && i < g_transactions_count; i++) {
+            ok = transaction_journal_checkpoint_write(JOURNAL_OP_PUT, g_journal_payload,
+                                                      encode_record(&g_transactions[i])) == SYSTEM_OK;
+        }
+        transaction_journal_checkpoint_end(ok);
+    }
+    
+    xSemaphoreGive(g_mutex);
+}
+
+// Attend la durabilité d'une modification (hors mutex pour grouper les écritures concurrentes)
+static system_error_t journal_commit(uint32_t sequence)
+{
+    if (!g_journal_enabled || sequence == 0) {
+        return SYSTEM_OK;
+    }
+    
+    system_error_t ret = transaction_journal_wait(sequence);
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Modification non persistée (séquence %" PRIu32 ")", sequence);
+    }
+    
+    return ret;
+}
+
+static bool is_pending(uint32_t transaction_id)
+{
+    for (uint32_t i = 0; i < g_pending_count; i++) {
+        if (g_pending_ids[i] == transaction_id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Prend le mutex une fois terminée toute modification de la transaction encore en attente du journal
+static void lock_transaction(uint32_t transaction_id)
+{
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    while (g_journal_enabled && (is_pending(transaction_id) || g_pending_count >= JOURNAL_MAX_WAITERS)) {
+        xSemaphoreGive(g_mutex);
+        vTaskDelay(pdMS_TO_TICKS(JOURNAL_GROUP_COMMIT_MS));
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+    }
+}
+
+// Conserve l'état durable d'une transaction avant de la modifier (index < 0 : création)
+static system_error_t undo_capture(transaction_undo_t* undo, uint32_t transaction_id, int32_t index)
+{
+    memset(undo, 0, sizeof(transaction_undo_t));
+    undo->transaction_id = transaction_id;
+    
+    if (!g_journal_enabled) {
+        return SYSTEM_OK;
+    }
+    
+    if (index >= 0) {
+        undo->length = encode_record(&g_transactions[index]);
+        undo->payload = heap_caps_malloc(undo->length, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (undo->payload == NULL) {
+            undo->payload = heap_caps_malloc(undo->length, MALLOC_CAP_8BIT);
+        }
+        if (undo->payload == NULL) {
+            return SYSTEM_ERROR_MEMORY;
+        }
+        memcpy(undo->payload, g_journal_payload, undo->length);
+        undo->contact_id = g_transactions[index].contact_id;
+        contact_directory_retain(undo->contact_id);
+    }
+    
+    g_pending_ids[g_pending_count++] = transaction_id;
+    undo->registered = true;
+    return SYSTEM_OK;
+}
+
+// Réinstalle l'état durable d'une transaction dont la modification n'a pas été persistée
+static void undo_revert_locked(const transaction_undo_t* undo)
+{
+    int32_t index = find_transaction_index(undo->transaction_id);
+    transaction_record_t record;
+    
+    if (undo->payload != NULL) {
+        if (!decode_record(undo->payload, undo->length, &g_restore_transaction) ||
+            pack_transaction(&g_restore_transaction, &record) != SYSTEM_OK) {
+            ESP_LOGE(TAG, "Annulation impossible: transaction ID=%" PRIu32, undo->transaction_id);
+            return;
+        }
+    }
+    
+    if (index >= 0) {
+        const transaction_record_t* current = &g_transactions[index];
+        transaction_index_remove(current->transaction_date, current->animal_id, current->contact_id, current->id);
+        track_record(current, -1);
+        if (undo->payload == NULL) {
+            remove_record((uint32_t)index);
+            log_deletion(undo->transaction_id);
+            regulatory_transaction_removed(undo->transaction_id);
+            return;
+        }
+        release_record(current);
+    } else {
+        if (undo->payload == NULL) {
+            return;
+        }
+        if (g_transactions_count >= MAX_TRANSACTIONS) {
+            release_record(&record);
+            ESP_LOGE(TAG, "Annulation impossible: transaction ID=%" PRIu32, undo->transaction_id);
+            return;
+        }
+        
+        // Transaction supprimée : réinsertion à sa place dans l'ordre des IDs
+        uint32_t pos = g_transactions_count;
+        while (pos > 0 && g_transactions[pos - 1].id > record.id) {
+            pos--;
+        }
+        memmove(&g_transactions[pos + 1], &g_transactions[pos],
+                (g_transactions_count - pos) * sizeof(transaction_record_t));
+        g_transactions_count++;
+        index = (int32_t)pos;
+    }
+    
+    record.change_version = ++g_change_version;
+    g_transactions[index] = record;
+    transaction_index_insert(record.transaction_date, record.animal_id, record.contact_id, record.id);
+    track_record(&record, 1);
+    report_compliance(&record);
+}
+
+// Termine une modification : si elle n'est pas durable, l'état en mémoire redevient l'état durable ;
+// le journal est ensuite compacté s'il le faut
+static system_error_t undo_finish(transaction_undo_t* undo, system_error_t ret)
+{
+    if (undo->registered) {
+        xSemaphoreTake(g_mutex, portMAX_DELAY);
+        if (ret != SYSTEM_OK && undo->applied) {
+            undo_revert_locked(undo);
+            ESP_LOGW(TAG, "Modification annulée: transaction ID=%" PRIu32, undo->transaction_id);
+        }
+        for (uint32_t i = 0; i < g_pending_count; i++) {
+            if (g_pending_ids[i] == undo->transaction_id) {
+                g_pending_ids[i] = g_pending_ids[--g_pending_count];
+                break;
+            }
+        }
+        contact_directory_release(undo->contact_id);
+        xSemaphoreGive(g_mutex);
+    }
+    
+    heap_caps_free(undo->payload);
+    undo->payload = NULL;
+    journal_checkpoint();
+    return ret;
+}
+
+// Résumé d'un segment d'archive : cumuls financiers du mois
+static void summarize_archived(const archive_record_t* record, uint8_t* summary)
+{
+    financial_totals_t totals;
+    memcpy(&totals, summary, sizeof(totals));
+    if (decode_record(record->payload, record->length, &g_archive_transaction)) {
+        financial_tracker_accumulate(&totals, g_archive_transaction.type, g_archive_transaction.status,
+                                     g_archive_transaction.amount);
+    }
+    memcpy(summary, &totals, sizeof(totals));
+}
+
+_Static_assert(sizeof(financial_totals_t) <= ARCHIVE_SUMMARY_SIZE, "Résumé d'archive trop petit");
+
+// Motif d'une transaction dans le registre (NULL si elle n'y figure pas)
+static const char* register_reason(uint8_t type, uint8_t status, uint32_t animal_id, register_movement_t* movement)
+{
+    static const char* const k_reasons[TRANSACTION_TYPE_COUNT] = {
+        "Achat", "Vente", "Échange", "Don", "Naissance", "Décès", "Fuite"
+    };
+    
+    if (status == TRANSACTION_STATUS_CANCELLED || status == TRANSACTION_STATUS_REFUNDED || type >= TRANSACTION_TYPE_COUNT) {
+        return NULL;
+    }
+    // Un achat ou une naissance liés à une fiche animal sont déjà l'entrée de cette fiche
+    if (type == TRANSACTION_TYPE_PURCHASE || type == TRANSACTION_TYPE_BREEDING) {
+        if (animal_id != 0) {
+            return NULL;
+        }
+        *movement = REGISTER_MOVEMENT_ENTRY;
+    } else {
+        *movement = REGISTER_MOVEMENT_EXIT;
+    }
+    
+    return k_reasons[type];
+}
+
+static bool visit_register_archived(const archive_record_t* record, void* context)
+{
+    register_batch_t* batch = (register_batch_t*)context;
+    
+    if (register_batch_complete(batch, record->date)) {
+        return false;
+    }
+    // La copie en mémoire d'une transaction fait foi
+    if (!register_batch_accepts(batch, record->date, record->keys[0]) || find_transaction_index(record->keys[0]) >= 0 ||
+        !decode_record(record->payload, record->length, &g_archive_transaction)) {
+        return true;
+    }
+    
+    const transaction_t* transaction = &g_archive_transaction;
+    register_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    const char* reason = register_reason(transaction->type, transaction->status, transaction->animal_id, &entry.movement);
+    if (reason != NULL) {
+        entry.date = record->date;
+        entry.key = transaction->id;
+        entry.animal_id = transaction->animal_id;
+        snprintf(entry.reason, sizeof(entry.reason), "%s", reason);
+        snprintf(entry.species_name, sizeof(entry.species_name), "%.*s",
+                 (int)sizeof(entry.species_name) - 1, transaction->animal_species);
+        snprintf(entry.identification, sizeof(entry.identification), "%.*s",
+                 (int)sizeof(entry.identification) - 1, transaction->animal_name);
+        snprintf(entry.counterpart, sizeof(entry.counterpart), "%.*s",
+                 (int)sizeof(entry.counterpart) - 1, transaction->counterpart_name);
+        snprintf(entry.document, sizeof(entry.document), "%.*s",
+                 (int)sizeof(entry.document) - 1, transaction->cites_permit_number);
+        register_batch_offer(batch, &entry);
+    }
+    
+    return true;
+}
+
+// Registre : cessions, décès et fuites, de l'archive puis de la table en mémoire
+static void fetch_register_transactions(register_batch_t* batch)
+{
+    time_t start_date = batch->started ? batch->after_date : 0;
+    register_entry_t entry;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_archive_enabled) {
+        archive_store_query(&g_archive, start_date, 0, -1, 0, visit_register_archived, batch);
+    }
+    
+    uint32_t count = 0;
+    const transaction_date_entry_t* entries = transaction_index_range(start_date, 0, &count);
+    for (uint32_t i = 0; i < count && !register_batch_complete(batch, entries[i].transaction_date); i++) {
+        if (!register_batch_accepts(batch, entries[i].transaction_date, entries[i].transaction_id)) {
+            continue;
+        }
+        int32_t index = find_transaction_index(entries[i].transaction_id);
+        if (index < 0) {
+            continue;
+        }
+        
+        const transaction_record_t* record = &g_transactions[index];
+        memset(&entry, 0, sizeof(entry));
+        const char* reason = register_reason(record->type, record->status, record->animal_id, &entry.movement);
+        if (reason == NULL) {
+            continue;
+        }
+        const transaction_contact_t* contact = contact_directory_get(record->contact_id);
+        entry.date = record->transaction_date;
+        entry.key = record->id;
+        entry.animal_id = record->animal_id;
+        snprintf(entry.reason, sizeof(entry.reason), "%s", reason);
+        snprintf(entry.species_name, sizeof(entry.species_name), "%s",
+                 string_arena_get(&g_strings, record->strings[STRING_FIELD_SPECIES]));
+        snprintf(entry.identification, sizeof(entry.identification), "%s",
+                 string_arena_get(&g_strings, record->strings[STRING_FIELD_ANIMAL_NAME]));
+        if (contact != NULL) {
+            snprintf(entry.counterpart, sizeof(entry.counterpart), "%.*s",
+                     (int)sizeof(entry.counterpart) - 1, contact->name);
+        }
+        snprintf(entry.document, sizeof(entry.document), "%s",
+                 string_arena_get(&g_strings, record->strings[STRING_FIELD_CITES_PERMIT]));
+        register_batch_offer(batch, &entry);
+    }
+    
+    xSemaphoreGive(g_mutex);
+}
+
+system_error_t transaction_manager_init(void)
+{
+    if (g_initialized) {
+        return SYSTEM_OK;
+    }
+    
+    ESP_LOGI(TAG, "Initialisation du gestionnaire de transactions...");
+    
+    // Initialisation des données (en-têtes et textes en PSRAM)
+    g_transactions = heap_caps_calloc(MAX_TRANSACTIONS, sizeof(transaction_record_t),
+                                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (g_transactions == NULL) {
+        g_transactions = heap_caps_calloc(MAX_TRANSACTIONS, sizeof(transaction_record_t), MALLOC_CAP_8BIT);
+    }
+    if (g_transactions == NULL ||
+        string_arena_init(&g_strings, TRANSACTION_ARENA_SIZE, TRANSACTION_ARENA_SLOTS) != SYSTEM_OK ||
+        transaction_index_init() != SYSTEM_OK ||
+        contact_directory_init() != SYSTEM_OK ||
+        certificate_generator_init() != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Impossible d'allouer le stockage des transactions");
+        heap_caps_free(g_transactions);
+        g_transactions = NULL;
+        return SYSTEM_ERROR_MEMORY;
+    }
+    g_transactions_count = 0;
+    g_next_id = 1;
+    
+    g_mutex = xSemaphoreCreateMutex();
+    if (g_mutex == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    // Relecture du journal : l'état est reconstruit avant le démarrage des modifications
+    g_journal_enabled = (transaction_journal_init(TRANSACTION_JOURNAL_PATH, replay_record) == SYSTEM_OK);
+    if (g_journal_enabled) {
+        transaction_journal_start();
+    } else {
+        ESP_LOGW(TAG, "Journal indisponible, transactions non persistées");
+    }
+    
+    g_archive_enabled = (archive_store_open(&g_archive, TRANSACTION_ARCHIVE_PATH, summarize_archived) == SYSTEM_OK);
+    if (!g_archive_enabled) {
+        ESP_LOGW(TAG, "Archive indisponible, transactions conservées en mémoire");
+    }
+    
+    // Contacts que plus aucune transaction ne désigne depuis le dernier point de reprise
+    uint32_t pruned = contact_directory_prune(g_archive_enabled ? contact_archived : NULL);
+    if (pruned > 0) {
+        ESP_LOGI(TAG, "%" PRIu32 " contacts inutilisés retirés", pruned);
+    }
+    
+    // Les IDs archivés ne sont jamais réattribués
+    if (g_transactions_count > 0) {
+        g_next_id = g_transactions[g_transactions_count - 1].id + 1;
+    }
+    if (g_archive_enabled && archive_store_key_max(&g_archive, 0) >= g_next_id) {
+        g_next_id = archive_store_key_max(&g_archive, 0) + 1;
+    }
+    rebuild_indexes();
+    breeding_register_set_source(REGISTER_SOURCE_TRANSACTIONS, fetch_register_transactions);
+    
+    g_initialized = true;
+    ESP_LOGI(TAG, "Gestionnaire de transactions initialisé (%d en-têtes de %u octets, arène de %d octets)",
+             MAX_TRANSACTIONS, (unsigned)sizeof(transaction_record_t), TRANSACTION_ARENA_SIZE);
+    
+    return SYSTEM_OK;
+}
+
+static system_error_t create_locked(transaction_t* transaction, uint32_t* sequence, transaction_undo_t* undo)
+{
+    if (g_transactions_count >= MAX_TRANSACTIONS) {
+        ESP_LOGE(TAG, "Nombre maximum de transactions atteint");
+        return SYSTEM_ERROR_MEMORY;
+    }
+    
+    // Assigner un ID unique
+    transaction->id = g_next_id;
+    transaction->created_at = time(NULL);
+    transaction->updated_at = transaction->created_at;
+    
+    system_error_t ret = undo_capture(undo, transaction->id, -1);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    // Ajouter à la liste
+    ret = pack_transaction(transaction, &g_transactions[g_transactions_count]);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    g_transactions_count++;
+    undo->applied = true;
+    g_next_id++;
+    transaction_record_t* record = &g_transactions[g_transactions_count - 1];
+    record->change_version = ++g_change_version;
+    transaction->change_version = record->change_version;
+    transaction->counterpart_id = record->contact_id;
+    transaction_index_insert(record->transaction_date, record->animal_id, record->contact_id, record->id);
+    track_record(record, 1);
+    report_compliance(record);
+    
+    return journal_put(record, sequence);
+}
+
+system_error_t transaction_create(transaction_t* transaction)
+{
+    if (!g_initialized || transaction == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t sequence;
+    transaction_undo_t undo = {0};
+    lock_transaction(0);
+    system_error_t ret = create_locked(transaction, &sequence, &undo);
+    xSemaphoreGive(g_mutex);
+    
+    if (ret != SYSTEM_OK) {
+        return undo_finish(&undo, ret);
+    }
+    
+    ESP_LOGI(TAG, "Transaction créée: ID=%" PRIu32 ", Type=%d", transaction->id, transaction->type);
+    
+    return undo_finish(&undo, journal_commit(sequence));
+}
+
+static system_error_t update_locked(const transaction_t* transaction, uint32_t* sequence, transaction_undo_t* undo)
+{
+    // Rechercher la transaction
+    int32_t index = find_transaction_index(transaction->id);
+    if (index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    system_error_t ret = undo_capture(undo, transaction->id, index);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    // Les nouvelles chaînes sont référencées avant de libérer les anciennes pour partager les textes inchangés
+    transaction_record_t record;
+    ret = pack_transaction(transaction, &record);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    undo->applied = true;
+    
+    release_record(&g_transactions[index]);
+    const transaction_record_t* previous = &g_transactions[index];
+    if (record.transaction_date != previous->transaction_date || record.animal_id != previous->animal_id ||
+        record.contact_id != previous->contact_id) {
+        transaction_index_remove(previous->transaction_date, previous->animal_id, previous->contact_id, record.id);
+        transaction_index_insert(record.transaction_date, record.animal_id, record.contact_id, record.id);
+    }
+    track_record(&g_transactions[index], -1);
+    track_record(&record, 1);
+    record.updated_at = time(NULL);
+    record.change_version = ++g_change_version;
+    g_transactions[index] = record;
+    report_compliance(&g_transactions[index]);
+    
+    return journal_put(&g_transactions[index], sequence);
+}
+
+system_error_t transaction_update(const transaction_t* transaction)
+{
+    if (!g_initialized || transaction == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t sequence;
+    transaction_undo_t undo = {0};
+    lock_transaction(transaction->id);
+    system_error_t ret = update_locked(transaction, &sequence, &undo);
+    xSemaphoreGive(g_mutex);
+    
+    if (ret != SYSTEM_OK) {
+        return undo_finish(&undo, ret);
+    }
+    
+    ESP_LOGI(TAG, "Transaction mise à jour: ID=%" PRIu32, transaction->id);
+    return undo_finish(&undo, journal_commit(sequence));
+}
+
+static system_error_t delete_locked(uint32_t transaction_id, uint32_t* sequence, transaction_undo_t* undo)
+{
+    // Rechercher et supprimer la transaction
+    int32_t index = find_transaction_index(transaction_id);
+    if (index < 0) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    system_error_t ret = undo_capture(undo, transaction_id, index);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    undo->applied = true;
+    
+    transaction_index_remove(g_transactions[index].transaction_date, g_transactions[index].animal_id,
+                             g_transactions[index].contact_id, transaction_id);
+    track_record(&g_transactions[index], -1);
+    remove_record((uint32_t)index);
+    log_deletion(transaction_id);
+    regulatory_transaction_removed(transaction_id);
+    
+    return journal_delete(transaction_id, sequence);
+}
+
+system_error_t transaction_delete(uint32_t transaction_id)
+{
+    if (!g_initialized) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    uint32_t sequence;
+    transaction_undo_t undo = {0};
+    lock_transaction(transaction_id);
+    system_error_t ret = delete_locked(transaction_id, &sequence, &undo);
+    xSemaphoreGive(g_mutex);
+    
+    if (ret != SYSTEM_OK) {
+        return undo_finish(&undo, ret);
+    }
+    
+    ESP_LOGI(TAG, "Transaction supprimée: ID=%" PRIu32, transaction_id);
+    return undo_finish(&undo, journal_commit(sequence));
+}
+
+// Parcours par date croissante fusionnant l'archive et un index de la table en mémoire. Les transactions
+// sont copiées sous g_mutex par lots triés par (date, ID), dans le format du journal, chaque lot reprenant
+// après la dernière transaction du précédent ; elles sont décodées et remises à l'appelant hors du verrou
+#define READ_BATCH_ENTRIES  64
+
+_Static_assert(TRANSACTION_READ_BUFFER >= JOURNAL_MAX_PAYLOAD && TRANSACTION_READ_BUFFER <= UINT16_MAX,
+               "Tampon de lecture incapable de contenir une transaction");
+
+typedef struct {
+    time_t date;
+    uint32_t id;
+    uint32_t counterpart_id;
+    uint32_t change_version;
+    uint16_t offset;        // Image dans data
+    uint16_t length;
+} read_entry_t;
+
+typedef struct {
+    read_entry_t entries[READ_BATCH_ENTRIES];
+    uint8_t data[TRANSACTION_READ_BUFFER];
+    transaction_t transaction;  // Transaction décodée remise à l'appelant
+} read_batch_t;
+
+typedef struct {
+    time_t start_date;
+    time_t end_date;
+    int32_t key_slot;       // Clé d'archive : 1 pour un animal, 2 pour un contact, -1 pour toutes
+    uint32_t key;
+    bool started;           // Position de reprise : après (after_date, after_id)
+    time_t after_date;
+    uint32_t after_id;
+    read_batch_t* batch;
+    uint32_t count;
+    size_t used;
+    bool truncated;         // Des transactions au-delà de la dernière du lot ont été écartées
+} history_cursor_t;
 
-system_error_t transaction_manager_init(void)
+// Page de résultats copiée dans le tableau de l'appelant
+typedef struct {
+    transaction_t* transactions;
+    uint32_t max_count;
+    uint32_t skip;          // Résultats à sauter (pagination)
+    uint32_t count;
+} history_page_t;
+
+static int compare_position(time_t date, uint32_t id, time_t other_date, uint32_t other_id)
 {
-    if (g_initialized) {
-        return SYSTEM_OK;
+    if (date != other_date) {
+        return (date < other_date) ? -1 : 1;
+    }
+    return (id < other_id) ? -1 : (id > other_id) ? 1 : 0;
+}
+
+static bool cursor_accepts(const history_cursor_t* cursor, time_t date, uint32_t id)
+{
+    if (cursor->started && compare_position(date, id, cursor->after_date, cursor->after_id) <= 0) {
+        return false;
+    }
+    if (cursor->truncated) {
+        const read_entry_t* last = &cursor->batch->entries[cursor->count - 1];
+        return compare_position(date, id, last->date, last->id) < 0;
+    }
+    return true;
+}
+
+// Lot tronqué et date au-delà de sa dernière transaction : la suite de la source n'y entrera plus
+static bool cursor_complete(const history_cursor_t* cursor, time_t date)
+{
+    return cursor->truncated && date > cursor->batch->entries[cursor->count - 1].date;
+}
+
+// Insère une transaction à sa position ; faute de place, les dernières du lot (ou celle-ci) sont écartées
+// et seront relues au lot suivant
+static void cursor_offer(history_cursor_t* cursor, const read_entry_t* candidate, const uint8_t* payload)
+{
+    read_batch_t* batch = cursor->batch;
+    uint32_t pos = cursor->count;
+    while (pos > 0 && compare_position(candidate->date, candidate->id,
+                                       batch->entries[pos - 1].date, batch->entries[pos - 1].id) < 0) {
+        pos--;
     }
     
-    ESP_LOGI(TAG, "Initialisation du gestionnaire de transactions...");
+    while (cursor->count > pos &&
+           (cursor->count == READ_BATCH_ENTRIES || cursor->used + candidate->length > TRANSACTION_READ_BUFFER)) {
+        const read_entry_t* last = &batch->entries[--cursor->count];
+        if (last->offset + last->length == cursor->used) {
+            cursor->used = last->offset;
+        }
+        cursor->truncated = true;
+    }
+    if (cursor->count == READ_BATCH_ENTRIES || cursor->used + candidate->length > TRANSACTION_READ_BUFFER) {
+        cursor->truncated = true;
+        return;
+    }
     
-    // Initialisation des données
-    memset(g_transactions, 0, sizeof(g_transactions));
-    g_transactions_count = 0;
-    g_next_id = 1;
+    memmove(&batch->entries[pos + 1], &batch->entries[pos], (cursor->count - pos) * sizeof(read_entry_t));
+    batch->entries[pos] = *candidate;
+    batch->entries[pos].offset = (uint16_t)cursor->used;
+    memcpy(&batch->data[cursor->used], payload, candidate->length);
+    cursor->used += candidate->length;
+    cursor->count++;
+}
+
+static bool visit_archived(const archive_record_t* record, void* context)
+{
+    history_cursor_t* cursor = (history_cursor_t*)context;
     
-    g_initialized = true;
-    ESP_LOGI(TAG, "Gestionnaire de transactions initialisé");
+    if (cursor_complete(cursor, record->date)) {
+        return false;
+    }
+    // Transaction encore en mémoire après un archivage interrompu : la copie en mémoire fait foi
+    if (!cursor_accepts(cursor, record->date, record->keys[0]) || find_transaction_index(record->keys[0]) >= 0) {
+        return true;
+    }
     
-    return SYSTEM_OK;
+    read_entry_t entry = { .date = record->date, .id = record->keys[0], .counterpart_id = record->keys[2],
+                           .length = record->length };
+    cursor_offer(cursor, &entry, record->payload);
+    return true;
 }
 
-system_error_t transaction_create(transaction_t* transaction)
+// Copie le lot suivant sous g_mutex : l'index en mémoire est relu à chaque lot, il peut avoir changé entre deux
+static void cursor_fill(history_cursor_t* cursor)
 {
-    if (!g_initialized || transaction == NULL) {
-        return SYSTEM_ERROR_INVALID_PARAM;
+    time_t from = cursor->started ? cursor->after_date : cursor->start_date;
+    const transaction_date_entry_t* by_date = NULL;
+    const transaction_key_entry_t* by_key = NULL;
+    uint32_t hot_count = 0;
+    
+    cursor->count = 0;
+    cursor->used = 0;
+    cursor->truncated = false;
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    if (g_archive_enabled &&
+        archive_store_query(&g_archive, from, cursor->end_date, cursor->key_slot, cursor->key, visit_archived, cursor) != SYSTEM_OK) {
+        ESP_LOGW(TAG, "Lecture de l'archive incomplète");
     }
     
-    if (g_transactions_count >= MAX_TRANSACTIONS) {
-        ESP_LOGE(TAG, "Nombre maximum de transactions atteint");
-        return SYSTEM_ERROR_MEMORY;
+    if (cursor->key_slot == 1) {
+        by_key = transaction_index_animal_range(cursor->key, &hot_count);
+    } else if (cursor->key_slot == 2) {
+        by_key = transaction_index_contact_range(cursor->key, &hot_count);
+    } else {
+        by_date = transaction_index_range(from, cursor->end_date, &hot_count);
     }
     
-    // Assigner un ID unique
-    transaction->id = g_next_id++;
-    transaction->created_at = time(NULL);
-    transaction->updated_at = transaction->created_at;
+    for (uint32_t i = 0; i < hot_count; i++) {
+        time_t date = (by_date != NULL) ? by_date[i].transaction_date : by_key[i].transaction_date;
+        uint32_t id = (by_date != NULL) ? by_date[i].transaction_id : by_key[i].transaction_id;
+        if (cursor_complete(cursor, date)) {
+            break;
+        }
+        
+        int32_t index = cursor_accepts(cursor, date, id) ? find_transaction_index(id) : -1;
+        if (index >= 0) {
+            const transaction_record_t* record = &g_transactions[index];
+            read_entry_t entry = { .date = date, .id = id, .counterpart_id = record->contact_id,
+                                   .change_version = record->change_version };
+            entry.length = (uint16_t)encode_record(record);
+            cursor_offer(cursor, &entry, g_journal_payload);
+        }
+    }
     
-    // Ajouter à la liste
-    memcpy(&g_transactions[g_transactions_count], transaction, sizeof(transaction_t));
-    g_transactions_count++;
+    xSemaphoreGive(g_mutex);
+}
+
+static system_error_t cursor_run(history_cursor_t* cursor, transaction_visit_fn_t visit, void* context)
+{
+    cursor->batch = heap_caps_malloc(sizeof(read_batch_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (cursor->batch == NULL) {
+        cursor->batch = heap_caps_malloc(sizeof(read_batch_t), MALLOC_CAP_8BIT);
+    }
+    if (cursor->batch == NULL) {
+        return SYSTEM_ERROR_MEMORY;
+    }
     
-    ESP_LOGI(TAG, "Transaction créée: ID=%" PRIu32 ", Type=%d", transaction->id, transaction->type);
+    transaction_t* transaction = &cursor->batch->transaction;
+    bool keep_going = true;
+    do {
+        cursor_fill(cursor);
+        for (uint32_t i = 0; keep_going && i < cursor->count; i++) {
+            const read_entry_t* entry = &cursor->batch->entries[i];
+            if (!decode_record(&cursor->batch->data[entry->offset], entry->length, transaction)) {
+                continue;
+            }
+            transaction->counterpart_id = entry->counterpart_id;
+            transaction->change_version = entry->change_version;
+            keep_going = visit(transaction, context);
+        }
+        if (cursor->count > 0) {
+            cursor->started = true;
+            cursor->after_date = cursor->batch->entries[cursor->count - 1].date;
+            cursor->after_id = cursor->batch->entries[cursor->count - 1].id;
+        }
+    } while (keep_going && cursor->truncated);
     
+    heap_caps_free(cursor->batch);
     return SYSTEM_OK;
 }
 
-system_error_t transaction_update(const transaction_t* transaction)
+static bool collect_page(const transaction_t* transaction, void* context)
 {
-    if (!g_initialized || transaction == NULL) {
-        return SYSTEM_ERROR_INVALID_PARAM;
+    history_page_t* page = (history_page_t*)context;
+    
+    if (page->skip > 0) {
+        page->skip--;
+        return true;
     }
     
-    // Rechercher la transaction
-    for (uint32_t i = 0; i < g_transactions_count; i++) {
-        if (g_transactions[i].id == transaction->id) {
-            memcpy(&g_transactions[i], transaction, sizeof(transaction_t));
-            g_transactions[i].updated_at = time(NULL);
-            
-            ESP_LOGI(TAG, "Transaction mise à jour: ID=%" PRIu32, transaction->id);
+    page->transactions[page->count++] = *transaction;
+    return page->count < page->max_count;
+}
+
+// Page d'un parcours : les lots sont copiés dans le tableau de l'appelant hors du verrou
+static system_error_t cursor_collect(history_cursor_t* cursor, history_page_t* page, uint32_t* count)
+{
+    system_error_t ret = SYSTEM_OK;
+    
+    if (page->max_count > 0) {
+        ret = cursor_run(cursor, collect_page, page);
+    }
+    
+    *count = page->count;
+    return ret;
+}
+
+static bool copy_archived(const archive_record_t* record, void* context)
+{
+    transaction_t* transaction = (transaction_t*)context;
+    
+    if (decode_record(record->payload, record->length, transaction)) {
+        transaction->counterpart_id = record->keys[2];
+    }
+    
+    return false;
+}
+
+// Recherche une transaction en mémoire puis dans l'archive
+static system_error_t load_transaction(uint32_t transaction_id, transaction_t* transaction)
+{
+    system_error_t ret = SYSTEM_OK;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    int32_t index = find_transaction_index(transaction_id);
+    if (index >= 0) {
+        unpack_transaction(&g_transactions[index], transaction);
+    } else if (!g_archive_enabled || transaction_id == 0) {
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    } else {
+        transaction->id = 0;
+        archive_store_query(&g_archive, 0, 0, 0, transaction_id, copy_archived, transaction);
+        ret = (transaction->id == transaction_id) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+    }
+    
+    xSemaphoreGive(g_mutex);
+    return ret;
+}
+
+static system_error_t restore_locked(const transaction_t* transaction, uint32_t* sequence, transaction_undo_t* undo)
+{
+    *sequence = 0;
+    
+    int32_t index = find_transaction_index(transaction->id);
+    if (index < 0 && g_archive_enabled && transaction->id <= archive_store_key_max(&g_archive, 0)) {
+        // Le segment du mois de la transaction d'abord, toute l'archive si sa date a changé depuis
+        g_restore_transaction.id = 0;
+        archive_store_query(&g_archive, transaction->transaction_date, transaction->transaction_date, 0,
+                            transaction->id, copy_archived, &g_restore_transaction);
+        if (g_restore_transaction.id != transaction->id) {
+            archive_store_query(&g_archive, 0, 0, 0, transaction->id, copy_archived, &g_restore_transaction);
+        }
+        if (g_restore_transaction.id == transaction->id) {
             return SYSTEM_OK;
         }
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    system_error_t ret = undo_capture(undo, transaction->id, index);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    // L'ID du contact n'est repris que s'il désigne la même personne dans cet annuaire ;
+    // sinon le contact est retrouvé ou recréé à partir des coordonnées de la transaction
+    memcpy(&g_restore_transaction, transaction, sizeof(transaction_t));
+    const transaction_contact_t* contact = contact_directory_get(g_restore_transaction.counterpart_id);
+    if (contact == NULL || strcmp(contact->name, g_restore_transaction.counterpart_name) != 0) {
+        g_restore_transaction.counterpart_id = 0;
+    }
+    
+    transaction_record_t record;
+    ret = pack_transaction(&g_restore_transaction, &record);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    record.change_version = ++g_change_version;
+    
+    if (index >= 0) {
+        const transaction_record_t* previous = &g_transactions[index];
+        transaction_index_remove(previous->transaction_date, previous->animal_id, previous->contact_id, previous->id);
+        track_record(previous, -1);
+        release_record(previous);
+    } else {
+        if (g_transactions_count >= MAX_TRANSACTIONS) {
+            release_record(&record);
+            return SYSTEM_ERROR_MEMORY;
+        }
+        
+        // Insertion à sa place dans l'ordre des IDs
+        uint32_t pos = g_transactions_count;
+        while (pos > 0 && g_transactions[pos - 1].id > record.id) {
+            pos--;
+        }
+        memmove(&g_transactions[pos + 1], &g_transactions[pos],
+                (g_transactions_count - pos) * sizeof(transaction_record_t));
+        g_transactions_count++;
+        index = (int32_t)pos;
+    }
+    
+    undo->applied = true;
+    g_transactions[index] = record;
+    transaction_index_insert(record.transaction_date, record.animal_id, record.contact_id, record.id);
+    track_record(&record, 1);
+    report_compliance(&record);
+    if (record.id >= g_next_id) {
+        g_next_id = record.id + 1;
+    }
+    
+    return journal_put(&g_transactions[index], sequence);
 }
 
-system_error_t transaction_delete(uint32_t transaction_id)
+// Restauration par lots de modifications en attente : un lot est rendu durable par une seule écriture
+// du journal, et chaque transaction attend comme une modification la fin de celle qui la précède
+#define RESTORE_BATCH_ENTRIES   JOURNAL_MAX_WAITERS
+
+system_error_t transaction_restore(const transaction_t* transactions, uint32_t count)
+{
+    if (!g_initialized || transactions == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    transaction_undo_t undo[RESTORE_BATCH_ENTRIES];
+    
+    for (uint32_t i = 0; ret == SYSTEM_OK && i < count; ) {
+        uint32_t batch_count = 0;
+        uint32_t sequence = 0;
+        
+        // Le lot s'arrête à la première transaction encore en attente, y compris dans ce lot
+        lock_transaction(transactions[i].id);
+        do {
+            uint32_t record_sequence = 0;
+            memset(&undo[batch_count], 0, sizeof(transaction_undo_t));
+            ret = restore_locked(&transactions[i], &record_sequence, &undo[batch_count]);
+            batch_count++;
+            i++;
+            if (record_sequence != 0) {
+                sequence = record_sequence;
+            }
+        } while (ret == SYSTEM_OK && i < count && batch_count < RESTORE_BATCH_ENTRIES &&
+                 (!g_journal_enabled || (!is_pending(transactions[i].id) && g_pending_count < JOURNAL_MAX_WAITERS)));
+        xSemaphoreGive(g_mutex);
+        
+        // Le dernier enregistrement durable rend durables tous ceux qui le précèdent ; la transaction
+        // en échec est annulée avec son erreur
+        system_error_t journal_ret = journal_commit(sequence);
+        for (uint32_t k = 0; k < batch_count; k++) {
+            bool failed = (k == batch_count - 1 && ret != SYSTEM_OK);
+            system_error_t undo_ret = undo_finish(&undo[k], failed ? ret : journal_ret);
+            if (ret == SYSTEM_OK) {
+                ret = undo_ret;
+            }
+        }
+    }
+    
+    return ret;
+}
+
+uint32_t transaction_get_change_version(void)
 {
     if (!g_initialized) {
+        return 0;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    uint32_t version = g_change_version;
+    xSemaphoreGive(g_mutex);
+    
+    return version;
+}
+
+system_error_t transaction_for_each_changed(uint32_t since_version, transaction_visit_fn_t visit, void* context)
+{
+    if (!g_initialized || visit == NULL) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // Rechercher et supprimer la transaction
-    for (uint32_t i = 0; i < g_transactions_count; i++) {
-        if (g_transactions[i].id == transaction_id) {
-            // Décaler les éléments suivants
-            for (uint32_t j = i; j < g_transactions_count - 1; j++) {
-                memcpy(&g_transactions[j], &g_transactions[j + 1], sizeof(transaction_t));
+    transaction_t transaction;
+    system_error_t ret = SYSTEM_OK;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    if (since_version < g_archived_version) {
+        // Une transaction modifiée depuis n'est plus en mémoire
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    } else {
+        for (uint32_t i = 0; i < g_transactions_count; i++) {
+            if (g_transactions[i].change_version <= since_version) {
+                continue;
+            }
+            unpack_transaction(&g_transactions[i], &transaction);
+            if (!visit(&transaction, context)) {
+                break;
             }
-            g_transactions_count--;
-            
-            ESP_LOGI(TAG, "Transaction supprimée: ID=%" PRIu32, transaction_id);
-            return SYSTEM_OK;
         }
     }
+    xSemaphoreGive(g_mutex);
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    return ret;
 }
 
-system_error_t transaction_get_by_id(uint32_t transaction_id, transaction_t* transaction)
+system_error_t transaction_get_deletions(uint32_t since_version, record_deletion_t* deletions, uint32_t max_count,
+                                         uint32_t* count)
 {
-    if (!g_initialized || transaction == NULL) {
+    if (!g_initialized || deletions == NULL || count == NULL) {
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    for (uint32_t i = 0; i < g_transactions_count; i++) {
-        if (g_transactions[i].id == transaction_id) {
-            memcpy(transaction, &g_transactions[i], sizeof(transaction_t));
-            return SYSTEM_OK;
+    system_error_t ret = SYSTEM_OK;
+    *count = 0;
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    if (since_version < g_forgotten_version || since_version < g_archived_version) {
+        ret = SYSTEM_ERROR_NOT_FOUND;
+    } else {
+        for (uint32_t i = 0; i < g_deletions_count; i++) {
+            if (g_deletions[i].version <= since_version) {
+                continue;
+            }
+            if (*count >= max_count) {
+                ret = SYSTEM_ERROR_MEMORY;
+                break;
+            }
+            deletions[(*count)++] = g_deletions[i];
+        }
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return ret;
+}
+
+// Transaction ancienne, ou terminée depuis un certain temps
+static bool is_archivable(const transaction_record_t* record, time_t now)
+{
+    // Une modification en attente du journal peut encore être annulée
+    if (is_pending(record->id)) {
+        return false;
+    }
+    
+    bool terminal = (record->status == TRANSACTION_STATUS_COMPLETED || record->status == TRANSACTION_STATUS_CANCELLED ||
+                     record->status == TRANSACTION_STATUS_REFUNDED);
+    time_t age = now - record->transaction_date;
+    
+    if (terminal && age > (time_t)TRANSACTION_ARCHIVE_TERMINAL_DAYS * 24 * 3600) {
+        return true;
+    }
+    return age > (time_t)TRANSACTION_ARCHIVE_DAYS * 24 * 3600;
+}
+
+// Retire de la table les transactions archivables de [from, to) et renvoie la fin de la plage compactée
+static uint32_t remove_archived(uint32_t from, uint32_t to, time_t now, uint32_t* sequence)
+{
+    uint32_t kept = from;
+    
+    for (uint32_t i = from; i < to; i++) {
+        const transaction_record_t* record = &g_transactions[i];
+        if (!is_archivable(record, now)) {
+            g_transactions[kept++] = *record;
+            continue;
+        }
+        
+        // Les cumuls financiers restent acquis : ils sont relus dans le résumé du segment
+        if (record->change_version > g_archived_version) {
+            g_archived_version = record->change_version;
+        }
+        transaction_index_remove(record->transaction_date, record->animal_id, record->contact_id, record->id);
+        regulatory_transaction_removed(record->id);
+        journal_delete(record->id, sequence);
+        contact_directory_set_archived(record->contact_id);
+        release_record(record);
+    }
+    
+    memmove(&g_transactions[kept], &g_transactions[to], (g_transactions_count - to) * sizeof(transaction_record_t));
+    g_transactions_count -= to - kept;
+    return kept;
+}
+
+system_error_t transaction_archive_old(time_t now, uint32_t* archived_count)
+{
+    if (!g_initialized || !g_archive_enabled) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    system_error_t ret = SYSTEM_OK;
+    uint32_t sequence = 0;
+    uint32_t total = 0;
+    uint32_t scanned = 0;
+    
+    // Les modifications attendent la fin de la passe
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    
+    while (ret == SYSTEM_OK && scanned < g_transactions_count) {
+        // Lot limité par le tampon de l'archive
+        uint32_t batch_end = scanned;
+        uint32_t batch_count = 0;
+        for (; batch_end < g_transactions_count; batch_end++) {
+            const transaction_record_t* record = &g_transactions[batch_end];
+            if (!is_archivable(record, now)) {
+                continue;
+            }
+            
+            uint32_t keys[ARCHIVE_KEY_COUNT] = { record->id, record->animal_id, record->contact_id };
+            ret = archive_store_add(&g_archive, record->transaction_date, keys, g_journal_payload, encode_record(record));
+            if (ret != SYSTEM_OK) {
+                break;
+            }
+            batch_count++;
         }
+        
+        if (ret == SYSTEM_ERROR_MEMORY && batch_count > 0) {
+            ret = SYSTEM_OK;
+        }
+        if (ret != SYSTEM_OK || batch_count == 0) {
+            break;
+        }
+        
+        // Suppression seulement une fois le lot durable dans l'archive
+        ret = archive_store_commit(&g_archive);
+        if (ret == SYSTEM_OK) {
+            scanned = remove_archived(scanned, batch_end, now, &sequence);
+            total += batch_count;
+        }
+    }
+    
+    xSemaphoreGive(g_mutex);
+    
+    if (total > 0) {
+        ESP_LOGI(TAG, "%" PRIu32 " transactions archivées", total);
+        system_error_t journal_ret = journal_commit(sequence);
+        if (ret == SYSTEM_OK) {
+            ret = journal_ret;
+        }
+        journal_checkpoint();
+    }
+    if (archived_count != NULL) {
+        *archived_count = total;
+    }
+    
+    return ret;
+}
+
+system_error_t transaction_get_by_id(uint32_t transaction_id, transaction_t* transaction)
+{
+    if (!g_initialized || transaction == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    return SYSTEM_ERROR_NOT_FOUND;
+    return load_transaction(transaction_id, transaction);
 }
 
 system_error_t transaction_get_all(transaction_t* transactions, uint32_t max_count, uint32_t* count)
@@ -120,11 +1630,13 @@ system_error_t transaction_get_all(transaction_t* transactions, uint32_t max_cou
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     uint32_t copy_count = (g_transactions_count < max_count) ? g_transactions_count : max_count;
     
     for (uint32_t i = 0; i < copy_count; i++) {
-        memcpy(&transactions[i], &g_transactions[i], sizeof(transaction_t));
+        unpack_transaction(&g_transactions[i], &transactions[i]);
     }
+    xSemaphoreGive(g_mutex);
     
     *count = copy_count;
     return SYSTEM_OK;
@@ -137,19 +1649,103 @@ system_error_t transaction_get_by_animal(uint32_t animal_id, transaction_t* tran
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    uint32_t found_count = 0;
+    history_cursor_t cursor = { .key_slot = 1, .key = animal_id };
+    history_page_t page = { .transactions = transactions, .max_count = max_count };
     
-    for (uint32_t i = 0; i < g_transactions_count && found_count < max_count; i++) {
-        if (g_transactions[i].animal_id == animal_id) {
-            memcpy(&transactions[found_count], &g_transactions[i], sizeof(transaction_t));
-            found_count++;
-        }
+    return cursor_collect(&cursor, &page, count);
+}
+
+system_error_t transaction_get_by_contact(uint32_t contact_id, transaction_t* transactions,
+                                         uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || transactions == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    history_cursor_t cursor = { .key_slot = 2, .key = contact_id };
+    history_page_t page = { .transactions = transactions, .max_count = max_count };
+    
+    return cursor_collect(&cursor, &page, count);
+}
+
+static void fill_contact(const transaction_contact_t* source, transaction_contact_t* contact)
+{
+    *contact = *source;
+    transaction_index_contact_range(source->id, &contact->transaction_count);
+}
+
+system_error_t transaction_contact_get(uint32_t contact_id, transaction_contact_t* contact)
+{
+    if (!g_initialized || contact == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    *count = found_count;
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    const transaction_contact_t* found = contact_directory_get(contact_id);
+    if (found != NULL) {
+        fill_contact(found, contact);
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return (found != NULL) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+}
+
+system_error_t transaction_contact_find(const char* name_or_email, transaction_contact_t* contact)
+{
+    if (!g_initialized || name_or_email == NULL || contact == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    const transaction_contact_t* found = contact_directory_find(name_or_email);
+    if (found != NULL) {
+        fill_contact(found, contact);
+    }
+    xSemaphoreGive(g_mutex);
+    
+    return (found != NULL) ? SYSTEM_OK : SYSTEM_ERROR_NOT_FOUND;
+}
+
+system_error_t transaction_contact_get_all(transaction_contact_t* contacts, uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || contacts == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    *count = contact_directory_get_all(contacts, max_count);
+    for (uint32_t i = 0; i < *count; i++) {
+        transaction_index_contact_range(contacts[i].id, &contacts[i].transaction_count);
+    }
+    xSemaphoreGive(g_mutex);
+    
     return SYSTEM_OK;
 }
 
+system_error_t transaction_get_by_date_range(time_t start_date, time_t end_date, uint32_t offset,
+                                            transaction_t* transactions, uint32_t max_count, uint32_t* count)
+{
+    if (!g_initialized || transactions == NULL || count == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    history_cursor_t cursor = { .start_date = start_date, .end_date = end_date, .key_slot = -1 };
+    history_page_t page = { .transactions = transactions, .max_count = max_count, .skip = offset };
+    
+    return cursor_collect(&cursor, &page, count);
+}
+
+system_error_t transaction_for_each(time_t start_date, time_t end_date, transaction_visit_fn_t visit, void* context)
+{
+    if (!g_initialized || visit == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    history_cursor_t cursor = { .start_date = start_date, .end_date = end_date, .key_slot = -1 };
+    
+    return cursor_run(&cursor, visit, context);
+}
+
 system_error_t transaction_generate_certificate(uint32_t transaction_id, const char* certificate_type, 
                                                certificate_t* certificate)
 {
@@ -157,18 +1753,55 @@ system_error_t transaction_generate_certificate(uint32_t transaction_id, const c
         return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    // TODO: Implémenter la génération de certificats
+    transaction_t transaction;
+    system_error_t ret = load_transaction(transaction_id, &transaction);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
     memset(certificate, 0, sizeof(certificate_t));
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    certificate->id = g_next_certificate_id++;
+    xSemaphoreGive(g_mutex);
     certificate->transaction_id = transaction_id;
     certificate->issue_date = time(NULL);
     certificate->is_valid = true;
-    strncpy(certificate->certificate_type, certificate_type, sizeof(certificate->certificate_type) - 1);
+    snprintf(certificate->certificate_type, sizeof(certificate->certificate_type), "%s", certificate_type);
+    snprintf(certificate->certificate_number, sizeof(certificate->certificate_number), "CERT-%06" PRIu32, certificate->id);
+    snprintf(certificate->issuing_authority, sizeof(certificate->issuing_authority), "Établissement d'élevage");
+    
+    // Contenu produit directement dans le certificat à partir du modèle compilé
+    document_sink_t sink;
+    document_buffer_sink_t buffer;
+    document_sink_buffer(&sink, &buffer, certificate->content, sizeof(certificate->content));
+    ret = certificate_generator_render(&transaction, certificate, &sink);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    if (buffer.truncated) {
+        ESP_LOGW(TAG, "Certificat %s tronqué, utiliser transaction_render_certificate", certificate->certificate_number);
+    }
     
     ESP_LOGI(TAG, "Certificat généré pour transaction ID=%" PRIu32, transaction_id);
     
     return SYSTEM_OK;
 }
 
+system_error_t transaction_render_certificate(const certificate_t* certificate, const document_sink_t* sink)
+{
+    if (!g_initialized || certificate == NULL || sink == NULL) {
+        return SYSTEM_ERROR_INVALID_PARAM;
+    }
+    
+    transaction_t transaction;
+    system_error_t ret = load_transaction(certificate->transaction_id, &transaction);
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
+    return certificate_generator_render(&transaction, certificate, sink);
+}
+
 system_error_t transaction_validate(const transaction_t* transaction, bool* is_valid, 
                                    char* error_message, size_t error_message_size)
 {
@@ -194,29 +1827,67 @@ system_error_t transaction_get_financial_stats(financial_stats_t* stats)
     
     memset(stats, 0, sizeof(financial_stats_t));
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
     stats->total_transactions = g_transactions_count;
+    if (g_archive_enabled) {
+        stats->total_transactions += archive_store_count(&g_archive);
+    }
     
-    // Calculer les statistiques financières
-    for (uint32_t i = 0; i < g_transactions_count; i++) {
-        if (g_transactions[i].type == TRANSACTION_TYPE_SALE) {
-            stats->sales_count++;
-            stats->total_sales_amount += g_transactions[i].amount;
-        } else if (g_transactions[i].type == TRANSACTION_TYPE_PURCHASE) {
-            stats->purchases_count++;
-            stats->total_purchases_amount += g_transactions[i].amount;
-        }
+    // Lecture directe des cumuls (transactions terminées uniquement)
+    financial_summary_t totals;
+    financial_tracker_get_summary(0, 0, &totals);
+    stats->sales_count = totals.count_by_type[TRANSACTION_TYPE_SALE];
+    stats->purchases_count = totals.count_by_type[TRANSACTION_TYPE_PURCHASE];
+    stats->total_sales_amount = totals.amount_by_type[TRANSACTION_TYPE_SALE];
+    stats->total_purchases_amount = totals.amount_by_type[TRANSACTION_TYPE_PURCHASE];
+    stats->average_sale_price = totals.average_by_type[TRANSACTION_TYPE_SALE];
+    stats->average_purchase_price = totals.average_by_type[TRANSACTION_TYPE_PURCHASE];
+    stats->net_profit = totals.net_profit;
+    
+    time_t now = time(NULL);
+    struct tm now_tm;
+    localtime_r(&now, &now_tm);
+    
+    financial_summary_t month;
+    financial_tracker_get_summary(now_tm.tm_year + 1900, now_tm.tm_mon + 1, &month);
+    for (uint32_t t = 0; t < TRANSACTION_TYPE_COUNT; t++) {
+        stats->transactions_this_month += month.count_by_type[t];
     }
+    stats->revenue_this_month = month.amount_by_type[TRANSACTION_TYPE_SALE];
     
-    stats->net_profit = stats->total_sales_amount - stats->total_purchases_amount;
+    uint32_t all_count;
+    const transaction_date_entry_t* all = transaction_index_range(0, 0, &all_count);
+    if (all_count > 0) {
+        stats->last_transaction_date = all[all_count - 1].transaction_date;
+    }
+    xSemaphoreGive(g_mutex);
     
-    if (stats->sales_count > 0) {
-        stats->average_sale_price = stats->total_sales_amount / stats->sales_count;
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_get_monthly_summary(uint16_t year, uint8_t month, financial_summary_t* summary)
+{
+    if (!g_initialized || summary == NULL || year == 0 || month < 1 || month > 12) {
+        return SYSTEM_ERROR_INVALID_PARAM;
     }
     
-    if (stats->purchases_count > 0) {
-        stats->average_purchase_price = stats->total_purchases_amount / stats->purchases_count;
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    financial_tracker_get_summary(year, month, summary);
+    xSemaphoreGive(g_mutex);
+    
+    return SYSTEM_OK;
+}
+
+system_error_t transaction_get_yearly_summary(uint16_t year, financial_summary_t* summary)
+{
+    if (!g_initialized || summary == NULL || year == 0) {
+        return SYSTEM_ERROR_INVALID_PARAM;
     }
     
+    xSemaphoreTake(g_mutex, portMAX_DELAY);
+    financial_tracker_get_summary(year, 0, summary);
+    xSemaphoreGive(g_mutex);
+    
     return SYSTEM_OK;
 }
 
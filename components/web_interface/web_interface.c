@@ -1,4 +1,5 @@
 #include "web_interface.h"
+#include "data_export.h"
 #include "esp_log.h"
 #include "esp_http_server.h"
 #include "esp_wifi.h"
@@ -8,6 +9,7 @@
 #include "nvs_flash.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <inttypes.h>
 
 static const char* TAG = "WEB_INTERFACE";
@@ -106,6 +108,161 @@ static esp_err_t api_status_handler(httpd_req_t *req)
     return httpd_resp_send(req, json_response, HTTPD_RESP_USE_STRLEN);
 }
 
+// Réponse HTTP alimentée par un export diffusé
+typedef struct {
+    httpd_req_t* req;
+    bool started;
+} http_stream_t;
+
+static bool send_chunk(const char* data, size_t length, void* context)
+{
+    http_stream_t* stream = (http_stream_t*)context;
+    stream->started = true;
+    return httpd_resp_send_chunk(stream->req, data, (ssize_t)length) == ESP_OK;
+}
+
+// Handler pour les exports JSON (/api/animals, /api/transactions), envoyés par morceaux
+static esp_err_t api_export_handler(httpd_req_t *req)
+{
+    export_type_t type = (export_type_t)(intptr_t)req->user_ctx;
+    http_stream_t stream = { .req = req, .started = false };
+    
+    httpd_resp_set_type(req, "application/json");
+    system_error_t ret = data_export_stream(type, EXPORT_FORMAT_JSON, 0, 0, send_chunk, &stream);
+    if (ret != SYSTEM_OK) {
+        ESP_LOGW(TAG, "Export %s interrompu: %d", req->uri, ret);
+        if (!stream.started) {
+            return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Export indisponible");
+        }
+        // Réponse déjà commencée : fermer la connexion signale au client un document incomplet
+        return ESP_FAIL;
+    }
+    
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static const char* const k_export_types[] = { "animals", "terrariums", "stocks", "transactions" };
+static const char* const k_export_formats[] = { "csv", "json", "pdf" };
+
+static bool query_code(const char* query, const char* key, const char* const* codes, uint32_t count, uint32_t* index)
+{
+    char value[16];
+    
+    if (httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if (strcmp(value, codes[i]) == 0) {
+            *index = i;
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+static uint32_t query_uint(const char* query, const char* key)
+{
+    char value[16];
+    
+    if (httpd_query_key_value(query, key, value, sizeof(value)) != ESP_OK) {
+        return 0;
+    }
+    return (uint32_t)strtoul(value, NULL, 10);
+}
+
+static esp_err_t send_json(httpd_req_t *req, const char* status, const char* json)
+{
+    httpd_resp_set_status(req, status);
+    httpd_resp_set_type(req, "application/json");
+    return httpd_resp_send(req, json, HTTPD_RESP_USE_STRLEN);
+}
+
+// POST /api/exports?type=transactions&format=pdf[&start=...&end=...] : mise en file, réponse immédiate
+static esp_err_t api_export_start_handler(httpd_req_t *req)
+{
+    char query[128] = {0};
+    uint32_t type;
+    uint32_t format;
+    
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (!query_code(query, "type", k_export_types, sizeof(k_export_types) / sizeof(k_export_types[0]), &type) ||
+        !query_code(query, "format", k_export_formats, sizeof(k_export_formats) / sizeof(k_export_formats[0]),
+                    &format)) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Type ou format d'export inconnu");
+    }
+    
+    export_params_t params = {
+        .type = (export_type_t)type,
+        .format = (export_format_t)format,
+        .start_date = (time_t)query_uint(query, "start"),
+        .end_date = (time_t)query_uint(query, "end"),
+        .compress = true
+    };
+    snprintf(params.output_path, sizeof(params.output_path), EXPORT_DIRECTORY "/%s.%s",
+             k_export_types[type], k_export_formats[format]);
+    
+    uint32_t export_id;
+    system_error_t ret = data_export_start(&params, &export_id);
+    if (ret == SYSTEM_ERROR_TIMEOUT) {
+        return send_json(req, "503 Service Unavailable", "{\"error\": \"busy\"}");
+    }
+    if (ret != SYSTEM_OK) {
+        return send_json(req, "409 Conflict", "{\"error\": \"rejected\"}");
+    }
+    
+    char json_response[64];
+    snprintf(json_response, sizeof(json_response), "{\"id\": %" PRIu32 "}", export_id);
+    return send_json(req, "202 Accepted", json_response);
+}
+
+// GET /api/exports?id=N : avancement d'un export
+static esp_err_t api_export_status_handler(httpd_req_t *req)
+{
+    char query[32] = {0};
+    export_status_t status;
+    
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (data_export_get_status(query_uint(query, "id"), &status) != SYSTEM_OK) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Export inconnu");
+    }
+    
+    const char* state = !status.is_complete ? ((status.start_time == 0) ? "queued" : "running") :
+                        status.is_cancelled ? "cancelled" : status.has_error ? "failed" : "done";
+    char json_response[512];
+    snprintf(json_response, sizeof(json_response),
+        "{"
+        "\"id\": %" PRIu32 ","
+        "\"state\": \"%s\","
+        "\"records_processed\": %" PRIu32 ","
+        "\"total_records\": %" PRIu32 ","
+        "\"file\": \"%s\","
+        "\"file_size\": %u"
+        "}",
+        status.export_id,
+        state,
+        status.records_processed,
+        status.total_records,
+        status.output_file,
+        (unsigned)status.file_size
+    );
+    
+    return send_json(req, "200 OK", json_response);
+}
+
+// DELETE /api/exports?id=N : annulation
+static esp_err_t api_export_cancel_handler(httpd_req_t *req)
+{
+    char query[32] = {0};
+    
+    httpd_req_get_url_query_str(req, query, sizeof(query));
+    if (data_export_cancel(query_uint(query, "id")) != SYSTEM_OK) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Export inconnu");
+    }
+    
+    return send_json(req, "200 OK", "{\"status\": \"ok\"}");
+}
+
 // Configuration des URI handlers
 static const httpd_uri_t root_uri = {
     .uri       = "/",
@@ -121,12 +278,48 @@ static const httpd_uri_t api_status_uri = {
     .user_ctx  = NULL
 };
 
+static const httpd_uri_t api_animals_uri = {
+    .uri       = "/api/animals",
+    .method    = HTTP_GET,
+    .handler   = api_export_handler,
+    .user_ctx  = (void*)EXPORT_TYPE_ANIMALS
+};
+
+static const httpd_uri_t api_transactions_uri = {
+    .uri       = "/api/transactions",
+    .method    = HTTP_GET,
+    .handler   = api_export_handler,
+    .user_ctx  = (void*)EXPORT_TYPE_TRANSACTIONS
+};
+
+static const httpd_uri_t api_export_start_uri = {
+    .uri       = "/api/exports",
+    .method    = HTTP_POST,
+    .handler   = api_export_start_handler,
+    .user_ctx  = NULL
+};
+
+static const httpd_uri_t api_export_status_uri = {
+    .uri       = "/api/exports",
+    .method    = HTTP_GET,
+    .handler   = api_export_status_handler,
+    .user_ctx  = NULL
+};
+
+static const httpd_uri_t api_export_cancel_uri = {
+    .uri       = "/api/exports",
+    .method    = HTTP_DELETE,
+    .handler   = api_export_cancel_handler,
+    .user_ctx  = NULL
+};
+
 static httpd_handle_t start_webserver(void)
 {
     httpd_handle_t server = NULL;
     httpd_config_t config = HTTPD_DEFAULT_CONFIG();
     config.lru_purge_enable = true;
     config.server_port = 80;
+    config.stack_size = WEB_SERVER_STACK_SIZE;
     
     ESP_LOGI(TAG, "Démarrage serveur HTTP sur port %d", config.server_port);
     
@@ -134,6 +327,11 @@ static httpd_handle_t start_webserver(void)
         ESP_LOGI(TAG, "Enregistrement des URI handlers");
         httpd_register_uri_handler(server, &root_uri);
         httpd_register_uri_handler(server, &api_status_uri);
+        httpd_register_uri_handler(server, &api_animals_uri);
+        httpd_register_uri_handler(server, &api_transactions_uri);
+        httpd_register_uri_handler(server, &api_export_start_uri);
+        httpd_register_uri_handler(server, &api_export_status_uri);
+        httpd_register_uri_handler(server, &api_export_cancel_uri);
         return server;
     }
     
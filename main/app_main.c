@@ -37,6 +37,13 @@ static void backup_timer_callback(void* arg)
 {
     ESP_LOGI(TAG, "Sauvegarde automatique déclenchée");
     
+    // Écrite par une tâche d'export : incrément de la chaîne en cours, ou nouvelle sauvegarde complète
+    uint32_t export_id;
+    if (data_export_auto_backup(&export_id) != SYSTEM_OK) {
+        ESP_LOGW(TAG, "Sauvegarde automatique non mise en file");
+        return;
+    }
+    
     system_event_t event = {
         .type = EVENT_BACKUP_COMPLETED,
         .timestamp = time(NULL),
@@ -119,6 +126,14 @@ system_error_t app_init(void)
         return ret;
     }
     
+    // La conformité précède les gestionnaires qui lui signalent leurs modifications
+    ESP_LOGI(TAG, "Initialisation conformité réglementaire...");
+    ret = regulatory_compliance_init();
+    if (ret != SYSTEM_OK) {
+        ESP_LOGE(TAG, "Échec initialisation conformité réglementaire");
+        return ret;
+    }
+    
     ESP_LOGI(TAG, "Initialisation gestionnaire d'animaux...");
     ret = animals_manager_init();
     if (ret != SYSTEM_OK) {
@@ -147,13 +162,6 @@ system_error_t app_init(void)
         return ret;
     }
     
-    ESP_LOGI(TAG, "Initialisation conformité réglementaire...");
-    ret = regulatory_compliance_init();
-    if (ret != SYSTEM_OK) {
-        ESP_LOGE(TAG, "Échec initialisation conformité réglementaire");
-        return ret;
-    }
-    
     ESP_LOGI(TAG, "Initialisation export de données...");
     ret = data_export_init();
     if (ret != SYSTEM_OK) {
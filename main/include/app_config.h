@@ -13,6 +13,7 @@
 #define SCREEN_WIDTH            800
 #define SCREEN_HEIGHT           480
 #define SCREEN_BPP              16
+#define LVGL_TASK_CORE          1             // Cœur réservé au rendu de l'interface
 
 // Configuration tactile GT911
 #define TOUCH_I2C_PORT          I2C_NUM_0
@@ -38,10 +39,40 @@
 // Configuration serveur web
 #define WEB_SERVER_PORT         80
 #define WEB_SERVER_MAX_CLIENTS  4
+#define WEB_SERVER_STACK_SIZE   8192          // Les exports diffusés décodent une transaction sur la pile
 
 // Configuration stockage
 #define STORAGE_MOUNT_POINT     "/storage"
+// Fichiers ouverts simultanément au pire : journal des transactions et magasin de documents (2),
+// point de reprise du journal (1), archivage en cours (1), export en tâche de fond avec son fichier
+// de renvois PDF et une archive lue (3), export diffusé par le serveur web (1), plus une marge de 2
+#define STORAGE_MAX_OPEN_FILES  10
+#define TRANSACTION_JOURNAL_PATH STORAGE_MOUNT_POINT "/txn.wal"
+#define JOURNAL_GROUP_COMMIT_MS 5             // Fenêtre de regroupement des écritures
+#define JOURNAL_BUFFER_SIZE     (16 * 1024)   // Tampon des enregistrements en attente
+#define JOURNAL_CHECKPOINT_SIZE (512 * 1024)  // Taille du journal déclenchant un point de reprise
+#define JOURNAL_MAX_WAITERS     8             // Tâches en attente de durabilité
+#define ARCHIVE_DIRECTORY       STORAGE_MOUNT_POINT "/archive"
+#define ARCHIVE_MAX_SEGMENTS    240           // Segments mensuels par archive
+#define ARCHIVE_MAX_BLOCKS      512           // Blocs par segment
+#define ARCHIVE_BLOCK_SIZE      (8 * 1024)    // Bloc décompressé
+#define ARCHIVE_PENDING_SIZE    (128 * 1024)  // Lot en attente d'archivage (PSRAM)
+#define ARCHIVE_INTERVAL_MS     (6 * 60 * 60 * 1000)  // 6 heures
 #define BACKUP_INTERVAL_MS      (30 * 60 * 1000)  // 30 minutes
+#define EXPORT_BUFFER_SIZE      4096          // Tampon d'écriture des exports : un cluster FAT (allocation_unit_size)
+#define PDF_PAGE_BUFFER_SIZE    (32 * 1024)   // Contenu d'une page PDF avant compression (PSRAM)
+#define EXPORT_DIRECTORY        STORAGE_MOUNT_POINT "/exports"
+#define EXPORT_QUEUE_LENGTH     4             // Exports en attente d'une tâche d'export
+#define EXPORT_MAX_JOBS         8             // Exports suivis (en attente, en cours et derniers terminés)
+#define EXPORT_WORKER_COUNT     1             // Exports exécutés simultanément
+#define EXPORT_TASK_STACK_SIZE  8192          // Une transaction est décodée sur la pile
+#define EXPORT_TASK_PRIORITY    2             // Sous l'interface, les capteurs et le serveur web
+#define EXPORT_TASK_CORE        0             // Hors du cœur de LVGL
+#define BACKUP_DIRECTORY        STORAGE_MOUNT_POINT "/backups"
+#define BACKUP_BLOCK_SIZE       (32 * 1024)   // Enregistrements bruts par bloc de sauvegarde (PSRAM)
+#define BACKUP_MAX_INCREMENTS   12            // Incréments avant une nouvelle sauvegarde complète
+#define BACKUP_KEEP_CHAINS      2             // Chaînes (complète et incréments) gardées par la sauvegarde automatique
+#define CHANGE_LOG_DELETIONS    64            // Suppressions retenues par gestionnaire pour les incréments
 
 // Configuration capteurs
 #define MAX_TERRARIUMS          16
@@ -52,15 +83,49 @@
 #define MAX_ANIMALS             100
 #define MAX_SPECIES_NAME_LEN    64
 #define MAX_NOTES_LEN           512
+#define MAX_ANIMAL_EVENTS       512           // Événements récents en mémoire (PSRAM)
+#define EVENT_ARCHIVE_DAYS      90            // Au-delà, les événements sont archivés
+#define EVENT_ARCHIVE_PATH      ARCHIVE_DIRECTORY "/events"
 
 // Configuration stocks
 #define MAX_STOCK_ITEMS         200
 #define MAX_ITEM_NAME_LEN       64
+#define STOCK_NEAR_EXPIRY_DAYS  30
+#define MAX_STOCK_MOVEMENTS     1000
+#define MAX_STOCK_LOTS          600
+#define STOCK_BATCH_MAX_LINES   32
+#define MAX_SUPPLIERS           32
+#define MAX_SUPPLIER_OFFERS     1024  // Prix courant par couple (article, fournisseur)
+#define MAX_PRICE_HISTORY       1000
+#define STOCK_PO_MAX_LINES      64
+#define STOCK_FORECAST_ALPHA    0.2f  // Lissage de la consommation journalière
+#define STOCK_FORECAST_COVERAGE_DAYS 14
 
 // Configuration transactions
-#define MAX_TRANSACTIONS        500
+#define MAX_TRANSACTIONS        5000
+#define TRANSACTION_ARENA_SIZE  (512 * 1024)  // Textes des transactions (PSRAM)
+#define TRANSACTION_ARENA_SLOTS 16384         // Table de déduplication (puissance de 2)
+#define FINANCE_MAX_MONTHS      240           // Cumuls financiers mensuels conservés
+#define MAX_CONTACTS            256           // Annuaire des contreparties
+#define TRANSACTION_ARCHIVE_DAYS 730          // Au-delà, toute transaction est archivée
+#define TRANSACTION_ARCHIVE_TERMINAL_DAYS 90  // Transactions terminées, annulées ou remboursées
+#define TRANSACTION_ARCHIVE_PATH ARCHIVE_DIRECTORY "/txn"
+#define TRANSACTION_READ_BUFFER (6 * 1024)  // Transactions copiées à la fois sous le verrou par les parcours
 #define MAX_CERTIFICATE_LEN     1024
 
+// Configuration conformité
+#define REGULATORY_MAX_RULES    64            // Règles compilées par sujet (animal, transaction)
+#define REGULATORY_RULE_TEXT_SIZE 2048        // Textes des manquements
+#define REGULATORY_RULES_PATH   STORAGE_MOUNT_POINT "/rules.txt"  // Règles complémentaires (facultatif)
+#define SPECIES_MATCH_MIN_CONFIDENCE 75       // Seuil de la reconnaissance approchée des noms d'espèces (%)
+#define REGULATORY_MAX_DOCUMENTS 1024         // En-têtes de documents en mémoire (PSRAM)
+#define REGULATORY_DOCUMENT_PATH STORAGE_MOUNT_POINT "/documents.dat"  // Contenu complet des documents
+#define DOCUMENT_RENEWAL_DAYS   30            // Alerte de renouvellement avant l'échéance
+#define REGISTER_CHUNK_SIZE     1024          // Blocs d'écriture du registre d'élevage (multiple d'un secteur)
+#define REGISTER_BATCH_SIZE     4             // Lignes lues à la fois dans chaque source
+#define REGISTER_LINE_SIZE      512           // Mise en forme d'une ligne
+#define COMPLIANCE_SWEEP_INTERVAL_MS (24 * 60 * 60 * 1000)  // Vérification complète de sécurité
+
 // Configuration sécurité
 #define SESSION_TIMEOUT_MS      (60 * 60 * 1000)  // 1 heure
 #define MAX_LOGIN_ATTEMPTS      3
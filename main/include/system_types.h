@@ -18,6 +18,12 @@ typedef enum {
     SYSTEM_ERROR_NETWORK = -7
 } system_error_t;
 
+// Suppression d'un enregistrement, datée par la version de changement de son gestionnaire
+typedef struct {
+    uint32_t id;
+    uint32_t version;
+} record_deletion_t;
+
 // État du système
 typedef enum {
     SYSTEM_STATE_INIT,
@@ -37,6 +43,7 @@ typedef enum {
     EVENT_ANIMAL_UPDATED,
     EVENT_TRANSACTION_CREATED,
     EVENT_STOCK_LOW,
+    EVENT_DOCUMENT_EXPIRING,
     EVENT_BACKUP_COMPLETED,
     EVENT_USER_LOGIN,
     EVENT_USER_LOGOUT,
@@ -11,6 +11,9 @@
 
 #include "app_main.h"
 #include "system_init.h"
+#include "transaction_manager.h"
+#include "animals_manager.h"
+#include "regulatory_compliance.h"
 
 static const char* TAG = "MAIN";
 
@@ -54,6 +57,8 @@ void app_main(void)
     ESP_LOGI(TAG, "Système démarré avec succès");
     
     // Boucle principale
+    uint32_t archive_elapsed_ms = 0;
+    uint32_t sweep_elapsed_ms = 0;
     while (1) {
         vTaskDelay(pdMS_TO_TICKS(1000));
         
@@ -62,5 +67,23 @@ void app_main(void)
         if (free_heap < MIN_FREE_HEAP_SIZE) {
             ESP_LOGW(TAG, "Mémoire faible: %d bytes", free_heap);
         }
+        
+        // Passe d'archivage : transactions et événements anciens quittent la mémoire
+        archive_elapsed_ms += 1000;
+        if (archive_elapsed_ms >= ARCHIVE_INTERVAL_MS) {
+            archive_elapsed_ms = 0;
+            time_t now = time(NULL);
+            transaction_archive_old(now, NULL);
+            animals_archive_events(now);
+        }
+        
+        // Conformité : seuls les animaux modifiés sont réévalués, la vérification complète reste rare
+        regulatory_process_changes();
+        regulatory_check_document_expiry();
+        sweep_elapsed_ms += 1000;
+        if (sweep_elapsed_ms >= COMPLIANCE_SWEEP_INTERVAL_MS) {
+            sweep_elapsed_ms = 0;
+            regulatory_check_all_compliance();
+        }
     }
 }
\ No newline at end of file
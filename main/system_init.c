@@ -2,6 +2,8 @@
 #include "esp_log.h"
 #include "esp_err.h"
 #include "nvs_flash.h"
+#include "esp_vfs_fat.h"
+#include "wear_levelling.h"
 #include "esp_netif.h"
 #include "esp_event.h"
 #include "esp_timer.h"
@@ -29,6 +31,25 @@ static system_error_t init_nvs(void)
     return SYSTEM_OK;
 }
 
+static system_error_t init_storage(void)
+{
+    static wl_handle_t wl_handle = WL_INVALID_HANDLE;
+    const esp_vfs_fat_mount_config_t mount_config = {
+        .format_if_mount_failed = true,
+        .max_files = STORAGE_MAX_OPEN_FILES,
+        .allocation_unit_size = CONFIG_WL_SECTOR_SIZE
+    };
+    
+    esp_err_t ret = esp_vfs_fat_spiflash_mount_rw_wl(STORAGE_MOUNT_POINT, "storage", &mount_config, &wl_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Échec montage stockage: %s", esp_err_to_name(ret));
+        return SYSTEM_ERROR;
+    }
+    
+    ESP_LOGI(TAG, "Stockage monté sur %s", STORAGE_MOUNT_POINT);
+    return SYSTEM_OK;
+}
+
 static system_error_t init_network(void)
 {
     esp_err_t ret = esp_netif_init();
@@ -135,6 +156,12 @@ system_error_t system_init(void)
         return ret;
     }
     
+    // Montage du stockage (journal des transactions)
+    ret = init_storage();
+    if (ret != SYSTEM_OK) {
+        return ret;
+    }
+    
     // Initialisation réseau
     ret = init_network();
     if (ret != SYSTEM_OK) {
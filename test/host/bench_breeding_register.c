@@ -0,0 +1,102 @@
+// Registre d'élevage sur dix ans pour 2 000 animaux : durée et pic d'occupation du tas
+#include "host_test.h"
+#include "regulatory_compliance.h"
+#include "animals_manager.h"
+#include "transaction_manager.h"
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+#define ANIMAL_COUNT        2000
+#define HISTORY_SECONDS     (10L * 365 * 86400)
+#define MAX_REGISTER_HEAP   (8 * 1024)
+
+static const char* const SPECIES[] = {
+    "Python regius", "Pogona vitticeps", "Testudo hermanni", "Eublepharis macularius", "Trachemys scripta elegans"
+};
+
+// Cheptel de dix ans : entrées, naissances, décès, ventes et achats, dont une partie archivée
+static void populate(time_t now)
+{
+    time_t start = now - HISTORY_SECONDS;
+    srand(1);
+    
+    for (uint32_t i = 0; i < ANIMAL_COUNT; i++) {
+        animal_t animal = {0};
+        snprintf(animal.name, sizeof(animal.name), "Animal-%u", i);
+        strcpy(animal.species, SPECIES[i % 5]);
+        animal.birth_date = start + rand() % HISTORY_SECONDS;
+        animal.acquisition_date = (i % 3) ? start + rand() % HISTORY_SECONDS : 0;
+        snprintf(animal.microchip_id, sizeof(animal.microchip_id), "250%09u", i);
+        strcpy(animal.origin, (i % 7) ? "Élevage \"Dupont\"; Lyon" : "");
+        CHECK(animals_add(&animal) == SYSTEM_OK);
+        
+        time_t base = animal.acquisition_date ? animal.acquisition_date : animal.birth_date;
+        if (i % 4 == 0) {
+            transaction_t sale = {0};
+            sale.type = TRANSACTION_TYPE_SALE;
+            sale.status = TRANSACTION_STATUS_COMPLETED;
+            sale.animal_id = animal.id;
+            strcpy(sale.animal_name, animal.name);
+            strcpy(sale.animal_species, animal.species);
+            snprintf(sale.counterpart_name, sizeof(sale.counterpart_name), "Client %u", i % 50);
+            sale.transaction_date = base + (now - base) / 2;
+            strcpy(sale.cites_permit_number, "FR-(1)");
+            CHECK(transaction_create(&sale) == SYSTEM_OK);
+        } else if (i % 10 == 1) {
+            animal_event_t death = {0};
+            death.animal_id = animal.id;
+            death.event_date = base + (now - base) / 3;
+            strcpy(death.event_type, "death");
+            strcpy(death.description, "Vieillesse");
+            CHECK(animals_add_event(&death) == SYSTEM_OK);
+        }
+        if (i % 20 == 2) {
+            transaction_t purchase = {0};
+            purchase.type = TRANSACTION_TYPE_PURCHASE;
+            purchase.status = TRANSACTION_STATUS_COMPLETED;
+            strcpy(purchase.animal_species, "Python regius");
+            purchase.transaction_date = start + rand() % HISTORY_SECONDS;
+            CHECK(transaction_create(&purchase) == SYSTEM_OK);
+        }
+    }
+    
+    uint32_t archived = 0;
+    CHECK(transaction_archive_old(now, &archived) == SYSTEM_OK);
+    CHECK(animals_archive_events(now) == SYSTEM_OK);
+}
+
+static void measure(const char* format)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/registre.%s", STORAGE_MOUNT_POINT, format);
+    
+    size_t base = host_heap_in_use();
+    host_heap_reset_peak();
+    double start = host_seconds();
+    CHECK(regulatory_generate_breeding_register(path, format) == SYSTEM_OK);
+    double elapsed = host_seconds() - start;
+    size_t peak = host_heap_peak() - base;
+    
+    struct stat st;
+    CHECK(stat(path, &st) == 0);
+    printf("Registre %s : %ld octets en %.1f ms, pic du tas %zu octets\n",
+           format, (long)st.st_size, elapsed * 1000.0, peak);
+    CHECK(peak <= MAX_REGISTER_HEAP);
+    CHECK(host_heap_in_use() == base);
+}
+
+int main(void)
+{
+    host_storage_reset();
+    CHECK(regulatory_compliance_init() == SYSTEM_OK);
+    CHECK(animals_manager_init() == SYSTEM_OK);
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    
+    populate(time(NULL));
+    measure("csv");
+    measure("pdf");
+    
+    printf("bench_breeding_register: OK\n");
+    return 0;
+}
\ No newline at end of file
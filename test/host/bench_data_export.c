@@ -0,0 +1,219 @@
+// Exports de 10 000 transactions (table chaude et archive) : débit et pic d'occupation du tas
+#include "host_test.h"
+#include "data_export.h"
+#include "regulatory_compliance.h"
+#include "animals_manager.h"
+#include "stock_manager.h"
+#include "terrarium_monitor.h"
+#include "transaction_manager.h"
+#include "pdf_generator.h"
+#include <string.h>
+#include <time.h>
+
+#define TRANSACTION_COUNT   10000
+#define HISTORY_DAYS        (5 * 365)
+#define MAX_EXPORT_HEAP     (16 * 1024)
+#define MAX_PDF_HEAP        (96 * 1024)     // Page, page compressée et table de hachage DEFLATE
+
+// Transactions sur cinq ans, archivées au fil de l'eau comme sur la cible
+static void populate(time_t now)
+{
+    srand(7);
+    
+    for (uint32_t i = 0; i < TRANSACTION_COUNT; i++) {
+        transaction_t transaction = {0};
+        transaction.type = (transaction_type_t)(i % 7);
+        transaction.status = TRANSACTION_STATUS_COMPLETED;
+        transaction.amount = (float)(rand() % 100000) / 100.0f;
+        strcpy(transaction.currency, "EUR");
+        snprintf(transaction.counterpart_name, sizeof(transaction.counterpart_name), "Client %u; \"VIP\"", i % 40);
+        strcpy(transaction.counterpart_address, "12 rue des Lézards, 69000 Lyon");
+        strcpy(transaction.animal_species, "Pogona vitticeps");
+        snprintf(transaction.notes, sizeof(transaction.notes), "Note %u", i);
+        transaction.transaction_date = now - (time_t)(rand() % HISTORY_DAYS) * 86400;
+        CHECK(transaction_create(&transaction) == SYSTEM_OK);
+        
+        if (i % 2000 == 1999) {
+            uint32_t archived = 0;
+            CHECK(transaction_archive_old(now, &archived) == SYSTEM_OK);
+        }
+    }
+}
+
+static long count_lines(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    
+    long lines = 0;
+    for (int c; (c = fgetc(file)) != EOF; ) {
+        lines += (c == '\n');
+    }
+    fclose(file);
+    return lines;
+}
+
+// Export de toutes les transactions vers un fichier ; renvoie la taille produite
+static long measure(export_format_t format, const char* name, double* elapsed, size_t* peak)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "%s/%s", STORAGE_MOUNT_POINT, name);
+    
+    size_t base = host_heap_in_use();
+    host_heap_reset_peak();
+    double start = host_seconds();
+    CHECK(data_export_transactions(format, path, 0, 0) == SYSTEM_OK);
+    *elapsed = host_seconds() - start;
+    *peak = host_heap_peak() - base;
+    CHECK(host_heap_in_use() == base);
+    
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+static void bench_csv(void)
+{
+    double elapsed;
+    size_t peak;
+    long size = measure(EXPORT_FORMAT_CSV, "transactions.csv", &elapsed, &peak);
+    
+    // Une ligne d'en-tête puis une ligne par transaction
+    CHECK(count_lines(STORAGE_MOUNT_POINT "/transactions.csv") == TRANSACTION_COUNT + 1);
+    printf("CSV : %u lignes, %ld octets en %.1f ms (%.0f lignes/s), pic du tas %zu octets\n",
+           TRANSACTION_COUNT, size, elapsed * 1000.0, TRANSACTION_COUNT / elapsed, peak);
+    CHECK(peak <= MAX_EXPORT_HEAP);
+}
+
+// Destination diffusée : le flux est comparé au fichier produit par l'export JSON
+typedef struct {
+    FILE* expected;
+    size_t length;
+    size_t stamp_start;     // Valeur de generated_at, propre à chaque export
+    size_t stamp_end;
+    bool matches;
+} stream_check_t;
+
+static bool compare_sink(const char* data, size_t length, void* context)
+{
+    stream_check_t* check = context;
+    char block[4096];
+    
+    for (size_t done = 0; done < length; ) {
+        size_t part = (length - done < sizeof(block)) ? length - done : sizeof(block);
+        if (fread(block, 1, part, check->expected) != part) {
+            check->matches = false;
+        }
+        for (size_t i = 0; memcmp(block, data + done, part) != 0 && i < part; i++) {
+            size_t offset = check->length + done + i;
+            if (block[i] != data[done + i] && (offset < check->stamp_start || offset >= check->stamp_end)) {
+                check->matches = false;
+            }
+        }
+        done += part;
+    }
+    check->length += length;
+    return true;
+}
+
+static void bench_json(void)
+{
+    double elapsed;
+    size_t peak;
+    long size = measure(EXPORT_FORMAT_JSON, "transactions.json", &elapsed, &peak);
+    printf("JSON fichier : %ld octets en %.1f ms, pic du tas %zu octets\n", size, elapsed * 1000.0, peak);
+    CHECK(peak <= MAX_EXPORT_HEAP);
+    
+    stream_check_t check = { fopen(STORAGE_MOUNT_POINT "/transactions.json", "rb"), 0, 0, 0, true };
+    CHECK(check.expected != NULL);
+    char header[128] = {0};
+    CHECK(fread(header, 1, sizeof(header) - 1, check.expected) == sizeof(header) - 1);
+    const char* stamp = strstr(header, "\"generated_at\":\"");
+    CHECK(stamp != NULL);
+    check.stamp_start = (size_t)(stamp - header) + strlen("\"generated_at\":\"");
+    check.stamp_end = (size_t)(strchr(header + check.stamp_start, '"') - header);
+    rewind(check.expected);
+    size_t base = host_heap_in_use();
+    host_heap_reset_peak();
+    double start = host_seconds();
+    CHECK(data_export_stream(EXPORT_TYPE_TRANSACTIONS, EXPORT_FORMAT_JSON, 0, 0, compare_sink, &check) == SYSTEM_OK);
+    elapsed = host_seconds() - start;
+    peak = host_heap_peak() - base;
+    fclose(check.expected);
+    
+    CHECK(check.matches && check.length == (size_t)size);
+    printf("JSON diffusé : %zu octets en %.1f ms, pic du tas %zu octets\n", check.length, elapsed * 1000.0, peak);
+    CHECK(peak <= MAX_EXPORT_HEAP);
+}
+
+// Nombre de pages annoncé par l'arbre des pages (/Type /Pages /Count n)
+static long pdf_page_count(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    CHECK(file != NULL);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    
+    char* content = malloc((size_t)size + 1);
+    CHECK(content != NULL && fread(content, 1, (size_t)size, file) == (size_t)size);
+    content[size] = '\0';
+    fclose(file);
+    
+    // Les flux compressés peuvent contenir des octets nuls : recherche octet par octet
+    static const char marker[] = "/Type /Pages /Count ";
+    long pages = -1;
+    for (long i = 0; i + (long)sizeof(marker) <= size; i++) {
+        if (memcmp(content + i, marker, sizeof(marker) - 1) == 0) {
+            pages = strtol(content + i + sizeof(marker) - 1, NULL, 10);
+        }
+    }
+    free(content);
+    return pages;
+}
+
+static void bench_pdf(void)
+{
+    double elapsed;
+    size_t peak;
+    long size = measure(EXPORT_FORMAT_PDF, "transactions.pdf", &elapsed, &peak);
+    long pages = pdf_page_count(STORAGE_MOUNT_POINT "/transactions.pdf");
+    CHECK(pages > 0);
+    printf("PDF compressé : %ld pages, %ld octets en %.1f ms, pic du tas %zu octets\n",
+           pages, size, elapsed * 1000.0, peak);
+    
+    // Même export sans compression : seul le tampon de page reste alloué
+    size_t base = host_heap_in_use();
+    host_heap_reset_peak();
+    double start = host_seconds();
+    CHECK(pdf_export_transactions(STORAGE_MOUNT_POINT "/transactions_raw.pdf", 0, 0, false, NULL) == SYSTEM_OK);
+    elapsed = host_seconds() - start;
+    size_t raw_peak = host_heap_peak() - base;
+    CHECK(host_heap_in_use() == base);
+    CHECK(pdf_page_count(STORAGE_MOUNT_POINT "/transactions_raw.pdf") == pages);
+    printf("PDF brut : %ld pages en %.1f ms, pic du tas %zu octets\n", pages, elapsed * 1000.0, raw_peak);
+    
+    CHECK(peak <= MAX_PDF_HEAP && raw_peak <= peak);
+}
+
+int main(void)
+{
+    host_storage_reset();
+    CHECK(regulatory_compliance_init() == SYSTEM_OK);
+    CHECK(animals_manager_init() == SYSTEM_OK);
+    CHECK(stock_manager_init() == SYSTEM_OK);
+    CHECK(terrarium_monitor_init() == SYSTEM_OK);
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    CHECK(data_export_init() == SYSTEM_OK);
+    
+    populate(time(NULL));
+    bench_csv();
+    bench_json();
+    bench_pdf();
+    
+    printf("bench_data_export: OK\n");
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,546 @@
+#include "host_test.h"
+#include "app_main.h"
+#include "esp_heap_caps.h"
+#include "esp_rom_crc.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+
+// Journalisation
+
+void host_log(char level, const char* tag, const char* format, ...)
+{
+    static int verbose = -1;
+    if (verbose < 0) {
+        const char* env = getenv("HOST_LOG_VERBOSE");
+        verbose = (env != NULL && env[0] == '1');
+    }
+    if (!verbose && level != 'E' && level != 'W') {
+        return;
+    }
+    
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "%c (%s) ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+system_error_t app_emit_event(const system_event_t* event)
+{
+    return (event != NULL) ? SYSTEM_OK : SYSTEM_ERROR_INVALID_PARAM;
+}
+
+// Tas : chaque bloc est précédé de sa taille pour suivre l'occupation et son pic. Les
+// malloc/calloc/realloc/free des composants passent aussi par ici (édition de liens --wrap)
+
+void* __real_malloc(size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+typedef union {
+    size_t size;
+    max_align_t align;
+} heap_header_t;
+
+static size_t g_heap_in_use = 0;
+static size_t g_heap_peak = 0;
+static pthread_mutex_t g_heap_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void heap_account(ssize_t delta)
+{
+    pthread_mutex_lock(&g_heap_lock);
+    g_heap_in_use += delta;
+    if (g_heap_in_use > g_heap_peak) {
+        g_heap_peak = g_heap_in_use;
+    }
+    pthread_mutex_unlock(&g_heap_lock);
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+    heap_header_t* header = __real_malloc(sizeof(heap_header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    heap_account((ssize_t)size);
+    return header + 1;
+}
+
+void* heap_caps_calloc(size_t count, size_t size, uint32_t caps)
+{
+    void* ptr = heap_caps_malloc(count * size, caps);
+    if (ptr != NULL) {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps)
+{
+    if (ptr == NULL) {
+        return heap_caps_malloc(size, caps);
+    }
+    
+    heap_header_t* header = (heap_header_t*)ptr - 1;
+    size_t old_size = header->size;
+    header = __real_realloc(header, sizeof(heap_header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    heap_account((ssize_t)size - (ssize_t)old_size);
+    return header + 1;
+}
+
+void heap_caps_free(void* ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    
+    heap_header_t* header = (heap_header_t*)ptr - 1;
+    heap_account(-(ssize_t)header->size);
+    __real_free(header);
+}
+
+void* __wrap_malloc(size_t size)
+{
+    return heap_caps_malloc(size, MALLOC_CAP_8BIT);
+}
+
+void* __wrap_calloc(size_t count, size_t size)
+{
+    return heap_caps_calloc(count, size, MALLOC_CAP_8BIT);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    return heap_caps_realloc(ptr, size, MALLOC_CAP_8BIT);
+}
+
+void __wrap_free(void* ptr)
+{
+    heap_caps_free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+    return 8 * 1024 * 1024;
+}
+
+void host_heap_reset_peak(void)
+{
+    pthread_mutex_lock(&g_heap_lock);
+    g_heap_peak = g_heap_in_use;
+    pthread_mutex_unlock(&g_heap_lock);
+}
+
+size_t host_heap_peak(void)
+{
+    return g_heap_peak;
+}
+
+size_t host_heap_in_use(void)
+{
+    return g_heap_in_use;
+}
+
+// Horloge
+
+double host_seconds(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return (int64_t)(host_seconds() * 1e6);
+}
+
+uint32_t esp_rom_crc32_le(uint32_t crc, const uint8_t* buf, uint32_t len)
+{
+    crc = ~crc;
+    while (len-- > 0) {
+        crc ^= *buf++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+    }
+    return ~crc;
+}
+
+// Stockage
+
+void host_storage_reset(void)
+{
+    char command[256];
+    snprintf(command, sizeof(command), "rm -rf '%s' && mkdir -p '%s'", STORAGE_MOUNT_POINT, STORAGE_MOUNT_POINT);
+    if (system(command) != 0) {
+        fprintf(stderr, "Impossible de préparer %s\n", STORAGE_MOUNT_POINT);
+        exit(1);
+    }
+}
+
+// Injection d'échec d'écriture (édition de liens avec -Wl,--wrap=fwrite)
+
+static char g_fail_suffix[64];
+static size_t g_fail_kept = 0;
+static char g_count_suffix[64];
+static size_t g_write_count = 0;
+static pthread_mutex_t g_fail_lock = PTHREAD_MUTEX_INITIALIZER;
+
+size_t __real_fwrite(const void* data, size_t size, size_t count, FILE* file);
+
+void host_fail_next_write(const char* name_suffix, size_t kept_bytes)
+{
+    pthread_mutex_lock(&g_fail_lock);
+    strncpy(g_fail_suffix, name_suffix, sizeof(g_fail_suffix) - 1);
+    g_fail_kept = kept_bytes;
+    pthread_mutex_unlock(&g_fail_lock);
+}
+
+static bool write_targeted(FILE* file, const char* suffix)
+{
+    char link[64];
+    char path[512];
+    snprintf(link, sizeof(link), "/proc/self/fd/%d", fileno(file));
+    ssize_t length = readlink(link, path, sizeof(path) - 1);
+    if (length <= 0) {
+        return false;
+    }
+    path[length] = '\0';
+    
+    size_t suffix_length = strlen(suffix);
+    return (size_t)length >= suffix_length && strcmp(path + length - suffix_length, suffix) == 0;
+}
+
+void host_count_writes(const char* name_suffix)
+{
+    pthread_mutex_lock(&g_fail_lock);
+    snprintf(g_count_suffix, sizeof(g_count_suffix), "%s", name_suffix);
+    g_write_count = 0;
+    pthread_mutex_unlock(&g_fail_lock);
+}
+
+size_t host_write_count(void)
+{
+    pthread_mutex_lock(&g_fail_lock);
+    size_t count = g_write_count;
+    pthread_mutex_unlock(&g_fail_lock);
+    return count;
+}
+
+size_t __wrap_fwrite(const void* data, size_t size, size_t count, FILE* file)
+{
+    pthread_mutex_lock(&g_fail_lock);
+    if (g_count_suffix[0] != '\0' && size * count > 0 && write_targeted(file, g_count_suffix)) {
+        g_write_count++;
+    }
+    bool fail = (g_fail_suffix[0] != '\0' && size * count > 0 && write_targeted(file, g_fail_suffix));
+    size_t kept = g_fail_kept;
+    if (fail) {
+        g_fail_suffix[0] = '\0';
+    }
+    pthread_mutex_unlock(&g_fail_lock);
+    
+    if (!fail) {
+        return __real_fwrite(data, size, count, file);
+    }
+    
+    // Écriture partielle puis échec, comme une coupure ou un support plein
+    if (kept > size * count) {
+        kept = size * count;
+    }
+    __real_fwrite(data, 1, kept, file);
+    fflush(file);
+    return kept / size;
+}
+
+// Renommages (édition de liens avec -Wl,--wrap=rename) : échec injecté ou destination existante
+// refusée comme par FATFS
+
+static char g_rename_fail_suffix[64];
+static bool g_rename_no_replace = false;
+
+int __real_rename(const char* old_path, const char* new_path);
+
+void host_fail_next_rename(const char* name_suffix)
+{
+    pthread_mutex_lock(&g_fail_lock);
+    strncpy(g_rename_fail_suffix, name_suffix, sizeof(g_rename_fail_suffix) - 1);
+    pthread_mutex_unlock(&g_fail_lock);
+}
+
+void host_rename_no_replace(bool enabled)
+{
+    g_rename_no_replace = enabled;
+}
+
+int __wrap_rename(const char* old_path, const char* new_path)
+{
+    if (g_rename_no_replace && access(new_path, F_OK) == 0) {
+        errno = EEXIST;
+        return -1;
+    }
+    
+    pthread_mutex_lock(&g_fail_lock);
+    size_t length = strlen(new_path);
+    size_t suffix_length = strlen(g_rename_fail_suffix);
+    bool fail = (suffix_length > 0 && length >= suffix_length &&
+                 strcmp(new_path + length - suffix_length, g_rename_fail_suffix) == 0);
+    if (fail) {
+        g_rename_fail_suffix[0] = '\0';
+    }
+    pthread_mutex_unlock(&g_fail_lock);
+    
+    if (fail) {
+        errno = EIO;
+        return -1;
+    }
+    return __real_rename(old_path, new_path);
+}
+
+// Sémaphores : un compteur protégé, le mutex retient sa tâche propriétaire
+
+struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max_count;
+    bool is_mutex;
+    TaskHandle_t owner;
+};
+
+struct host_task {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notifications;
+    TaskFunction_t function;
+    void* parameters;
+};
+
+static __thread TaskHandle_t t_current_task = NULL;
+
+static SemaphoreHandle_t semaphore_create(uint32_t max_count, uint32_t initial_count, bool is_mutex)
+{
+    SemaphoreHandle_t semaphore = calloc(1, sizeof(struct host_semaphore));
+    if (semaphore == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&semaphore->lock, NULL);
+    pthread_cond_init(&semaphore->cond, NULL);
+    semaphore->count = initial_count;
+    semaphore->max_count = max_count;
+    semaphore->is_mutex = is_mutex;
+    return semaphore;
+}
+
+// Attend la condition jusqu'à l'échéance ; false si le délai est écoulé
+static bool wait_until(pthread_cond_t* cond, pthread_mutex_t* lock, TickType_t ticks, const struct timespec* deadline)
+{
+    if (ticks == portMAX_DELAY) {
+        pthread_cond_wait(cond, lock);
+        return true;
+    }
+    return pthread_cond_timedwait(cond, lock, deadline) != ETIMEDOUT;
+}
+
+static struct timespec deadline_after(TickType_t ticks)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += ticks / 1000;
+    deadline.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return semaphore_create(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return semaphore_create(1, 0, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    return semaphore_create(max_count, initial_count, false);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks == portMAX_DELAY ? 0 : ticks);
+    BaseType_t taken = pdTRUE;
+    
+    pthread_mutex_lock(&semaphore->lock);
+    // Les mutex FreeRTOS ne sont pas récursifs : une seconde prise bloquerait la tâche sur la cible
+    if (semaphore->is_mutex && semaphore->owner == self) {
+        fprintf(stderr, "Mutex pris deux fois par la même tâche\n");
+        abort();
+    }
+    while (semaphore->count == 0) {
+        if (ticks == 0 || !wait_until(&semaphore->cond, &semaphore->lock, ticks, &deadline)) {
+            taken = (semaphore->count > 0) ? pdTRUE : pdFALSE;
+            break;
+        }
+    }
+    if (taken) {
+        semaphore->count--;
+        if (semaphore->is_mutex) {
+            semaphore->owner = self;
+        }
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore)
+{
+    BaseType_t given = pdFALSE;
+    
+    pthread_mutex_lock(&semaphore->lock);
+    if (semaphore->is_mutex && semaphore->owner != xTaskGetCurrentTaskHandle()) {
+        fprintf(stderr, "Mutex rendu par une tâche qui ne le détient pas\n");
+        abort();
+    }
+    if (semaphore->count < semaphore->max_count) {
+        semaphore->count++;
+        semaphore->owner = NULL;
+        pthread_cond_signal(&semaphore->cond);
+        given = pdTRUE;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    
+    return given;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore)
+{
+    pthread_mutex_destroy(&semaphore->lock);
+    pthread_cond_destroy(&semaphore->cond);
+    free(semaphore);
+}
+
+// Tâches
+
+static TaskHandle_t task_create(void)
+{
+    TaskHandle_t task = calloc(1, sizeof(struct host_task));
+    if (task != NULL) {
+        pthread_mutex_init(&task->lock, NULL);
+        pthread_cond_init(&task->cond, NULL);
+    }
+    return task;
+}
+
+static void* task_entry(void* arg)
+{
+    t_current_task = arg;
+    t_current_task->function(t_current_task->parameters);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth,
+                                   void* parameters, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core)
+{
+    TaskHandle_t task = task_create();
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->function = function;
+    task->parameters = parameters;
+    
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, task_entry, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(thread);
+    
+    if (handle != NULL) {
+        *handle = task;
+    }
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t stack_depth, void* parameters,
+                       UBaseType_t priority, TaskHandle_t* handle)
+{
+    return xTaskCreatePinnedToCore(function, name, stack_depth, parameters, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if (task == NULL || task == t_current_task) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    usleep((useconds_t)ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    // Tâche principale ou fil non créé par xTaskCreate : poignée créée à la première demande
+    if (t_current_task == NULL) {
+        t_current_task = task_create();
+    }
+    return t_current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notifications++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    struct timespec deadline = deadline_after(ticks == portMAX_DELAY ? 0 : ticks);
+    
+    pthread_mutex_lock(&self->lock);
+    while (self->notifications == 0 && ticks != 0) {
+        if (!wait_until(&self->cond, &self->lock, ticks, &deadline)) {
+            break;
+        }
+    }
+    uint32_t value = self->notifications;
+    if (value > 0) {
+        self->notifications = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&self->lock);
+    
+    return value;
+}
\ No newline at end of file
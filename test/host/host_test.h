@@ -0,0 +1,75 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "system_types.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Vérification d'un test : arrêt immédiat avec la position de l'échec
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: échec: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+/**
+ * @brief Vide le répertoire de stockage (STORAGE_MOUNT_POINT) et le recrée
+ */
+void host_storage_reset(void);
+
+/**
+ * @brief Fait échouer la prochaine écriture vers un fichier
+ * @param name_suffix Fin du chemin du fichier visé
+ * @param kept_bytes Octets réellement écrits avant l'échec (écriture partielle)
+ */
+void host_fail_next_write(const char* name_suffix, size_t kept_bytes);
+
+/**
+ * @brief Compte désormais les écritures (appels à fwrite) vers un fichier
+ * @param name_suffix Fin du chemin du fichier visé
+ */
+void host_count_writes(const char* name_suffix);
+
+/**
+ * @brief Écritures comptées depuis host_count_writes
+ * @return Nombre d'appels à fwrite
+ */
+size_t host_write_count(void);
+
+/**
+ * @brief Fait échouer le prochain renommage vers un fichier
+ * @param name_suffix Fin du chemin de destination visé
+ */
+void host_fail_next_rename(const char* name_suffix);
+
+/**
+ * @brief Refuse les renommages vers un fichier existant, comme FATFS sur la cible
+ * @param enabled true pour refuser le remplacement
+ */
+void host_rename_no_replace(bool enabled);
+
+/**
+ * @brief Remet à zéro le pic d'occupation du tas (allocations heap_caps_* et malloc)
+ */
+void host_heap_reset_peak(void);
+
+/**
+ * @brief Pic d'occupation du tas depuis la dernière remise à zéro
+ * @return Octets alloués au plus haut
+ */
+size_t host_heap_peak(void);
+
+/**
+ * @brief Occupation courante du tas
+ * @return Octets alloués
+ */
+size_t host_heap_in_use(void);
+
+/**
+ * @brief Horloge monotone
+ * @return Temps en secondes
+ */
+double host_seconds(void);
+
+#endif // HOST_TEST_H
\ No newline at end of file
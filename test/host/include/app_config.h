@@ -0,0 +1,14 @@
+#ifndef HOST_APP_CONFIG_H
+#define HOST_APP_CONFIG_H
+
+// Configuration de l'application pour les tests sur hôte : stockage dans un répertoire local et
+// cheptel élargi pour les mesures sur un élevage complet
+#include "../../../main/include/app_config.h"
+
+#undef STORAGE_MOUNT_POINT
+#define STORAGE_MOUNT_POINT     HOST_STORAGE_DIR
+
+#undef MAX_ANIMALS
+#define MAX_ANIMALS             2000
+
+#endif // HOST_APP_CONFIG_H
\ No newline at end of file
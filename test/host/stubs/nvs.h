@@ -0,0 +1,6 @@
+#ifndef NVS_H
+#define NVS_H
+
+#include "esp_err.h"
+
+#endif // NVS_H
\ No newline at end of file
@@ -0,0 +1,109 @@
+// Annuaire des contacts : références des transactions, retrait des contacts inutilisés, contacts archivés
+#include "host_test.h"
+#include "transaction_manager.h"
+#include <string.h>
+#include <time.h>
+
+static uint32_t contact_count(void)
+{
+    static transaction_contact_t contacts[MAX_CONTACTS];
+    uint32_t count = 0;
+    CHECK(transaction_contact_get_all(contacts, MAX_CONTACTS, &count) == SYSTEM_OK);
+    return count;
+}
+
+static void make_transaction(transaction_t* transaction, const char* counterpart, time_t date)
+{
+    memset(transaction, 0, sizeof(transaction_t));
+    transaction->type = TRANSACTION_TYPE_SALE;
+    transaction->status = TRANSACTION_STATUS_COMPLETED;
+    transaction->amount = 50.0f;
+    transaction->transaction_date = date;
+    strcpy(transaction->animal_name, "Pogona");
+    snprintf(transaction->counterpart_name, sizeof(transaction->counterpart_name), "%s", counterpart);
+}
+
+// Coordonnées modifiées bien plus souvent que la taille de l'annuaire : l'ancien contact est retiré à chaque fois
+static void test_updates_reclaim_contacts(void)
+{
+    transaction_t transaction;
+    make_transaction(&transaction, "Client 0", time(NULL));
+    CHECK(transaction_create(&transaction) == SYSTEM_OK);
+    
+    for (uint32_t i = 1; i <= 3 * MAX_CONTACTS; i++) {
+        snprintf(transaction.counterpart_name, sizeof(transaction.counterpart_name), "Client %u", i);
+        snprintf(transaction.counterpart_email, sizeof(transaction.counterpart_email), "client%u@example.org", i);
+        CHECK(transaction_update(&transaction) == SYSTEM_OK);
+    }
+    CHECK(contact_count() == 1);
+    
+    transaction_t read;
+    CHECK(transaction_get_by_id(transaction.id, &read) == SYSTEM_OK);
+    CHECK(strcmp(read.counterpart_name, transaction.counterpart_name) == 0);
+    
+    CHECK(transaction_delete(transaction.id) == SYSTEM_OK);
+    CHECK(contact_count() == 0);
+    printf("%d modifications de coordonnées, un seul contact conservé\n", 3 * MAX_CONTACTS);
+}
+
+// Un contact partagé reste tant qu'une transaction le désigne
+static void test_shared_contact_kept(void)
+{
+    transaction_t first;
+    transaction_t second;
+    make_transaction(&first, "Jean Dupont", time(NULL));
+    make_transaction(&second, "Jean Dupont", time(NULL));
+    CHECK(transaction_create(&first) == SYSTEM_OK);
+    CHECK(transaction_create(&second) == SYSTEM_OK);
+    CHECK(first.counterpart_id == second.counterpart_id && contact_count() == 1);
+    
+    strcpy(first.counterpart_name, "Marie Martin");
+    first.counterpart_id = 0;
+    CHECK(transaction_update(&first) == SYSTEM_OK);
+    CHECK(contact_count() == 2);
+    
+    transaction_contact_t contact;
+    CHECK(transaction_contact_get(second.counterpart_id, &contact) == SYSTEM_OK);
+    CHECK(strcmp(contact.name, "Jean Dupont") == 0 && contact.transaction_count == 1);
+    
+    CHECK(transaction_delete(second.id) == SYSTEM_OK);
+    CHECK(transaction_contact_get(second.counterpart_id, &contact) == SYSTEM_ERROR_NOT_FOUND);
+    CHECK(transaction_delete(first.id) == SYSTEM_OK);
+    CHECK(contact_count() == 0);
+    printf("Contact partagé conservé jusqu'à sa dernière transaction\n");
+}
+
+// Le contact d'une transaction archivée reste dans l'annuaire sans transaction en mémoire
+static void test_archived_contact_kept(void)
+{
+    time_t now = time(NULL);
+    transaction_t transaction;
+    make_transaction(&transaction, "Ancien Client", now - 400L * 86400);
+    CHECK(transaction_create(&transaction) == SYSTEM_OK);
+    
+    uint32_t archived = 0;
+    CHECK(transaction_archive_old(now, &archived) == SYSTEM_OK && archived == 1);
+    
+    transaction_contact_t contact;
+    CHECK(transaction_contact_find("ancien client", &contact) == SYSTEM_OK);
+    CHECK(contact.id == transaction.counterpart_id && contact.transaction_count == 0);
+    
+    static transaction_t history[4];
+    uint32_t count = 0;
+    CHECK(transaction_get_by_contact(contact.id, history, 4, &count) == SYSTEM_OK && count == 1);
+    CHECK(history[0].id == transaction.id);
+    printf("Contact d'une transaction archivée conservé\n");
+}
+
+int main(void)
+{
+    host_storage_reset();
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    
+    test_updates_reclaim_contacts();
+    test_shared_contact_kept();
+    test_archived_contact_kept();
+    
+    printf("test_contact_directory: OK\n");
+    return 0;
+}
\ No newline at end of file
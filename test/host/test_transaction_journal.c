@@ -0,0 +1,353 @@
+// Coupures d'alimentation et échecs d'écriture du journal des transactions, sur fichier réel
+#include "host_test.h"
+#include "transaction_journal.h"
+#include "transaction_manager.h"
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define RECORD_COUNT    40
+#define JOURNAL_PATH    STORAGE_MOUNT_POINT "/cut.wal"
+#define TMP_PATH        JOURNAL_PATH ".tmp"
+
+// Enregistrements relus par le rappel de relecture
+static uint8_t g_replayed[RECORD_COUNT + 2][JOURNAL_MAX_PAYLOAD];
+static size_t g_replayed_length[RECORD_COUNT + 2];
+static uint32_t g_replayed_count = 0;
+
+static void collect(journal_op_t op, const uint8_t* payload, size_t length)
+{
+    CHECK(op == JOURNAL_OP_PUT);
+    CHECK(g_replayed_count < RECORD_COUNT + 2);
+    memcpy(g_replayed[g_replayed_count], payload, length);
+    g_replayed_length[g_replayed_count] = length;
+    g_replayed_count++;
+}
+
+static uint32_t reopen(void)
+{
+    g_replayed_count = 0;
+    CHECK(transaction_journal_init(JOURNAL_PATH, collect) == SYSTEM_OK);
+    return g_replayed_count;
+}
+
+// Charge utile reconnaissable : longueur et contenu dérivés du numéro
+static size_t make_payload(uint32_t number, uint8_t* payload)
+{
+    size_t length = 1 + (number * 37) % 300;
+    for (size_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(number * 31 + i);
+    }
+    return length;
+}
+
+static void check_replayed(uint32_t index, uint32_t number)
+{
+    uint8_t expected[JOURNAL_MAX_PAYLOAD];
+    size_t length = make_payload(number, expected);
+    CHECK(g_replayed_length[index] == length);
+    CHECK(memcmp(g_replayed[index], expected, length) == 0);
+}
+
+// Ajout synchrone (sans tâche de validation) : renvoie le résultat de durabilité
+static system_error_t append(uint32_t number)
+{
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+    uint32_t sequence;
+    CHECK(transaction_journal_append(JOURNAL_OP_PUT, payload, make_payload(number, payload), &sequence) == SYSTEM_OK);
+    return transaction_journal_wait(sequence);
+}
+
+static long file_size(const char* path)
+{
+    struct stat st;
+    return (stat(path, &st) == 0) ? (long)st.st_size : -1;
+}
+
+static void write_file(const char* path, const uint8_t* data, size_t length)
+{
+    FILE* file = fopen(path, "wb");
+    CHECK(file != NULL);
+    CHECK(fwrite(data, 1, length, file) == length);
+    CHECK(fclose(file) == 0);
+}
+
+// Coupure à chaque octet du journal : seuls les enregistrements complets sont relus,
+// la fin incomplète est retirée et un nouvel ajout est relu à sa suite
+static void test_power_cut(void)
+{
+    static uint8_t image[RECORD_COUNT * (JOURNAL_MAX_PAYLOAD + 16)];
+    long ends[RECORD_COUNT];
+    
+    host_storage_reset();
+    CHECK(reopen() == 0);
+    for (uint32_t i = 0; i < RECORD_COUNT; i++) {
+        CHECK(append(i) == SYSTEM_OK);
+        ends[i] = file_size(JOURNAL_PATH);
+    }
+    
+    long total = ends[RECORD_COUNT - 1];
+    FILE* file = fopen(JOURNAL_PATH, "rb");
+    CHECK(file != NULL && fread(image, 1, (size_t)total, file) == (size_t)total);
+    fclose(file);
+    
+    for (long cut = 0; cut <= total; cut++) {
+        write_file(JOURNAL_PATH, image, (size_t)cut);
+        
+        uint32_t complete = 0;
+        while (complete < RECORD_COUNT && ends[complete] <= cut) {
+            complete++;
+        }
+        CHECK(reopen() == complete);
+        for (uint32_t i = 0; i < complete; i++) {
+            check_replayed(i, i);
+        }
+        CHECK(file_size(JOURNAL_PATH) == (complete > 0 ? ends[complete - 1] : 0));
+        
+        CHECK(append(1000) == SYSTEM_OK);
+        CHECK(reopen() == complete + 1);
+        check_replayed(complete, 1000);
+    }
+    
+    printf("Coupure à chacun des %ld octets : relecture cohérente\n", total + 1);
+}
+
+// Octet altéré au milieu du journal : relecture arrêtée à l'enregistrement précédent
+static void test_corrupted_record(void)
+{
+    host_storage_reset();
+    CHECK(reopen() == 0);
+    long ends[RECORD_COUNT];
+    for (uint32_t i = 0; i < RECORD_COUNT; i++) {
+        CHECK(append(i) == SYSTEM_OK);
+        ends[i] = file_size(JOURNAL_PATH);
+    }
+    
+    const uint32_t damaged = RECORD_COUNT / 2;
+    FILE* file = fopen(JOURNAL_PATH, "r+b");
+    CHECK(file != NULL);
+    fseek(file, ends[damaged - 1] + 14, SEEK_SET);
+    int byte = fgetc(file);
+    fseek(file, ends[damaged - 1] + 14, SEEK_SET);
+    fputc(byte ^ 0x40, file);
+    fclose(file);
+    
+    CHECK(reopen() == damaged);
+    CHECK(file_size(JOURNAL_PATH) == ends[damaged - 1]);
+    printf("Enregistrement altéré : %u enregistrements conservés\n", damaged);
+}
+
+// Écriture partielle : le journal revient à sa taille durable et les ajouts suivants restent relisibles
+static void test_failed_write(void)
+{
+    host_storage_reset();
+    CHECK(reopen() == 0);
+    for (uint32_t i = 0; i < 3; i++) {
+        CHECK(append(i) == SYSTEM_OK);
+    }
+    long durable = file_size(JOURNAL_PATH);
+    
+    host_fail_next_write("cut.wal", 9);
+    CHECK(append(3) == SYSTEM_ERROR_STORAGE);
+    CHECK(file_size(JOURNAL_PATH) == durable);
+    
+    CHECK(append(4) == SYSTEM_OK);
+    CHECK(reopen() == 4);
+    check_replayed(0, 0);
+    check_replayed(1, 1);
+    check_replayed(2, 2);
+    check_replayed(3, 4);
+    printf("Écriture partielle retirée, ajouts suivants relus\n");
+}
+
+// Point de reprise contenant les enregistrements first à first + count - 1
+static system_error_t checkpoint(uint32_t first, uint32_t count)
+{
+    uint8_t payload[JOURNAL_MAX_PAYLOAD];
+    CHECK(transaction_journal_checkpoint_begin() == SYSTEM_OK);
+    for (uint32_t i = 0; i < count; i++) {
+        CHECK(transaction_journal_checkpoint_write(JOURNAL_OP_PUT, payload, make_payload(first + i, payload)) == SYSTEM_OK);
+    }
+    return transaction_journal_checkpoint_end(true);
+}
+
+// Renommage du point de reprise refusé : le nouveau journal reste le journal courant sous son nom
+// temporaire, jamais remplacé par un journal vide, et il est renommé ensuite
+static void test_checkpoint_rename_failure(void)
+{
+    host_storage_reset();
+    host_rename_no_replace(true);
+    CHECK(reopen() == 0);
+    for (uint32_t i = 0; i < 5; i++) {
+        CHECK(append(i) == SYSTEM_OK);
+    }
+    
+    // Remplacement refusé comme sur FAT : l'ancien journal n'est supprimé qu'au renommage
+    CHECK(checkpoint(100, 3) == SYSTEM_OK);
+    CHECK(file_size(TMP_PATH) < 0);
+    CHECK(reopen() == 3);
+    check_replayed(2, 102);
+    
+    // Renommage en échec : le .tmp reçoit les ajouts suivants et est retenu à la relecture
+    host_fail_next_rename("cut.wal");
+    CHECK(checkpoint(200, 2) == SYSTEM_ERROR_STORAGE);
+    CHECK(file_size(JOURNAL_PATH) < 0 && file_size(TMP_PATH) > 0);
+    CHECK(append(300) == SYSTEM_OK);
+    CHECK(reopen() == 3);
+    check_replayed(0, 200);
+    check_replayed(1, 201);
+    check_replayed(2, 300);
+    CHECK(file_size(TMP_PATH) < 0);
+    
+    // Le point de reprise suivant renomme d'abord le .tmp resté courant
+    host_fail_next_rename("cut.wal");
+    CHECK(checkpoint(400, 1) == SYSTEM_ERROR_STORAGE);
+    CHECK(checkpoint(500, 2) == SYSTEM_OK);
+    CHECK(file_size(TMP_PATH) < 0);
+    CHECK(append(600) == SYSTEM_OK);
+    CHECK(reopen() == 3);
+    check_replayed(0, 500);
+    check_replayed(1, 501);
+    check_replayed(2, 600);
+    
+    host_rename_no_replace(false);
+    printf("Renommage du point de reprise refusé : aucun enregistrement perdu\n");
+}
+
+// Modification non persistée : erreur renvoyée et état en mémoire inchangé. Le scénario tourne dans
+// un processus fils ; le parent relit ensuite le journal comme au redémarrage
+static void run_failed_commits(void)
+{
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    
+    transaction_t kept = {0};
+    kept.type = TRANSACTION_TYPE_SALE;
+    kept.status = TRANSACTION_STATUS_COMPLETED;
+    kept.amount = 120.0f;
+    kept.transaction_date = time(NULL);
+    strcpy(kept.animal_name, "Pogona");
+    strcpy(kept.counterpart_name, "Jean Dupont");
+    CHECK(transaction_create(&kept) == SYSTEM_OK);
+    
+    transaction_t lost = kept;
+    lost.amount = 80.0f;
+    host_fail_next_write("txn.wal", 0);
+    CHECK(transaction_create(&lost) == SYSTEM_ERROR_STORAGE);
+    transaction_t read;
+    CHECK(transaction_get_by_id(lost.id, &read) == SYSTEM_ERROR_NOT_FOUND);
+    
+    transaction_t changed = kept;
+    changed.amount = 999.0f;
+    strcpy(changed.animal_name, "Modifié");
+    host_fail_next_write("txn.wal", 20);
+    CHECK(transaction_update(&changed) == SYSTEM_ERROR_STORAGE);
+    CHECK(transaction_get_by_id(kept.id, &read) == SYSTEM_OK);
+    CHECK(read.amount == 120.0f && strcmp(read.animal_name, "Pogona") == 0);
+    
+    host_fail_next_write("txn.wal", 0);
+    CHECK(transaction_delete(kept.id) == SYSTEM_ERROR_STORAGE);
+    CHECK(transaction_get_by_id(kept.id, &read) == SYSTEM_OK);
+    
+    transaction_t restored[2] = { changed, lost };
+    host_fail_next_write("txn.wal", 0);
+    CHECK(transaction_restore(restored, 2) == SYSTEM_ERROR_STORAGE);
+    CHECK(transaction_get_by_id(kept.id, &read) == SYSTEM_OK && read.amount == 120.0f);
+    CHECK(transaction_get_by_id(lost.id, &read) == SYSTEM_ERROR_NOT_FOUND);
+    
+    financial_stats_t stats;
+    CHECK(transaction_get_financial_stats(&stats) == SYSTEM_OK);
+    CHECK(stats.total_transactions == 1 && stats.total_sales_amount == 120.0f);
+    
+    // Le journal reste utilisable et ne contient que la transaction conservée
+    changed.amount = 150.0f;
+    CHECK(transaction_update(&changed) == SYSTEM_OK);
+    CHECK(transaction_get_by_id(kept.id, &read) == SYSTEM_OK && read.amount == 150.0f);
+    printf("Création, modification, suppression et restauration non persistées annulées\n");
+}
+
+static void test_failed_commit_rolls_back(void)
+{
+    host_storage_reset();
+    fflush(NULL);
+    pid_t pid = fork();
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        run_failed_commits();
+        exit(0);
+    }
+    int status;
+    CHECK(waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    
+    // Relecture : seule la dernière modification durable de la transaction conservée subsiste
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    transaction_t read[2];
+    uint32_t count = 0;
+    CHECK(transaction_get_by_date_range(0, 0, 0, read, 2, &count) == SYSTEM_OK && count == 1);
+    CHECK(read[0].amount == 150.0f && strcmp(read[0].animal_name, "Modifié") == 0);
+    
+    financial_stats_t stats;
+    CHECK(transaction_get_financial_stats(&stats) == SYSTEM_OK);
+    CHECK(stats.total_transactions == 1 && stats.total_sales_amount == 150.0f);
+    printf("Relecture du journal sans les modifications annulées\n");
+}
+
+// Créations simultanées : une seule écriture du journal les rend toutes durables
+#define GROUP_WRITERS   JOURNAL_MAX_WAITERS
+
+static pthread_barrier_t g_group_start;
+
+static void* create_in_group(void* arg)
+{
+    transaction_t* transaction = (transaction_t*)arg;
+    pthread_barrier_wait(&g_group_start);
+    CHECK(transaction_create(transaction) == SYSTEM_OK);
+    return NULL;
+}
+
+static void test_group_commit(void)
+{
+    static transaction_t created[GROUP_WRITERS];
+    pthread_t threads[GROUP_WRITERS];
+    
+    CHECK(pthread_barrier_init(&g_group_start, NULL, GROUP_WRITERS) == 0);
+    host_count_writes("txn.wal");
+    for (uint32_t i = 0; i < GROUP_WRITERS; i++) {
+        memset(&created[i], 0, sizeof(transaction_t));
+        created[i].type = TRANSACTION_TYPE_PURCHASE;
+        created[i].status = TRANSACTION_STATUS_COMPLETED;
+        created[i].amount = 10.0f + (float)i;
+        created[i].transaction_date = time(NULL);
+        snprintf(created[i].animal_name, sizeof(created[i].animal_name), "Lot %u", i);
+        CHECK(pthread_create(&threads[i], NULL, create_in_group, &created[i]) == 0);
+    }
+    for (uint32_t i = 0; i < GROUP_WRITERS; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+    CHECK(pthread_barrier_destroy(&g_group_start) == 0);
+    
+    size_t writes = host_write_count();
+    host_count_writes("");
+    CHECK(writes == 1);
+    
+    transaction_t read;
+    for (uint32_t i = 0; i < GROUP_WRITERS; i++) {
+        CHECK(transaction_get_by_id(created[i].id, &read) == SYSTEM_OK && read.amount == created[i].amount);
+    }
+    printf("%d créations simultanées, %zu écriture du journal\n", GROUP_WRITERS, writes);
+}
+
+
+int main(void)
+{
+    test_power_cut();
+    test_corrupted_record();
+    test_failed_write();
+    test_checkpoint_rename_failure();
+    test_failed_commit_rolls_back();
+    test_group_commit();
+    
+    printf("test_transaction_journal: OK\n");
+    return 0;
+}
\ No newline at end of file
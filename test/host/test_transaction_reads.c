@@ -0,0 +1,190 @@
+// Lectures des transactions par lots sous le verrou, archive comprise, pendant des modifications concurrentes
+#include "host_test.h"
+#include "transaction_manager.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#define TRANSACTION_COUNT   300
+#define SAME_DATE_GROUP     150     // Transactions partageant une date, au-delà d'un lot
+#define WRITER_ROUNDS       200
+
+typedef struct {
+    time_t date;
+    uint32_t id;
+} position_t;
+
+typedef struct {
+    position_t positions[TRANSACTION_COUNT + WRITER_ROUNDS];
+    uint32_t count;
+    bool ordered;           // (date, ID) strictement croissants
+    bool reentered;         // Lecture par ID depuis le rappel
+} walk_t;
+
+static time_t g_now;
+static atomic_bool g_writer_done;
+
+static bool record_position(const transaction_t* transaction, void* context)
+{
+    walk_t* walk = (walk_t*)context;
+    
+    if (walk->count > 0) {
+        const position_t* last = &walk->positions[walk->count - 1];
+        if (transaction->transaction_date < last->date ||
+            (transaction->transaction_date == last->date && transaction->id <= last->id)) {
+            walk->ordered = false;
+        }
+    }
+    CHECK(walk->count < TRANSACTION_COUNT + WRITER_ROUNDS);
+    walk->positions[walk->count].date = transaction->transaction_date;
+    walk->positions[walk->count].id = transaction->id;
+    walk->count++;
+    
+    // Le rappel est appelé hors du verrou : il peut relire le gestionnaire
+    transaction_t copy;
+    walk->reentered = (transaction_get_by_id(transaction->id, &copy) == SYSTEM_OK && copy.id == transaction->id);
+    return true;
+}
+
+static void create_transaction(uint32_t number, time_t date, transaction_status_t status)
+{
+    transaction_t transaction = {0};
+    transaction.type = TRANSACTION_TYPE_SALE;
+    transaction.status = status;
+    transaction.amount = 10.0f + (float)number;
+    transaction.animal_id = 1 + number % 5;
+    transaction.transaction_date = date;
+    snprintf(transaction.animal_name, sizeof(transaction.animal_name), "Animal %u", number % 5);
+    snprintf(transaction.counterpart_name, sizeof(transaction.counterpart_name), "Client %u", number % 3);
+    CHECK(transaction_create(&transaction) == SYSTEM_OK);
+}
+
+// Moitié ancienne (archivée), moitié récente (en mémoire), par groupes de même date ; des transactions
+// en attente, restées en mémoire, s'intercalent entre deux groupes archivés
+static void populate(void)
+{
+    for (uint32_t i = 0; i < TRANSACTION_COUNT; i++) {
+        uint32_t group = i / SAME_DATE_GROUP;
+        if (i % 2 == 0) {
+            create_transaction(i, g_now - (time_t)(200 + group) * 86400, TRANSACTION_STATUS_COMPLETED);
+        } else if (i % 10 == 1) {
+            create_transaction(i, g_now - 200 * 86400 - 43200, TRANSACTION_STATUS_PENDING);
+        } else {
+            create_transaction(i, g_now - (time_t)group * 3600, TRANSACTION_STATUS_COMPLETED);
+        }
+    }
+    
+    uint32_t archived = 0;
+    CHECK(transaction_archive_old(g_now, &archived) == SYSTEM_OK);
+    CHECK(archived == TRANSACTION_COUNT / 2);
+}
+
+static void test_batched_walks(void)
+{
+    static walk_t walk;
+    walk.count = 0;
+    walk.ordered = true;
+    CHECK(transaction_for_each(0, 0, record_position, &walk) == SYSTEM_OK);
+    CHECK(walk.count == TRANSACTION_COUNT && walk.ordered && walk.reentered);
+    
+    // Pages de taille première : chaque page reprend exactement où s'arrête la précédente
+    static transaction_t page[7];
+    uint32_t offset = 0;
+    for (uint32_t count; transaction_get_by_date_range(0, 0, offset, page, 7, &count) == SYSTEM_OK && count > 0; ) {
+        for (uint32_t i = 0; i < count; i++) {
+            CHECK(page[i].id == walk.positions[offset + i].id);
+        }
+        offset += count;
+    }
+    CHECK(offset == TRANSACTION_COUNT);
+    
+    // Historique d'un animal : même ordre, archive comprise
+    static transaction_t history[TRANSACTION_COUNT];
+    uint32_t count = 0;
+    CHECK(transaction_get_by_animal(3, history, TRANSACTION_COUNT, &count) == SYSTEM_OK);
+    CHECK(count == TRANSACTION_COUNT / 5);
+    for (uint32_t i = 0, j = 0; i < walk.count; i++) {
+        transaction_t transaction;
+        CHECK(transaction_get_by_id(walk.positions[i].id, &transaction) == SYSTEM_OK);
+        if (transaction.animal_id == 3) {
+            CHECK(history[j++].id == transaction.id);
+        }
+    }
+    
+    transaction_contact_t contact;
+    CHECK(transaction_contact_find("Client 1", &contact) == SYSTEM_OK);
+    CHECK(transaction_get_by_contact(contact.id, history, TRANSACTION_COUNT, &count) == SYSTEM_OK);
+    CHECK(count == TRANSACTION_COUNT / 3);
+    CHECK(transaction_get_by_contact(contact.id, history, 0, &count) == SYSTEM_OK && count == 0);
+    
+    printf("Parcours par lots : %u transactions ordonnées, pages et historiques identiques\n", walk.count);
+}
+
+// Créations, modifications, suppressions et archivages pendant les parcours
+static void* writer(void* arg)
+{
+    for (uint32_t i = 0; i < WRITER_ROUNDS; i++) {
+        create_transaction(TRANSACTION_COUNT + i, g_now - (time_t)(i % 50) * 3600, TRANSACTION_STATUS_COMPLETED);
+        
+        transaction_t changed;
+        uint32_t count = 0;
+        if (transaction_get_by_date_range(g_now - 86400, 0, i % 20, &changed, 1, &count) == SYSTEM_OK && count == 1) {
+            if (i % 3 == 0) {
+                CHECK(transaction_delete(changed.id) == SYSTEM_OK);
+            } else {
+                changed.amount += 1.0f;
+                strcpy(changed.notes, (i % 2) ? "Texte modifié pendant le parcours" : "Autre texte");
+                CHECK(transaction_update(&changed) == SYSTEM_OK);
+            }
+        }
+        if (i % 25 == 0) {
+            uint32_t archived;
+            CHECK(transaction_archive_old(g_now, &archived) == SYSTEM_OK);
+        }
+    }
+    atomic_store(&g_writer_done, true);
+    return NULL;
+}
+
+static void test_concurrent_walks(void)
+{
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, writer, NULL) == 0);
+    
+    static walk_t walk;
+    uint32_t walks = 0;
+    for (bool running = true; running; walks++) {
+        running = !atomic_load(&g_writer_done);
+        walk.count = 0;
+        walk.ordered = true;
+        CHECK(transaction_for_each(0, 0, record_position, &walk) == SYSTEM_OK);
+        CHECK(walk.ordered);
+        
+        financial_stats_t stats;
+        CHECK(transaction_get_financial_stats(&stats) == SYSTEM_OK);
+    }
+    CHECK(pthread_join(thread, NULL) == 0);
+    
+    walk.count = 0;
+    walk.ordered = true;
+    CHECK(transaction_for_each(0, 0, record_position, &walk) == SYSTEM_OK);
+    financial_stats_t stats;
+    CHECK(transaction_get_financial_stats(&stats) == SYSTEM_OK);
+    CHECK(walk.ordered && walk.count == stats.total_transactions);
+    printf("%u parcours pendant les modifications, %u transactions à la fin\n", walks, walk.count);
+}
+
+int main(void)
+{
+    host_storage_reset();
+    g_now = time(NULL);
+    CHECK(transaction_manager_init() == SYSTEM_OK);
+    
+    populate();
+    test_batched_walks();
+    test_concurrent_walks();
+    
+    printf("test_transaction_reads: OK\n");
+    return 0;
+}
\ No newline at end of file